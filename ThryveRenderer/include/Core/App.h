@@ -44,6 +44,7 @@ namespace Thryve::Core {
         void PushOverlay(Layer* overlay);
 
         [[nodiscard]] Core::SharedRef<Rendering::RenderContext> GetRenderContext() const { return m_renderContext; };
+        [[nodiscard]] UI::ImGuiLayer* GetImGuiLayer() const { return m_imGuiLayer; }
 
         void Run();
 
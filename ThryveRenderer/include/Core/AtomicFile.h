@@ -0,0 +1,10 @@
+#pragma once
+#include <filesystem>
+#include <functional>
+#include <ostream>
+
+namespace Thryve::Core {
+    // Creates the parent directories, lets write fill path.tmp and renames it over path, so a crash never leaves a
+    // half-written file behind. Throws std::runtime_error when the file cannot be written or replaced.
+    void WriteFileAtomically(const std::filesystem::path& path, const std::function<void(std::ostream&)>& write);
+} // namespace Thryve::Core
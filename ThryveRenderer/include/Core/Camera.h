@@ -15,6 +15,12 @@ struct UniformTransform {
 };
 
 namespace Thryve::Core {
+    struct Ray {
+        glm::vec3 Origin;
+        // Normalized
+        glm::vec3 Direction;
+    };
+
     class Camera final {
     public:
         explicit Camera(const glm::vec3& position = glm::vec3(-9.f, 2.f, 2.f),
@@ -22,7 +28,12 @@ namespace Thryve::Core {
                         const glm::vec3& upVector = glm::vec3(0.0f, 1.0f, 0.0f), float nearPlane = .1f,
                         float farPlane = 4000.0f, float aspectRatio = 800.f / 600.f);
 
-        std::array<glm::vec4, 6> CalculateFrustrumPlanes();
+        // World space planes for Rendering::Frustum, tested by the FrustumCuller
+        [[nodiscard]] std::array<glm::vec4, 6> CalculateFrustrumPlanes() const;
+
+        // World space ray through a point given in normalized device coordinates of the projection, x pointing
+        // right and y up, both from -1 to 1. Starts on the near plane
+        [[nodiscard]] Ray ScreenPointToRay(const glm::vec2& ndc) const;
 
         void Move(const glm::vec3& direction, float increment);
 
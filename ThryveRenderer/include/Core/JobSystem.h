@@ -0,0 +1,333 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "IService.h"
+
+namespace Thryve::Core {
+    /**
+     * Type-erased callable stored inline. Jobs never allocate, so the captured state has to fit into
+     * STORAGE_SIZE; capture large data by reference or pointer.
+     */
+    class JobFunction {
+    public:
+        static constexpr size_t STORAGE_SIZE = 48;
+
+        JobFunction() = default;
+        JobFunction(const JobFunction&) = delete;
+        JobFunction& operator=(const JobFunction&) = delete;
+        ~JobFunction() { Reset(); }
+
+        template <typename Func>
+        void Emplace(Func&& func)
+        {
+            using Callable = std::decay_t<Func>;
+            static_assert(sizeof(Callable) <= STORAGE_SIZE, "Job captures too much state, capture by reference instead");
+            static_assert(alignof(Callable) <= alignof(std::max_align_t), "Job capture is over-aligned");
+
+            Reset();
+            new (m_storage) Callable(std::forward<Func>(func));
+            m_invoke = [](void* storage) { (*static_cast<Callable*>(storage))(); };
+            m_destroy = [](void* storage) { static_cast<Callable*>(storage)->~Callable(); };
+        }
+
+        void operator()() { m_invoke(m_storage); }
+
+        void Reset()
+        {
+            if (m_destroy)
+            {
+                m_destroy(m_storage);
+            }
+            m_invoke = nullptr;
+            m_destroy = nullptr;
+        }
+
+    private:
+        alignas(std::max_align_t) std::byte m_storage[STORAGE_SIZE]{};
+        void (*m_invoke)(void*) = nullptr;
+        void (*m_destroy)(void*) = nullptr;
+    };
+
+    class JobCounter;
+
+    struct alignas(64) Job {
+        JobFunction Function;
+        // Signalled once Function has run, may be null
+        JobCounter* Counter = nullptr;
+        // Intrusive link while the job waits on a dependency
+        Job* NextContinuation = nullptr;
+        std::atomic<bool> bIsUsed{false};
+    };
+
+    /**
+     * Counts outstanding jobs. Jobs started with a counter increment it and decrement it when they finish,
+     * jobs started with a dependency only get scheduled once that counter reaches zero.
+     * A counter has to outlive every job referencing it, typically by waiting on it before it goes out of scope.
+     * Only add jobs to a counter from inside one of its own jobs or after it has been waited on.
+     */
+    class JobCounter {
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        [[nodiscard]] bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+
+        // Set while the last job collects continuations, so waiters cannot release the counter underneath it
+        static constexpr uint32_t FINISHING = 1u << 31;
+
+        std::atomic<uint32_t> m_pending{0};
+        std::mutex m_continuationMutex;
+        Job* m_continuations = nullptr;
+    };
+
+    /**
+     * Fixed-capacity Chase-Lev work-stealing deque (Le et al., "Correct and Efficient Work-Stealing for Weak
+     * Memory Models"). The owning worker pushes and pops at the bottom, every other worker steals from the top.
+     */
+    class JobDeque {
+    public:
+        static constexpr int64_t CAPACITY = 4096;
+
+        bool Push(Job* job)
+        {
+            const int64_t _bottom = m_bottom.load(std::memory_order_relaxed);
+            const int64_t _top = m_top.load(std::memory_order_acquire);
+            if (_bottom - _top >= CAPACITY)
+            {
+                return false;
+            }
+
+            m_jobs[_bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+            m_bottom.store(_bottom + 1, std::memory_order_release);
+            return true;
+        }
+
+        Job* Pop()
+        {
+            const int64_t _bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            m_bottom.store(_bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t _top = m_top.load(std::memory_order_relaxed);
+
+            if (_top > _bottom)
+            {
+                m_bottom.store(_bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            Job* _job = m_jobs[_bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+            if (_top == _bottom)
+            {
+                // Last job, race the thieves for it
+                if (!m_top.compare_exchange_strong(_top, _top + 1, std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed))
+                {
+                    _job = nullptr;
+                }
+                m_bottom.store(_bottom + 1, std::memory_order_relaxed);
+            }
+            return _job;
+        }
+
+        Job* Steal()
+        {
+            int64_t _top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t _bottom = m_bottom.load(std::memory_order_acquire);
+
+            if (_top >= _bottom)
+            {
+                return nullptr;
+            }
+
+            Job* _job = m_jobs[_top & (CAPACITY - 1)].load(std::memory_order_acquire);
+            if (!m_top.compare_exchange_strong(_top, _top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            return _job;
+        }
+
+        [[nodiscard]] bool IsEmpty() const
+        {
+            return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+        }
+
+    private:
+        alignas(64) std::atomic<int64_t> m_top{0};
+        alignas(64) std::atomic<int64_t> m_bottom{0};
+        std::array<std::atomic<Job*>, CAPACITY> m_jobs{};
+    };
+
+    struct JobSystemConfiguration : ServiceConfiguration {
+        // 0 picks hardware_concurrency - 1, the thread calling Init is always worker 0
+        uint32_t WorkerCount = 0;
+    };
+
+    /**
+     * Work-stealing job scheduler.
+     * Every worker owns a JobDeque and a ring of preallocated jobs, so starting a job takes no lock and no
+     * allocation. Idle workers steal from random victims and go to sleep only after spinning for a while.
+     * Threads that are not workers hand their jobs over through a locked injection queue.
+     */
+    class JobSystem : public IService {
+    public:
+        static constexpr uint32_t MAX_JOBS_PER_THREAD = JobDeque::CAPACITY;
+
+        JobSystem();
+        ~JobSystem() override;
+
+        void Init(ServiceConfiguration* configuration) override;
+        // Expects every counter to have been waited on, jobs still queued are dropped
+        void ShutDown() override;
+
+        // Runs func on any worker. counter is incremented now and decremented once func has run.
+        template <typename Func>
+        void Run(Func&& func, JobCounter* counter = nullptr)
+        {
+            RunAfter(nullptr, std::forward<Func>(func), counter);
+        }
+
+        // Like Run, but func is only scheduled once dependency has reached zero
+        template <typename Func>
+        void RunAfter(JobCounter* dependency, Func&& func, JobCounter* counter = nullptr)
+        {
+            if (counter)
+            {
+                counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            Job* _job = AllocateJob();
+            if (!_job)
+            {
+                // Every slot of this thread is still in flight, degrade to running inline
+                WaitFor(dependency);
+                func();
+                FinishCounter(counter);
+                return;
+            }
+
+            _job->Function.Emplace(std::forward<Func>(func));
+            _job->Counter = counter;
+            Schedule(_job, dependency);
+        }
+
+        // Executes other jobs until counter reaches zero, so waiting never leaves a core idle
+        void Wait(const JobCounter& counter);
+
+        /**
+         * Splits [0, count) into batches of at least batchSize and calls func(begin, end) for each on the workers.
+         * Returns once every batch has run, the calling thread works on batches while it waits.
+         */
+        template <typename Func>
+        void ParallelFor(const uint32_t count, const uint32_t batchSize, Func&& func)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            const uint32_t _batchSize = GetBatchSize(count, batchSize);
+            if (_batchSize >= count)
+            {
+                func(0u, count);
+                return;
+            }
+
+            JobCounter _counter;
+            for (uint32_t _begin = 0; _begin < count; _begin += _batchSize)
+            {
+                const uint32_t _end = std::min(count, _begin + _batchSize);
+                Run([&func, _begin, _end] { func(_begin, _end); }, &_counter);
+            }
+            Wait(_counter);
+        }
+
+        /**
+         * Maps every batch of [0, count) with map(begin, end) -> T and folds the partial results with
+         * reduce(T, T) -> T in batch order, so the result does not depend on scheduling.
+         */
+        template <typename T, typename MapFunc, typename ReduceFunc>
+        T ParallelReduce(const uint32_t count, const uint32_t batchSize, T identity, MapFunc&& map, ReduceFunc&& reduce)
+        {
+            if (count == 0)
+            {
+                return identity;
+            }
+
+            const uint32_t _batchSize = GetBatchSize(count, batchSize);
+            const uint32_t _batchCount = (count + _batchSize - 1) / _batchSize;
+            std::vector<T> _partials(_batchCount, identity);
+
+            ParallelFor(_batchCount, 1, [&](const uint32_t batchBegin, const uint32_t batchEnd) {
+                for (uint32_t _batch = batchBegin; _batch < batchEnd; ++_batch)
+                {
+                    const uint32_t _begin = _batch * _batchSize;
+                    _partials[_batch] = map(_begin, std::min(count, _begin + _batchSize));
+                }
+            });
+
+            T _result = std::move(identity);
+            for (T& _partial : _partials)
+            {
+                _result = reduce(std::move(_result), std::move(_partial));
+            }
+            return _result;
+        }
+
+        [[nodiscard]] uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+        // Index of the calling worker in [0, GetWorkerCount()), or UINT32_MAX on other threads
+        [[nodiscard]] static uint32_t GetCurrentWorkerIndex();
+
+    private:
+        struct alignas(64) Worker {
+            JobDeque Deque;
+            std::unique_ptr<Job[]> Jobs;
+            uint32_t NextJob = 0;
+            uint32_t RandomState = 0;
+        };
+
+        Job* AllocateJob();
+        void Schedule(Job* job, JobCounter* dependency);
+        void Push(Job* job);
+        Job* FindJob();
+        void Execute(Job* job);
+        void FinishCounter(JobCounter* counter);
+        void WaitFor(JobCounter* counter);
+        void AddContinuation(JobCounter* dependency, Job* job);
+        void WorkerLoop(uint32_t workerIndex);
+        [[nodiscard]] uint32_t GetBatchSize(uint32_t count, uint32_t batchSize) const;
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::vector<std::thread> m_threads;
+
+        // Jobs started from threads that are not workers
+        std::mutex m_injectMutex;
+        std::vector<Job*> m_injectedJobs;
+        std::unique_ptr<Job[]> m_externalJobs;
+        uint32_t m_nextExternalJob = 0;
+
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wakeCondition;
+        std::atomic<uint32_t> m_sleepingWorkers{0};
+        std::atomic<uint32_t> m_queuedJobs{0};
+        std::atomic<bool> m_bRunning{false};
+    };
+} // namespace Thryve::Core
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Thryve::Core {
+    /**
+     * Read-only memory mapping of a whole file. The bytes are paged in by the OS on first touch,
+     * so reading straight out of GetData() skips the read() into an intermediate buffer.
+     */
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        // Returns false and stays closed when the file is missing or empty
+        bool Open(const std::string& path);
+        void Close();
+
+        [[nodiscard]] bool IsOpen() const { return m_data != nullptr; }
+        [[nodiscard]] const std::byte* GetData() const { return m_data; }
+        [[nodiscard]] size_t GetSize() const { return m_size; }
+
+    private:
+        const std::byte* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_fileHandle = nullptr;
+        void* m_mappingHandle = nullptr;
+#endif
+    };
+} // namespace Thryve::Core
@@ -2,17 +2,27 @@
 // Created by thomppa on 3/29/24.
 //
 #pragma once
- #include <chrono>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 #include "IService.h"
 #include "ServiceRegistry.h"
 
 
 
 namespace Thryve::Core {
+    // Interned (Name, ScopeName) pair, resolved back to strings only when results are written out
+    using ProfileScopeID = uint32_t;
+
     struct ProfileKey {
         std::string Name;
         std::string ScopeName;
@@ -26,12 +36,113 @@ namespace Thryve::Core {
         }
     };
 
-    struct ProfilingData {
-        std::string Name;
-        std::string ScopeName;
-        std::thread::id ThreadID;
-        std::time_t StartTime;
-        long long Duration;
+    enum class ProfileEventType : uint8_t {
+        Scope,
+        GpuScope,
+        FrameMarker,
+        Counter
+    };
+
+    // Fixed-size record written on the hot path, times are nanoseconds since the capture epoch.
+    // FrameMarker events carry the frame number in ScopeID and have no duration, Counter events carry their value in
+    // Duration.
+    struct ProfileEvent {
+        int64_t StartTime;
+        int64_t Duration;
+        ProfileScopeID ScopeID;
+        uint32_t ThreadIndex;
+        uint16_t Depth;
+        ProfileEventType Type;
+    };
+
+    struct ProfilingServiceConfiguration : ServiceConfiguration {
+        // Streams Chrome/Perfetto trace events to disk while the capture runs
+        bool StreamTraceEvents = true;
+        // Keeps every invocation in memory for the legacy summary read by Profiling/profiler.py.
+        // Disable for long captures, the trace stream does not need it.
+        bool KeepInvocationHistory = true;
+        // Invocations kept at most, about 32 MB. Later ones only reach the trace stream and are counted as dropped
+        // in the summary
+        size_t MaxInvocationHistory = 1u << 20;
+    };
+
+    /**
+     * Single-producer/single-consumer ring owned by one recording thread.
+     * The owning thread pushes, the profiling flusher drains; neither side takes a lock.
+     * When the flusher falls behind, new events are dropped and counted instead of blocking the producer.
+     */
+    class ProfileEventRingBuffer {
+    public:
+        static constexpr uint32_t CAPACITY = 1u << 14;
+
+        ProfileEventRingBuffer(const uint32_t threadIndex, const std::thread::id threadID) :
+            m_ThreadIndex{threadIndex}, m_ThreadID{threadID}
+        {
+        }
+
+        ProfileEventRingBuffer(const ProfileEventRingBuffer&) = delete;
+        ProfileEventRingBuffer& operator=(const ProfileEventRingBuffer&) = delete;
+
+        bool Push(const ProfileEvent& event)
+        {
+            const uint32_t _head = m_Head.load(std::memory_order_relaxed);
+            if (_head - m_CachedTail >= CAPACITY)
+            {
+                // Only touch the consumer's cache line when the ring looks full
+                m_CachedTail = m_Tail.load(std::memory_order_acquire);
+                if (_head - m_CachedTail >= CAPACITY)
+                {
+                    m_Dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+            }
+
+            m_Events[_head & (CAPACITY - 1)] = event;
+            m_Head.store(_head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side only, hands every pending event to func and frees the slots afterwards
+        template <typename Func>
+        uint32_t Drain(Func&& func)
+        {
+            const uint32_t _tail = m_Tail.load(std::memory_order_relaxed);
+            const uint32_t _head = m_Head.load(std::memory_order_acquire);
+
+            for (uint32_t _i = _tail; _i != _head; ++_i)
+            {
+                func(m_Events[_i & (CAPACITY - 1)]);
+            }
+
+            m_Tail.store(_head, std::memory_order_release);
+            return _head - _tail;
+        }
+
+        [[nodiscard]] uint32_t GetThreadIndex() const { return m_ThreadIndex; }
+        [[nodiscard]] std::thread::id GetThreadID() const { return m_ThreadID; }
+        [[nodiscard]] uint32_t GetDroppedCount() const { return m_Dropped.load(std::memory_order_relaxed); }
+
+        // Name accessors are guarded by the owning ProfilingService, not by the ring itself
+        void SetThreadName(std::string name)
+        {
+            m_ThreadName = std::move(name);
+            m_bThreadNameDirty = true;
+        }
+        [[nodiscard]] const std::string& GetThreadName() const { return m_ThreadName; }
+        [[nodiscard]] bool IsThreadNameDirty() const { return m_bThreadNameDirty; }
+        void ClearThreadNameDirty() { m_bThreadNameDirty = false; }
+
+    private:
+        std::array<ProfileEvent, CAPACITY> m_Events{};
+        uint32_t m_ThreadIndex;
+        std::thread::id m_ThreadID;
+        std::string m_ThreadName;
+        bool m_bThreadNameDirty{false};
+
+        alignas(64) std::atomic<uint32_t> m_Head{0};
+        uint32_t m_CachedTail{0};
+        alignas(64) std::atomic<uint32_t> m_Tail{0};
+        std::atomic<uint32_t> m_Dropped{0};
     };
 }
 
@@ -46,54 +157,114 @@ namespace std {
 
 namespace Thryve::Core
 {
+    class TraceEventWriter;
+
     class ProfilingService : public IService {
     public:
+        // Out of line, the trace writer is only forward declared here
+        ProfilingService();
         ~ProfilingService() override;
         void Init(ServiceConfiguration *configuration) override;
         void ShutDown() override;
 
-        void RecordProfileResult(const ProfilingData& data);
+        // Called once per call site through the PROFILE_* macros, never on the hot path
+        static ProfileScopeID RegisterScope(const char* name, const char* scopeName);
+
+        // Returns the calling thread's ring, registering it on first use. nullptr while the service is not running.
+        static ProfileEventRingBuffer* GetThreadBuffer();
+
+        // Names the calling thread in trace output, e.g. "Main" or "Worker 3"
+        static void SetThreadName(const std::string& name);
+
+        static void MarkFrame();
+
+        // GPU scopes are timed on the device and handed in already converted to the profiler clock
+        static void RecordGpuScope(ProfileScopeID scopeID, int64_t startTime, int64_t duration, uint16_t depth);
+
+        // Samples a named value at the current time, drawn as a graph in the trace
+        static void RecordCounter(ProfileScopeID scopeID, int64_t value);
+
+        static int64_t Now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Epoch)
+                .count();
+        }
+
+        // Drains every thread ring into the collected results
+        void Flush();
 
         void SaveProfileResultsToJson(std::string& filePath);
     private:
-        std::mutex m_mutex;
-        std::unordered_map<ProfileKey, std::unordered_map<std::thread::id, std::vector<ProfilingData>>> m_Profiles;
+        void ConsumeEvent(const ProfileEvent& event);
+
+        ProfileEventRingBuffer* RegisterCurrentThread();
+        void FlusherLoop();
+
+        inline static std::atomic<ProfilingService*> s_Instance{nullptr};
+        inline static const std::chrono::steady_clock::time_point s_Epoch = std::chrono::steady_clock::now();
+        inline static std::atomic<uint32_t> s_FrameIndex{0};
+
+        inline static std::mutex s_ScopeMutex;
+        inline static std::vector<ProfileKey> s_Scopes;
+        inline static std::unordered_map<ProfileKey, ProfileScopeID> s_ScopeLookup;
+
+        std::mutex m_bufferMutex;
+        std::vector<std::unique_ptr<ProfileEventRingBuffer>> m_ThreadBuffers;
+
+        ProfilingServiceConfiguration m_config;
+        int m_captureIndex{0};
+
+        std::mutex m_eventMutex;
+        std::vector<ProfileEvent> m_Events;
+        uint64_t m_droppedHistoryEvents{0};
+        std::unique_ptr<TraceEventWriter> m_traceWriter;
+
+        std::mutex m_flusherMutex;
+        std::condition_variable m_flusherCondition;
+        std::thread m_flusher;
+        bool m_bFlusherRunning{false};
     };
 
     class ScopeProfiler {
     public:
-        explicit ScopeProfiler(const std::string& functionName)
-        : m_Data{functionName, "",std::this_thread::get_id()}
-        , m_start{std::chrono::steady_clock::now()}
-        {
-
-        }
-
-        explicit ScopeProfiler(const std::string& scopeName, const std::string& functionName) :
-          m_Data{functionName,scopeName, std::this_thread::get_id()}
-        , m_start{std::chrono::steady_clock::now()}
+        explicit ScopeProfiler(const ProfileScopeID scopeID) :
+            m_ScopeID{scopeID}, m_Depth{t_ScopeDepth++}, m_start{ProfilingService::Now()}
         {
         }
 
         ~ScopeProfiler()
         {
-            const auto _end = std::chrono::steady_clock::now();
-            m_Data.Duration = std::chrono::duration_cast<std::chrono::microseconds>(_end - m_start).count();
-            ServiceRegistry::GetService<ProfilingService>()->RecordProfileResult(m_Data);
+            const int64_t _end = ProfilingService::Now();
+            --t_ScopeDepth;
+            if (ProfileEventRingBuffer* _buffer = ProfilingService::GetThreadBuffer())
+            {
+                _buffer->Push({m_start, _end - m_start, m_ScopeID, _buffer->GetThreadIndex(),
+                               static_cast<uint16_t>(m_Depth), ProfileEventType::Scope});
+            }
         }
 
     private:
-        ProfilingData m_Data;
-        std::chrono::steady_clock::time_point m_start;
+        inline static thread_local uint32_t t_ScopeDepth = 0;
+
+        ProfileScopeID m_ScopeID;
+        uint32_t m_Depth;
+        int64_t m_start;
     };
 } // namespace Thryve::Core
 
 
 
+// Each call site is interned once on first pass, so operationName has to be a constant (e.g. a string literal)
 #ifdef ENABLE_PROFILING
-#define PROFILE_SCOPE(operationName) Thryve::Core::ScopeProfiler scopeProfilerInstance{operationName, __func__};
-#define PROFILE_FUNCTION() Thryve::Core::ScopeProfiler scopeProfilerFunctionInstance{__func__};
+#define PROFILE_SCOPE(operationName) static const Thryve::Core::ProfileScopeID s_profileScopeID = Thryve::Core::ProfilingService::RegisterScope(__func__, operationName); Thryve::Core::ScopeProfiler scopeProfilerInstance{s_profileScopeID};
+#define PROFILE_FUNCTION() static const Thryve::Core::ProfileScopeID s_profileFunctionID = Thryve::Core::ProfilingService::RegisterScope(__func__, ""); Thryve::Core::ScopeProfiler scopeProfilerFunctionInstance{s_profileFunctionID};
+#define PROFILE_FRAME_MARK() Thryve::Core::ProfilingService::MarkFrame();
+#define PROFILE_THREAD_NAME(threadName) Thryve::Core::ProfilingService::SetThreadName(threadName);
+#define PROFILE_COUNTER(counterName, value) { static const Thryve::Core::ProfileScopeID s_profileCounterID = Thryve::Core::ProfilingService::RegisterScope(counterName, ""); Thryve::Core::ProfilingService::RecordCounter(s_profileCounterID, value); }
 #else
 #define PROFILE_SCOPE(operationName)
 #define PROFILE_FUNCTION()
+#define PROFILE_FRAME_MARK()
+#define PROFILE_THREAD_NAME(threadName)
+#define PROFILE_COUNTER(counterName, value)
 #endif
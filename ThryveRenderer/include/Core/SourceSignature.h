@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace Thryve::Core {
+    // Cheap identity of a source file that caches are checked against before falling back to HashSource
+    struct SourceSignature {
+        uint64_t Size = 0;
+        int64_t WriteTime = 0;
+    };
+
+    // False when the file does not exist
+    bool GetSourceSignature(const std::string& sourcePath, SourceSignature& signature);
+
+    // FNV-1a over the whole file, only run on a cache miss or when the source was touched. 0 when unreadable.
+    uint64_t HashSource(const std::string& sourcePath);
+
+    // Overwrites the write time a cache stored at offset in cachePath, once HashSource showed that a touched source
+    // is unchanged, so later checks match on the signature again. cachePath must not be mapped. False on failure,
+    // which only costs the next check another hash
+    bool StoreSourceWriteTime(const std::string& cachePath, uint64_t offset, int64_t writeTime);
+} // namespace Thryve::Core
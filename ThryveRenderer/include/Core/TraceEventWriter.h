@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include "Profiling.h"
+
+namespace Thryve::Core {
+    /**
+     * Streams events in the Chrome trace-event JSON format, readable by chrome://tracing and ui.perfetto.dev.
+     * Events are appended as they arrive, so a capture never has to be held in memory as a whole.
+     * Timestamps are written in microseconds with nanosecond precision.
+     */
+    class TraceEventWriter {
+    public:
+        explicit TraceEventWriter(const std::string& filePath);
+        ~TraceEventWriter();
+
+        TraceEventWriter(const TraceEventWriter&) = delete;
+        TraceEventWriter& operator=(const TraceEventWriter&) = delete;
+
+        [[nodiscard]] bool IsOpen() const { return m_file.is_open(); }
+
+        void WriteThreadName(uint32_t threadIndex, std::string_view name);
+        void WriteScope(const ProfileKey& key, const ProfileEvent& event);
+        // Drawn on a separate "GPU" track instead of the recording thread's
+        void WriteGpuScope(const ProfileKey& key, const ProfileEvent& event);
+        void WriteFrameMarker(const ProfileEvent& event);
+        // Process-wide counter track named after the key, the value is taken from the event's Duration
+        void WriteCounter(const ProfileKey& key, const ProfileEvent& event);
+
+        void Flush();
+        // Terminates the event array, the file stays valid JSON after this
+        void Close();
+
+    private:
+        void BeginEvent();
+        void WriteCompleteEvent(const ProfileKey& key, const ProfileEvent& event, std::string_view category,
+                                uint32_t threadID);
+        void WriteEscaped(std::string_view text);
+        void WriteMicroseconds(int64_t nanoseconds);
+
+        static constexpr uint32_t PROCESS_ID = 1;
+        // Far above any real thread index
+        static constexpr uint32_t GPU_THREAD_ID = 1u << 20;
+
+        std::ofstream m_file;
+        bool m_bFirstEvent{true};
+    };
+} // namespace Thryve::Core
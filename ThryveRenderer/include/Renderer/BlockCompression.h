@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Thryve::Rendering {
+    enum class BlockFormat : uint32_t {
+        // One channel, 4 bpp. Masks like metallic or roughness.
+        BC4 = 0,
+        // Two BC4 blocks for red and green, 8 bpp. Tangent space normals with z rebuilt in the shader.
+        BC5 = 1,
+        // RGBA, 8 bpp. Colour data.
+        BC7 = 2,
+    };
+
+    /**
+     * CPU encoders for the BCn block formats the texture cooker writes. Every 4x4 block is encoded on its own, so
+     * Compress spreads block rows over the JobSystem. Partial blocks at the image edge repeat the last row and
+     * column, sampling never reads those texels.
+     *
+     * BC7 only uses mode 6, one RGBA subset with 7-bit endpoints, a p-bit each and 4-bit indices. Endpoints come
+     * from the principal axis of the block and are refined with a least-squares fit, which is far from what an
+     * exhaustive encoder reaches on blocks with several distinct colours but cheap enough to cook at load time.
+     */
+    class BlockCompression {
+    public:
+        static constexpr uint32_t BLOCK_DIMENSION = 4;
+
+        static uint32_t GetBlockBytes(BlockFormat format);
+
+        // Bytes needed for a width x height image, partial blocks included
+        static uint64_t GetCompressedSize(BlockFormat format, uint32_t width, uint32_t height);
+
+        // rgba is tightly packed RGBA8, output receives GetCompressedSize bytes with blocks in row-major order
+        static void Compress(BlockFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, std::byte* output);
+
+        static void EncodeBC4Block(const uint8_t values[16], std::byte output[8]);
+        static void EncodeBC5Block(const uint8_t rgba[64], std::byte output[16]);
+        static void EncodeBC7Block(const uint8_t rgba[64], std::byte output[16]);
+    };
+} // namespace Thryve::Rendering
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "Core/Camera.h"
+#include "Core/JobSystem.h"
+#include "Core/Ref.h"
+#include "Renderer/Frustum.h"
+#include "glm/glm.hpp"
+
+namespace Thryve::Rendering {
+    // 32 bytes, two nodes share a cache line
+    struct BvhNode {
+        glm::vec3 Min;
+        // Inner nodes: the left child, the right one follows it. Leaves: first entry of their object range
+        uint32_t LeftFirst;
+        glm::vec3 Max;
+        // Objects of a leaf, 0 for inner nodes
+        uint32_t Count;
+
+        [[nodiscard]] bool IsLeaf() const { return Count > 0; }
+    };
+
+    struct BvhHit {
+        uint32_t Object;
+        // Along the ray to the object's box, 0 when the ray starts inside it
+        float Distance;
+    };
+
+    /**
+     * Bounding volume hierarchy over object boxes, for hierarchical frustum culling and ray picking. Nodes live
+     * in one flat array with both children of a node next to each other, leaves point into a permuted list of
+     * object indices so every subtree covers a contiguous range of it.
+     *
+     * Build splits every node with the binned surface area heuristic, BIN_COUNT bins per axis over the object
+     * centroids, and falls back to a median split when no bin boundary separates them. Subtrees above
+     * PARALLEL_SUBTREE_SIZE objects are built as jobs and the bins of large nodes are filled in parallel.
+     *
+     * Moving objects are refitted, which keeps the topology and only grows or shrinks boxes. That is cheap but
+     * the tree gets worse the further objects travel from where they were built, Build again after large moves.
+     */
+    class BoundingVolumeHierarchy {
+    public:
+        static constexpr uint32_t BIN_COUNT = 16;
+        static constexpr uint32_t MAX_LEAF_SIZE = 4;
+        static constexpr uint32_t PARALLEL_SUBTREE_SIZE = 4096;
+        static constexpr uint32_t PARALLEL_BINNING_SIZE = 65536;
+
+        BoundingVolumeHierarchy();
+
+        // bounds[i] is object i, the indices reported by Cull and Raycast
+        void Build(std::span<const Aabb> bounds);
+        // Every object moved, same count as the last Build
+        void Refit(std::span<const Aabb> bounds);
+        // One object moved, walks from its leaf up until a box stops changing
+        void UpdateObject(uint32_t object, const Aabb& bounds);
+
+        // Replaces visible with the objects that intersect frustum, in no particular order. Subtrees entirely
+        // inside are taken without testing their objects
+        void Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+        // Nearest object box the ray hits within maxDistance
+        [[nodiscard]] std::optional<BvhHit> Raycast(const Core::Ray& ray,
+                                                    float maxDistance = std::numeric_limits<float>::max()) const;
+
+        [[nodiscard]] uint32_t GetObjectCount() const { return static_cast<uint32_t>(m_objectBounds.size()); }
+        [[nodiscard]] uint32_t GetNodeCount() const { return m_nodeCount; }
+        [[nodiscard]] const Aabb& GetObjectBounds(uint32_t object) const { return m_objectBounds[object]; }
+
+        // Times build, refit, culling and picking at 10k, 100k and 1M objects and compares culling against the
+        // FrustumCuller and picking against testing every object
+        static void RunBenchmark();
+
+    private:
+        struct Bin {
+            Aabb Bounds;
+            uint32_t Count = 0;
+        };
+
+        struct BinSet {
+            Bin Bins[3][BIN_COUNT];
+        };
+
+        struct Split {
+            int Axis = -1;
+            // Bins up to and including this one go to the left child
+            uint32_t Bin = 0;
+            float Cost = std::numeric_limits<float>::max();
+            Aabb LeftBounds;
+            Aabb RightBounds;
+        };
+
+        void Subdivide(uint32_t nodeIndex, Core::JobCounter& counter);
+        [[nodiscard]] Split FindSplit(uint32_t first, uint32_t count, const Aabb& centroidBounds);
+        void FillBins(uint32_t begin, uint32_t end, const Aabb& centroidBounds, BinSet& bins) const;
+        [[nodiscard]] Aabb ComputeBounds(uint32_t first, uint32_t count);
+        void MakeLeaf(uint32_t nodeIndex);
+        // Recomputes the node's box from its objects or children, returns whether it changed
+        bool RefitNode(uint32_t nodeIndex);
+        void AppendSubtree(uint32_t nodeIndex, std::vector<uint32_t>& visible) const;
+
+        Core::SharedRef<Core::JobSystem> m_jobSystem;
+
+        std::vector<BvhNode> m_nodes;
+        std::atomic<uint32_t> m_nodeCount{0};
+        // UINT32_MAX for the root
+        std::vector<uint32_t> m_parents;
+
+        std::vector<Aabb> m_objectBounds;
+        // Only needed while building
+        std::vector<glm::vec3> m_centroids;
+        // Object indices in leaf order, a leaf's range is [LeftFirst, LeftFirst + Count)
+        std::vector<uint32_t> m_objectIndices;
+        std::vector<uint32_t> m_leafOfObject;
+    };
+} // namespace Thryve::Rendering
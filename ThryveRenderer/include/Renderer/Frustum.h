@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "Vertex2D.h"
+#include "glm/glm.hpp"
+
+namespace Thryve::Rendering {
+    struct BoundingSphere {
+        glm::vec3 Center{0.0f};
+        float Radius = 0.0f;
+
+        // Centered on the vertices' bounding box, loose but found in a single pass
+        static BoundingSphere FromVertices(std::span<const Vertex3D> vertices);
+
+        // Bounds of the same geometry placed with transform, scaled by its largest axis
+        [[nodiscard]] BoundingSphere Transform(const glm::mat4& transform) const;
+    };
+
+    // Axis aligned box, empty until something is grown into it
+    struct Aabb {
+        glm::vec3 Min{std::numeric_limits<float>::max()};
+        glm::vec3 Max{std::numeric_limits<float>::lowest()};
+
+        static Aabb FromSphere(const BoundingSphere& sphere);
+
+        void Grow(const glm::vec3& point);
+        void Grow(const Aabb& box);
+
+        [[nodiscard]] glm::vec3 GetCenter() const { return 0.5f * (Min + Max); }
+        [[nodiscard]] glm::vec3 GetExtents() const { return 0.5f * (Max - Min); }
+        // Half the surface area, the surface area heuristic only compares ratios
+        [[nodiscard]] float GetHalfArea() const;
+    };
+
+    /**
+     * The six planes of a view frustum, normals pointing inwards and normalized, so plane.xyz dot p + plane.w is
+     * the signed distance of p. Planes are in the space viewProjection maps from, world space for
+     * projection * view. Expects Vulkan clip space with depth from 0 to 1.
+     */
+    struct Frustum {
+        enum Plane : uint32_t { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+        std::array<glm::vec4, PlaneCount> Planes;
+
+        static Frustum FromViewProjection(const glm::mat4& viewProjection);
+
+        [[nodiscard]] bool IntersectsSphere(const glm::vec3& center, float radius) const;
+        // Axis aligned box given by its center and half extents
+        [[nodiscard]] bool IntersectsBox(const glm::vec3& center, const glm::vec3& extents) const;
+    };
+} // namespace Thryve::Rendering
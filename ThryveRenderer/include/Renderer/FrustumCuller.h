@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Core/Ref.h"
+#include "Renderer/Frustum.h"
+#include "glm/glm.hpp"
+
+namespace Thryve::Rendering {
+    // Bounding spheres as structure of arrays, so the culler loads the same component of four or eight at once
+    struct SphereBoundsSoA {
+        std::vector<float> CenterX;
+        std::vector<float> CenterY;
+        std::vector<float> CenterZ;
+        std::vector<float> Radius;
+
+        void Add(const BoundingSphere& sphere);
+        void Reserve(uint32_t count);
+        void Clear();
+        [[nodiscard]] uint32_t Size() const { return static_cast<uint32_t>(Radius.size()); }
+    };
+
+    // Axis aligned boxes as structure of arrays, stored as center and half extents
+    struct BoxBoundsSoA {
+        std::vector<float> CenterX;
+        std::vector<float> CenterY;
+        std::vector<float> CenterZ;
+        std::vector<float> ExtentX;
+        std::vector<float> ExtentY;
+        std::vector<float> ExtentZ;
+
+        void Add(const glm::vec3& min, const glm::vec3& max);
+        void Reserve(uint32_t count);
+        void Clear();
+        [[nodiscard]] uint32_t Size() const { return static_cast<uint32_t>(ExtentX.size()); }
+    };
+
+    enum class CullingPath : uint32_t {
+        Scalar = 0,
+        // Four objects per test, always available on x86-64
+        SSE = 1,
+        // Eight objects per test, picked at runtime when the CPU has it
+        AVX2 = 2,
+    };
+
+    struct FrustumCullerStats {
+        uint32_t TestedCount = 0;
+        uint32_t VisibleCount = 0;
+        // Chunks of CHUNK_SIZE objects spread over the JobSystem
+        uint32_t ChunkCount = 0;
+    };
+
+    /**
+     * Tests bounds against the six planes of a Frustum, four or eight at a time with SSE or AVX2, the same
+     * conservative tests as Frustum::IntersectsSphere and Frustum::IntersectsBox and with bit identical results.
+     * The bounds are split into chunks of CHUNK_SIZE that run on the JobSystem, every chunk writes its visible
+     * indices into its own range of a scratch list which is then compacted into an ascending visible-index list,
+     * ready to record draws from. Nothing is allocated once the lists have grown to the object count.
+     */
+    class FrustumCuller {
+    public:
+        static constexpr uint32_t CHUNK_SIZE = 4096;
+
+        explicit FrustumCuller(CullingPath path = GetBestPath());
+
+        // Replaces visible with the indices of the bounds that intersect frustum
+        void Cull(const Frustum& frustum, const SphereBoundsSoA& bounds, std::vector<uint32_t>& visible);
+        void Cull(const Frustum& frustum, const BoxBoundsSoA& bounds, std::vector<uint32_t>& visible);
+
+        [[nodiscard]] CullingPath GetPath() const { return m_path; }
+        [[nodiscard]] const FrustumCullerStats& GetStats() const { return m_stats; }
+
+        // Widest path the CPU running this supports
+        static CullingPath GetBestPath();
+        static const char* GetPathName(CullingPath path);
+
+        // Times every supported path at 10k, 100k and 1M objects against a single threaded scalar reference and
+        // throws if any of them disagrees with it
+        static void RunBenchmark();
+
+    private:
+        using ChunkFunction = uint32_t (*)(const Frustum& frustum, const void* bounds, uint32_t begin, uint32_t end,
+                                           uint32_t* visible);
+
+        void CullChunks(const Frustum& frustum, const void* bounds, uint32_t count, ChunkFunction cullChunk,
+                        std::vector<uint32_t>& visible);
+
+        CullingPath m_path;
+        Core::SharedRef<Core::JobSystem> m_jobSystem;
+
+        // Visible indices of every chunk at the chunk's own offset, before compaction
+        std::vector<uint32_t> m_scratch;
+        std::vector<uint32_t> m_chunkVisibleCounts;
+
+        FrustumCullerStats m_stats;
+    };
+} // namespace Thryve::Rendering
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Core/MappedFile.h"
+#include "Renderer/MipGenerator.h"
+#include "pch.h"
+
+namespace Thryve::Rendering {
+    /**
+     * Header of a KTX 2.0 container, https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html. The identifier
+     * comes first, this header follows it and the level index follows the header, all little endian. Packed to
+     * four bytes because the sgd fields sit at offset 52 without padding.
+     */
+#pragma pack(push, 4)
+    struct Ktx2Header {
+        uint32_t Format;
+        uint32_t TypeSize;
+        uint32_t PixelWidth;
+        uint32_t PixelHeight;
+        uint32_t PixelDepth;
+        uint32_t LayerCount;
+        uint32_t FaceCount;
+        uint32_t LevelCount;
+        uint32_t SupercompressionScheme;
+
+        uint32_t DfdByteOffset;
+        uint32_t DfdByteLength;
+        uint32_t KvdByteOffset;
+        uint32_t KvdByteLength;
+        uint64_t SgdByteOffset;
+        uint64_t SgdByteLength;
+    };
+#pragma pack(pop)
+    static_assert(sizeof(Ktx2Header) == 68);
+
+    struct Ktx2LevelIndex {
+        uint64_t ByteOffset;
+        uint64_t ByteLength;
+        uint64_t UncompressedByteLength;
+    };
+
+    /**
+     * Reads and writes single-image 2D KTX2 files holding a block-compressed mip chain without supercompression,
+     * the files the texture cooker produces. The reader maps the file and hands the level data out in place.
+     */
+    class Ktx2File {
+    public:
+        static constexpr uint8_t IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+        // Returns false for anything that is not a 2D, single layer, unsupercompressed KTX2 file with all its levels
+        bool Open(const std::string& path);
+
+        [[nodiscard]] VkFormat GetFormat() const { return static_cast<VkFormat>(m_header.Format); }
+        [[nodiscard]] uint32_t GetWidth() const { return m_header.PixelWidth; }
+        [[nodiscard]] uint32_t GetHeight() const { return m_header.PixelHeight; }
+
+        // Level 0 first, offsets relative to GetLevelData()
+        [[nodiscard]] std::span<const MipLevel> GetLevels() const { return m_levels; }
+        // Every level back to back, smallest first as KTX2 stores them
+        [[nodiscard]] std::span<const std::byte> GetLevelData() const { return m_levelData; }
+
+        // Empty when the key is missing
+        [[nodiscard]] std::string GetKeyValue(const std::string& key) const;
+
+        // levels are level 0 first with offsets into data. Supports the BC4, BC5 and BC7 formats.
+        static void Write(const std::string& path, VkFormat format, std::span<const MipLevel> levels,
+                          std::span<const std::byte> data,
+                          std::vector<std::pair<std::string, std::string>> keyValues);
+
+    private:
+        Core::MappedFile m_file;
+        Ktx2Header m_header{};
+        std::vector<MipLevel> m_levels;
+        std::span<const std::byte> m_levelData;
+        std::vector<std::pair<std::string, std::string>> m_keyValues;
+    };
+} // namespace Thryve::Rendering
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+
+#include "Core/MappedFile.h"
+#include "Renderer/MeshImporter.h"
+
+namespace Thryve::Rendering {
+    struct MeshCacheAttribute {
+        uint32_t Location;
+        uint32_t Format;
+        uint32_t Offset;
+    };
+
+    /**
+     * On-disk layout of a .tmesh file: this header, then the vertex blob and the index blob, each starting on a
+     * BLOB_ALIGNMENT boundary. Offsets are from the start of the file. The attribute table mirrors
+     * Vertex3D::getAttributeDescriptions(), so a vertex layout change invalidates old caches on its own.
+     */
+    struct MeshCacheHeader {
+        static constexpr uint32_t MAGIC = 0x48534D54; // "TMSH"
+        static constexpr uint32_t VERSION = 1;
+        static constexpr uint32_t MAX_ATTRIBUTES = 8;
+        static constexpr uint64_t BLOB_ALIGNMENT = 64;
+
+        uint32_t Magic;
+        uint32_t Version;
+
+        // Source signature, size and write time are checked first, the hash only when they differ
+        uint64_t SourceSize;
+        int64_t SourceWriteTime;
+        uint64_t SourceHash;
+
+        uint32_t VertexStride;
+        uint32_t AttributeCount;
+        MeshCacheAttribute Attributes[MAX_ATTRIBUTES];
+
+        uint32_t IndexSize;
+        uint32_t Reserved;
+        uint64_t VertexCount;
+        uint64_t VertexOffset;
+        uint64_t IndexCount;
+        uint64_t IndexOffset;
+    };
+
+    // Vertex and index data read in place from a mapped cache file, valid for the lifetime of this object
+    class CachedMesh {
+    public:
+        [[nodiscard]] std::span<const Vertex3D> GetVertices() const { return m_vertices; }
+        [[nodiscard]] std::span<const uint32_t> GetIndices() const { return m_indices; }
+
+    private:
+        friend class MeshCache;
+
+        Core::MappedFile m_file;
+        std::span<const Vertex3D> m_vertices;
+        std::span<const uint32_t> m_indices;
+    };
+
+    struct MeshCacheStats {
+        bool bCacheHit = false;
+        // Total time until the mesh is mapped, including the import and cache write on a miss
+        double LoadMilliseconds = 0.0;
+        // Only filled in on a miss
+        MeshImportStats ImportStats;
+    };
+
+    class MeshCache {
+    public:
+        // Maps the cache of sourcePath, importing the OBJ and writing a new cache first when it is missing or stale
+        static std::unique_ptr<CachedMesh> LoadOrImport(const std::string& sourcePath, MeshCacheStats* stats = nullptr);
+
+        // nullptr when there is no cache for sourcePath or it no longer matches the source or the vertex layout
+        static std::unique_ptr<CachedMesh> Load(const std::string& sourcePath);
+
+        static void Write(const std::string& sourcePath, const MeshData& mesh);
+
+        static std::string GetCachePath(const std::string& sourcePath);
+    };
+} // namespace Thryve::Rendering
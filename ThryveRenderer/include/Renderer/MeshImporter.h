@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Vertex2D.h"
+
+namespace Thryve::Rendering {
+    struct MeshData {
+        std::vector<Vertex3D> Vertices;
+        std::vector<uint32_t> Indices;
+    };
+
+    struct MeshImportStats {
+        // One vertex per triangle corner, what a loader without deduplication would emit
+        size_t SourceVertexCount = 0;
+        size_t UniqueVertexCount = 0;
+        size_t IndexCount = 0;
+        uint32_t ChunkCount = 0;
+        double ParseMilliseconds = 0.0;
+        double ProcessMilliseconds = 0.0;
+
+        [[nodiscard]] double GetVertexReduction() const
+        {
+            return SourceVertexCount == 0
+                ? 0.0
+                : 1.0 - static_cast<double>(UniqueVertexCount) / static_cast<double>(SourceVertexCount);
+        }
+    };
+
+    /**
+     * Turns an OBJ file into an indexed mesh. Triangle ranges of every shape are processed on the JobSystem:
+     * each chunk deduplicates its corners by (position, normal, texcoord) index and accumulates face tangents,
+     * then the chunks are merged in file order, so vertices keep the locality of the source triangles.
+     * Tangents end up smoothed over every face sharing a vertex and orthonormalised against its normal.
+     */
+    class MeshImporter {
+    public:
+        static constexpr uint32_t TRIANGLES_PER_CHUNK = 8192;
+
+        static MeshData LoadObj(const std::string& path, MeshImportStats* stats = nullptr);
+    };
+} // namespace Thryve::Rendering
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Core/MappedFile.h"
+#include "Renderer/MipGenerator.h"
+
+namespace Thryve::Rendering {
+    /**
+     * On-disk layout of a .tmip file: this header, then every level of an RGBA8 mip chain back to back starting at
+     * DataOffset, laid out exactly as MipGenerator produced it. Level offsets are relative to DataOffset.
+     */
+    struct MipCacheHeader {
+        static constexpr uint32_t MAGIC = 0x50494D54; // "TMIP"
+        static constexpr uint32_t VERSION = 1;
+        static constexpr uint32_t MAX_LEVELS = 16;
+        static constexpr uint64_t DATA_ALIGNMENT = 64;
+
+        uint32_t Magic;
+        uint32_t Version;
+
+        // Source signature, size and write time are checked first, the hash only when they differ
+        uint64_t SourceSize;
+        int64_t SourceWriteTime;
+        uint64_t SourceHash;
+
+        uint32_t Filter;
+        uint32_t bSrgb;
+        uint32_t LevelCount;
+        uint32_t Reserved;
+        MipLevel Levels[MAX_LEVELS];
+
+        uint64_t DataOffset;
+        uint64_t DataSize;
+    };
+
+    // A baked mip chain read in place from a mapped cache file, valid for the lifetime of this object
+    class CachedMipChain {
+    public:
+        [[nodiscard]] std::span<const MipLevel> GetLevels() const { return m_levels; }
+        [[nodiscard]] std::span<const std::byte> GetPixels() const { return m_pixels; }
+
+    private:
+        friend class MipCache;
+
+        Core::MappedFile m_file;
+        std::vector<MipLevel> m_levels;
+        std::span<const std::byte> m_pixels;
+    };
+
+    struct MipCacheStats {
+        bool bCacheHit = false;
+        // Total time until the chain is mapped, including decode, filtering and the cache write on a miss
+        double LoadMilliseconds = 0.0;
+        // Only filled in on a miss
+        double BakeMilliseconds = 0.0;
+    };
+
+    /**
+     * Offline mip pyramids for source images. A miss decodes the image, filters the whole chain on the CPU and
+     * writes it to CACHE_DIR/textures, later runs map the file and upload every level straight from it.
+     */
+    class MipCache {
+    public:
+        static std::unique_ptr<CachedMipChain> LoadOrBake(const std::string& sourcePath, bool bSrgb, MipFilter filter,
+                                                          MipCacheStats* stats = nullptr);
+
+        // nullptr when there is no cache for sourcePath or it was baked from another source or with other settings
+        static std::unique_ptr<CachedMipChain> Load(const std::string& sourcePath, bool bSrgb, MipFilter filter);
+
+        static void Write(const std::string& sourcePath, bool bSrgb, MipFilter filter, const MipChain& chain);
+
+        // One file per colour space and filter, a texture used both ways keeps both chains
+        static std::string GetCachePath(const std::string& sourcePath, bool bSrgb, MipFilter filter);
+    };
+} // namespace Thryve::Rendering
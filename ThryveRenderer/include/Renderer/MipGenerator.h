@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Thryve::Rendering {
+    enum class MipFilter : uint32_t {
+        // 2x2 average, cheap and slightly blurry
+        Box = 0,
+        // 6x6 separable Kaiser-windowed sinc, keeps more detail in the smaller levels without ringing much
+        Kaiser = 1,
+    };
+
+    // One level inside a tightly packed mip chain, offsets are from the start of the pixel data
+    struct MipLevel {
+        uint32_t Width;
+        uint32_t Height;
+        uint64_t Offset;
+        uint64_t Size;
+    };
+
+    struct MipChain {
+        std::vector<MipLevel> Levels;
+        std::vector<std::byte> Pixels;
+    };
+
+    /**
+     * CPU mip chain generation for RGBA8 images. Every level is filtered from the previous one in linear float,
+     * four channels per SSE register, so the chain is only quantised once per level. sRGB images are decoded
+     * before filtering and encoded again afterwards, matching what the GPU does when it blits an sRGB image.
+     * Rows are filtered in parallel on the JobSystem.
+     */
+    class MipGenerator {
+    public:
+        // Level offsets are kept on this boundary, which suits every copy and compressed block size
+        static constexpr uint64_t LEVEL_ALIGNMENT = 16;
+
+        // Full chain down to 1x1
+        static uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+
+        static MipChain Generate(const uint8_t* rgba, uint32_t width, uint32_t height, bool bSrgb, MipFilter filter);
+    };
+} // namespace Thryve::Rendering
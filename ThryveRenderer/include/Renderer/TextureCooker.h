@@ -0,0 +1,63 @@
+#pragma once
+
+#include <span>
+#include <string>
+
+#include "Renderer/BlockCompression.h"
+#include "Renderer/MipGenerator.h"
+#include "pch.h"
+
+namespace Thryve::Rendering {
+    enum class TextureKind : uint32_t {
+        // sRGB colour with alpha, albedo and emission. BC7.
+        Color = 0,
+        // Tangent space normal, only x and y are kept. BC5.
+        Normal = 1,
+        // Single linear channel read from red, metallic, roughness or occlusion. BC4.
+        Mask = 2,
+    };
+
+    struct TextureCookStats {
+        bool bCooked = false;
+        // Only filled in when the texture was cooked
+        double DecodeMilliseconds = 0.0;
+        double MipMilliseconds = 0.0;
+        double EncodeMilliseconds = 0.0;
+        // Whole mip chain as RGBA8 against the block compressed chain
+        uint64_t UncompressedBytes = 0;
+        uint64_t CompressedBytes = 0;
+    };
+
+    /**
+     * Offline conversion of source images into block-compressed KTX2 files under CACHE_DIR/textures. The source
+     * is decoded once, its mip chain filtered on the CPU and every level encoded to the block format matching
+     * its kind. The source signature is stored in the file's key/value data, so a changed source gets re-cooked
+     * on the next run and every other run only maps the KTX2.
+     */
+    class TextureCooker {
+    public:
+        // Bumped whenever the encoders change their output, older files are cooked again
+        static constexpr uint32_t VERSION = 1;
+
+        static VkFormat GetFormat(TextureKind kind);
+        static BlockFormat GetBlockFormat(TextureKind kind);
+
+        static std::string GetCookedPath(const std::string& sourcePath, TextureKind kind);
+
+        // True when the cooked file exists and was cooked from the current source with this cooker version. A touched
+        // but unchanged source gets its new write time stored, so the next check skips the hash
+        static bool IsUpToDate(const std::string& sourcePath, TextureKind kind);
+
+        // Returns the cooked path, cooking it first when it is missing or stale
+        static std::string CookIfStale(const std::string& sourcePath, TextureKind kind,
+                                       TextureCookStats* stats = nullptr);
+
+        static void Cook(const std::string& sourcePath, TextureKind kind, TextureCookStats* stats = nullptr);
+
+    private:
+        // levels are level 0 first with offsets into data, stored with the source identity IsUpToDate checks
+        static void WriteCooked(const std::string& sourcePath, TextureKind kind, std::span<const MipLevel> levels,
+                                std::span<const std::byte> data, uint64_t sourceSize, int64_t sourceWriteTime,
+                                uint64_t sourceHash);
+    };
+} // namespace Thryve::Rendering
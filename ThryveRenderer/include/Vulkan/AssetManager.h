@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Core/Ref.h"
+#include "Renderer/Frustum.h"
+#include "Renderer/MeshCache.h"
+#include "Renderer/TextureCooker.h"
+#include "UploadManager.h"
+#include "VulkanIndexBuffer.h"
+#include "VulkanTextureImage.h"
+#include "VulkanVertexBuffer.h"
+#include "pch.h"
+#include "vk_mem_alloc.h"
+
+namespace Thryve::Rendering {
+    struct TextureHandle {
+        uint32_t Index = UINT32_MAX;
+        [[nodiscard]] bool IsValid() const { return Index != UINT32_MAX; }
+    };
+
+    struct MeshHandle {
+        uint32_t Index = UINT32_MAX;
+        [[nodiscard]] bool IsValid() const { return Index != UINT32_MAX; }
+    };
+
+    // What a texture samples as until it is resident, 1x1 and picked to be neutral for its use
+    enum class FallbackTexture : uint32_t {
+        White = 0,
+        Black = 1,
+        // (0.5, 0.5, 1.0), an unperturbed tangent space normal
+        FlatNormal = 2,
+    };
+
+    /**
+     * Streams textures and meshes in the background. Load calls return a handle right away, the file is decoded
+     * on the job system and recorded into the upload manager by Update once the decode has finished. Until the
+     * upload's ticket is ready a texture handle resolves to a 1x1 fallback and a mesh handle to no buffers at all,
+     * so the first frame never waits for an asset. Everything but the decode runs on the render thread.
+     */
+    class AssetManager {
+    public:
+        AssetManager(UploadManager& uploadManager, VkCommandPool commandPool);
+        // Waits for decodes still running, the GPU must be done with every resource
+        ~AssetManager();
+
+        AssetManager(const AssetManager&) = delete;
+        AssetManager& operator=(const AssetManager&) = delete;
+
+        // bCompressed and mipSource as for VulkanTextureImage::decodeTextureImage
+        TextureHandle LoadTexture(const std::string& path, TextureKind kind, FallbackTexture fallback,
+                                  bool bCompressed = true,
+                                  VulkanTextureImage::MipSource mipSource = VulkanTextureImage::MipSource::GpuBlit);
+        MeshHandle LoadMesh(const std::string& path);
+
+        // Once per frame after UploadManager::Update: makes assets whose upload finished resident and records the
+        // uploads of freshly decoded ones into a new batch
+        void Update();
+
+        // The texture's view and sampler once it is resident, its fallback before that
+        [[nodiscard]] VkDescriptorImageInfo GetTextureDescriptor(TextureHandle handle) const;
+        [[nodiscard]] bool IsResident(TextureHandle handle) const;
+        // nullptr until the mesh is resident
+        [[nodiscard]] const VulkanVertexBuffer<Vertex3D>* GetVertexBuffer(MeshHandle handle) const;
+        [[nodiscard]] const VulkanIndexBuffer* GetIndexBuffer(MeshHandle handle) const;
+        // In model space, valid once the mesh is resident
+        [[nodiscard]] const BoundingSphere& GetMeshBounds(MeshHandle handle) const;
+
+        [[nodiscard]] uint32_t GetPendingCount() const { return m_pendingCount; }
+
+    private:
+        enum class AssetState {
+            // Decode job queued or running
+            Decoding,
+            // Recorded into the upload batch with Ticket
+            Uploading,
+            Resident,
+            Failed,
+        };
+
+        struct TextureAsset {
+            std::string Path;
+            TextureKind Kind = TextureKind::Color;
+            FallbackTexture Fallback = FallbackTexture::White;
+            bool bCompressed = true;
+            VulkanTextureImage::MipSource MipSource = VulkanTextureImage::MipSource::GpuBlit;
+            std::unique_ptr<VulkanTextureImage> Texture;
+
+            AssetState State = AssetState::Decoding;
+            Core::JobCounter Counter;
+            // Set by the decode job, read once Counter is done
+            std::exception_ptr Error;
+            uint64_t Ticket = 0;
+            std::chrono::steady_clock::time_point RequestTime;
+        };
+
+        struct MeshAsset {
+            std::string Path;
+            // Mapped by the decode job, released once the buffers are recorded
+            std::unique_ptr<CachedMesh> Mesh;
+            MeshCacheStats Stats;
+            // Computed by the decode job
+            BoundingSphere Bounds;
+            std::unique_ptr<VulkanVertexBuffer<Vertex3D>> VertexBuffer;
+            std::unique_ptr<VulkanIndexBuffer> IndexBuffer;
+
+            AssetState State = AssetState::Decoding;
+            Core::JobCounter Counter;
+            std::exception_ptr Error;
+            uint64_t Ticket = 0;
+            std::chrono::steady_clock::time_point RequestTime;
+        };
+
+        struct FallbackImage {
+            VkImage Image = VK_NULL_HANDLE;
+            VmaAllocation Allocation = VK_NULL_HANDLE;
+            VkImageView View = VK_NULL_HANDLE;
+        };
+
+        void CreateFallbacks();
+        // Starts a stream of loads, the report in Update covers everything requested until it drains
+        void BeginRequest(std::chrono::steady_clock::time_point requestTime);
+        // Without other workers nothing picks up the decode jobs, so the render thread runs one per frame
+        void HelpDecode();
+        bool UploadTexture(TextureAsset& asset);
+        bool UploadMesh(MeshAsset& asset);
+        void FinishAsset(const std::string& path, AssetState& state, const std::exception_ptr& error);
+        void ReportStream();
+
+        UploadManager& m_uploadManager;
+        VkDevice m_device;
+        VkPhysicalDevice m_physicalDevice;
+        VkCommandPool m_commandPool;
+        VkQueue m_graphicsQueue;
+        Core::SharedRef<Core::JobSystem> m_jobSystem;
+
+        // Heap allocated so decode jobs can keep pointers while more assets are requested
+        std::vector<std::unique_ptr<TextureAsset>> m_textures;
+        std::vector<std::unique_ptr<MeshAsset>> m_meshes;
+
+        std::array<FallbackImage, 3> m_fallbacks{};
+        VkSampler m_fallbackSampler = VK_NULL_HANDLE;
+
+        uint32_t m_pendingCount = 0;
+
+        // Stream report, from the first request until nothing is pending
+        std::chrono::steady_clock::time_point m_streamStart;
+        double m_streamDecodeMilliseconds = 0.0;
+        uint32_t m_streamAssetCount = 0;
+    };
+} // namespace Thryve::Rendering
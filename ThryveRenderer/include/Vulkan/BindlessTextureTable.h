@@ -0,0 +1,78 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "pch.h"
+
+namespace Thryve::Rendering {
+    struct BindlessTextureTableStats {
+        // Slots holding a texture right now
+        uint32_t SlotCount = 0;
+        // Descriptors written into a free slot
+        uint32_t WriteCount = 0;
+        // Slots given back after no frame in flight used them anymore
+        uint32_t RetireCount = 0;
+    };
+
+    /**
+     * One set with one large combined image sampler array that every texture lives in, so any number of
+     * materials draw with a single descriptor bind and pick their textures by index, passed in push constants.
+     * Requires VK_EXT_descriptor_indexing, see VulkanDeviceSelector::SupportsDescriptorIndexing: the array is
+     * partially bound, and written with update-after-bind while earlier frames are still in flight.
+     *
+     * A slot is never rewritten while a frame that used it may still run. GetIndex hands out a fresh slot for
+     * each view and sampler it has not seen, and BeginFrame recycles slots no frame in flight looked up, so a
+     * texture replacing its fallback moves to a new index instead of changing the one pending draws read.
+     */
+    class BindlessTextureTable {
+    public:
+        // Upper bound for the array, the device limit lowers it further
+        static constexpr uint32_t MAX_TEXTURES = 4096;
+
+        explicit BindlessTextureTable(uint32_t framesInFlight);
+        ~BindlessTextureTable();
+
+        BindlessTextureTable(const BindlessTextureTable&) = delete;
+        BindlessTextureTable& operator=(const BindlessTextureTable&) = delete;
+
+        // Set 1 of pipelines sampling from the table, triangle_bindless.frag declares it there
+        [[nodiscard]] VkDescriptorSetLayout GetLayout() const { return m_layout; }
+        [[nodiscard]] VkDescriptorSet GetSet() const { return m_set; }
+        [[nodiscard]] uint32_t GetCapacity() const { return m_capacity; }
+
+        // Once per frame after the fence of the frame about to be recorded
+        void BeginFrame();
+
+        // The array element holding this image, written into a free slot on first use
+        uint32_t GetIndex(const VkDescriptorImageInfo& image);
+
+        [[nodiscard]] const BindlessTextureTableStats& GetStats() const { return m_stats; }
+
+    private:
+        struct Slot {
+            VkDescriptorImageInfo Image;
+            uint32_t Index;
+            uint64_t LastUsedFrame;
+        };
+
+        void CreateLayout();
+        void CreatePool();
+
+        VkDevice m_device;
+        uint32_t m_framesInFlight;
+        uint32_t m_capacity;
+
+        VkDescriptorSetLayout m_layout = VK_NULL_HANDLE;
+        VkDescriptorPool m_pool = VK_NULL_HANDLE;
+        VkDescriptorSet m_set = VK_NULL_HANDLE;
+
+        // Keyed by a hash of the image info
+        std::unordered_multimap<uint64_t, Slot> m_slots;
+        std::vector<uint32_t> m_freeSlots;
+        uint32_t m_nextSlot = 0;
+
+        uint64_t m_frame = 0;
+        BindlessTextureTableStats m_stats;
+    };
+} // namespace Thryve::Rendering
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <initializer_list>
+#include <vector>
+
+#include "pch.h"
+
+namespace Thryve::Rendering {
+    struct DescriptorPoolSizeRatio {
+        VkDescriptorType Type;
+        // Descriptors of Type per set in the pool
+        float Ratio;
+    };
+
+    struct DescriptorAllocatorStats {
+        uint32_t PoolCount = 0;
+        // Pools created because every other one was full
+        uint32_t GrowCount = 0;
+        // Allocations since the last Reset
+        uint32_t SetCount = 0;
+    };
+
+    /**
+     * Growable descriptor set allocator. Sets are carved out of the current pool, and once it runs out the next
+     * one is taken from the pools freed by the last Reset or created with twice the capacity of the previous one.
+     * The pools never free single sets, so a driver can hand them out with a pointer bump, and Reset recycles
+     * all of them at once with vkResetDescriptorPool. Keep one per frame in flight and reset it after the frame's
+     * fence for per-draw sets, or never reset one for sets that live as long as the allocator.
+     */
+    class DescriptorAllocator {
+    public:
+        static constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+        DescriptorAllocator(uint32_t initialSetsPerPool, std::initializer_list<DescriptorPoolSizeRatio> ratios);
+        ~DescriptorAllocator();
+
+        DescriptorAllocator(const DescriptorAllocator&) = delete;
+        DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+        VkDescriptorSet Allocate(VkDescriptorSetLayout layout);
+
+        // Every set allocated so far becomes invalid, none of them may still be in use by the GPU
+        void Reset();
+
+        [[nodiscard]] const DescriptorAllocatorStats& GetStats() const { return m_stats; }
+
+    private:
+        // A freed pool when there is one, a new one otherwise
+        VkDescriptorPool GrabPool();
+        [[nodiscard]] VkDescriptorPool CreatePool(uint32_t setCount) const;
+
+        VkDevice m_device;
+        std::vector<DescriptorPoolSizeRatio> m_ratios;
+        uint32_t m_setsPerPool;
+
+        VkDescriptorPool m_currentPool = VK_NULL_HANDLE;
+        // Handed out since the last Reset, the current pool included
+        std::vector<VkDescriptorPool> m_usedPools;
+        // Reset and ready to be reused
+        std::vector<VkDescriptorPool> m_freePools;
+
+        DescriptorAllocatorStats m_stats;
+    };
+} // namespace Thryve::Rendering
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "pch.h"
+
+namespace Thryve::Rendering {
+    /**
+     * Owns every descriptor set layout, keyed by a hash of its bindings. Asking for the same bindings again, in
+     * any order, returns the layout created the first time, so pipelines and sets built from identical
+     * declarations stay compatible and nothing is created twice. Layouts live until the cache is destroyed.
+     */
+    class DescriptorLayoutCache {
+    public:
+        DescriptorLayoutCache();
+        ~DescriptorLayoutCache();
+
+        DescriptorLayoutCache(const DescriptorLayoutCache&) = delete;
+        DescriptorLayoutCache& operator=(const DescriptorLayoutCache&) = delete;
+
+        // Immutable samplers are not supported, pImmutableSamplers has to be null
+        VkDescriptorSetLayout GetOrCreate(std::span<const VkDescriptorSetLayoutBinding> bindings);
+
+        [[nodiscard]] uint32_t GetLayoutCount() const { return static_cast<uint32_t>(m_layouts.size()); }
+        [[nodiscard]] uint32_t GetHitCount() const { return m_hitCount; }
+
+    private:
+        struct Entry {
+            // Sorted by binding
+            std::vector<VkDescriptorSetLayoutBinding> Bindings;
+            VkDescriptorSetLayout Layout;
+        };
+
+        VkDevice m_device;
+        std::unordered_multimap<uint64_t, Entry> m_layouts;
+        uint32_t m_hitCount = 0;
+    };
+} // namespace Thryve::Rendering
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "DescriptorAllocator.h"
+#include "pch.h"
+
+namespace Thryve::Rendering {
+    // One descriptor of a set, Buffer is used for buffer types and Image for image and sampler types
+    struct DescriptorWrite {
+        uint32_t Binding = 0;
+        VkDescriptorType Type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        VkDescriptorBufferInfo Buffer{};
+        VkDescriptorImageInfo Image{};
+
+        static DescriptorWrite UniformBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+        // Bound with a dynamic offset added to offset, see UniformBufferRing
+        static DescriptorWrite DynamicUniformBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize offset,
+                                                    VkDeviceSize range);
+        static DescriptorWrite CombinedImageSampler(uint32_t binding, const VkDescriptorImageInfo& image);
+    };
+
+    struct DescriptorSetCacheStats {
+        // Lookups answered with a set written earlier
+        uint32_t HitCount = 0;
+        // Sets allocated and written with vkUpdateDescriptorSets
+        uint32_t WriteCount = 0;
+        // Times every set was dropped and the allocator reset
+        uint32_t FlushCount = 0;
+    };
+
+    /**
+     * Content-addressed descriptor sets. A set is keyed by its layout and a hash of the resources written to it,
+     * so draws and materials that bind the same buffers and textures share one set, written once. Sets are never
+     * updated again after their first write, which makes them safe to reuse in later frames without waiting.
+     * Each frame in flight keeps its own cache on top of its own allocator: BeginFrame runs after the frame's fence
+     * and, once too many sets went unused, drops all of them with a single allocator reset.
+     */
+    class DescriptorSetCache {
+    public:
+        // Sets unused in the previous frame that are kept before the cache starts over
+        static constexpr uint32_t MAX_UNUSED_SETS = 64;
+
+        explicit DescriptorSetCache(DescriptorAllocator& allocator);
+
+        DescriptorSetCache(const DescriptorSetCache&) = delete;
+        DescriptorSetCache& operator=(const DescriptorSetCache&) = delete;
+
+        // Once the GPU is done with every set handed out before, after the fence of the frame using this cache
+        void BeginFrame();
+
+        // The set holding exactly these writes, allocated and written on a miss
+        VkDescriptorSet GetOrWrite(VkDescriptorSetLayout layout, std::span<const DescriptorWrite> writes);
+
+        [[nodiscard]] const DescriptorSetCacheStats& GetStats() const { return m_stats; }
+
+    private:
+        struct Entry {
+            VkDescriptorSetLayout Layout;
+            std::vector<DescriptorWrite> Writes;
+            VkDescriptorSet Set;
+            uint64_t LastUsedFrame;
+        };
+
+        [[nodiscard]] bool Matches(const Entry& entry, VkDescriptorSetLayout layout,
+                                   std::span<const DescriptorWrite> writes) const;
+
+        VkDevice m_device;
+        DescriptorAllocator& m_allocator;
+        std::unordered_multimap<uint64_t, Entry> m_sets;
+
+        uint64_t m_frame = 0;
+        // Distinct sets looked up since BeginFrame
+        uint32_t m_usedThisFrame = 0;
+        DescriptorSetCacheStats m_stats;
+    };
+} // namespace Thryve::Rendering
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "AssetManager.h"
+#include "DescriptorAllocator.h"
+#include "DescriptorLayoutCache.h"
+#include "InstanceBatcher.h"
+#include "Renderer/Frustum.h"
+#include "glm/glm.hpp"
+#include "pch.h"
+#include "vk_mem_alloc.h"
+
+namespace Thryve::Rendering {
+    // Per-object culling input of cull.comp, std430 layout
+    struct GpuObject {
+        // Model space bounding sphere, center and radius
+        glm::vec4 Sphere;
+        uint32_t IndexCount;
+        // Counter of the object's mesh in the count buffer
+        uint32_t Batch;
+        // First command of the mesh's range in the command buffer
+        uint32_t FirstCommand;
+        // The object's own command when draws are not compacted
+        uint32_t Slot;
+    };
+
+    struct GpuDrivenSceneStats {
+        uint32_t ObjectCount = 0;
+        // One indirect draw call per mesh
+        uint32_t BatchCount = 0;
+        // Objects copied to a frame's buffers, only the ones that changed
+        uint32_t UploadedObjectCount = 0;
+    };
+
+    /**
+     * Objects that are culled and drawn without the CPU touching them per frame. Every object is an instance of a
+     * mesh with a transform, kept in a persistently mapped buffer per frame in flight that only receives the
+     * objects changed since that frame last ran. RecordCull dispatches cull.comp over all of them, which tests
+     * each bounding sphere against the frustum and appends a VkDrawIndexedIndirectCommand for the survivors to
+     * their mesh's range, counted with an atomic. RecordDraws then issues one vkCmdDrawIndexedIndirectCountKHR per
+     * mesh, each command drawing one instance whose firstInstance is the object, read by triangle_instanced.vert.
+     *
+     * Without VK_KHR_draw_indirect_count the shader writes every object's command in place, culled ones with an
+     * instance count of zero, and the draws use vkCmdDrawIndexedIndirect over the whole range.
+     */
+    class GpuDrivenScene {
+    public:
+        static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+        GpuDrivenScene(DescriptorLayoutCache& layoutCache, const AssetManager& assetManager, uint32_t frameCount);
+        ~GpuDrivenScene();
+
+        GpuDrivenScene(const GpuDrivenScene&) = delete;
+        GpuDrivenScene& operator=(const GpuDrivenScene&) = delete;
+
+        // Objects live as long as the scene, the returned index is used to update them
+        uint32_t AddObject(MeshHandle mesh, const InstanceData& instance);
+        void UpdateObject(uint32_t object, const InstanceData& instance);
+        [[nodiscard]] const InstanceData& GetObject(uint32_t object) const { return m_instances[object]; }
+
+        // Uploads what changed since frameIndex last ran, after its fence
+        void BeginFrame(uint32_t frameIndex);
+
+        // Outside a render pass, before RecordDraws. The caller orders the compute shader's writes before the
+        // indirect reads of RecordDraws, the last frame's draws were already ordered by its fence
+        void RecordCull(VkCommandBuffer commandBuffer, const Frustum& frustum);
+        // Inside a render pass with an instanced pipeline and its descriptor sets bound
+        void RecordDraws(VkCommandBuffer commandBuffer) const;
+
+        [[nodiscard]] bool IsCompacting() const { return m_bCompact; }
+        [[nodiscard]] const GpuDrivenSceneStats& GetStats() const { return m_stats; }
+
+    private:
+        struct Batch {
+            MeshHandle Mesh;
+            uint32_t ObjectCount = 0;
+            uint32_t FirstCommand = 0;
+            bool bResident = false;
+        };
+
+        struct FrameResources {
+            // Host visible and mapped, read as vertex attributes and by the cull shader
+            VkBuffer InstanceBuffer = VK_NULL_HANDLE;
+            VmaAllocation InstanceAllocation = VK_NULL_HANDLE;
+            InstanceData* Instances = nullptr;
+            VkBuffer ObjectBuffer = VK_NULL_HANDLE;
+            VmaAllocation ObjectAllocation = VK_NULL_HANDLE;
+            GpuObject* Objects = nullptr;
+            // Device local, written by the cull shader and read by the indirect draws
+            VkBuffer CommandBuffer = VK_NULL_HANDLE;
+            VmaAllocation CommandAllocation = VK_NULL_HANDLE;
+            VkBuffer CountBuffer = VK_NULL_HANDLE;
+            VmaAllocation CountAllocation = VK_NULL_HANDLE;
+            uint32_t ObjectCapacity = 0;
+            uint32_t BatchCapacity = 0;
+
+            VkDescriptorSet Set = VK_NULL_HANDLE;
+            // Objects changed since this frame last uploaded, empty when DirtyBegin == DirtyEnd
+            uint32_t DirtyBegin = 0;
+            uint32_t DirtyEnd = 0;
+        };
+
+        struct CullPushConstants {
+            std::array<glm::vec4, Frustum::PlaneCount> Planes;
+            uint32_t ObjectCount;
+        };
+
+        void CreatePipeline();
+        void MarkDirty(uint32_t begin, uint32_t end);
+        // Picks up meshes that became resident and lays the command ranges out again after objects were added
+        void RefreshBatches();
+        // Recreates the frame's buffers once they cannot hold every object, the GPU must be done with them
+        void Reserve(FrameResources& frame);
+        void DestroyBuffers(FrameResources& frame) const;
+
+        VkDevice m_device;
+        const AssetManager& m_assetManager;
+        bool m_bCompact;
+        PFN_vkCmdDrawIndexedIndirectCountKHR m_drawIndexedIndirectCount = nullptr;
+
+        VkDescriptorSetLayout m_setLayout;
+        VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+        VkPipeline m_pipeline = VK_NULL_HANDLE;
+        // Never reset, every frame keeps its set and rewrites it when its buffers grow
+        DescriptorAllocator m_descriptorAllocator;
+
+        std::vector<InstanceData> m_instances;
+        std::vector<GpuObject> m_objects;
+        std::vector<Batch> m_batches;
+        // Indexed by MeshHandle::Index, UINT32_MAX for meshes without objects
+        std::vector<uint32_t> m_batchOfMesh;
+        bool m_bLayoutDirty = false;
+
+        std::vector<FrameResources> m_frames;
+        uint32_t m_frameIndex = 0;
+
+        GpuDrivenSceneStats m_stats;
+    };
+} // namespace Thryve::Rendering
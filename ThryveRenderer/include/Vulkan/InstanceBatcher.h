@@ -0,0 +1,99 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "AssetManager.h"
+#include "glm/glm.hpp"
+#include "pch.h"
+#include "vk_mem_alloc.h"
+
+namespace Thryve::Rendering {
+    // Per-instance vertex attributes of triangle_instanced.vert, read from vertex binding 1
+    struct InstanceData {
+        glm::mat4 Model;
+        // Bindless table slots of the albedo, normal, metallic and emission maps, unused without the table
+        glm::uvec4 Textures;
+
+        static VkVertexInputBindingDescription getBindingDescription() {
+            VkVertexInputBindingDescription bindingDescription{};
+            bindingDescription.binding = 1;
+            bindingDescription.stride = sizeof(InstanceData);
+            bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+            return bindingDescription;
+        }
+
+        // Locations 5-8 hold the columns of Model, 9 holds Textures
+        static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions() {
+            std::vector<VkVertexInputAttributeDescription> attributeDescriptions(5);
+            for (uint32_t i = 0; i < 4; i++) {
+                attributeDescriptions[i].binding = 1;
+                attributeDescriptions[i].location = 5 + i;
+                attributeDescriptions[i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+                attributeDescriptions[i].offset = offsetof(InstanceData, Model) + sizeof(glm::vec4) * i;
+            }
+            attributeDescriptions[4].binding = 1;
+            attributeDescriptions[4].location = 9;
+            attributeDescriptions[4].format = VK_FORMAT_R32G32B32A32_UINT;
+            attributeDescriptions[4].offset = offsetof(InstanceData, Textures);
+            return attributeDescriptions;
+        }
+    };
+
+    struct InstanceBatcherStats {
+        // Instanced draws recorded last frame, one per mesh with instances
+        uint32_t DrawCount = 0;
+        uint32_t InstanceCount = 0;
+        // Times an instance buffer was recreated larger
+        uint32_t GrowCount = 0;
+    };
+
+    /**
+     * Collects instances per mesh over a frame and draws every mesh once with vkCmdDrawIndexed and an instance
+     * count. Submitting the same mesh again, from anywhere, appends to its batch, so identical meshes always
+     * merge into one draw. Record packs all batches back to back into the frame's persistently mapped instance
+     * buffer and binds it at vertex binding 1, each draw starting at its batch through firstInstance. There is an
+     * instance buffer per frame in flight that grows when a frame submits more than it holds.
+     */
+    class InstanceBatcher {
+    public:
+        InstanceBatcher(const AssetManager& assetManager, uint32_t frameCount);
+        ~InstanceBatcher();
+
+        InstanceBatcher(const InstanceBatcher&) = delete;
+        InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+
+        // Drops last frame's instances, after the fence of the last frame that used frameIndex's buffer
+        void BeginFrame(uint32_t frameIndex);
+
+        void Submit(MeshHandle mesh, std::span<const InstanceData> instances);
+        void Submit(MeshHandle mesh, const InstanceData& instance) { Submit(mesh, {&instance, 1}); }
+
+        // Inside a render pass with an instanced pipeline and its descriptor sets bound. Meshes that are not
+        // resident yet are skipped
+        void Record(VkCommandBuffer commandBuffer);
+
+        [[nodiscard]] const InstanceBatcherStats& GetStats() const { return m_stats; }
+
+    private:
+        struct InstanceBuffer {
+            VkBuffer Buffer = VK_NULL_HANDLE;
+            VmaAllocation Allocation = VK_NULL_HANDLE;
+            InstanceData* Mapped = nullptr;
+            uint32_t Capacity = 0;
+        };
+
+        // Recreates the buffer once it cannot hold instanceCount, it must not be in use by the GPU
+        void Reserve(InstanceBuffer& buffer, uint32_t instanceCount);
+
+        const AssetManager& m_assetManager;
+        std::vector<InstanceBuffer> m_frameBuffers;
+        uint32_t m_frameIndex = 0;
+
+        // Indexed by MeshHandle::Index, cleared but never shrunk so steady frames do not allocate
+        std::vector<std::vector<InstanceData>> m_batches;
+        uint32_t m_instanceCount = 0;
+
+        InstanceBatcherStats m_stats;
+    };
+} // namespace Thryve::Rendering
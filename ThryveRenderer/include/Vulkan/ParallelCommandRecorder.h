@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Core/Ref.h"
+#include "pch.h"
+
+namespace Thryve::Rendering {
+    struct ParallelCommandRecorderStats {
+        // Items and secondary command buffers of the last Record
+        uint32_t ItemCount = 0;
+        uint32_t SecondaryCount = 0;
+        // Threads that recorded at least one of those buffers
+        uint32_t ThreadCount = 0;
+    };
+
+    /**
+     * Records the draws of a subpass into secondary command buffers on the JobSystem. Every thread owns one
+     * transient command pool per frame in flight, so no pool is ever touched by two threads, and BeginFrame
+     * resets a frame's pools as a whole instead of resetting buffers one by one. Buffers stay allocated and are
+     * reused by the same thread next time its pool comes around.
+     *
+     * Record splits the items into contiguous ranges of at least MIN_ITEMS_PER_BUFFER, one secondary each, and
+     * returns the buffers in range order, so executing them draws in the same order as recording inline would.
+     */
+    class ParallelCommandRecorder {
+    public:
+        // Below this a secondary costs more to begin, set up and execute than its draws take to record
+        static constexpr uint32_t MIN_ITEMS_PER_BUFFER = 256;
+
+        explicit ParallelCommandRecorder(uint32_t frameCount);
+        ~ParallelCommandRecorder();
+
+        ParallelCommandRecorder(const ParallelCommandRecorder&) = delete;
+        ParallelCommandRecorder& operator=(const ParallelCommandRecorder&) = delete;
+
+        // Resets every pool of frameIndex, after the fence of the last frame that executed its buffers
+        void BeginFrame(uint32_t frameIndex);
+
+        /**
+         * Calls record(commandBuffer, begin, end) for every range of [0, itemCount) on the workers, each into a
+         * secondary that continues subpass of renderPass on framebuffer. Nothing is inherited from the primary,
+         * record binds its own pipeline, dynamic state and descriptor sets. The returned buffers are meant for
+         * vkCmdExecuteCommands and stay valid until the next Record. Call from one thread at a time.
+         */
+        template <typename Func>
+        std::span<const VkCommandBuffer> Record(const VkRenderPass renderPass, const uint32_t subpass,
+                                                const VkFramebuffer framebuffer, const uint32_t itemCount,
+                                                Func&& record)
+        {
+            m_recorded.clear();
+            if (itemCount == 0)
+            {
+                UpdateStats(0);
+                return m_recorded;
+            }
+
+            // One range per thread at most, more would only add secondaries without adding parallelism
+            const uint32_t _targetRanges = std::clamp(itemCount / MIN_ITEMS_PER_BUFFER, 1u, GetSlotCount());
+            const uint32_t _rangeSize = (itemCount + _targetRanges - 1) / _targetRanges;
+            const uint32_t _rangeCount = (itemCount + _rangeSize - 1) / _rangeSize;
+            m_recorded.resize(_rangeCount, VK_NULL_HANDLE);
+
+            VkCommandBufferInheritanceInfo _inheritance{};
+            _inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+            _inheritance.renderPass = renderPass;
+            _inheritance.subpass = subpass;
+            _inheritance.framebuffer = framebuffer;
+
+            m_jobSystem->ParallelFor(_rangeCount, 1, [&](const uint32_t rangeBegin, const uint32_t rangeEnd) {
+                for (uint32_t _range = rangeBegin; _range < rangeEnd; ++_range)
+                {
+                    const VkCommandBuffer _commandBuffer = BeginSecondary(_inheritance);
+                    const uint32_t _begin = _range * _rangeSize;
+                    record(_commandBuffer, _begin, std::min(itemCount, _begin + _rangeSize));
+                    EndSecondary(_commandBuffer);
+                    m_recorded[_range] = _commandBuffer;
+                }
+            });
+
+            UpdateStats(itemCount);
+            return m_recorded;
+        }
+
+        [[nodiscard]] const ParallelCommandRecorderStats& GetStats() const { return m_stats; }
+
+    private:
+        // Padded so threads bumping UsedCount next to each other do not share a cache line
+        struct alignas(64) ThreadPool {
+            VkCommandPool Pool = VK_NULL_HANDLE;
+            std::vector<VkCommandBuffer> Buffers;
+            // Buffers handed out since the pool was last reset
+            uint32_t UsedCount = 0;
+        };
+
+        // Every worker plus one for a recording thread that is not a worker
+        [[nodiscard]] uint32_t GetSlotCount() const { return m_jobSystem->GetWorkerCount() + 1; }
+        // The calling thread's pool of the current frame
+        ThreadPool& GetThreadPool();
+        VkCommandBuffer BeginSecondary(const VkCommandBufferInheritanceInfo& inheritance);
+        static void EndSecondary(VkCommandBuffer commandBuffer);
+        void UpdateStats(uint32_t itemCount);
+
+        VkDevice m_device;
+        Core::SharedRef<Core::JobSystem> m_jobSystem;
+
+        // GetSlotCount() pools per frame in flight, frame after frame
+        std::vector<ThreadPool> m_pools;
+        uint32_t m_frameIndex = 0;
+
+        std::vector<VkCommandBuffer> m_recorded;
+        ParallelCommandRecorderStats m_stats;
+    };
+} // namespace Thryve::Rendering
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "pch.h"
+#include "Core/IService.h"
+
+namespace Thryve::Rendering {
+    struct PipelineCacheServiceConfiguration : ServiceConfiguration {
+        // Empty picks CACHE_DIR/pipeline_cache.bin
+        std::string CachePath;
+        // Disable to measure a cold start without deleting the cache, the blob is still written on release
+        bool bLoadFromDisk = true;
+    };
+
+    struct PipelineCacheStats {
+        // The driver accepted a blob from disk
+        bool bWarm = false;
+        size_t LoadedBytes = 0;
+        uint32_t PipelineCount = 0;
+        double PipelineCreationMilliseconds = 0.0;
+    };
+
+    /**
+     * Owns the one VkPipelineCache every pipeline is created with and persists it between runs.
+     * The driver blob is wrapped in a small file header with its size and hash, and its own
+     * VkPipelineCacheHeaderVersionOne is checked against the current vendor, device and pipelineCacheUUID
+     * before it is handed back to the driver, so a driver update or a different GPU just starts cold.
+     */
+    class PipelineCacheService : public Core::IService {
+    public:
+        struct FileHeader {
+            static constexpr uint32_t MAGIC = 0x43505954; // "TYPC"
+            static constexpr uint32_t VERSION = 1;
+
+            uint32_t Magic;
+            uint32_t Version;
+            uint64_t DataSize;
+            uint64_t DataHash;
+        };
+
+        void Init(ServiceConfiguration* configuration) override;
+        void ShutDown() override;
+
+        // Created on first use from the current device, so layers attached before the render context can share it.
+        // VK_NULL_HANDLE after Release, pipelines created that late are not cached instead of never being saved
+        VkPipelineCache GetPipelineCache();
+
+        // Called by pipeline creation with the time vkCreate*Pipelines took, feeds the startup metrics
+        void RecordPipelineCreation(double milliseconds);
+
+        // Writes the cache to disk and destroys it, has to run while the device is still alive. Final, the cache is
+        // not created again afterwards
+        void Release();
+
+        [[nodiscard]] PipelineCacheStats GetStats();
+
+    private:
+        void CreateCache();
+        // Returns the driver blob when the file exists, is intact and matches this device, empty otherwise
+        std::vector<char> LoadCacheData(const VkPhysicalDeviceProperties& properties) const;
+        void SaveCacheData() const;
+
+        std::mutex m_mutex;
+        PipelineCacheServiceConfiguration m_config;
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+        bool m_bReleased = false;
+        PipelineCacheStats m_stats;
+    };
+} // namespace Thryve::Rendering
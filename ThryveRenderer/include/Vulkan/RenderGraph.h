@@ -0,0 +1,275 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Core/Profiling.h"
+#include "TransientAttachmentAllocator.h"
+#include "pch.h"
+
+namespace Thryve::Rendering {
+    // An image or buffer of a RenderGraph, only valid for the graph that returned it until its next Reset
+    struct RenderGraphResource {
+        uint32_t Index = UINT32_MAX;
+
+        [[nodiscard]] bool IsValid() const { return Index != UINT32_MAX; }
+    };
+
+    // Where and as what a pass touches a resource, decides the stages, accesses and image layout of its barriers.
+    // Whether it reads or writes is up to RenderGraphPassBuilder::Read and Write
+    enum class RenderGraphUsage : uint32_t {
+        ColorAttachment = 0,
+        // Read is a depth test without depth writes, in the read-only layout
+        DepthAttachment,
+        SampledFragment,
+        SampledCompute,
+        StorageCompute,
+        IndirectCommand,
+        VertexInput,
+        Transfer,
+    };
+
+    enum class RenderGraphPassType : uint32_t {
+        Graphics = 0,
+        Compute,
+        Transfer,
+    };
+
+    struct RenderGraphImageDesc {
+        VkFormat Format = VK_FORMAT_UNDEFINED;
+        VkExtent2D Extent{};
+        VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+    };
+
+    // Where an imported image is before the graph's first pass, or where it has to be after the last one
+    struct RenderGraphExternalState {
+        VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags Stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        VkAccessFlags Access = 0;
+    };
+
+    struct RenderGraphStats {
+        uint32_t PassCount = 0;
+        // Passes nothing depends on, never recorded
+        uint32_t CulledPassCount = 0;
+        // Barrier calls per Execute, at most one per pass plus one after the last
+        uint32_t BarrierBatchCount = 0;
+        uint32_t ImageBarrierCount = 0;
+        uint32_t MemoryBarrierCount = 0;
+        // Images the graph owns, aliased and lazily allocated by its TransientAttachmentAllocator
+        TransientAttachmentStats TransientImages;
+    };
+
+    class RenderGraph;
+
+    struct RenderGraphPassContext {
+        const RenderGraph& Graph;
+        // Graphics passes only, begun before the pass's function runs and ended after it returns
+        VkRenderPass RenderPass = VK_NULL_HANDLE;
+        VkFramebuffer Framebuffer = VK_NULL_HANDLE;
+        VkExtent2D Extent{};
+        // Begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS, the function may only execute secondaries
+        bool bSecondaryCommandBuffers = false;
+    };
+
+    using RenderGraphExecuteFunction = std::function<void(VkCommandBuffer commandBuffer,
+                                                          const RenderGraphPassContext& context)>;
+
+    // Declares what a pass added with RenderGraph::AddPass reads and writes
+    class RenderGraphPassBuilder {
+    public:
+        RenderGraphPassBuilder& Read(RenderGraphResource resource, RenderGraphUsage usage);
+        RenderGraphPassBuilder& Write(RenderGraphResource resource, RenderGraphUsage usage);
+        // Graphics passes only, attachments are numbered in the order they are declared. Cleared to clearValue,
+        // otherwise the previous contents are loaded
+        RenderGraphPassBuilder& ColorAttachment(RenderGraphResource resource,
+                                                std::optional<VkClearColorValue> clearValue = std::nullopt);
+        RenderGraphPassBuilder& DepthAttachment(RenderGraphResource resource,
+                                                std::optional<VkClearDepthStencilValue> clearValue = std::nullopt,
+                                                bool bReadOnly = false);
+        // Kept even when nothing reads what the pass writes
+        RenderGraphPassBuilder& SideEffect();
+        // The render pass begins with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS, the pass's function only
+        // executes secondaries that continue context.RenderPass. condition, when given, is asked on every Execute
+        // and the pass records inline while it returns false
+        RenderGraphPassBuilder& SecondaryCommandBuffers(std::function<bool()> condition = {});
+        RenderGraphPassBuilder& Execute(RenderGraphExecuteFunction function);
+
+    private:
+        friend class RenderGraph;
+
+        RenderGraphPassBuilder(RenderGraph& graph, const uint32_t passIndex) : m_graph(graph), m_passIndex(passIndex) {}
+
+        RenderGraphPassBuilder& Attach(RenderGraphResource resource, RenderGraphUsage usage, bool bWrite,
+                                       std::optional<VkClearValue> clearValue);
+
+        RenderGraph& m_graph;
+        uint32_t m_passIndex;
+    };
+
+    /**
+     * Frame graph of passes that declare the images and buffers they read and write. Compile works out the
+     * whole frame once:
+     * - passes whose results nothing reads are culled, unless they write an imported resource or have side effects
+     * - every resource's state is followed from pass to pass, and each pass gets the barriers its reads and writes
+     *   need, batched into a single call in front of it. Reads that an earlier barrier already made visible, or
+     *   that only follow other reads in the same layout, get none. Buffers share one global memory barrier
+     * - transient images that are never alive at the same time are placed into the same memory, and attachments
+     *   that never leave their render pass into lazily allocated memory where the device has it
+     * - graphics passes get a render pass that starts and ends in the attachment layouts, so every transition is
+     *   one of the graph's barriers, and stores only what a later pass or the outside world reads
+     *
+     * Execute then only replays that plan, with vkCmdPipelineBarrier2KHR when the device has synchronization2 and
+     * vkCmdPipelineBarrier otherwise. Declare everything, Compile, then Execute every frame. Compile again after
+     * anything changed, e.g. the swapchain's extent.
+     */
+    class RenderGraph {
+    public:
+        RenderGraph();
+        ~RenderGraph();
+
+        RenderGraph(const RenderGraph&) = delete;
+        RenderGraph& operator=(const RenderGraph&) = delete;
+
+        // Drops every pass and resource and everything compiled from them. The GPU must be done with them. The
+        // memory of the transient images is kept for the next Compile, e.g. at the swapchain's new extent
+        void Reset();
+
+        // Owned by the graph, only valid between its first and last use within a frame
+        RenderGraphResource CreateImage(std::string name, const RenderGraphImageDesc& desc);
+        // Owned by someone else and set every frame with SetImportedImage. Passes writing it are never culled
+        RenderGraphResource ImportImage(std::string name, const RenderGraphImageDesc& desc,
+                                        const RenderGraphExternalState& initialState,
+                                        const RenderGraphExternalState& finalState);
+        // Owned by someone else, ordered through global memory barriers so the buffer itself is not needed
+        RenderGraphResource ImportBuffer(std::string name);
+
+        // name has to be a constant, it doubles as the pass's GPU profiling scope
+        RenderGraphPassBuilder AddPass(const char* name, RenderGraphPassType type);
+
+        void Compile();
+
+        void SetImportedImage(RenderGraphResource resource, VkImage image, VkImageView view);
+        [[nodiscard]] VkImage GetImage(RenderGraphResource resource) const { return m_resources[resource.Index].Image; }
+        [[nodiscard]] VkImageView GetImageView(RenderGraphResource resource) const
+        {
+            return m_resources[resource.Index].View;
+        }
+
+        // Records every pass that survived culling with its barriers, outside of any render pass
+        void Execute(VkCommandBuffer commandBuffer);
+
+        [[nodiscard]] const RenderGraphStats& GetStats() const { return m_stats; }
+
+    private:
+        friend class RenderGraphPassBuilder;
+
+        struct ResourceUse {
+            uint32_t Resource;
+            RenderGraphUsage Usage;
+            bool bWrite;
+        };
+
+        struct Attachment {
+            uint32_t Resource;
+            // Index into the pass's Uses
+            uint32_t Use;
+            std::optional<VkClearValue> ClearValue;
+        };
+
+        struct Pass {
+            const char* Name;
+            RenderGraphPassType Type;
+            std::vector<ResourceUse> Uses;
+            std::vector<Attachment> Attachments;
+            RenderGraphExecuteFunction Function;
+            bool bSideEffect = false;
+            bool bSecondaryCommandBuffers = false;
+            std::function<bool()> SecondaryCondition;
+            Core::ProfileScopeID ScopeID = 0;
+
+            // Compiled
+            bool bCulled = false;
+            uint32_t FirstBarrier = 0;
+            uint32_t BarrierCount = 0;
+            VkRenderPass RenderPass = VK_NULL_HANDLE;
+            std::vector<VkClearValue> ClearValues;
+            // One per set of attachment views seen, imported images change from frame to frame
+            std::vector<std::pair<std::vector<VkImageView>, VkFramebuffer>> Framebuffers;
+        };
+
+        struct Resource {
+            std::string Name;
+            bool bImage = false;
+            bool bImported = false;
+            RenderGraphImageDesc Desc;
+            RenderGraphExternalState InitialState;
+            RenderGraphExternalState FinalState;
+            VkImage Image = VK_NULL_HANDLE;
+            VkImageView View = VK_NULL_HANDLE;
+
+            // Compiled, first and last pass using it that was not culled
+            uint32_t FirstPass = UINT32_MAX;
+            uint32_t LastPass = 0;
+            VkImageUsageFlags ImageUsage = 0;
+            // Into m_transientAllocator
+            uint32_t TransientImage = UINT32_MAX;
+        };
+
+        // Resource is UINT32_MAX for the pass's global memory barrier
+        struct PlannedBarrier {
+            uint32_t Resource;
+            VkPipelineStageFlags SrcStage;
+            VkAccessFlags SrcAccess;
+            VkPipelineStageFlags DstStage;
+            VkAccessFlags DstAccess;
+            VkImageLayout OldLayout;
+            VkImageLayout NewLayout;
+        };
+
+        // Where the simulation in PlanBarriers has a resource after the passes so far
+        struct ResourceState {
+            VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            // Stages of the last write and the reads since, whatever comes next has to wait for them
+            VkPipelineStageFlags WriteStages = 0;
+            VkAccessFlags WriteAccess = 0;
+            VkPipelineStageFlags ReadStages = 0;
+            // Stages and accesses the last write is already visible to
+            VkPipelineStageFlags VisibleStages = 0;
+            VkAccessFlags VisibleAccess = 0;
+        };
+
+        void ReleaseCompiled();
+        void CullPasses();
+        void ComputeLifetimes();
+        void AllocateTransientImages();
+        void PlanBarriers();
+        void CreateRenderPass(Pass& pass);
+        VkFramebuffer GetFramebuffer(Pass& pass);
+        void RecordBarriers(VkCommandBuffer commandBuffer, uint32_t firstBarrier, uint32_t barrierCount);
+        [[nodiscard]] VkImageSubresourceRange GetSubresourceRange(const Resource& resource) const;
+
+        VkDevice m_device;
+        PFN_vkCmdPipelineBarrier2KHR m_pipelineBarrier2 = nullptr;
+
+        std::vector<Pass> m_passes;
+        std::vector<Resource> m_resources;
+
+        std::vector<PlannedBarrier> m_barriers;
+        // Into m_barriers, after the last pass, leaves imported images in their final state
+        uint32_t m_finalBarrier = 0;
+        uint32_t m_finalBarrierCount = 0;
+        TransientAttachmentAllocator m_transientAllocator;
+
+        // Filled by RecordBarriers, kept so steady frames do not allocate
+        std::vector<VkImageMemoryBarrier> m_imageBarriers;
+        std::vector<VkImageMemoryBarrier2KHR> m_imageBarriers2;
+        std::vector<VkImageView> m_attachmentViews;
+
+        RenderGraphStats m_stats;
+    };
+} // namespace Thryve::Rendering
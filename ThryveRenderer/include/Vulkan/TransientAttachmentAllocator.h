@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "pch.h"
+#include "vk_mem_alloc.h"
+
+namespace Thryve::Rendering {
+    struct TransientAttachmentDesc {
+        VkFormat Format = VK_FORMAT_UNDEFINED;
+        VkExtent2D Extent{};
+        VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+        VkImageUsageFlags Usage = 0;
+        VkImageAspectFlags Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        // Passes the image is used in, images whose ranges do not overlap are placed into the same memory
+        uint32_t FirstUse = 0;
+        uint32_t LastUse = 0;
+        // The contents never leave the render pass that writes them, cleared or discarded on load and never
+        // stored. Only taken for attachment-only usage, which then goes to lazily allocated memory
+        bool bLazy = false;
+    };
+
+    struct TransientAttachmentStats {
+        uint32_t ImageCount = 0;
+        uint32_t LazyImageCount = 0;
+        uint32_t BlockCount = 0;
+        // Blocks of the last Allocate that were big enough to be kept
+        uint32_t ReusedBlockCount = 0;
+        // What the images take on their own against what the blocks they are aliased into take
+        VkDeviceSize ImageBytes = 0;
+        VkDeviceSize AllocatedBytes = 0;
+        // Part of AllocatedBytes that is lazily allocated, only backed once the GPU has to spill the attachments
+        // out of tile memory, which tile-based GPUs do not for attachments that are never stored
+        VkDeviceSize LazyBytes = 0;
+        // ImageBytes minus the memory that is actually backed, through aliasing and lazy allocation
+        VkDeviceSize SavedBytes = 0;
+    };
+
+    /**
+     * Creates the transient render targets of a frame, depth and MSAA color buffers or anything else only used
+     * between two passes. Images whose uses never overlap are placed into the same memory, largest first at the
+     * lowest offset no image alive at the same time occupies. Images marked lazy get
+     * VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT and go to a VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT memory type
+     * where the device has one, usually only tile-based GPUs do, and ordinary device local memory otherwise.
+     *
+     * Allocate again after a resize. The blocks of the last layout are kept and reused for the new one as long as
+     * they are big enough and not more than MAX_REUSE_FACTOR times bigger than needed, so resizing back and forth
+     * or shrinking does not go back to the driver for memory.
+     */
+    class TransientAttachmentAllocator {
+    public:
+        static constexpr VkDeviceSize MAX_REUSE_FACTOR = 2;
+
+        TransientAttachmentAllocator();
+        ~TransientAttachmentAllocator();
+
+        TransientAttachmentAllocator(const TransientAttachmentAllocator&) = delete;
+        TransientAttachmentAllocator& operator=(const TransientAttachmentAllocator&) = delete;
+
+        // Replaces every image of the last Allocate with one per desc, in order. The GPU must be done with them
+        void Allocate(std::span<const TransientAttachmentDesc> descs);
+        // Destroys the images but keeps their memory for the next Allocate
+        void ReleaseImages();
+
+        [[nodiscard]] VkImage GetImage(const uint32_t index) const { return m_images[index].Image; }
+        [[nodiscard]] VkImageView GetImageView(const uint32_t index) const { return m_images[index].View; }
+        [[nodiscard]] bool IsLazy(const uint32_t index) const { return m_images[index].bLazy; }
+        // Whether the two images overlap in memory, an image always does with itself
+        [[nodiscard]] bool SharesMemory(uint32_t first, uint32_t second) const;
+
+        [[nodiscard]] bool SupportsLazyAllocation() const { return m_lazyMemoryTypeBits != 0; }
+        [[nodiscard]] const TransientAttachmentStats& GetStats() const { return m_stats; }
+
+    private:
+        struct Image {
+            VkImage Image = VK_NULL_HANDLE;
+            VkImageView View = VK_NULL_HANDLE;
+            VkMemoryRequirements Requirements{};
+            uint32_t FirstUse = 0;
+            uint32_t LastUse = 0;
+            bool bLazy = false;
+            uint32_t Block = UINT32_MAX;
+            VkDeviceSize Offset = 0;
+        };
+
+        struct Block {
+            VmaAllocation Allocation = VK_NULL_HANDLE;
+            // Size and alignment the images placed into it need, memoryTypeBits every one of them accepts
+            VkMemoryRequirements Requirements{};
+            bool bLazy = false;
+        };
+
+        // Places every image into m_blocks, which only have their requirements set afterwards
+        void PlaceImages();
+        // Hands block the allocation of a block of the last Allocate that fits it, along with its actual size
+        bool TakeRetainedBlock(std::vector<Block>& retained, Block& block) const;
+        void FreeBlocks(std::vector<Block>& blocks) const;
+
+        VkDevice m_device;
+        VmaAllocator m_allocator;
+        uint32_t m_lazyMemoryTypeBits = 0;
+
+        std::vector<Image> m_images;
+        std::vector<Block> m_blocks;
+        TransientAttachmentStats m_stats;
+    };
+} // namespace Thryve::Rendering
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstring>
+
+#include "pch.h"
+#include "vk_mem_alloc.h"
+
+namespace Thryve::Rendering {
+    struct UniformAllocation {
+        void* Data = nullptr;
+        // Dynamic offset to bind the allocation with, relative to the start of the whole buffer
+        uint32_t Offset = 0;
+    };
+
+    /**
+     * Per-frame linear allocator for uniform data. One persistently mapped, host-coherent buffer is split into a
+     * region per frame in flight, and every allocation is a bump of the frame's cursor rounded up to
+     * minUniformBufferOffsetAlignment. Bind the buffer once as VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC with a
+     * range of the largest block and pass each object's Offset as the dynamic offset, so any number of objects
+     * share one descriptor set and nothing is allocated per object. Offsets include the frame's region, so the
+     * set stays the same across frames as well.
+     */
+    class UniformBufferRing {
+    public:
+        static constexpr VkDeviceSize DEFAULT_BYTES_PER_FRAME = 1024 * 1024;
+
+        UniformBufferRing(uint32_t frameCount, VkDeviceSize bytesPerFrame = DEFAULT_BYTES_PER_FRAME);
+        ~UniformBufferRing();
+
+        UniformBufferRing(const UniformBufferRing&) = delete;
+        UniformBufferRing& operator=(const UniformBufferRing&) = delete;
+
+        // Rewinds the frame's region, after the fence of the last frame that used it
+        void BeginFrame(uint32_t frameIndex);
+
+        // Throws once the frame's region is exhausted
+        UniformAllocation Allocate(VkDeviceSize size);
+
+        template <typename T>
+        uint32_t Push(const T& data)
+        {
+            const UniformAllocation _allocation = Allocate(sizeof(T));
+            std::memcpy(_allocation.Data, &data, sizeof(T));
+            return _allocation.Offset;
+        }
+
+        [[nodiscard]] VkBuffer GetBuffer() const { return m_buffer; }
+        [[nodiscard]] VkDeviceSize GetAlignment() const { return m_alignment; }
+        // Bytes allocated in the current frame, alignment padding included
+        [[nodiscard]] VkDeviceSize GetUsedBytes() const { return m_cursor - m_frameBegin; }
+
+    private:
+        VkBuffer m_buffer = VK_NULL_HANDLE;
+        VmaAllocation m_allocation = VK_NULL_HANDLE;
+        uint8_t* m_mapped = nullptr;
+
+        uint32_t m_frameCount;
+        VkDeviceSize m_bytesPerFrame;
+        VkDeviceSize m_alignment;
+
+        VkDeviceSize m_frameBegin = 0;
+        VkDeviceSize m_cursor = 0;
+    };
+} // namespace Thryve::Rendering
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "pch.h"
+#include "Renderer/MipGenerator.h"
+#include "vk_mem_alloc.h"
+
+namespace Thryve::Rendering {
+    struct StagingAllocation {
+        void* Data = nullptr;
+        VkBuffer Buffer = VK_NULL_HANDLE;
+        VkDeviceSize Offset = 0;
+    };
+
+    struct UploadStats {
+        uint64_t BytesUploaded = 0;
+        uint32_t CopyCount = 0;
+        uint32_t SubmitCount = 0;
+        // Allocations that had to wait for the GPU to hand ring space back
+        uint32_t StallCount = 0;
+        // Uploads larger than the whole ring, staged through a temporary buffer of their own
+        uint32_t DedicatedCount = 0;
+        // Batches handed from the transfer to the graphics queue family
+        uint32_t OwnershipTransferCount = 0;
+    };
+
+    /**
+     * Streams data into device-local buffers and images through one persistently mapped staging ring.
+     * Copies and layout transitions are recorded into a shared command buffer and go out in a single submit
+     * on Flush. Every submit is fence-tracked and the ring space it read from is reclaimed once that fence
+     * has signalled, so nothing waits for the queue to go idle.
+     *
+     * Copies run on the device's dedicated transfer queue when it has one, so they overlap rendering. The
+     * resources are then released to the graphics family on the transfer queue and acquired again in a small
+     * graphics submit that waits on the batch's semaphore. Without a transfer family everything runs on the
+     * graphics queue and no ownership transfer is needed. Not thread safe, record from the render thread only.
+     */
+    class UploadManager {
+    public:
+        static constexpr VkDeviceSize DEFAULT_RING_SIZE = 64ull * 1024 * 1024;
+
+        explicit UploadManager(VkDeviceSize ringSize = DEFAULT_RING_SIZE);
+        ~UploadManager();
+
+        UploadManager(const UploadManager&) = delete;
+        UploadManager& operator=(const UploadManager&) = delete;
+
+        void UploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+        // Copies tightly packed texels into mip 0 and leaves the image in SHADER_READ_ONLY_OPTIMAL. With more than one
+        // mip level the rest of the chain is blitted down from mip 0 on the graphics queue, the format has to support
+        // linear blits and the image TRANSFER_SRC usage.
+        void UploadImage(VkImage image, uint32_t width, uint32_t height, const void* data, VkDeviceSize size,
+                         uint32_t mipLevels = 1);
+
+        // Copies a pre-built mip chain, one region per level out of a single staging allocation, and leaves the
+        // image in SHADER_READ_ONLY_OPTIMAL. Level offsets are relative to data.
+        void UploadImageLevels(VkImage image, std::span<const MipLevel> levels, const void* data, VkDeviceSize size);
+
+        // Submits everything recorded since the last flush without waiting for it, returns the batch's ticket
+        uint64_t Flush();
+
+        // Flushes and lets every graphics submit from now on see all uploads so far. The graphics queue waits
+        // for the transfers on the GPU, the CPU does not block.
+        void Synchronize();
+
+        // Once per frame before the frame is submitted: hands finished batches to the graphics queue and
+        // recycles completed ones. Frames never wait for a transfer that is still running.
+        void Update();
+
+        // True once graphics submits made after this call see the uploads of the ticket's batch
+        [[nodiscard]] bool IsReady(const uint64_t ticket) const { return ticket <= m_readyTicket; }
+
+        // Flushes and blocks until every submitted batch has completed
+        void WaitIdle();
+
+        [[nodiscard]] bool UsesDedicatedTransferQueue() const { return m_bOwnershipTransfer; }
+        [[nodiscard]] const UploadStats& GetStats() const { return m_stats; }
+
+    private:
+        struct MipGeneration {
+            VkImage Image;
+            uint32_t Width;
+            uint32_t Height;
+            uint32_t MipLevels;
+        };
+
+        struct Batch {
+            uint64_t Ticket = 0;
+            VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+            VkFence Fence = VK_NULL_HANDLE;
+            // Ring position after the batch's last allocation, everything before it is free once Fence signals
+            uint64_t RingEnd = 0;
+            std::vector<std::pair<VkBuffer, VmaAllocation>> DedicatedBuffers;
+
+            // Ownership transfer to the graphics family, only used with a dedicated transfer queue
+            VkSemaphore TransferSemaphore = VK_NULL_HANDLE;
+            VkCommandBuffer AcquireCommandBuffer = VK_NULL_HANDLE;
+            VkFence AcquireFence = VK_NULL_HANDLE;
+            std::vector<VkBufferMemoryBarrier> BufferAcquires;
+            std::vector<VkImageMemoryBarrier> ImageAcquires;
+            VkPipelineStageFlags AcquireStageMask = 0;
+            // Blits need a graphics queue, they are recorded after the acquire barriers
+            std::vector<MipGeneration> MipGenerations;
+            bool bAcquireSubmitted = false;
+
+            [[nodiscard]] bool NeedsAcquire() const { return !BufferAcquires.empty() || !ImageAcquires.empty(); }
+        };
+
+        // Reserves staging memory in the current batch. A full ring submits and reclaims earlier batches, so the
+        // copy reading from the allocation has to be recorded before the next Allocate.
+        StagingAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+        StagingAllocation AllocateDedicated(VkDeviceSize size);
+        // Command buffer of the current batch, begun on first use. It runs on the transfer queue.
+        VkCommandBuffer GetCommandBuffer();
+        Batch& GetCurrentBatch();
+
+        // Makes a range written in the current batch available to the graphics queue
+        void ReleaseBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size);
+        // Moves an image written in the current batch from oldLayout to newLayout and makes it available to the
+        // graphics queue for reads from dstStageMask
+        void ReleaseImage(VkImage image, const VkImageSubresourceRange& range, VkImageLayout oldLayout,
+                          VkImageLayout newLayout, VkPipelineStageFlags dstStageMask);
+        // All levels from UNDEFINED to TRANSFER_DST_OPTIMAL, ahead of the copies
+        void BeginImageUpload(VkCommandBuffer commandBuffer, VkImage image) const;
+        static void RecordMipGeneration(VkCommandBuffer commandBuffer, const MipGeneration& generation);
+        void SubmitAcquire(Batch& batch);
+        // Returns whether at least one batch finished its transfer
+        bool RetireBatches(bool bWaitForOldest);
+        void RecycleBatch(Batch& batch);
+
+        VkDevice m_device;
+        VkQueue m_transferQueue;
+        VkQueue m_graphicsQueue;
+        uint32_t m_transferFamily;
+        uint32_t m_graphicsFamily;
+        bool m_bOwnershipTransfer;
+        VkCommandPool m_commandPool = VK_NULL_HANDLE;
+        // Graphics family pool for the acquire side of ownership transfers
+        VkCommandPool m_acquireCommandPool = VK_NULL_HANDLE;
+
+        VkBuffer m_ringBuffer = VK_NULL_HANDLE;
+        VmaAllocation m_ringAllocation = VK_NULL_HANDLE;
+        std::byte* m_ringData = nullptr;
+        VkDeviceSize m_ringSize;
+        // Monotonic byte positions, the offset into the ring is position % m_ringSize
+        uint64_t m_head = 0;
+        uint64_t m_tail = 0;
+
+        uint64_t m_nextTicket = 1;
+        uint64_t m_readyTicket = 0;
+
+        std::optional<Batch> m_currentBatch;
+        // Submitted to the transfer queue, in submission order
+        std::deque<Batch> m_inFlightBatches;
+        // Transfer done, waiting for the acquire submit on the graphics queue to complete
+        std::deque<Batch> m_acquiringBatches;
+        // Retired batches, their command buffers, fences and semaphore are reused
+        std::vector<Batch> m_freeBatches;
+
+        UploadStats m_stats;
+    };
+} // namespace Thryve::Rendering
@@ -4,12 +4,14 @@
 #pragma once
 
 #include "Core/Ref.h"
+#include "DescriptorAllocator.h"
+#include "DescriptorLayoutCache.h"
 #include "VulkanDescriptor.h"
 
 namespace Thryve::Rendering {
     class VulkanDescriptorManager : public Core::ReferenceCounted {
     public:
-        VulkanDescriptorManager(VkDescriptorPool descriptorPool);
+        explicit VulkanDescriptorManager(DescriptorLayoutCache &layoutCache);
         ~VulkanDescriptorManager() = default;
 
         // Disallow copying to avoid issues with Vulkan handle ownership
@@ -26,9 +28,11 @@ namespace Thryve::Rendering {
         VkWriteDescriptorSet createImageDescriptorWrite(VkDescriptorSet descriptorSet, uint32_t dstBinding,
                                                         VkDescriptorImageInfo *imageInfo);
 
+        // The layout belongs to the layout cache
         void CreateDescriptorSetLayout(const std::vector<VulkanDescriptor> &descriptors);
 
-        void AllocateDescriptorSets(uint32_t setCount);
+        // Sets live as long as allocator is not reset
+        void AllocateDescriptorSets(DescriptorAllocator &allocator, uint32_t setCount);
         // Function to update the descriptor sets with actual resources
         void UpdateDescriptorSets(const std::vector<VkWriteDescriptorSet> &writeSets) const;
 
@@ -37,7 +41,7 @@ namespace Thryve::Rendering {
 
     private:
         VkDevice m_device;
-        VkDescriptorPool m_descriptorPool;
+        DescriptorLayoutCache *m_layoutCache;
         VkDescriptorSetLayout m_descriptorSetLayout;
         std::vector<VkDescriptorSet> m_descriptorSets;
     };
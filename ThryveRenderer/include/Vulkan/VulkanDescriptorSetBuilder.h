@@ -3,12 +3,13 @@
 //
 #pragma once
 
+#include "DescriptorLayoutCache.h"
 #include "VulkanDescriptor.h"
 
 
 class VulkanDescriptorSetBuilder {
 public:
-    explicit VulkanDescriptorSetBuilder(const VkDevice device) : m_device(device){}
+    explicit VulkanDescriptorSetBuilder(Thryve::Rendering::DescriptorLayoutCache& layoutCache) : m_layoutCache(layoutCache){}
     ~VulkanDescriptorSetBuilder() = default;
 
     VulkanDescriptorSetBuilder& AddDescriptor(const VulkanDescriptor& descriptor) {
@@ -16,6 +17,7 @@ public:
         return *this;
     }
 
+    // Owned by the layout cache, identical bindings built twice give the same layout
     [[nodiscard]] VkDescriptorSetLayout BuildLayout() const {
         std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
 
@@ -28,21 +30,11 @@ public:
             layoutBindings.push_back(layoutBinding);
         }
 
-        VkDescriptorSetLayoutCreateInfo layoutInfo{};
-        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
-        layoutInfo.pBindings = layoutBindings.data();
-
-        VkDescriptorSetLayout descriptorSetLayout;
-        if (vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create descriptor set layout!");
-        }
-
-        return descriptorSetLayout;
+        return m_layoutCache.GetOrCreate(layoutBindings);
     }
 
 private:
-    VkDevice m_device;
+    Thryve::Rendering::DescriptorLayoutCache& m_layoutCache;
     std::vector<VulkanDescriptor> m_descriptors;
 };
 
@@ -7,11 +7,15 @@
 #include "pch.h"
 
 #include "Core/Ref.h"
+#include "vk_mem_alloc.h"
 
 
 struct QueueFamilyIndices {
     std::optional<uint32_t> GraphicsFamily;
     std::optional<uint32_t> PresentFamily;
+    // Family that supports transfers but not graphics, usually backed by a copy engine. Not required,
+    // devices without one (lavapipe, many integrated GPUs) upload on the graphics queue instead
+    std::optional<uint32_t> TransferFamily;
 
     [[nodiscard]] bool IsComplete() const {
         return GraphicsFamily.has_value() && PresentFamily.has_value();
@@ -46,6 +50,25 @@ public:
     [[nodiscard]] VkPhysicalDevice GetPhysicalDevice() const;
     [[nodiscard]] VkQueue GetGraphicsQueue() const;
     [[nodiscard]] VkQueue GetPresentQueue() const;
+    // The dedicated transfer queue when the device has one, the graphics queue otherwise
+    [[nodiscard]] VkQueue GetTransferQueue() const;
+    [[nodiscard]] uint32_t GetTransferFamily() const;
+    [[nodiscard]] bool HasDedicatedTransferQueue() const { return m_transferQueue != VK_NULL_HANDLE; }
+    // BC1-BC7 images can be sampled, enabled on the device whenever the hardware has it
+    [[nodiscard]] bool SupportsTextureCompressionBC() const { return m_bTextureCompressionBC; }
+    // VK_EXT_descriptor_indexing with partially bound, update-after-bind sampled image arrays indexed non-uniformly,
+    // enabled whenever the hardware has it. Needs VK_KHR_get_physical_device_properties2 on the instance
+    [[nodiscard]] bool SupportsDescriptorIndexing() const { return m_bDescriptorIndexing; }
+    // Largest update-after-bind sampled image array a fragment shader may use, 0 without descriptor indexing
+    [[nodiscard]] uint32_t GetMaxBindlessTextures() const { return m_maxBindlessTextures; }
+    // multiDrawIndirect and drawIndirectFirstInstance, enough to draw a buffer of indirect commands
+    [[nodiscard]] bool SupportsIndirectDraws() const { return m_bIndirectDraws; }
+    // VK_KHR_draw_indirect_count, the draw count is read from a buffer as well
+    [[nodiscard]] bool SupportsDrawIndirectCount() const { return m_bDrawIndirectCount; }
+    // VK_KHR_synchronization2, the render graph records its barriers with vkCmdPipelineBarrier2KHR
+    [[nodiscard]] bool SupportsSynchronization2() const { return m_bSynchronization2; }
+    // Every buffer and image of this device is allocated through it, see VulkanBufferUtils and ImageUtils
+    [[nodiscard]] VmaAllocator GetAllocator() const { return m_allocator; }
 
     std::string GetGraphicsCardType(VkPhysicalDeviceProperties props);
 
@@ -62,13 +85,25 @@ private:
     VkSurfaceKHR m_surface;
     VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
     VkDevice m_logicalDevice = VK_NULL_HANDLE;
+    VmaAllocator m_allocator = VK_NULL_HANDLE;
 
     VkQueue m_graphicsQueue;
     VkQueue m_presentQueue;
+    VkQueue m_transferQueue = VK_NULL_HANDLE;
+    bool m_bTextureCompressionBC = false;
+    bool m_bDescriptorIndexing = false;
+    uint32_t m_maxBindlessTextures = 0;
+    bool m_bIndirectDraws = false;
+    bool m_bDrawIndirectCount = false;
+    bool m_bSynchronization2 = false;
     int m_validationLayers{};
     QueueFamilyIndices m_queueFamiliyIndices;
 
     bool IsDeviceSuitable(VkPhysicalDevice device, const std::vector<const char*>& deviceExtensions);
     bool CheckDeviceExtensionSupport(VkPhysicalDevice device, const std::vector<const char*>& deviceExtensions);
+    // Fills features with what the device supports, false when it lacks one the bindless texture table needs
+    bool QueryDescriptorIndexing(VkPhysicalDevice device, VkPhysicalDeviceDescriptorIndexingFeaturesEXT& features);
+    bool QuerySynchronization2(VkPhysicalDevice device);
     void CreateLogicalDevice(VkPhysicalDevice physicalDevice, const std::vector<const char*>& deviceExtensions, bool enableValidationLayers);
+    void CreateAllocator();
 };
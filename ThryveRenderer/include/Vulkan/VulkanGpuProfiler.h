@@ -0,0 +1,103 @@
+#pragma once
+
+#include "pch.h"
+#include "Core/Profiling.h"
+
+namespace Thryve::Rendering {
+    /**
+     * Brackets GPU work with vkCmdWriteTimestamp pairs, using one query pool per frame in flight.
+     * A frame slot's results are collected the next time that slot is recorded, after its fence has signalled,
+     * so reading them back never stalls. Ticks are converted with timestampPeriod and shifted onto the
+     * ProfilingService clock, so GPU and CPU scopes end up on the same timeline.
+     */
+    class VulkanGpuProfiler {
+    public:
+        static constexpr uint32_t MAX_SCOPES_PER_FRAME = 128;
+
+        VulkanGpuProfiler(VkCommandPool commandPool, uint32_t maxFramesInFlight);
+        ~VulkanGpuProfiler();
+
+        VulkanGpuProfiler(const VulkanGpuProfiler&) = delete;
+        VulkanGpuProfiler& operator=(const VulkanGpuProfiler&) = delete;
+
+        // Must be recorded outside a render pass, once the fence of frameIndex has been waited on
+        void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+        // Returns the slot to hand to EndScope, or INVALID_SCOPE when the frame ran out of queries
+        uint32_t BeginScope(VkCommandBuffer commandBuffer, Core::ProfileScopeID scopeID);
+        void EndScope(VkCommandBuffer commandBuffer, uint32_t scopeIndex);
+
+        [[nodiscard]] bool IsSupported() const { return m_bSupported; }
+
+        // The profiler PROFILE_GPU_SCOPE records into, nullptr when none exists
+        static VulkanGpuProfiler* Get() { return s_Current; }
+
+        static constexpr uint32_t INVALID_SCOPE = UINT32_MAX;
+
+    private:
+        struct GpuScope {
+            Core::ProfileScopeID ScopeID;
+            uint16_t Depth;
+        };
+
+        // Scope i writes its begin timestamp to query 2i and its end timestamp to query 2i + 1
+        struct FrameQueries {
+            VkQueryPool QueryPool = VK_NULL_HANDLE;
+            std::vector<GpuScope> Scopes;
+        };
+
+        void Calibrate(VkCommandPool commandPool);
+        void CollectResults(FrameQueries& frame);
+        [[nodiscard]] int64_t ToProfilerTime(uint64_t ticks) const;
+
+        inline static VulkanGpuProfiler* s_Current = nullptr;
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        std::vector<FrameQueries> m_frames;
+        // Value/availability pairs, reused for every readback
+        std::vector<uint64_t> m_results;
+        uint32_t m_currentFrame = 0;
+        uint16_t m_depth = 0;
+
+        double m_timestampPeriod = 1.0;
+        uint64_t m_timestampMask = UINT64_MAX;
+        uint64_t m_calibrationTicks = 0;
+        int64_t m_calibrationTime = 0;
+        bool m_bSupported = false;
+    };
+
+    class GpuScopeProfiler {
+    public:
+        GpuScopeProfiler(const VkCommandBuffer commandBuffer, const Core::ProfileScopeID scopeID) :
+            m_commandBuffer{commandBuffer}, m_profiler{VulkanGpuProfiler::Get()}
+        {
+            if (m_profiler)
+            {
+                m_scopeIndex = m_profiler->BeginScope(m_commandBuffer, scopeID);
+            }
+        }
+
+        ~GpuScopeProfiler()
+        {
+            if (m_profiler)
+            {
+                m_profiler->EndScope(m_commandBuffer, m_scopeIndex);
+            }
+        }
+
+        GpuScopeProfiler(const GpuScopeProfiler&) = delete;
+        GpuScopeProfiler& operator=(const GpuScopeProfiler&) = delete;
+
+    private:
+        VkCommandBuffer m_commandBuffer;
+        VulkanGpuProfiler* m_profiler;
+        uint32_t m_scopeIndex = VulkanGpuProfiler::INVALID_SCOPE;
+    };
+} // namespace Thryve::Rendering
+
+// The scope ends when the enclosing block closes, so it has to close before the command buffer is ended
+#ifdef ENABLE_PROFILING
+#define PROFILE_GPU_SCOPE(commandBuffer, operationName) static const Thryve::Core::ProfileScopeID s_profileGpuScopeID = Thryve::Core::ProfilingService::RegisterScope(__func__, operationName); Thryve::Rendering::GpuScopeProfiler gpuScopeProfilerInstance{commandBuffer, s_profileGpuScopeID};
+#else
+#define PROFILE_GPU_SCOPE(commandBuffer, operationName)
+#endif
@@ -32,39 +32,6 @@ namespace Thryve::UI {
         VkDescriptorPool m_descriptorPool;
     };
 
-    class VulkanCommandBuffer {
-    public:
-        VulkanCommandBuffer(const VkDevice device, const VkCommandPool commandPool) :
-            device_(device), commandPool_(commandPool), commandBuffer_(VK_NULL_HANDLE)
-        {
-            VkCommandBufferAllocateInfo _allocInfo{};
-            _allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-            _allocInfo.commandPool = commandPool_;
-            _allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-            _allocInfo.commandBufferCount = 1;
-
-            if (vkAllocateCommandBuffers(device_, &_allocInfo, &commandBuffer_) != VK_SUCCESS)
-            {
-                throw std::runtime_error("Failed to allocate command buffer!");
-            }
-        }
-
-        ~VulkanCommandBuffer()
-        {
-            if (commandBuffer_ != VK_NULL_HANDLE)
-            {
-                vkFreeCommandBuffers(device_, commandPool_, 1, &commandBuffer_);
-            }
-        }
-
-        [[nodiscard]] VkCommandBuffer Get() const { return commandBuffer_; }
-
-    private:
-        VkDevice device_;
-        VkCommandPool commandPool_;
-        VkCommandBuffer commandBuffer_;
-    };
-
     class VulkanImGuiLayer final : public ImGuiLayer {
 
     public:
@@ -75,9 +42,16 @@ namespace Thryve::UI {
         void OnImGuiRender() override;
 
         void Begin() override;
+        // Finishes the frame's draw data, recorded later by RecordDrawData
         void End() override;
 
+        // Inside a render pass compatible with the swapchain's overlay render pass, e.g. the frame graph's UI pass
+        void RecordDrawData(VkCommandBuffer commandBuffer) const;
+
     private:
+        // Per-heap usage and budget of the device's VmaAllocator
+        void DrawGpuMemoryPanel();
+
         std::unique_ptr<VulkanDescriptorPool> m_imguiPool;
     };
 } // namespace Thryve::UI
@@ -3,6 +3,10 @@
 //
 #pragma once
 
+#include <span>
+
+#include "UploadManager.h"
+#include "vk_mem_alloc.h"
 
 namespace Thryve::Rendering {
     class VulkanIndexBuffer {
@@ -11,13 +15,16 @@ namespace Thryve::Rendering {
 
         ~VulkanIndexBuffer();
 
-        void Create(const std::vector<uint32_t> &indices);
+        // Records the upload into uploadManager, the buffer is usable once it has been flushed
+        void Create(std::span<const uint32_t> indices, UploadManager& uploadManager);
 
         void Bind(VkCommandBuffer commandBuffer) const;
         void Draw(VkCommandBuffer commandBuffer) const;
+        // Per-instance attributes are read from firstInstance on
+        void DrawInstanced(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance) const;
 
         [[nodiscard]] VkBuffer GetIndexBuffer() const { return m_indexBuffer; }
-        [[nodiscard]] VkDeviceMemory GetIndexBufferMemory() const { return m_indexBufferMemory; }
+        [[nodiscard]] VmaAllocation GetIndexAllocation() const { return m_indexAllocation; }
         [[nodiscard]] uint32_t GetIndexCount() const { return m_indexCount; }
 
         // Optionally, add methods to update or modify the index buffer
@@ -26,7 +33,7 @@ namespace Thryve::Rendering {
         VkPhysicalDevice m_physicalDevice;
         VkCommandPool m_commandPool;
         VkBuffer m_indexBuffer;
-        VkDeviceMemory m_indexBufferMemory;
+        VmaAllocation m_indexAllocation;
         uint32_t m_indexCount = 0;
     };
 }
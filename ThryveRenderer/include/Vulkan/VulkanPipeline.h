@@ -46,7 +46,9 @@ struct PipelineConfigInfo {
     // If dynamic states are used, their flags would be stored here.
     std::vector<VkDynamicState> dynamicStates;
 
-    VkDescriptorSetLayout descriptorSetLayout;
+    // One layout per set number, in order
+    std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+    std::vector<VkPushConstantRange> pushConstantRanges;
 
     // TODO Simplifying for example purposes; in practice, you may need more detailed configurations.
 
@@ -122,6 +124,9 @@ public:
     void CreatePipeline(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const PipelineConfigInfo& configInfo);
     void Bind(VkCommandBuffer commandBuffer);
 
+    // SPIR-V of a compiled shader, see shaders/convertshader.sh
+    static std::vector<char> ReadShaderFile(const std::string& filename);
+
     // Additional functionalities like setting dynamic states, if needed
 
 private:
@@ -138,7 +143,6 @@ private:
     VkPipelineMultisampleStateCreateInfo ConfigureMultisampling(const PipelineConfigInfo& configInfo);
     VkPipelineColorBlendStateCreateInfo ConfigureColorBlending(const PipelineConfigInfo& configInfo, const VkPipelineColorBlendAttachmentState& colorBlendAttachment);
 
-    static std::vector<char> ReadShaderFile(const std::string& filename);
     [[nodiscard]] VkShaderModule createShaderModule(const std::vector<char> &code) const;
 
     void cleanup() const;
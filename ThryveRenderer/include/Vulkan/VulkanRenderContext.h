@@ -3,14 +3,30 @@
 //
 #pragma once
 
+#include <chrono>
+
 #include "GLFW/glfw3.h"
-#include "ThreadPool.h"
+#include "AssetManager.h"
+#include "BindlessTextureTable.h"
+#include "Core/JobSystem.h"
+#include "Renderer/BoundingVolumeHierarchy.h"
+#include "Renderer/FrustumCuller.h"
+#include "InstanceBatcher.h"
+#include "DescriptorAllocator.h"
+#include "DescriptorLayoutCache.h"
+#include "DescriptorSetCache.h"
+#include "GpuDrivenScene.h"
+#include "ParallelCommandRecorder.h"
+#include "RenderGraph.h"
+#include "UniformBufferRing.h"
+#include "UploadManager.h"
 #include "Vertex2D.h"
 #include "VulkanCommandBuffer.h"
 #include "VulkanCommandPoolManager.h"
 #include "VulkanDescriptorManager.h"
 #include "VulkanDeviceSelector.h"
 #include "VulkanFrameSynchronizer.h"
+#include "VulkanGpuProfiler.h"
 #include "VulkanIndexBuffer.h"
 #include "VulkanPipeline.h"
 #include "VulkanRenderPassBuilder.h"
@@ -55,6 +71,14 @@ const std::vector<uint32_t> INDICES_3D = {
 
 namespace Thryve::Rendering
 {
+    // Push constants of triangle_bindless.frag, indices into the bindless texture table
+    struct MaterialPushConstants {
+        uint32_t Albedo;
+        uint32_t Normal;
+        uint32_t Metallic;
+        uint32_t Emission;
+    };
+
     class VulkanRenderContext final : public Core::ReferenceCounted {
     public:
         VulkanRenderContext();
@@ -62,87 +86,164 @@ namespace Thryve::Rendering
 
         void Run();
 
+        // What the last left click hit, numbered like m_sceneBvh's objects. Empty when it hit nothing
+        [[nodiscard]] const std::optional<BvhHit>& GetPickedObject() const { return m_pickedObject; }
+
     private:
         // Vulkan core components
         VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
         VkDevice m_device;
 
 
-        std::vector<Vertex3D> ModelVertices;
-        std::vector<uint32_t> ModelIndices;
-        VkBuffer vertexBufer;
-        VkDeviceMemory vertexBufferMemory;
-
-        void LoadModel(const std::string& path);
-
         // Swap chain and rendering setup
         VulkanSwapChain* m_swapChain;
         VkRenderPass m_renderPass;
         std::unique_ptr<VulkanPipeline> m_pipeline;
-        VkFramebuffer m_framebuffer;
 
         // Command processing
         VkCommandPool m_commandPool;
         VkCommandBuffer m_commandBuffer;
 
-        // Buffers, vertices, and indices
-        std::unique_ptr<VulkanVertexBuffer<Vertex3D>> m_vulkanVertexBuffer;
-        std::unique_ptr<VulkanIndexBuffer> m_indexBuffer;
+        // Staging ring every upload is recorded into
+        std::unique_ptr<UploadManager> m_uploadManager;
+        // Streams the textures and the model in while the first frames render with fallbacks
+        std::unique_ptr<AssetManager> m_assetManager;
+        MeshHandle m_modelMesh;
 
         // Descriptor sets and buffers
         VkDescriptorSetLayout m_descriptorSetLayout;
-        VkDescriptorPool m_descriptorPool;
-        std::vector<VkDescriptorSet> m_descriptorSets;
-        std::vector<VkBuffer> m_uniformBuffers;
-        std::vector<VkDeviceMemory> m_uniformBuffersMemory;
-        std::vector<void*> m_uniformBuffersMapped;
+        std::unique_ptr<DescriptorLayoutCache> m_descriptorLayoutCache;
+        // Per-draw sets come from the set cache of their frame, backed by that frame's allocator
+        std::array<std::unique_ptr<DescriptorAllocator>, MAX_FRAMES_IN_FLIGHT> m_frameDescriptorAllocators;
+        std::array<std::unique_ptr<DescriptorSetCache>, MAX_FRAMES_IN_FLIGHT> m_frameDescriptorSetCaches;
+        VkDescriptorSet m_drawDescriptorSet = VK_NULL_HANDLE;
+        // Samples every texture from one table bound once, set to false to compare against a set per material
+        static constexpr bool BINDLESS_TEXTURES = true;
+        // BINDLESS_TEXTURES and the device supports descriptor indexing
+        bool m_bBindless = false;
+        std::unique_ptr<BindlessTextureTable> m_bindlessTable;
+        MaterialPushConstants m_material{};
+
+        // Draws every mesh once with all of its instances, set to false to compare against a draw per object
+        static constexpr bool INSTANCED_DRAWS = true;
+        // Robots drawn next to the scene's one for the stress benchmark, 0 turns it off. Try 10000 or 100000
+        static constexpr uint32_t STRESS_INSTANCE_COUNT = 0;
+        // Frames the stress benchmark averages over before each report
+        static constexpr uint32_t BENCHMARK_FRAMES = 256;
+        bool m_bInstanced = INSTANCED_DRAWS;
+        std::unique_ptr<InstanceBatcher> m_instanceBatcher;
+        // Culls every object in a compute pass and draws the survivors indirectly, set to false to compare
+        // against CPU recorded instanced draws
+        static constexpr bool GPU_DRIVEN_DRAWS = true;
+        // GPU_DRIVEN_DRAWS, m_bInstanced and the device supports multi draw indirect
+        bool m_bGpuDriven = false;
+        std::unique_ptr<GpuDrivenScene> m_gpuScene;
+        // Projection with Vulkan's inverted Y, the frustum is culled against this frame's
+        glm::mat4 m_viewProjection{1.0f};
+        glm::mat4 m_modelMatrix{1.0f};
+        std::vector<InstanceData> m_stressInstances;
+        // World space bounds of the stress instances, built once the model is resident. Without GPU-driven draws
+        // only the visible ones are drawn
+        std::unique_ptr<FrustumCuller> m_frustumCuller;
+        SphereBoundsSoA m_stressBounds;
+        std::vector<uint32_t> m_visibleStressInstances;
+        std::vector<InstanceData> m_visibleInstanceData;
+        // Times the CPU culling paths and the scene BVH at 10k, 100k and 1M objects on startup and checks them
+        // against the scalar test
+        static constexpr bool CULLING_BENCHMARK = false;
+        // Culls the stress instances through m_sceneBvh, set to false to compare against the flat FrustumCuller
+        static constexpr bool HIERARCHICAL_CULLING = true;
+        // The scene's robot is object 0 and stress instance i is object i + 1, built once the model is resident
+        std::unique_ptr<BoundingVolumeHierarchy> m_sceneBvh;
+        std::vector<uint32_t> m_visibleSceneObjects;
+        bool m_bPickButtonDown = false;
+        std::optional<BvhHit> m_pickedObject;
+        // Records the main pass into secondary command buffers on the JobSystem, set to false to compare against
+        // recording inline on the render thread. Pays off without instancing, where every robot is its own draw
+        static constexpr bool PARALLEL_RECORDING = true;
+        bool m_bParallelRecording = PARALLEL_RECORDING;
+        std::unique_ptr<ParallelCommandRecorder> m_commandRecorder;
+        // The frame's passes with their barriers and transient attachments, rebuilt when the swapchain is
+        std::unique_ptr<RenderGraph> m_frameGraph;
+        RenderGraphResource m_backbuffer;
+        uint32_t m_frameGraphGeneration = UINT32_MAX;
+        // Without instancing every stress instance binds the uniform ring at its own offset
+        std::vector<uint32_t> m_stressUniformOffsets;
+        std::chrono::steady_clock::time_point m_lastFrameStart;
+        double m_benchmarkRecordMilliseconds = 0.0;
+        double m_benchmarkFrameMilliseconds = 0.0;
+        uint32_t m_benchmarkFrameCount = 0;
+        // Per-object uniforms of every frame in flight, bound with dynamic offsets through one set
+        std::unique_ptr<UniformBufferRing> m_uniformRing;
+        uint32_t m_modelUniformOffset = 0;
         Core::UniqueRef<VulkanDescriptorManager> m_descriptorManager;
 
         // Synchronization
         std::unique_ptr<VulkanFrameSynchronizer> m_FrameSynchronizer;
         uint32_t currentFrame = 0;
 
+        // GPU timestamps for PROFILE_GPU_SCOPE, one query pool per frame in flight
+        std::unique_ptr<VulkanGpuProfiler> m_gpuProfiler;
+
         //Texture Creation
-        std::unique_ptr<VulkanTextureImage> m_AlbedoTextureImage;
-        std::unique_ptr<VulkanTextureImage> m_MetallicTextureImage;
-        std::unique_ptr<VulkanTextureImage> m_NormalTextureImage;
-        std::unique_ptr<VulkanTextureImage> m_EmmissionTextureImage;
-        VkImage m_albedoImage;
-        VkImage m_metallicImage;
-        VkImage m_normalImage;
-        VkImage m_EmmissionImage;
-
-        VkImageView m_AlbedoImageView;
-        VkSampler m_AlbedoSampler;
-        VkImageView m_MetallicImageView;
-        VkSampler m_MetallicSampler;
-        VkImageView m_NormalImageView;
-        VkSampler m_NormalSampler;
-        VkImageView m_EmmissionImageView;
-        VkSampler m_EmmissionSampler;
+        // Set to None to compare the "Main Pass" GPU scope against textures without mips
+        static constexpr VulkanTextureImage::MipSource TEXTURE_MIP_SOURCE = VulkanTextureImage::MipSource::GpuBlit;
+        // Cooks textures into BC7/BC5/BC4 KTX2 files and samples those, set to false to compare against RGBA8
+        static constexpr bool TEXTURE_COMPRESSION = true;
+        TextureHandle m_AlbedoTexture;
+        TextureHandle m_MetallicTexture;
+        TextureHandle m_NormalTexture;
+        TextureHandle m_EmmissionTexture;
+
+        // Time to first frame is measured from the start of InitVulkan
+        std::chrono::steady_clock::time_point m_initStart;
+        bool m_bFirstFrameSubmitted = false;
 
 
         void InitVulkan();
         void PickSuitableDevices();
         void CreateGraphicsPipeline();
-        void CreateFramebuffers();
         void AssignCommandPool();
-        void CreateVertexBuffer();
-        void CreateIndexBuffer();
         void CreateUniformBuffer();
         void CreateDescriptorSetLayout();
-        void CreateTextureImage(const std::string &albedoPath, const std::string &metallicPath, const std::string &normalPath, const std::string &emmissionPath);
-        void CreateTextureImageView();
-        void CreateTextureSampler();
-        [[nodiscard]] VkDescriptorPool CreateDescriptorPool() const;
-        void CreateDescriptorSets();
+        // Requests every asset of the scene, returns before any of them is loaded
+        void RequestAssets();
+        void CreateDescriptorAllocators();
+        // A grid of STRESS_INSTANCE_COUNT robots behind the scene's one
+        void CreateStressInstances();
+        // Builds m_sceneBvh once the model is resident, then refits the scene's robot as it turns
+        void UpdateSceneBvh();
+        // Fills m_visibleStressInstances from the camera's frustum, before the uniforms and instances are pushed
+        void CullStressInstances();
+        // Casts a ray through the cursor into m_sceneBvh on a left click and reports the nearest object hit
+        void PickObject();
+        // Hands this frame's instances to the batcher, or updates the GPU-driven scene's objects, after the
+        // bindless material is known
+        void SubmitInstances();
+        void ReportBenchmark(double recordMilliseconds);
+        // The set holding the uniform ring and whatever textures are resident right now, only written
+        // when that combination was not used before
+        [[nodiscard]] VkDescriptorSet GetDrawDescriptorSet(uint32_t frameIndex);
+        // The table slots of the material's textures, fallbacks included, looked up after the table's BeginFrame
+        [[nodiscard]] MaterialPushConstants GetBindlessMaterial();
         void AssignCommandBuffer();
 
+        // Declares the cull, main and UI passes against the current swapchain and compiles them
+        void BuildFrameGraph();
         void RecordCommandBufferSegment(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+        // Inside the graph's main pass, inline or through secondaries on the JobSystem
+        void RecordMainPass(VkCommandBuffer commandBuffer, const RenderGraphPassContext& context);
+        // Parallel recording is on and the main pass has enough items for at least two secondaries
+        [[nodiscard]] bool RecordsMainPassInParallel() const;
+        // Draws of the main pass that can be recorded in independent ranges, 0 before anything is resident
+        [[nodiscard]] uint32_t GetMainPassItemCount() const;
+        // Binds the pass's state and records items [begin, end) into commandBuffer, called from any worker
+        void RecordMainPassItems(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end) const;
         // Main loop and frame drawing
         void MainLoop();
         void DrawFrame();
-        void UpdateUniformBuffer(uint32_t currentImage) const;
+        // Pushes this frame's object uniforms into the ring, after its BeginFrame
+        void UpdateUniformBuffer();
         // Synchronization methods
         void CreateSyncObjects();
         // Cleanup
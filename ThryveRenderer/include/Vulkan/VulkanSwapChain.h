@@ -32,7 +32,6 @@ public:
     void InitializeSwapChain();
     void CleanupSwapChain(); // For explicit cleanup, can be called before the destructor
 
-    void CreateFramebuffers(VkDevice device);
     void RecreateSwapChain();
 
     [[nodiscard]] VkSwapchainKHR GetSwapchain() const { return m_swapChain; }
@@ -40,8 +39,6 @@ public:
     [[nodiscard]] VkExtent2D GetSwapchainExtent() const { return m_swapChainExtent; }
     [[nodiscard]] VkFormat GetSwapchainImageFormat() const { return m_swapChainImageFormat; };
     [[nodiscard]] std::vector<VkImage> GetSwapchainImages() const { return m_swapChainImages; }
-    [[nodiscard]] std::vector<VkFramebuffer> GetFrameBuffers() const { return m_Framebuffers; }
-    VkFramebuffer GetCurrentFramebuffer() const {return m_Framebuffers[Thryve::Core::App::Get().GetCurrentImageIndex()];}
 
     std::pair<VkResult, std::optional<uint32_t>> AcquireNextImage(VkSemaphore imageAvailableSemaphore);
 
@@ -52,12 +49,14 @@ public:
     VkResult PresentImage(uint32_t imageIndex, VkSemaphore renderFinishedSemaphore) const;
 
     void CreateSwapChain();
-    // Depth Functions
-    void CreateDepthResources();
     void CreateImageViews(); // Helper method to create image views for the swap chain images
     uint32_t GetImageCount() const { return m_imageCount;}
+    // Bumped by every CreateSwapChain, anything built against the old images and extent compares it to rebuild
+    uint32_t GetGeneration() const { return m_generation; }
 
     VkRenderPass GetRenderPass() const { return m_renderPass; }
+    // Color only, loads what the passes before it drew, e.g. for the UI
+    VkRenderPass GetOverlayRenderPass() const { return m_overlayRenderPass; }
     VkCommandPool GetCommandPool() const { return m_commandPool; }
     VkCommandBuffer GetCommandBuffer() const { return m_commandBuffer; }
 
@@ -70,6 +69,7 @@ private:
     VkCommandPool m_commandPool;
     VkCommandBuffer m_commandBuffer;
     VkRenderPass m_renderPass;
+    VkRenderPass m_overlayRenderPass = VK_NULL_HANDLE;
 
     VkSwapchainKHR m_swapChain;
     std::vector<VkImage> m_swapChainImages;
@@ -78,18 +78,14 @@ private:
     VkExtent2D m_swapChainExtent;
 
     std::vector<VkImageView> m_swapChainImageViews;
-    std::vector<VkFramebuffer> m_Framebuffers;
     std::unique_ptr<VulkanRenderPassBuilder> m_renderPassBuilder;
 
     uint32_t m_imageCount;
+    uint32_t m_generation = 0;
     // Additional helper methods for swap chain creation and management
 
     // Utility methods for choosing swap chain surface format, present mode, and extent
     VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
     VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
     VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
-
-    VkImage m_DepthImage;
-    VkDeviceMemory m_DepthImageMemory;
-    VkImageView m_DepthImageView;
 };
@@ -2,20 +2,61 @@
 // Created by thomppa on 3/17/24.
 //
 #pragma once
+#include <memory>
+
 #include "pch.h"
+#include "Renderer/TextureCooker.h"
+#include "UploadManager.h"
+#include "vk_mem_alloc.h"
 
 class VulkanTextureImage {
 public:
+    enum class MipSource {
+        // Mip 0 only, what every texture used before
+        None,
+        // Blitted down from mip 0 on the GPU, falls back to Baked when the format cannot be linearly blitted
+        GpuBlit,
+        // Filtered offline on the CPU and read from the mip cache
+        Baked,
+    };
+
+    struct LoadStats {
+        // decodeTextureImage: decode or cook, mip generation and mapping cache files
+        double DecodeMilliseconds = 0.0;
+        // uploadTextureImage: creating the image and recording its upload, not the transfer itself
+        double UploadMilliseconds = 0.0;
+        // Size of the image's device memory allocation
+        VkDeviceSize GpuBytes = 0;
+        bool bCompressed = false;
+    };
+
     VulkanTextureImage(VkCommandPool commandPool, VkCommandBuffer commandBuffer);
     ~VulkanTextureImage();
 
     //Accessors
-    void createTextureImage(const std::string &fileName);
+    // Decodes and uploads on the calling thread, the image is ready to sample once uploadManager has been flushed
+    void createTextureImage(const std::string &fileName, Thryve::Rendering::UploadManager &uploadManager,
+                            MipSource mipSource = MipSource::GpuBlit);
+    // Uploads the block-compressed KTX2 the texture cooker made of fileName, cooking it first when it is missing or
+    // stale. Returns false without touching the image when the device cannot sample BC formats.
+    bool createCompressedTextureImage(const std::string &fileName, Thryve::Rendering::TextureKind kind,
+                                      Thryve::Rendering::UploadManager &uploadManager);
+
+    // First half of a split load: all CPU work, decoding, cooking or baking mips and mapping cache files. Creates
+    // no Vulkan objects, so textures can decode on worker threads, each texture on one thread at a time. With
+    // bCompressed the cooked KTX2 is used whenever the device samples BC formats, mipSource applies otherwise.
+    void decodeTextureImage(const std::string &fileName, Thryve::Rendering::TextureKind kind, bool bCompressed,
+                            MipSource mipSource = MipSource::GpuBlit);
+    // Second half, on the render thread: creates the image, records its upload and frees the decoded texels
+    void uploadTextureImage(Thryve::Rendering::UploadManager &uploadManager);
+
     void createTextureImageView();
     void createTextureSampler();
     [[nodiscard]] VkImage GetTextureImage() const {return m_textureImage;}
     [[nodiscard]] VkImageView GetTextureImageView() const {return m_textureImageView;}
     [[nodiscard]] VkSampler GetTextureSampler() const {return m_TextureSampler;}
+    [[nodiscard]] uint32_t GetMipLevels() const {return m_mipLevels;}
+    [[nodiscard]] const LoadStats& GetLoadStats() const {return m_loadStats;}
 
 private:
     VkDevice m_device;
@@ -27,9 +68,17 @@ private:
     VkImage m_textureImage{};
     VkImageView m_textureImageView{};
     VkSampler m_TextureSampler{};
-    VkDeviceMemory m_textureImageMemory{};
+    VmaAllocation m_textureImageAllocation{};
+    uint32_t m_mipLevels = 1;
+    VkFormat m_format = VK_FORMAT_UNDEFINED;
+    VkComponentMapping m_components{};
+    LoadStats m_loadStats;
+    // Between decodeTextureImage and uploadTextureImage
+    struct DecodedTexture;
+    std::unique_ptr<DecodedTexture> m_decoded;
     VkImageView imageView{};
     VkSampler sampler{};
 
     void cleanup();
+    [[nodiscard]] bool SupportsLinearBlit(VkFormat format) const;
 };
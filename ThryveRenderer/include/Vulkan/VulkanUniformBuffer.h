@@ -5,6 +5,7 @@
 
 #include "UniformBufferObject.h"
 #include "glm/glm.hpp"
+#include "vk_mem_alloc.h"
 
 
 class VulkanUniformBuffer {
@@ -20,12 +21,10 @@ private:
     VkDevice m_Device;
     VkPhysicalDevice m_PhysicalDevice;
     std::vector<VkBuffer> m_UniformBuffers;
-    std::vector<VkDeviceMemory> m_UniformBuffersMemory;
+    std::vector<VmaAllocation> m_UniformBufferAllocations;
     size_t m_BufferSize;
     uint32_t m_BufferCount;
     std::vector<void*> m_MappedMemory;
 
     void CreateUniformBuffers();
-    void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-    void MapMemory();
 };
\ No newline at end of file
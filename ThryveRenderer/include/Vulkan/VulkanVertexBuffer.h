@@ -5,7 +5,10 @@
 
 #include "pch.h"
 
+#include <span>
+
 #include "Core/Ref.h"
+#include "UploadManager.h"
 #include "Vertex2D.h"
 #include "utils/VkDebugUtils.h"
 #include "utils/VulkanBufferUtils.h"
@@ -32,11 +35,11 @@ namespace Thryve::Rendering {
             m_graphicsQueue(other.m_graphicsQueue)
         {
             m_buffer = other.m_buffer;
-            m_bufferMemory = other.m_bufferMemory;
+            m_allocation = other.m_allocation;
             m_vertexCount = other.m_vertexCount;
 
             other.m_buffer = VK_NULL_HANDLE;
-            other.m_bufferMemory = VK_NULL_HANDLE;
+            other.m_allocation = VK_NULL_HANDLE;
             other.m_vertexCount = 0;
         }
 
@@ -57,12 +60,12 @@ namespace Thryve::Rendering {
                 m_commandPool = other.m_commandPool;
                 m_graphicsQueue = other.m_graphicsQueue;
                 m_buffer = other.m_buffer;
-                m_bufferMemory = other.m_bufferMemory;
+                m_allocation = other.m_allocation;
                 m_vertexCount = other.m_vertexCount;
 
                 // Reset other
                 other.m_buffer = VK_NULL_HANDLE;
-                other.m_bufferMemory = VK_NULL_HANDLE;
+                other.m_allocation = VK_NULL_HANDLE;
                 other.m_vertexCount = 0;
             }
             return *this;
@@ -75,31 +78,13 @@ namespace Thryve::Rendering {
         /**
          * Create a vertex buffer from the given vertices.
          *
-         * @param vertices The vector of vertices to create the buffer from.
+         * @param vertices The vertices to create the buffer from, e.g. a vector or a mapped mesh cache.
+         * @param uploadManager Records the copy, the buffer is usable once the upload manager has been flushed.
          */
-        void Create(const std::vector<VertexType> &vertices)
+        void Create(const std::span<const VertexType> vertices, UploadManager &uploadManager)
         {
             m_vertexCount = vertices.size();
-            const VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-            VkBuffer stagingBuffer;
-            VkDeviceMemory stagingBufferMemory;
-
-            BufferCreationInfo stagingBufferInfo = {};
-            stagingBufferInfo.Device = m_device;
-            stagingBufferInfo.PhysicalDevice = m_physicalDevice;
-            stagingBufferInfo.Size = bufferSize;
-            stagingBufferInfo.Usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-            stagingBufferInfo.Properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-
-            // Create staging buffer
-            VulkanBufferUtils::CreateBuffer(stagingBufferInfo, stagingBuffer, stagingBufferMemory);
-
-            // Map memory and copy vertex data
-            void *data = nullptr; // Initialize to nullptr for safety
-            VK_CALL(vkMapMemory(m_device, stagingBufferMemory, 0, bufferSize, 0, &data));
-            memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
-            vkUnmapMemory(m_device, stagingBufferMemory);
+            const VkDeviceSize bufferSize = sizeof(VertexType) * vertices.size();
 
             BufferCreationInfo vertexBufferInfo = {};
             vertexBufferInfo.Device = m_device;
@@ -109,41 +94,20 @@ namespace Thryve::Rendering {
             vertexBufferInfo.Properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
             // Create vertex buffer
-            VulkanBufferUtils::CreateBuffer(vertexBufferInfo, m_buffer, m_bufferMemory);
-
-            BufferCopyInfo copyInfo = {};
-            copyInfo.Device = m_device;
-            copyInfo.PhysicalDevice = m_physicalDevice;
-            copyInfo.TransferQueue = m_graphicsQueue;
-            copyInfo.CommandPool = m_commandPool;
-            copyInfo.SrcBuffer = stagingBuffer;
-            copyInfo.DstBuffer = m_buffer;
-            copyInfo.Size = bufferSize;
-
-            // Copy vertex data from the staging buffer to the vertex buffer
-            VulkanBufferUtils::CopyBuffer(copyInfo);
-
-            // Clean up staging buffer
-            vkDestroyBuffer(m_device, stagingBuffer, nullptr);
-            vkFreeMemory(m_device, stagingBufferMemory, nullptr);
+            VulkanBufferUtils::CreateBuffer(vertexBufferInfo, m_buffer, m_allocation);
+
+            // Copy vertex data through the upload ring
+            uploadManager.UploadBuffer(m_buffer, 0, vertices.data(), bufferSize);
         }
 
 
         void Cleanup()
         {
-            if (m_buffer != VK_NULL_HANDLE)
-            {
-                vkDestroyBuffer(m_device, m_buffer, nullptr);
-                m_buffer = VK_NULL_HANDLE;
-            }
-            if (m_bufferMemory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, m_bufferMemory, nullptr);
-            }
+            VulkanBufferUtils::DestroyBuffer(m_buffer, m_allocation);
         }
 
         [[nodiscard]] VkBuffer GetBuffer() const { return m_buffer; }
-        [[nodiscard]] VkDeviceMemory GetBufferMemory() const { return m_bufferMemory; }
+        [[nodiscard]] VmaAllocation GetAllocation() const { return m_allocation; }
         [[nodiscard]] size_t GetVertexCount() const { return m_vertexCount; }
         [[nodiscard]] VkDeviceSize GetSize() const { return sizeof(VertexType) * m_vertexCount; }
 
@@ -154,7 +118,7 @@ namespace Thryve::Rendering {
         VkQueue m_graphicsQueue;
 
         VkBuffer m_buffer = VK_NULL_HANDLE;
-        VkDeviceMemory m_bufferMemory = VK_NULL_HANDLE;
+        VmaAllocation m_allocation = VK_NULL_HANDLE;
         size_t m_vertexCount = 0;
     };
 
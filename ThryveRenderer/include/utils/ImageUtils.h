@@ -5,6 +5,7 @@
 
 #include "pch.h"
 #include "SingleTimeCommandUtil.h"
+#include "vk_mem_alloc.h"
 
 namespace ImageUtils {
 
@@ -13,13 +14,12 @@ namespace ImageUtils {
         return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
     }
 
+    // Allocates through the device's VmaAllocator, release with DestroyImage
     static void CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling,
                             VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage &image,
-                            VkDeviceMemory &imageMemory)
+                            VmaAllocation &allocation, uint32_t mipLevels = 1)
     {
         auto _deviceSelector = Thryve::Core::App::Get().GetWindow()->GetRenderContext().As<Thryve::Rendering::VulkanContext>()->GetDevice();
-        VkDevice _device = _deviceSelector->GetLogicalDevice();
-        VkPhysicalDevice _physicalDevice = _deviceSelector->GetPhysicalDevice();
 
         VkImageCreateInfo imageCreateInfo{};
         imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -27,7 +27,7 @@ namespace ImageUtils {
         imageCreateInfo.extent.width = width;
         imageCreateInfo.extent.height = height;
         imageCreateInfo.extent.depth = 1;
-        imageCreateInfo.mipLevels = 1;
+        imageCreateInfo.mipLevels = mipLevels;
         imageCreateInfo.arrayLayers = 1;
         imageCreateInfo.tiling = tiling;
         imageCreateInfo.format = format;
@@ -37,32 +37,38 @@ namespace ImageUtils {
         imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
         imageCreateInfo.flags = 0;
 
-        VK_CALL(vkCreateImage(_device, &imageCreateInfo, nullptr, &image));
-
-        VkMemoryRequirements memRequirements;
-        vkGetImageMemoryRequirements(_device, image, &memRequirements);
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.usage = VMA_MEMORY_USAGE_UNKNOWN;
+        allocInfo.requiredFlags = properties;
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex =
-            VulkanBufferUtils::FindMemoryType(_physicalDevice, memRequirements.memoryTypeBits, properties);
-
-        VK_CALL(vkAllocateMemory(_device, &allocInfo, nullptr, &imageMemory));
+        VK_CALL(vmaCreateImage(_deviceSelector->GetAllocator(), &imageCreateInfo, &allocInfo, &image, &allocation,
+                               nullptr));
+    }
 
-        vkBindImageMemory(_device, image, imageMemory, 0);
+    static void DestroyImage(VkImage &image, VmaAllocation &allocation)
+    {
+        if (image != VK_NULL_HANDLE || allocation != VK_NULL_HANDLE)
+        {
+            auto _deviceSelector = Thryve::Core::App::Get().GetWindow()->GetRenderContext().As<Thryve::Rendering::VulkanContext>()->GetDevice();
+            vmaDestroyImage(_deviceSelector->GetAllocator(), image, allocation);
+        }
+        image = VK_NULL_HANDLE;
+        allocation = VK_NULL_HANDLE;
     }
 
-    static VkImageView CreateImageView(VkImage image, VkFormat imageFormat, VkImageAspectFlags aspectFlags)
+    // The default component mapping is the identity swizzle
+    static VkImageView CreateImageView(VkImage image, VkFormat imageFormat, VkImageAspectFlags aspectFlags,
+                                       uint32_t mipLevels = 1, VkComponentMapping components = {})
     {
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         viewInfo.image = image;
         viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
         viewInfo.format = imageFormat;
+        viewInfo.components = components;
         viewInfo.subresourceRange.aspectMask = aspectFlags;
         viewInfo.subresourceRange.baseMipLevel = 0;
-        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.levelCount = mipLevels;
         viewInfo.subresourceRange.baseArrayLayer = 0;
         viewInfo.subresourceRange.layerCount = 1;
 
@@ -6,6 +6,7 @@
 #include "SingleTimeCommandUtil.h"
 #include "VkDebugUtils.h"
 #include "../pch.h"
+#include "vk_mem_alloc.h"
 
 struct BufferCreationInfo {
     VkDevice Device;
@@ -41,27 +42,14 @@ public:
         throw std::runtime_error("failed to find suitable memory type!");
     }
 
-    static void CreateBuffer(const BufferCreationInfo& creationInfo, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
-        VkBufferCreateInfo bufferInfo{};
-        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bufferInfo.size = creationInfo.Size;
-        bufferInfo.usage = creationInfo.Usage;
-        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    /**
+     * Creates buffer through the device's VmaAllocator, so it is suballocated from a shared memory block.
+     * Pass mappedData for host-visible buffers that should stay mapped for their whole lifetime.
+     */
+    static void CreateBuffer(const BufferCreationInfo& creationInfo, VkBuffer& buffer, VmaAllocation& allocation,
+                             void** mappedData = nullptr);
 
-        VK_CALL(vkCreateBuffer(creationInfo.Device, &bufferInfo, nullptr, &buffer));
-
-        VkMemoryRequirements memRequirements;
-        vkGetBufferMemoryRequirements(creationInfo.Device, buffer, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = VulkanBufferUtils::FindMemoryType(creationInfo.PhysicalDevice,memRequirements.memoryTypeBits, creationInfo.Properties);
-
-        VK_CALL(vkAllocateMemory(creationInfo.Device, &allocInfo, nullptr, &bufferMemory));
-
-        VK_CALL(vkBindBufferMemory(creationInfo.Device, buffer, bufferMemory, 0));
-    }
+    static void DestroyBuffer(VkBuffer& buffer, VmaAllocation& allocation);
 
     static void CopyBuffer(const BufferCopyInfo& copyInfo) {
         const VkCommandBuffer commandBuffer = SingleTimeCommandUtil::BeginSingleTimeCommands(copyInfo.Device, copyInfo.CommandPool);
@@ -20,8 +20,9 @@ function Compile-Shaders {
     }
 }
 
-# Compile vertex and fragment shaders
+# Compile vertex, fragment and compute shaders
 Compile-Shaders -ExtensionFilter "*.vert"
 Compile-Shaders -ExtensionFilter "*.frag"
+Compile-Shaders -ExtensionFilter "*.comp"
 
 
@@ -4,8 +4,12 @@
 shaderDir=$(pwd)
 outputDir="$shaderDir/SPIRV"
 
-rm $outputDir/triangle.vert.spv
-rm $outputDir/triangle.frag.spv
+rm -f $outputDir/triangle.vert.spv
+rm -f $outputDir/triangle.frag.spv
+rm -f $outputDir/triangle_bindless.frag.spv
+rm -f $outputDir/triangle_instanced.vert.spv
+rm -f $outputDir/triangle_instanced.frag.spv
+rm -f $outputDir/cull.comp.spv
 
 # Create the output directory if it doesn't exist
 if [ ! -d "$outputDir" ]; then
@@ -24,6 +28,7 @@ compile_shaders() {
     done
 }
 
-# Compile vertex and fragment shaders
+# Compile vertex, fragment and compute shaders
 compile_shaders ".vert"
 compile_shaders ".frag"
+compile_shaders ".comp"
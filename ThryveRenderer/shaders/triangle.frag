@@ -17,9 +17,11 @@ const vec3 viewPos = vec3(0.0, 0.0, 10.0);
 
 void main()
 {
-    // Obtain normal from normal map in tangent space
-    vec3 normal = texture(normalMap, TexCoords).rgb;
-    normal = normalize(normal * 2.0 - 1.0); // Transform from [0,1] to [-1,1]
+    // Obtain normal from normal map in tangent space, only x and y are stored (BC5) so z is rebuilt
+    vec3 normal;
+    normal.xy = texture(normalMap, TexCoords).rg * 2.0 - 1.0; // Transform from [0,1] to [-1,1]
+    normal.z = sqrt(max(0.0, 1.0 - dot(normal.xy, normal.xy)));
+    normal = normalize(normal);
 
     // Transform normal to world space
     normal = normalize(TBN * normal);
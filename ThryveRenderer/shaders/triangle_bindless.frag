@@ -0,0 +1,66 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) out vec4 FragColor;
+
+layout(location = 0) in vec2 TexCoords;
+layout(location = 1) in vec3 FragPos;
+layout(location = 2) in mat3 TBN;
+
+// Every texture of the frame, see BindlessTextureTable
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+// Indices into textures, pushed per draw
+layout(push_constant) uniform Material {
+    uint albedo;
+    uint normal;
+    uint metallic;
+    uint emission;
+} material;
+
+// Define the light and view positions
+const vec3 lightPos = vec3(10.0, 10.0, 10.0);
+const vec3 viewPos = vec3(0.0, 0.0, 10.0);
+
+void main()
+{
+    // Obtain normal from normal map in tangent space, only x and y are stored (BC5) so z is rebuilt
+    vec3 normal;
+    normal.xy = texture(textures[nonuniformEXT(material.normal)], TexCoords).rg * 2.0 - 1.0; // Transform from [0,1] to [-1,1]
+    normal.z = sqrt(max(0.0, 1.0 - dot(normal.xy, normal.xy)));
+    normal = normalize(normal);
+
+    // Transform normal to world space
+    normal = normalize(TBN * normal);
+
+    // Calculate lighting
+    vec3 lightColor = vec3(1.0);
+    vec3 ambient = 0.1 * lightColor;
+
+    vec3 lightDir = normalize(lightPos - FragPos);
+    float diff = max(dot(lightDir, normal), 0.0);
+    vec3 diffuse = diff * lightColor;
+
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+    vec3 specular = spec * lightColor;
+
+    // Obtain albedo color
+    vec3 albedo = texture(textures[nonuniformEXT(material.albedo)], TexCoords).rgb;
+
+    // Obtain metallic factor
+    float metallic = texture(textures[nonuniformEXT(material.metallic)], TexCoords).r;
+
+    // Combine diffuse and specular based on metallic factor
+    vec3 color = (ambient + diffuse * (1.0 - metallic) + specular * metallic) * albedo;
+
+    // Obtain emission color
+    vec3 emission = texture(textures[nonuniformEXT(material.emission)], TexCoords).rgb;
+
+    // Add emission to final color
+    color += emission;
+
+    // Output final color
+    FragColor = vec4(color, 1.0);
+}
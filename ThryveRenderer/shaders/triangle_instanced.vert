@@ -0,0 +1,42 @@
+#version 450
+
+layout(location = 0) in vec3 aPos;         // Vertex position
+layout(location = 1) in vec3 aNormal;      // Vertex normal
+layout(location = 2) in vec2 aTexCoord;    // Vertex texture coordinate
+layout(location = 3) in vec3 aTangent;     // Vertex tangent
+layout(location = 4) in vec3 aBitangent;   // Vertex bitangent
+
+// Per instance, see InstanceData
+layout(location = 5) in mat4 aModel;       // Locations 5 to 8
+layout(location = 9) in uvec4 aTextures;   // Bindless table slots
+
+// The model matrix comes from the instance, only view and projection are read
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 projection;
+} ubo;
+
+layout(location = 0) out vec2 TexCoords;
+layout(location = 1) out vec3 FragPos;
+layout(location = 2) out mat3 TBN;
+layout(location = 5) flat out uvec4 TextureIndices;
+
+void main()
+{
+    // Transform vertex position to world space
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
+
+    // Pass texture coordinates and the instance's textures to the fragment shader
+    TexCoords = aTexCoord;
+    TextureIndices = aTextures;
+
+    // Transform normal, tangent, and bitangent to world space
+    vec3 T = normalize(mat3(aModel) * aTangent);
+    vec3 B = normalize(mat3(aModel) * aBitangent);
+    vec3 N = normalize(mat3(aModel) * aNormal);
+    TBN = mat3(T, B, N);
+
+    // Output the transformed position
+    gl_Position = ubo.projection * ubo.view * vec4(FragPos, 1.0);
+}
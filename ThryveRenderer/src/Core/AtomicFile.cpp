@@ -0,0 +1,35 @@
+#include "Core/AtomicFile.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace Thryve::Core {
+    void WriteFileAtomically(const std::filesystem::path& path, const std::function<void(std::ostream&)>& write)
+    {
+        std::error_code _error;
+        std::filesystem::create_directories(path.parent_path(), _error);
+
+        std::filesystem::path _tempPath = path;
+        _tempPath += ".tmp";
+        {
+            std::ofstream _file(_tempPath, std::ios::binary | std::ios::trunc);
+            if (!_file.is_open())
+            {
+                throw std::runtime_error("Unable to open " + _tempPath.string() + " for writing");
+            }
+
+            write(_file);
+            if (!_file.good())
+            {
+                throw std::runtime_error("Failed to write " + _tempPath.string());
+            }
+        }
+
+        std::filesystem::rename(_tempPath, path, _error);
+        if (_error)
+        {
+            throw std::runtime_error("Failed to replace " + path.string() + ": " + _error.message());
+        }
+    }
+} // namespace Thryve::Core
@@ -4,6 +4,8 @@
 
 #include "../../include/Core/Camera.h"
 
+#include "Renderer/Frustum.h"
+
 Thryve::Core::Camera::Camera(const glm::vec3& position, const glm::vec3& target, const glm::vec3& upVector,
                              float nearPlane, float farPlane, float aspectRatio) :
     m_Position{position}, m_Up{upVector}, m_Target{target}, m_NearPlane{nearPlane}, m_FarPlane{farPlane},
@@ -11,62 +13,23 @@ Thryve::Core::Camera::Camera(const glm::vec3& position, const glm::vec3& target,
 {
     m_ProjectionMatrix = glm::perspective<double>(glm::radians(m_Fov), m_Aspect, m_NearPlane, m_FarPlane);
 }
-std::array<glm::vec4, 6> Thryve::Core::Camera::CalculateFrustrumPlanes()
+std::array<glm::vec4, 6> Thryve::Core::Camera::CalculateFrustrumPlanes() const
 {
-    std::array<glm::vec4, 6> _planes;
-
-    const glm::vec3 _forward = glm::normalize(glm::cross(GetRightVector(), GetUpVector()));
-
-    const float _tanHalfFovY = glm::tan(glm::radians(m_Fov)*.5f);
-
-    const float _nearHalfHeight = m_NearPlane * _tanHalfFovY;
-    const float _farHalfHeight = m_FarPlane * _tanHalfFovY;
-
-    const float _nearHalfWidth = _nearHalfHeight * m_Aspect;
-    const float _farHalfWidth = _farHalfHeight * m_Aspect;
-
-    const glm::vec3 _nearCenter = GetPosition() + _forward * m_NearPlane;
-    const glm::vec3 _farCenter = GetPosition() + _forward * m_FarPlane;
-
-    const glm::vec3 _nearTopRight = _nearCenter + GetUpVector() * _nearHalfHeight + GetRightVector() * _nearHalfWidth;
-    const glm::vec3 _nearBottomRight = _nearCenter - GetUpVector() * _nearHalfHeight + GetRightVector() * _nearHalfWidth;
-    const glm::vec3 _nearTopLeft = _nearCenter + GetUpVector() * _nearHalfHeight - GetRightVector() * _nearHalfWidth;
-    const glm::vec3 _nearBottomLeft = _nearCenter - GetUpVector() * _nearHalfHeight - GetRightVector() * _nearHalfWidth;
-
-    const glm::vec3 _farTopRight = _farCenter + GetUpVector() * _farHalfHeight + GetRightVector() * _farHalfWidth;
-    const glm::vec3 _farBottomRight = _farCenter - GetUpVector() * _farHalfHeight + GetRightVector() * _farHalfWidth;
-    const glm::vec3 _farTopLeft = _farCenter + GetUpVector() * _farHalfHeight - GetRightVector() * _farHalfWidth;
-    const glm::vec3 _farBottomLeft = _farCenter - GetUpVector() * _farHalfHeight - GetRightVector() * _farHalfWidth;
-
-    auto _calculatePlaneNormal = [](const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
-    {
-      return glm::normalize(glm::cross(p1-p0, p2-p0));
-    };
-
-    const glm::vec3 _leftNormal = _calculatePlaneNormal(_farBottomLeft, _nearBottomLeft, _farTopLeft);
-    _planes[0] = glm::vec4(_leftNormal, -glm::dot(_leftNormal, _farBottomLeft));
-
-    // Bottom plane
-    const glm::vec3 _bottomNormal = _calculatePlaneNormal(_farBottomRight, _nearBottomRight, _farBottomLeft);
-    _planes[1] = glm::vec4(_bottomNormal, -glm::dot(_bottomNormal, _farBottomRight));
-
-    // Right plane
-    const glm::vec3 _rightNormal = _calculatePlaneNormal(_farTopRight, _nearTopRight, _farBottomRight);
-    _planes[2] = glm::vec4(_rightNormal, -glm::dot(_rightNormal, _farTopRight));
-
-    // Top plane
-    const glm::vec3 _topNormal = _calculatePlaneNormal(_farTopLeft, _nearTopLeft, _farTopRight);
-    _planes[3] = glm::vec4(_topNormal, -glm::dot(_topNormal, _farTopLeft));
-
-    // Near plane
-    const glm::vec3 _nearNormal = _calculatePlaneNormal(_nearTopRight, _nearTopLeft, _nearBottomRight);
-    _planes[4] = glm::vec4(_nearNormal, -glm::dot(_nearNormal, _nearTopRight));
-
-    // Far plane
-    const glm::vec3 _farNormal = _calculatePlaneNormal(_farTopRight, _farBottomRight, _farTopLeft);
-    _planes[5] = glm::vec4(_farNormal, -glm::dot(_farNormal, _farTopRight));
+    // Extracted from the matrices the scene is rendered with, so culling agrees with what ends up on screen.
+    // Left, right, bottom, top, near and far, normals pointing inwards
+    return Rendering::Frustum::FromViewProjection(GetProjectionMatrix() * GetViewMatrix()).Planes;
+}
 
-    return _planes;
+Thryve::Core::Ray Thryve::Core::Camera::ScreenPointToRay(const glm::vec2& ndc) const
+{
+    // The projection maps depth to -1 at the near and 1 at the far plane
+    const glm::mat4 _inverseViewProjection = glm::inverse(GetProjectionMatrix() * GetViewMatrix());
+    glm::vec4 _near = _inverseViewProjection * glm::vec4(ndc, -1.0f, 1.0f);
+    glm::vec4 _far = _inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+    _near /= _near.w;
+    _far /= _far.w;
+
+    return {glm::vec3(_near), glm::normalize(glm::vec3(_far - _near))};
 }
 
 void Thryve::Core::Camera::Move(const glm::vec3& direction, float increment)
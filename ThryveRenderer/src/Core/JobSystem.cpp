@@ -0,0 +1,372 @@
+#include "Core/JobSystem.h"
+
+#include <string>
+
+#include "Core/Profiling.h"
+
+namespace {
+    // Each worker thread remembers which system it belongs to, so a restarted system never reuses a stale index
+    thread_local const Thryve::Core::JobSystem* t_Owner = nullptr;
+    thread_local uint32_t t_WorkerIndex = UINT32_MAX;
+
+    constexpr uint32_t SPIN_COUNT_BEFORE_SLEEP = 64;
+
+    uint32_t NextRandom(uint32_t& state)
+    {
+        // xorshift32, only used to spread steal attempts
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+}
+
+Thryve::Core::JobSystem::JobSystem() = default;
+
+Thryve::Core::JobSystem::~JobSystem()
+{
+    JobSystem::ShutDown();
+}
+
+void Thryve::Core::JobSystem::Init(ServiceConfiguration* configuration)
+{
+    IService::Init(configuration);
+
+    uint32_t _workerCount = 0;
+    if (const auto* _config = dynamic_cast<JobSystemConfiguration*>(configuration))
+    {
+        _workerCount = _config->WorkerCount;
+    }
+    if (_workerCount == 0)
+    {
+        // hardware_concurrency is 0 when it cannot be determined
+        _workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    }
+
+    m_workers.reserve(_workerCount);
+    for (uint32_t _i = 0; _i < _workerCount; ++_i)
+    {
+        auto _worker = std::make_unique<Worker>();
+        _worker->Jobs = std::make_unique<Job[]>(MAX_JOBS_PER_THREAD);
+        _worker->RandomState = 0x9E3779B9u * (_i + 1);
+        m_workers.push_back(std::move(_worker));
+    }
+    m_externalJobs = std::make_unique<Job[]>(MAX_JOBS_PER_THREAD);
+    m_injectedJobs.reserve(MAX_JOBS_PER_THREAD);
+
+    // The initialising thread is worker 0, it executes jobs whenever it waits on a counter
+    t_Owner = this;
+    t_WorkerIndex = 0;
+
+    m_bRunning.store(true, std::memory_order_release);
+    for (uint32_t _i = 1; _i < _workerCount; ++_i)
+    {
+        m_threads.emplace_back(&JobSystem::WorkerLoop, this, _i);
+    }
+}
+
+void Thryve::Core::JobSystem::ShutDown()
+{
+    if (!m_bRunning.exchange(false, std::memory_order_acq_rel))
+    {
+        return;
+    }
+
+    {
+        std::lock_guard _lock(m_wakeMutex);
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& _thread : m_threads)
+    {
+        _thread.join();
+    }
+    m_threads.clear();
+
+    if (t_Owner == this)
+    {
+        t_Owner = nullptr;
+        t_WorkerIndex = UINT32_MAX;
+    }
+}
+
+uint32_t Thryve::Core::JobSystem::GetCurrentWorkerIndex()
+{
+    return t_Owner ? t_WorkerIndex : UINT32_MAX;
+}
+
+Thryve::Core::Job* Thryve::Core::JobSystem::AllocateJob()
+{
+    if (!m_bRunning.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+
+    Job* _job = nullptr;
+    if (t_Owner == this)
+    {
+        Worker& _worker = *m_workers[t_WorkerIndex];
+        _job = &_worker.Jobs[_worker.NextJob++ & (MAX_JOBS_PER_THREAD - 1)];
+    }
+    else
+    {
+        std::lock_guard _lock(m_injectMutex);
+        _job = &m_externalJobs[m_nextExternalJob++ & (MAX_JOBS_PER_THREAD - 1)];
+    }
+
+    // The ring wrapped onto a job that has not finished yet
+    if (_job->bIsUsed.exchange(true, std::memory_order_acq_rel))
+    {
+        return nullptr;
+    }
+    _job->NextContinuation = nullptr;
+    return _job;
+}
+
+void Thryve::Core::JobSystem::Schedule(Job* job, JobCounter* dependency)
+{
+    if (dependency)
+    {
+        AddContinuation(dependency, job);
+        return;
+    }
+    Push(job);
+}
+
+void Thryve::Core::JobSystem::AddContinuation(JobCounter* dependency, Job* job)
+{
+    for (;;)
+    {
+        {
+            std::lock_guard _lock(dependency->m_continuationMutex);
+            const uint32_t _pending = dependency->m_pending.load(std::memory_order_acquire);
+            if (_pending == 0)
+            {
+                break;
+            }
+            if (_pending != JobCounter::FINISHING)
+            {
+                job->NextContinuation = dependency->m_continuations;
+                dependency->m_continuations = job;
+                return;
+            }
+        }
+        // The last job is collecting continuations right now, this one would be missed
+        std::this_thread::yield();
+    }
+    Push(job);
+}
+
+void Thryve::Core::JobSystem::Push(Job* job)
+{
+    bool _bPushed = false;
+    if (t_Owner == this)
+    {
+        _bPushed = m_workers[t_WorkerIndex]->Deque.Push(job);
+    }
+    else
+    {
+        std::lock_guard _lock(m_injectMutex);
+        if (m_injectedJobs.size() < MAX_JOBS_PER_THREAD)
+        {
+            m_injectedJobs.push_back(job);
+            _bPushed = true;
+        }
+    }
+
+    if (!_bPushed)
+    {
+        Execute(job);
+        return;
+    }
+
+    m_queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+    if (m_sleepingWorkers.load(std::memory_order_seq_cst) > 0)
+    {
+        // Taking the lock orders this against a worker that is between checking and going to sleep
+        {
+            std::lock_guard _lock(m_wakeMutex);
+        }
+        m_wakeCondition.notify_one();
+    }
+}
+
+Thryve::Core::Job* Thryve::Core::JobSystem::FindJob()
+{
+    Job* _job = nullptr;
+    const bool _bIsWorker = t_Owner == this;
+
+    if (_bIsWorker)
+    {
+        _job = m_workers[t_WorkerIndex]->Deque.Pop();
+    }
+
+    if (!_job && m_queuedJobs.load(std::memory_order_relaxed) > 0)
+    {
+        {
+            std::lock_guard _lock(m_injectMutex);
+            if (!m_injectedJobs.empty())
+            {
+                _job = m_injectedJobs.back();
+                m_injectedJobs.pop_back();
+            }
+        }
+
+        const auto _workerCount = static_cast<uint32_t>(m_workers.size());
+        uint32_t _seed = _bIsWorker ? m_workers[t_WorkerIndex]->RandomState : 0x2545F491u;
+        const uint32_t _start = _workerCount > 0 ? NextRandom(_seed) % _workerCount : 0;
+        if (_bIsWorker)
+        {
+            m_workers[t_WorkerIndex]->RandomState = _seed;
+        }
+
+        for (uint32_t _i = 0; !_job && _i < _workerCount; ++_i)
+        {
+            const uint32_t _victim = (_start + _i) % _workerCount;
+            if (!_bIsWorker || _victim != t_WorkerIndex)
+            {
+                _job = m_workers[_victim]->Deque.Steal();
+            }
+        }
+    }
+
+    if (_job)
+    {
+        m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return _job;
+}
+
+void Thryve::Core::JobSystem::Execute(Job* job)
+{
+    job->Function();
+    job->Function.Reset();
+
+    JobCounter* _counter = job->Counter;
+    job->Counter = nullptr;
+    job->bIsUsed.store(false, std::memory_order_release);
+
+    FinishCounter(_counter);
+}
+
+void Thryve::Core::JobSystem::FinishCounter(JobCounter* counter)
+{
+    if (!counter)
+    {
+        return;
+    }
+
+    uint32_t _pending = counter->m_pending.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        if (_pending > 1)
+        {
+            if (counter->m_pending.compare_exchange_weak(_pending, _pending - 1, std::memory_order_acq_rel,
+                                                         std::memory_order_relaxed))
+            {
+                return;
+            }
+            continue;
+        }
+
+        if (counter->m_pending.compare_exchange_weak(_pending, JobCounter::FINISHING, std::memory_order_acq_rel,
+                                                     std::memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    Job* _ready = nullptr;
+    {
+        std::lock_guard _lock(counter->m_continuationMutex);
+        _ready = counter->m_continuations;
+        counter->m_continuations = nullptr;
+    }
+    // Last access, a waiter may destroy the counter as soon as it reads zero
+    counter->m_pending.store(0, std::memory_order_release);
+
+    while (_ready)
+    {
+        Job* _next = _ready->NextContinuation;
+        _ready->NextContinuation = nullptr;
+        Push(_ready);
+        _ready = _next;
+    }
+}
+
+void Thryve::Core::JobSystem::Wait(const JobCounter& counter)
+{
+    uint32_t _idle = 0;
+    while (!counter.IsDone())
+    {
+        if (Job* _job = FindJob())
+        {
+            Execute(_job);
+            _idle = 0;
+        }
+        else if (++_idle > SPIN_COUNT_BEFORE_SLEEP)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void Thryve::Core::JobSystem::WaitFor(JobCounter* counter)
+{
+    if (counter)
+    {
+        Wait(*counter);
+    }
+}
+
+void Thryve::Core::JobSystem::WorkerLoop(const uint32_t workerIndex)
+{
+    t_Owner = this;
+    t_WorkerIndex = workerIndex;
+    PROFILE_THREAD_NAME("Worker " + std::to_string(workerIndex))
+
+    uint32_t _idle = 0;
+    while (m_bRunning.load(std::memory_order_acquire))
+    {
+        if (Job* _job = FindJob())
+        {
+            Execute(_job);
+            _idle = 0;
+            continue;
+        }
+
+        if (++_idle < SPIN_COUNT_BEFORE_SLEEP)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock _lock(m_wakeMutex);
+        m_sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        m_wakeCondition.wait(_lock, [this] {
+            return !m_bRunning.load(std::memory_order_acquire) || m_queuedJobs.load(std::memory_order_seq_cst) > 0;
+        });
+        m_sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+        _idle = 0;
+    }
+
+    t_Owner = nullptr;
+    t_WorkerIndex = UINT32_MAX;
+}
+
+uint32_t Thryve::Core::JobSystem::GetBatchSize(const uint32_t count, const uint32_t batchSize) const
+{
+    if (m_workers.size() <= 1 || !m_bRunning.load(std::memory_order_relaxed))
+    {
+        return count;
+    }
+
+    // Keep the batch count well inside one thread's job ring
+    constexpr uint32_t MAX_BATCHES = MAX_JOBS_PER_THREAD / 4;
+    uint32_t _batchSize = std::max(batchSize, 1u);
+    if ((count + _batchSize - 1) / _batchSize > MAX_BATCHES)
+    {
+        _batchSize = (count + MAX_BATCHES - 1) / MAX_BATCHES;
+    }
+    return _batchSize;
+}
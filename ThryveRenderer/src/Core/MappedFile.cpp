@@ -0,0 +1,144 @@
+#include "Core/MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Thryve::Core::MappedFile::~MappedFile()
+{
+    Close();
+}
+
+Thryve::Core::MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+Thryve::Core::MappedFile& Thryve::Core::MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+        m_fileHandle = std::exchange(other.m_fileHandle, nullptr);
+        m_mappingHandle = std::exchange(other.m_mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+bool Thryve::Core::MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    HANDLE _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER _size;
+    if (!GetFileSizeEx(_file, &_size) || _size.QuadPart == 0)
+    {
+        CloseHandle(_file);
+        return false;
+    }
+
+    HANDLE _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!_mapping)
+    {
+        CloseHandle(_file);
+        return false;
+    }
+
+    const void* _view = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!_view)
+    {
+        CloseHandle(_mapping);
+        CloseHandle(_file);
+        return false;
+    }
+
+    m_fileHandle = _file;
+    m_mappingHandle = _mapping;
+    m_data = static_cast<const std::byte*>(_view);
+    m_size = static_cast<size_t>(_size.QuadPart);
+    return true;
+}
+
+void Thryve::Core::MappedFile::Close()
+{
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mappingHandle)
+    {
+        CloseHandle(m_mappingHandle);
+    }
+    if (m_fileHandle)
+    {
+        CloseHandle(m_fileHandle);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+}
+#else
+bool Thryve::Core::MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    const int _file = open(path.c_str(), O_RDONLY);
+    if (_file < 0)
+    {
+        return false;
+    }
+
+    struct stat _stat{};
+    if (fstat(_file, &_stat) != 0 || _stat.st_size <= 0)
+    {
+        close(_file);
+        return false;
+    }
+
+    void* _view = mmap(nullptr, static_cast<size_t>(_stat.st_size), PROT_READ, MAP_PRIVATE, _file, 0);
+    // The mapping keeps its own reference to the file
+    close(_file);
+    if (_view == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // Everything gets copied out right away, start reading ahead now
+    madvise(_view, static_cast<size_t>(_stat.st_size), MADV_WILLNEED);
+
+    m_data = static_cast<const std::byte*>(_view);
+    m_size = static_cast<size_t>(_stat.st_size);
+    return true;
+}
+
+void Thryve::Core::MappedFile::Close()
+{
+    if (m_data)
+    {
+        munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+}
+#endif
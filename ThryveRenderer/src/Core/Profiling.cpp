@@ -5,6 +5,7 @@
 #include "Core/Profiling.h"
 
 #include <Config.h>
+#include "Core/TraceEventWriter.h"
 #include <fstream>
 #include <future>
 #include <nlohmann/json.hpp>
@@ -12,6 +13,42 @@
 
 
 
+namespace {
+    // Both outputs of one capture share the same index, so the trace and the summary can be matched up
+    int GetNextCaptureIndex()
+    {
+        int fileIndex = 0;
+
+        std::ifstream indexFile("index.txt");
+        if (indexFile.is_open())
+        {
+            indexFile >> fileIndex;
+            indexFile.close();
+        }
+
+        fileIndex++;
+
+        std::ofstream outFile("index.txt");
+        {
+            if (outFile.is_open())
+            {
+                outFile << fileIndex;
+                outFile.close();
+            }
+        }
+        return fileIndex;
+    }
+
+    std::string MakeCaptureFileName(const std::string& baseFileName, const int fileIndex)
+    {
+        std::ostringstream fileName;
+        fileName << baseFileName << "_" << std::setw(4) << std::setfill('0') << fileIndex << ".json";
+        return fileName.str();
+    }
+}
+
+Thryve::Core::ProfilingService::ProfilingService() = default;
+
 Thryve::Core::ProfilingService::~ProfilingService()
 {
     ProfilingService::ShutDown();
@@ -20,69 +57,256 @@ Thryve::Core::ProfilingService::~ProfilingService()
 void Thryve::Core::ProfilingService::Init(ServiceConfiguration *configuration)
 {
     IService::Init(configuration);
+
+    if (const auto* _config = dynamic_cast<ProfilingServiceConfiguration*>(configuration))
+    {
+        m_config = *_config;
+    }
+
+    m_captureIndex = GetNextCaptureIndex();
+    if (m_config.StreamTraceEvents)
+    {
+        m_traceWriter = std::make_unique<TraceEventWriter>(MakeCaptureFileName(PROFILE_DIR "/trace", m_captureIndex));
+    }
+
+    {
+        std::lock_guard _lock(m_flusherMutex);
+        m_bFlusherRunning = true;
+    }
+    m_flusher = std::thread(&ProfilingService::FlusherLoop, this);
+
+    s_Instance.store(this, std::memory_order_release);
 }
 
-std::string GetNextFileName(const std::string& baseFileName)
+Thryve::Core::ProfileScopeID Thryve::Core::ProfilingService::RegisterScope(const char* name, const char* scopeName)
 {
-    static int fileIndex = 0;
+    std::lock_guard _lock(s_ScopeMutex);
 
-    std::ifstream indexFile("index.txt");
-    if (indexFile.is_open())
+    ProfileKey _key{name, scopeName};
+    if (const auto _it = s_ScopeLookup.find(_key); _it != s_ScopeLookup.end())
     {
-        indexFile >> fileIndex;
-        indexFile.close();
+        return _it->second;
     }
 
-    fileIndex++;
+    const auto _id = static_cast<ProfileScopeID>(s_Scopes.size());
+    s_Scopes.push_back(_key);
+    s_ScopeLookup.emplace(std::move(_key), _id);
+    return _id;
+}
+
+Thryve::Core::ProfileEventRingBuffer* Thryve::Core::ProfilingService::GetThreadBuffer()
+{
+    // Remember which service the cached ring belongs to, so a restarted service never sees a stale ring
+    thread_local ProfilingService* t_Owner = nullptr;
+    thread_local ProfileEventRingBuffer* t_Buffer = nullptr;
+
+    ProfilingService* _instance = s_Instance.load(std::memory_order_acquire);
+    if (!_instance)
+    {
+        return nullptr;
+    }
+
+    if (t_Owner != _instance)
+    {
+        t_Buffer = _instance->RegisterCurrentThread();
+        t_Owner = _instance;
+    }
+    return t_Buffer;
+}
 
-    std::ofstream outFile("index.txt");
+Thryve::Core::ProfileEventRingBuffer* Thryve::Core::ProfilingService::RegisterCurrentThread()
+{
+    std::lock_guard _lock(m_bufferMutex);
+    const auto _threadIndex = static_cast<uint32_t>(m_ThreadBuffers.size());
+    m_ThreadBuffers.push_back(std::make_unique<ProfileEventRingBuffer>(_threadIndex, std::this_thread::get_id()));
+    m_ThreadBuffers.back()->SetThreadName("Thread " + std::to_string(_threadIndex));
+    return m_ThreadBuffers.back().get();
+}
+
+void Thryve::Core::ProfilingService::SetThreadName(const std::string& name)
+{
+    ProfilingService* _instance = s_Instance.load(std::memory_order_acquire);
+    ProfileEventRingBuffer* _buffer = GetThreadBuffer();
+    if (!_instance || !_buffer)
     {
-        if (outFile.is_open())
+        return;
+    }
+
+    std::lock_guard _lock(_instance->m_bufferMutex);
+    _buffer->SetThreadName(name);
+}
+
+void Thryve::Core::ProfilingService::MarkFrame()
+{
+    if (ProfileEventRingBuffer* _buffer = GetThreadBuffer())
+    {
+        const uint32_t _frame = s_FrameIndex.fetch_add(1, std::memory_order_relaxed);
+        _buffer->Push({Now(), 0, _frame, _buffer->GetThreadIndex(), 0, ProfileEventType::FrameMarker});
+    }
+}
+
+void Thryve::Core::ProfilingService::RecordGpuScope(const ProfileScopeID scopeID, const int64_t startTime,
+                                                   const int64_t duration, const uint16_t depth)
+{
+    if (ProfileEventRingBuffer* _buffer = GetThreadBuffer())
+    {
+        _buffer->Push({startTime, duration, scopeID, _buffer->GetThreadIndex(), depth, ProfileEventType::GpuScope});
+    }
+}
+
+void Thryve::Core::ProfilingService::RecordCounter(const ProfileScopeID scopeID, const int64_t value)
+{
+    if (ProfileEventRingBuffer* _buffer = GetThreadBuffer())
+    {
+        _buffer->Push({Now(), value, scopeID, _buffer->GetThreadIndex(), 0, ProfileEventType::Counter});
+    }
+}
+
+void Thryve::Core::ProfilingService::Flush()
+{
+    std::lock_guard _bufferLock(m_bufferMutex);
+    std::lock_guard _eventLock(m_eventMutex);
+    // Scopes only grow, holding the lock keeps references into s_Scopes valid while writing
+    std::lock_guard _scopeLock(s_ScopeMutex);
+
+    for (const auto& _buffer : m_ThreadBuffers)
+    {
+        if (m_traceWriter && _buffer->IsThreadNameDirty())
         {
-            outFile << fileIndex;
-            outFile.close();
+            m_traceWriter->WriteThreadName(_buffer->GetThreadIndex(), _buffer->GetThreadName());
         }
+        _buffer->ClearThreadNameDirty();
+
+        _buffer->Drain([this](const ProfileEvent& event) { ConsumeEvent(event); });
     }
 
-    std::ostringstream fileName;
-    fileName << baseFileName << "_" << std::setw(4) << std::setfill('0') << fileIndex << ".json";
-    return fileName.str();
+    if (m_traceWriter)
+    {
+        m_traceWriter->Flush();
+    }
 }
 
-void Thryve::Core::ProfilingService::ShutDown()
+void Thryve::Core::ProfilingService::ConsumeEvent(const ProfileEvent& event)
 {
-    auto _filePath = GetNextFileName(std::string(PROFILE_DIR)+"/profile_Data");
-    SaveProfileResultsToJson(_filePath);
+    if (m_traceWriter)
+    {
+        switch (event.Type)
+        {
+        case ProfileEventType::Scope:
+            m_traceWriter->WriteScope(s_Scopes[event.ScopeID], event);
+            break;
+        case ProfileEventType::GpuScope:
+            m_traceWriter->WriteGpuScope(s_Scopes[event.ScopeID], event);
+            break;
+        case ProfileEventType::FrameMarker:
+            m_traceWriter->WriteFrameMarker(event);
+            break;
+        case ProfileEventType::Counter:
+            m_traceWriter->WriteCounter(s_Scopes[event.ScopeID], event);
+            break;
+        }
+    }
+
+    // The legacy summary only knows invocations
+    if (m_config.KeepInvocationHistory && event.Type != ProfileEventType::FrameMarker &&
+        event.Type != ProfileEventType::Counter)
+    {
+        if (m_Events.size() < m_config.MaxInvocationHistory)
+        {
+            m_Events.push_back(event);
+        }
+        else
+        {
+            ++m_droppedHistoryEvents;
+        }
+    }
 }
 
-void Thryve::Core::ProfilingService::RecordProfileResult(const ProfilingData &data)
+void Thryve::Core::ProfilingService::FlusherLoop()
 {
-    std::lock_guard _lock(m_mutex);
-    m_Profiles[ProfileKey{data.Name, data.ScopeName}][data.ThreadID].push_back(data);
+    constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(10);
+
+    std::unique_lock _lock(m_flusherMutex);
+    while (m_bFlusherRunning)
+    {
+        m_flusherCondition.wait_for(_lock, FLUSH_INTERVAL, [this] { return !m_bFlusherRunning; });
+
+        _lock.unlock();
+        Flush();
+        _lock.lock();
+    }
+}
+
+void Thryve::Core::ProfilingService::ShutDown()
+{
+    // ShutDown runs both explicitly and from the destructor, only the first call writes results
+    if (s_Instance.exchange(nullptr, std::memory_order_acq_rel) != this)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard _lock(m_flusherMutex);
+        m_bFlusherRunning = false;
+    }
+    m_flusherCondition.notify_all();
+    if (m_flusher.joinable())
+    {
+        m_flusher.join();
+    }
+    Flush();
+
+    if (m_traceWriter)
+    {
+        m_traceWriter->Close();
+        m_traceWriter.reset();
+    }
+
+    if (m_config.KeepInvocationHistory)
+    {
+        auto _filePath = MakeCaptureFileName(PROFILE_DIR "/profile_Data", m_captureIndex);
+        SaveProfileResultsToJson(_filePath);
+    }
 }
 
 void Thryve::Core::ProfilingService::SaveProfileResultsToJson(std::string &filePath)
 {
     nlohmann::json _json;
+    static const std::string GPU_THREAD_KEY = "GPU";
 
-    for (const auto& [functionName , threadProfiles] : m_Profiles)
+    std::vector<std::string> _threadIdStrings;
+    uint32_t _droppedEvents = 0;
     {
-        for (const auto& [threadID, dataVector] : threadProfiles)
+        std::lock_guard _lock(m_bufferMutex);
+        for (const auto& _buffer : m_ThreadBuffers)
         {
             std::ostringstream _oss;
-            _oss << threadID;
-            std::string _threadIdString = _oss.str();
+            _oss << _buffer->GetThreadID();
+            _threadIdStrings.push_back(_oss.str());
+            _droppedEvents += _buffer->GetDroppedCount();
+        }
+    }
 
-            nlohmann::json _threadJson;
-            for (const auto& _data : dataVector)
-            {
-                _threadJson.push_back({
-                    {"startTime", _data.StartTime},
-                    {"duration", _data.Duration}
-                });
-            }
+    std::vector<ProfileKey> _scopes;
+    {
+        std::lock_guard _lock(s_ScopeMutex);
+        _scopes = s_Scopes;
+    }
 
-            _json[functionName.Name][functionName.ScopeName][_threadIdString]["invocations"] = _threadJson;
+    uint64_t _droppedHistoryEvents = 0;
+    {
+        std::lock_guard _lock(m_eventMutex);
+        _droppedHistoryEvents = m_droppedHistoryEvents;
+        for (const auto& _event : m_Events)
+        {
+            const ProfileKey& _key = _scopes[_event.ScopeID];
+            const std::string& _thread =
+                _event.Type == ProfileEventType::GpuScope ? GPU_THREAD_KEY : _threadIdStrings[_event.ThreadIndex];
+            // Keep the microsecond resolution profiler.py expects
+            _json[_key.Name][_key.ScopeName][_thread]["invocations"].push_back({
+                {"startTime", _event.StartTime / 1000},
+                {"duration", _event.Duration / 1000}
+            });
         }
     }
 
@@ -95,7 +319,9 @@ void Thryve::Core::ProfilingService::SaveProfileResultsToJson(std::string &fileP
                            {"GPU Type", _specs.GPUType},
                            {"CPU", _specs.CPU},
                            {"Core Count", _specs.CPUCoreCount},
-                           {"RAM", _specs.RAM}
+                           {"RAM", _specs.RAM},
+                           {"Dropped Events", _droppedEvents},
+                           {"Dropped History Events", _droppedHistoryEvents}
     });
 
     _json["System"] = _systemInfo;
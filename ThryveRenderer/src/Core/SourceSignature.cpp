@@ -0,0 +1,56 @@
+#include "Core/SourceSignature.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "Core/MappedFile.h"
+
+namespace Thryve::Core {
+    bool GetSourceSignature(const std::string& sourcePath, SourceSignature& signature)
+    {
+        std::error_code _error;
+        const auto _size = std::filesystem::file_size(sourcePath, _error);
+        if (_error)
+        {
+            return false;
+        }
+        const auto _writeTime = std::filesystem::last_write_time(sourcePath, _error);
+        if (_error)
+        {
+            return false;
+        }
+
+        signature.Size = _size;
+        signature.WriteTime = _writeTime.time_since_epoch().count();
+        return true;
+    }
+
+    uint64_t HashSource(const std::string& sourcePath)
+    {
+        MappedFile _source;
+        if (!_source.Open(sourcePath))
+        {
+            return 0;
+        }
+
+        uint64_t _hash = 0xCBF29CE484222325ull;
+        for (size_t _i = 0; _i < _source.GetSize(); ++_i)
+        {
+            _hash ^= static_cast<uint8_t>(_source.GetData()[_i]);
+            _hash *= 0x100000001B3ull;
+        }
+        return _hash;
+    }
+
+    bool StoreSourceWriteTime(const std::string& cachePath, const uint64_t offset, const int64_t writeTime)
+    {
+        std::fstream _file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+        if (!_file.is_open())
+        {
+            return false;
+        }
+        _file.seekp(static_cast<std::streamoff>(offset));
+        _file.write(reinterpret_cast<const char*>(&writeTime), sizeof(writeTime));
+        return _file.good();
+    }
+} // namespace Thryve::Core
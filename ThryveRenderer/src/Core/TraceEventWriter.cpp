@@ -0,0 +1,170 @@
+#include "Core/TraceEventWriter.h"
+
+#include <cstdio>
+
+#include "Core/Log.h"
+#include "Core/ServiceRegistry.h"
+
+Thryve::Core::TraceEventWriter::TraceEventWriter(const std::string& filePath) : m_file(filePath, std::ios::trunc)
+{
+    if (!m_file.is_open())
+    {
+        ServiceRegistry::GetService<DevelopmentLogger>()->LogError("Unable to open trace file " + filePath);
+        return;
+    }
+
+    m_file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    BeginEvent();
+    m_file << R"({"name":"process_name","ph":"M","pid":)" << PROCESS_ID << R"(,"args":{"name":"Thryve"}})";
+    WriteThreadName(GPU_THREAD_ID, "GPU");
+}
+
+Thryve::Core::TraceEventWriter::~TraceEventWriter()
+{
+    Close();
+}
+
+void Thryve::Core::TraceEventWriter::WriteThreadName(const uint32_t threadIndex, const std::string_view name)
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+
+    BeginEvent();
+    m_file << R"({"name":"thread_name","ph":"M","pid":)" << PROCESS_ID << ",\"tid\":" << threadIndex
+           << R"(,"args":{"name":")";
+    WriteEscaped(name);
+    m_file << "\"}}";
+}
+
+void Thryve::Core::TraceEventWriter::WriteScope(const ProfileKey& key, const ProfileEvent& event)
+{
+    WriteCompleteEvent(key, event, key.ScopeName.empty() ? "function" : "scope", event.ThreadIndex);
+}
+
+void Thryve::Core::TraceEventWriter::WriteGpuScope(const ProfileKey& key, const ProfileEvent& event)
+{
+    WriteCompleteEvent(key, event, "gpu", GPU_THREAD_ID);
+}
+
+void Thryve::Core::TraceEventWriter::WriteFrameMarker(const ProfileEvent& event)
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+
+    // Global-scope instant events are drawn as a line across every track
+    BeginEvent();
+    m_file << R"({"name":"Frame","cat":"frame","ph":"i","s":"g","ts":)";
+    WriteMicroseconds(event.StartTime);
+    m_file << ",\"pid\":" << PROCESS_ID << ",\"tid\":" << event.ThreadIndex << ",\"args\":{\"frame\":" << event.ScopeID
+           << "}}";
+}
+
+void Thryve::Core::TraceEventWriter::WriteCounter(const ProfileKey& key, const ProfileEvent& event)
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+
+    BeginEvent();
+    m_file << "{\"name\":\"";
+    WriteEscaped(key.Name);
+    m_file << R"(","cat":"counter","ph":"C","ts":)";
+    WriteMicroseconds(event.StartTime);
+    m_file << ",\"pid\":" << PROCESS_ID << ",\"args\":{\"value\":" << event.Duration << "}}";
+}
+
+void Thryve::Core::TraceEventWriter::Flush()
+{
+    if (IsOpen())
+    {
+        m_file.flush();
+    }
+}
+
+void Thryve::Core::TraceEventWriter::Close()
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+
+    m_file << "\n]}\n";
+    m_file.close();
+}
+
+void Thryve::Core::TraceEventWriter::BeginEvent()
+{
+    if (!m_bFirstEvent)
+    {
+        m_file << ',';
+    }
+    m_file << '\n';
+    m_bFirstEvent = false;
+}
+
+void Thryve::Core::TraceEventWriter::WriteCompleteEvent(const ProfileKey& key, const ProfileEvent& event,
+                                                        const std::string_view category, const uint32_t threadID)
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+
+    BeginEvent();
+    m_file << "{\"name\":\"";
+    WriteEscaped(key.Name);
+    if (!key.ScopeName.empty())
+    {
+        m_file << "::";
+        WriteEscaped(key.ScopeName);
+    }
+    m_file << "\",\"cat\":\"" << category << "\",\"ph\":\"X\",\"ts\":";
+    WriteMicroseconds(event.StartTime);
+    m_file << ",\"dur\":";
+    WriteMicroseconds(event.Duration);
+    m_file << ",\"pid\":" << PROCESS_ID << ",\"tid\":" << threadID << ",\"args\":{\"depth\":" << event.Depth << "}}";
+}
+
+void Thryve::Core::TraceEventWriter::WriteEscaped(const std::string_view text)
+{
+    for (const char _c : text)
+    {
+        switch (_c)
+        {
+        case '"':
+            m_file << "\\\"";
+            break;
+        case '\\':
+            m_file << "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(_c) < 0x20)
+            {
+                char _escaped[8];
+                std::snprintf(_escaped, sizeof(_escaped), "\\u%04x", _c);
+                m_file << _escaped;
+            }
+            else
+            {
+                m_file << _c;
+            }
+        }
+    }
+}
+
+void Thryve::Core::TraceEventWriter::WriteMicroseconds(const int64_t nanoseconds)
+{
+    // Integer formatting keeps full precision on long captures, where a double would start rounding
+    const int64_t _whole = nanoseconds / 1000;
+    const int64_t _fraction = nanoseconds % 1000;
+    char _buffer[32];
+    std::snprintf(_buffer, sizeof(_buffer), "%lld.%03lld", static_cast<long long>(_whole),
+                  static_cast<long long>(_fraction < 0 ? -_fraction : _fraction));
+    m_file << _buffer;
+}
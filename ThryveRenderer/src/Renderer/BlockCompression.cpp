@@ -0,0 +1,463 @@
+#include "Renderer/BlockCompression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "Core/JobSystem.h"
+#include "Core/Profiling.h"
+#include "Core/ServiceRegistry.h"
+
+namespace {
+    constexpr uint32_t BLOCK_ROWS_PER_JOB = 4;
+    constexpr int TEXELS = 16;
+
+    // Mode 6 interpolation weights out of 64, from the BC7 specification
+    constexpr int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    // Palette entry whose weight is closest to each of 0..64
+    constexpr auto BC7_WEIGHT_INDEX = [] {
+        const auto _distance = [](const int a, const int b) { return a > b ? a - b : b - a; };
+        std::array<uint8_t, 65> _table{};
+        for (int _weight = 0; _weight <= 64; ++_weight)
+        {
+            for (int _index = 1; _index < 16; ++_index)
+            {
+                if (_distance(BC7_WEIGHTS[_index], _weight) < _distance(BC7_WEIGHTS[_table[_weight]], _weight))
+                {
+                    _table[_weight] = static_cast<uint8_t>(_index);
+                }
+            }
+        }
+        return _table;
+    }();
+    constexpr int POWER_ITERATIONS = 8;
+    constexpr int REFINE_PASSES = 2;
+
+    // Writes fields least significant bit first, the order every BCn block is defined in
+    class BitWriter {
+    public:
+        explicit BitWriter(std::byte* output, const uint32_t byteCount) : m_output(output)
+        {
+            std::memset(m_output, 0, byteCount);
+        }
+
+        void Write(const uint32_t value, const uint32_t bitCount)
+        {
+            for (uint32_t _bit = 0; _bit < bitCount; ++_bit, ++m_position)
+            {
+                if ((value >> _bit) & 1u)
+                {
+                    m_output[m_position >> 3] |= std::byte(1u << (m_position & 7));
+                }
+            }
+        }
+
+    private:
+        std::byte* m_output;
+        uint32_t m_position = 0;
+    };
+
+    // One mode 6 endpoint pair, 8-bit values with the p-bit already in the lowest bit
+    struct BC7Candidate {
+        int Endpoints[2][4] = {};
+        int PBits[2] = {};
+        uint8_t Indices[TEXELS] = {};
+        int64_t Error = std::numeric_limits<int64_t>::max();
+    };
+
+    int QuantizeEndpoint(const float value, const int pBit)
+    {
+        const int _quantized = static_cast<int>(std::lround((value - static_cast<float>(pBit)) * 0.5f));
+        return std::clamp(_quantized, 0, 127) * 2 + pBit;
+    }
+
+    int64_t EvaluateBC7(const uint8_t* rgba, BC7Candidate& candidate)
+    {
+        int _palette[16][4];
+        for (int _index = 0; _index < 16; ++_index)
+        {
+            for (int _channel = 0; _channel < 4; ++_channel)
+            {
+                _palette[_index][_channel] = ((64 - BC7_WEIGHTS[_index]) * candidate.Endpoints[0][_channel] +
+                                              BC7_WEIGHTS[_index] * candidate.Endpoints[1][_channel] + 32) >> 6;
+            }
+        }
+
+        int _direction[4];
+        int _lengthSquared = 0;
+        for (int _channel = 0; _channel < 4; ++_channel)
+        {
+            _direction[_channel] = candidate.Endpoints[1][_channel] - candidate.Endpoints[0][_channel];
+            _lengthSquared += _direction[_channel] * _direction[_channel];
+        }
+
+        // The palette lies on a line, projecting onto it lands within one entry of the best one
+        int64_t _error = 0;
+        for (int _texel = 0; _texel < TEXELS; ++_texel)
+        {
+            const uint8_t* _color = rgba + _texel * 4;
+            int _nearest = 0;
+            if (_lengthSquared > 0)
+            {
+                int _projection = 0;
+                for (int _channel = 0; _channel < 4; ++_channel)
+                {
+                    _projection += (_color[_channel] - candidate.Endpoints[0][_channel]) * _direction[_channel];
+                }
+                const int _weight = std::clamp((_projection * 64 + _lengthSquared / 2) / _lengthSquared, 0, 64);
+                _nearest = BC7_WEIGHT_INDEX[_weight];
+            }
+
+            int _bestError = std::numeric_limits<int>::max();
+            for (int _index = std::max(_nearest - 1, 0); _index <= std::min(_nearest + 1, 15); ++_index)
+            {
+                int _texelError = 0;
+                for (int _channel = 0; _channel < 4; ++_channel)
+                {
+                    const int _delta = _palette[_index][_channel] - _color[_channel];
+                    _texelError += _delta * _delta;
+                }
+                if (_texelError < _bestError)
+                {
+                    _bestError = _texelError;
+                    candidate.Indices[_texel] = static_cast<uint8_t>(_index);
+                }
+            }
+            _error += _bestError;
+        }
+        candidate.Error = _error;
+        return _error;
+    }
+
+    // Quantises both float endpoints with every p-bit combination and keeps the best one in best
+    void TryBC7Endpoints(const uint8_t* rgba, const float first[4], const float second[4], BC7Candidate& best)
+    {
+        for (int _p0 = 0; _p0 < 2; ++_p0)
+        {
+            for (int _p1 = 0; _p1 < 2; ++_p1)
+            {
+                BC7Candidate _candidate;
+                _candidate.PBits[0] = _p0;
+                _candidate.PBits[1] = _p1;
+                for (int _channel = 0; _channel < 4; ++_channel)
+                {
+                    _candidate.Endpoints[0][_channel] = QuantizeEndpoint(first[_channel], _p0);
+                    _candidate.Endpoints[1][_channel] = QuantizeEndpoint(second[_channel], _p1);
+                }
+                if (EvaluateBC7(rgba, _candidate) < best.Error)
+                {
+                    best = _candidate;
+                }
+            }
+        }
+    }
+
+    // Least-squares endpoints for fixed indices, false when every texel picked the same weight
+    bool RefitBC7Endpoints(const uint8_t* rgba, const uint8_t indices[TEXELS], float first[4], float second[4])
+    {
+        float _aa = 0.0f, _ab = 0.0f, _bb = 0.0f;
+        float _ax[4] = {}, _bx[4] = {};
+        for (int _texel = 0; _texel < TEXELS; ++_texel)
+        {
+            const float _b = static_cast<float>(BC7_WEIGHTS[indices[_texel]]) / 64.0f;
+            const float _a = 1.0f - _b;
+            _aa += _a * _a;
+            _ab += _a * _b;
+            _bb += _b * _b;
+            for (int _channel = 0; _channel < 4; ++_channel)
+            {
+                _ax[_channel] += _a * rgba[_texel * 4 + _channel];
+                _bx[_channel] += _b * rgba[_texel * 4 + _channel];
+            }
+        }
+
+        const float _determinant = _aa * _bb - _ab * _ab;
+        if (std::abs(_determinant) < 1e-6f)
+        {
+            return false;
+        }
+        const float _inverse = 1.0f / _determinant;
+        for (int _channel = 0; _channel < 4; ++_channel)
+        {
+            first[_channel] = std::clamp((_bb * _ax[_channel] - _ab * _bx[_channel]) * _inverse, 0.0f, 255.0f);
+            second[_channel] = std::clamp((_aa * _bx[_channel] - _ab * _ax[_channel]) * _inverse, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    // Endpoints at the extremes of the block along its principal axis
+    void FindBC7Endpoints(const uint8_t* rgba, float first[4], float second[4])
+    {
+        float _mean[4] = {};
+        float _min[4] = {255.0f, 255.0f, 255.0f, 255.0f};
+        float _max[4] = {};
+        for (int _texel = 0; _texel < TEXELS; ++_texel)
+        {
+            for (int _channel = 0; _channel < 4; ++_channel)
+            {
+                const float _value = rgba[_texel * 4 + _channel];
+                _mean[_channel] += _value;
+                _min[_channel] = std::min(_min[_channel], _value);
+                _max[_channel] = std::max(_max[_channel], _value);
+            }
+        }
+
+        float _covariance[4][4] = {};
+        for (int _channel = 0; _channel < 4; ++_channel)
+        {
+            _mean[_channel] /= TEXELS;
+        }
+        for (int _texel = 0; _texel < TEXELS; ++_texel)
+        {
+            float _delta[4];
+            for (int _channel = 0; _channel < 4; ++_channel)
+            {
+                _delta[_channel] = rgba[_texel * 4 + _channel] - _mean[_channel];
+            }
+            for (int _row = 0; _row < 4; ++_row)
+            {
+                for (int _column = 0; _column < 4; ++_column)
+                {
+                    _covariance[_row][_column] += _delta[_row] * _delta[_column];
+                }
+            }
+        }
+
+        // Power iteration, seeded with the bounding box diagonal which is usually close already
+        float _axis[4];
+        for (int _channel = 0; _channel < 4; ++_channel)
+        {
+            _axis[_channel] = _max[_channel] - _min[_channel];
+        }
+        for (int _iteration = 0; _iteration < POWER_ITERATIONS; ++_iteration)
+        {
+            float _next[4] = {};
+            float _length = 0.0f;
+            for (int _row = 0; _row < 4; ++_row)
+            {
+                for (int _column = 0; _column < 4; ++_column)
+                {
+                    _next[_row] += _covariance[_row][_column] * _axis[_column];
+                }
+                _length = std::max(_length, std::abs(_next[_row]));
+            }
+            if (_length < 1e-6f)
+            {
+                break;
+            }
+            for (int _channel = 0; _channel < 4; ++_channel)
+            {
+                _axis[_channel] = _next[_channel] / _length;
+            }
+        }
+
+        const float _axisLength = std::sqrt(_axis[0] * _axis[0] + _axis[1] * _axis[1] + _axis[2] * _axis[2] +
+                                            _axis[3] * _axis[3]);
+        if (_axisLength < 1e-6f)
+        {
+            // Flat block
+            std::memcpy(first, _mean, sizeof(_mean));
+            std::memcpy(second, _mean, sizeof(_mean));
+            return;
+        }
+
+        float _minProjection = std::numeric_limits<float>::max();
+        float _maxProjection = std::numeric_limits<float>::lowest();
+        for (int _texel = 0; _texel < TEXELS; ++_texel)
+        {
+            float _projection = 0.0f;
+            for (int _channel = 0; _channel < 4; ++_channel)
+            {
+                _projection += (rgba[_texel * 4 + _channel] - _mean[_channel]) * _axis[_channel] / _axisLength;
+            }
+            _minProjection = std::min(_minProjection, _projection);
+            _maxProjection = std::max(_maxProjection, _projection);
+        }
+
+        for (int _channel = 0; _channel < 4; ++_channel)
+        {
+            const float _direction = _axis[_channel] / _axisLength;
+            first[_channel] = std::clamp(_mean[_channel] + _direction * _minProjection, 0.0f, 255.0f);
+            second[_channel] = std::clamp(_mean[_channel] + _direction * _maxProjection, 0.0f, 255.0f);
+        }
+    }
+
+    // Gathers the 4x4 block at (blockX, blockY), clamping to the last row and column
+    void LoadBlock(const uint8_t* rgba, const uint32_t width, const uint32_t height, const uint32_t blockX,
+                   const uint32_t blockY, uint8_t block[64])
+    {
+        for (uint32_t _y = 0; _y < 4; ++_y)
+        {
+            const uint32_t _sourceY = std::min(blockY * 4 + _y, height - 1);
+            for (uint32_t _x = 0; _x < 4; ++_x)
+            {
+                const uint32_t _sourceX = std::min(blockX * 4 + _x, width - 1);
+                std::memcpy(block + (_y * 4 + _x) * 4, rgba + (size_t(_sourceY) * width + _sourceX) * 4, 4);
+            }
+        }
+    }
+}
+
+namespace Thryve::Rendering {
+    uint32_t BlockCompression::GetBlockBytes(const BlockFormat format)
+    {
+        return format == BlockFormat::BC4 ? 8 : 16;
+    }
+
+    uint64_t BlockCompression::GetCompressedSize(const BlockFormat format, const uint32_t width, const uint32_t height)
+    {
+        const uint64_t _blocksX = (width + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+        const uint64_t _blocksY = (height + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+        return _blocksX * _blocksY * GetBlockBytes(format);
+    }
+
+    void BlockCompression::Compress(const BlockFormat format, const uint8_t* rgba, const uint32_t width,
+                                    const uint32_t height, std::byte* output)
+    {
+        PROFILE_FUNCTION()
+        if (width == 0 || height == 0)
+        {
+            throw std::invalid_argument("Cannot block compress an empty image");
+        }
+
+        const uint32_t _blocksX = (width + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+        const uint32_t _blocksY = (height + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+        const uint32_t _blockBytes = GetBlockBytes(format);
+
+        auto _jobSystem = Core::ServiceRegistry::GetService<Core::JobSystem>();
+        _jobSystem->ParallelFor(_blocksY, BLOCK_ROWS_PER_JOB, [&](const uint32_t begin, const uint32_t end) {
+            uint8_t _block[64];
+            uint8_t _red[TEXELS];
+            for (uint32_t _blockY = begin; _blockY < end; ++_blockY)
+            {
+                for (uint32_t _blockX = 0; _blockX < _blocksX; ++_blockX)
+                {
+                    LoadBlock(rgba, width, height, _blockX, _blockY, _block);
+                    std::byte* _output = output + (size_t(_blockY) * _blocksX + _blockX) * _blockBytes;
+                    switch (format)
+                    {
+                    case BlockFormat::BC4:
+                        for (int _texel = 0; _texel < TEXELS; ++_texel)
+                        {
+                            _red[_texel] = _block[_texel * 4];
+                        }
+                        EncodeBC4Block(_red, _output);
+                        break;
+                    case BlockFormat::BC5:
+                        EncodeBC5Block(_block, _output);
+                        break;
+                    case BlockFormat::BC7:
+                        EncodeBC7Block(_block, _output);
+                        break;
+                    }
+                }
+            }
+        });
+    }
+
+    void BlockCompression::EncodeBC4Block(const uint8_t values[16], std::byte output[8])
+    {
+        const auto [_minIt, _maxIt] = std::minmax_element(values, values + TEXELS);
+        const int _first = *_maxIt;
+        const int _second = *_minIt;
+
+        // first > second selects the eight value mode, indices 0 and 1 are the endpoints and 2..7 step from
+        // first to second. A flat block leaves every index at 0.
+        int _palette[8] = {_first, _second};
+        for (int _index = 2; _index < 8; ++_index)
+        {
+            _palette[_index] = ((8 - _index) * _first + (_index - 1) * _second) / 7;
+        }
+
+        uint64_t _indexBits = 0;
+        if (_first != _second)
+        {
+            for (int _texel = 0; _texel < TEXELS; ++_texel)
+            {
+                int _bestIndex = 0;
+                int _bestError = std::numeric_limits<int>::max();
+                for (int _index = 0; _index < 8; ++_index)
+                {
+                    const int _error = std::abs(_palette[_index] - values[_texel]);
+                    if (_error < _bestError)
+                    {
+                        _bestError = _error;
+                        _bestIndex = _index;
+                    }
+                }
+                _indexBits |= uint64_t(_bestIndex) << (_texel * 3);
+            }
+        }
+
+        BitWriter _writer(output, 8);
+        _writer.Write(static_cast<uint32_t>(_first), 8);
+        _writer.Write(static_cast<uint32_t>(_second), 8);
+        _writer.Write(static_cast<uint32_t>(_indexBits & 0xFFFFFF), 24);
+        _writer.Write(static_cast<uint32_t>(_indexBits >> 24), 24);
+    }
+
+    void BlockCompression::EncodeBC5Block(const uint8_t rgba[64], std::byte output[16])
+    {
+        uint8_t _red[TEXELS];
+        uint8_t _green[TEXELS];
+        for (int _texel = 0; _texel < TEXELS; ++_texel)
+        {
+            _red[_texel] = rgba[_texel * 4];
+            _green[_texel] = rgba[_texel * 4 + 1];
+        }
+        EncodeBC4Block(_red, output);
+        EncodeBC4Block(_green, output + 8);
+    }
+
+    void BlockCompression::EncodeBC7Block(const uint8_t rgba[64], std::byte output[16])
+    {
+        float _first[4];
+        float _second[4];
+        FindBC7Endpoints(rgba, _first, _second);
+
+        BC7Candidate _best;
+        TryBC7Endpoints(rgba, _first, _second, _best);
+        for (int _pass = 0; _pass < REFINE_PASSES && _best.Error > 0; ++_pass)
+        {
+            const int64_t _previousError = _best.Error;
+            if (!RefitBC7Endpoints(rgba, _best.Indices, _first, _second))
+            {
+                break;
+            }
+            TryBC7Endpoints(rgba, _first, _second, _best);
+            if (_best.Error >= _previousError)
+            {
+                break;
+            }
+        }
+
+        // The top bit of the first index is implied zero, flip the endpoints when it would be set
+        if (_best.Indices[0] & 8)
+        {
+            std::swap(_best.Endpoints[0], _best.Endpoints[1]);
+            std::swap(_best.PBits[0], _best.PBits[1]);
+            for (uint8_t& _index : _best.Indices)
+            {
+                _index = static_cast<uint8_t>(15 - _index);
+            }
+        }
+
+        BitWriter _writer(output, 16);
+        _writer.Write(1u << 6, 7);
+        for (int _channel = 0; _channel < 4; ++_channel)
+        {
+            _writer.Write(static_cast<uint32_t>(_best.Endpoints[0][_channel] >> 1), 7);
+            _writer.Write(static_cast<uint32_t>(_best.Endpoints[1][_channel] >> 1), 7);
+        }
+        _writer.Write(static_cast<uint32_t>(_best.PBits[0]), 1);
+        _writer.Write(static_cast<uint32_t>(_best.PBits[1]), 1);
+        _writer.Write(_best.Indices[0], 3);
+        for (int _texel = 1; _texel < TEXELS; ++_texel)
+        {
+            _writer.Write(_best.Indices[_texel], 4);
+        }
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,644 @@
+#include "Renderer/BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <sstream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "Core/Log.h"
+#include "Core/Profiling.h"
+#include "Core/ServiceRegistry.h"
+#include "Renderer/FrustumCuller.h"
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+
+namespace {
+    using namespace Thryve::Rendering;
+
+    constexpr uint32_t NO_PARENT = UINT32_MAX;
+    constexpr uint32_t REDUCE_BATCH_SIZE = 16384;
+    constexpr float NO_HIT = std::numeric_limits<float>::max();
+
+    inline uint32_t GetBinIndex(const float centroid, const float min, const float scale)
+    {
+        return std::min(BoundingVolumeHierarchy::BIN_COUNT - 1, static_cast<uint32_t>((centroid - min) * scale));
+    }
+
+    // Slab test, the distance at which the ray enters box or NO_HIT
+    inline float IntersectRay(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin,
+                              const glm::vec3& inverseDirection)
+    {
+        const glm::vec3 _t1 = (min - origin) * inverseDirection;
+        const glm::vec3 _t2 = (max - origin) * inverseDirection;
+        const glm::vec3 _near = glm::min(_t1, _t2);
+        const glm::vec3 _far = glm::max(_t1, _t2);
+        const float _enter = std::max({_near.x, _near.y, _near.z, 0.0f});
+        const float _exit = std::min({_far.x, _far.y, _far.z});
+        return _enter <= _exit ? _enter : NO_HIT;
+    }
+
+    template <typename Func>
+    double TimeMilliseconds(const int repeats, Func&& func)
+    {
+        const auto _start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeats; ++i)
+        {
+            func();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count() / repeats;
+    }
+} // namespace
+
+namespace Thryve::Rendering {
+    BoundingVolumeHierarchy::BoundingVolumeHierarchy() :
+        m_jobSystem(Core::ServiceRegistry::GetService<Core::JobSystem>())
+    {
+    }
+
+    void BoundingVolumeHierarchy::Build(const std::span<const Aabb> bounds)
+    {
+        PROFILE_FUNCTION()
+        const auto _objectCount = static_cast<uint32_t>(bounds.size());
+        m_objectBounds.assign(bounds.begin(), bounds.end());
+        m_objectIndices.resize(_objectCount);
+        std::iota(m_objectIndices.begin(), m_objectIndices.end(), 0u);
+        m_leafOfObject.resize(_objectCount);
+        m_centroids.resize(_objectCount);
+        for (uint32_t i = 0; i < _objectCount; ++i)
+        {
+            m_centroids[i] = m_objectBounds[i].GetCenter();
+        }
+
+        // A binary tree with one object per leaf at most
+        const uint32_t _maxNodeCount = std::max(1u, 2 * _objectCount - 1);
+        m_nodes.resize(_maxNodeCount);
+        m_parents.resize(_maxNodeCount);
+        if (_objectCount == 0)
+        {
+            m_nodeCount = 0;
+            return;
+        }
+
+        const Aabb _rootBounds = ComputeBounds(0, _objectCount);
+        m_nodes[0] = {_rootBounds.Min, 0, _rootBounds.Max, _objectCount};
+        m_parents[0] = NO_PARENT;
+        m_nodeCount = 1;
+
+        Core::JobCounter _counter;
+        Subdivide(0, _counter);
+        m_jobSystem->Wait(_counter);
+
+        m_centroids.clear();
+        m_centroids.shrink_to_fit();
+    }
+
+    void BoundingVolumeHierarchy::Subdivide(const uint32_t nodeIndex, Core::JobCounter& counter)
+    {
+        BvhNode& _node = m_nodes[nodeIndex];
+        const uint32_t _first = _node.LeftFirst;
+        const uint32_t _count = _node.Count;
+        if (_count <= 1)
+        {
+            MakeLeaf(nodeIndex);
+            return;
+        }
+
+        Aabb _centroidBounds;
+        if (_count >= PARALLEL_BINNING_SIZE)
+        {
+            _centroidBounds = m_jobSystem->ParallelReduce(
+                _count, REDUCE_BATCH_SIZE, Aabb{},
+                [&](const uint32_t begin, const uint32_t end) {
+                    Aabb _partial;
+                    for (uint32_t i = _first + begin; i < _first + end; ++i)
+                    {
+                        _partial.Grow(m_centroids[m_objectIndices[i]]);
+                    }
+                    return _partial;
+                },
+                [](Aabb a, const Aabb& b) {
+                    a.Grow(b);
+                    return a;
+                });
+        }
+        else
+        {
+            for (uint32_t i = _first; i < _first + _count; ++i)
+            {
+                _centroidBounds.Grow(m_centroids[m_objectIndices[i]]);
+            }
+        }
+
+        const Split _split = FindSplit(_first, _count, _centroidBounds);
+        const float _leafCost = static_cast<float>(_count) * Aabb{_node.Min, _node.Max}.GetHalfArea();
+        if (_count <= MAX_LEAF_SIZE && (_split.Axis < 0 || _split.Cost >= _leafCost))
+        {
+            MakeLeaf(nodeIndex);
+            return;
+        }
+
+        uint32_t _leftCount;
+        Aabb _leftBounds;
+        Aabb _rightBounds;
+        if (_split.Axis >= 0)
+        {
+            // Same bin index as FillBins, so the counts match the ones the cost was computed from
+            const auto _axis = static_cast<glm::length_t>(_split.Axis);
+            const float _min = _centroidBounds.Min[_axis];
+            const float _scale = static_cast<float>(BIN_COUNT) / (_centroidBounds.Max[_axis] - _min);
+            const auto _middle = std::partition(
+                m_objectIndices.begin() + _first, m_objectIndices.begin() + _first + _count,
+                [&](const uint32_t object) {
+                    return GetBinIndex(m_centroids[object][_axis], _min, _scale) <= _split.Bin;
+                });
+            _leftCount = static_cast<uint32_t>(_middle - (m_objectIndices.begin() + _first));
+            _leftBounds = _split.LeftBounds;
+            _rightBounds = _split.RightBounds;
+        }
+        else
+        {
+            // Every centroid in one spot, any halves are as good as the other
+            _leftCount = _count / 2;
+            _leftBounds = ComputeBounds(_first, _leftCount);
+            _rightBounds = ComputeBounds(_first + _leftCount, _count - _leftCount);
+        }
+
+        const uint32_t _left = m_nodeCount.fetch_add(2, std::memory_order_relaxed);
+        m_nodes[_left] = {_leftBounds.Min, _first, _leftBounds.Max, _leftCount};
+        m_nodes[_left + 1] = {_rightBounds.Min, _first + _leftCount, _rightBounds.Max, _count - _leftCount};
+        m_parents[_left] = nodeIndex;
+        m_parents[_left + 1] = nodeIndex;
+        _node.LeftFirst = _left;
+        _node.Count = 0;
+
+        // Children always come after their parent, which Refit relies on
+        if (_count >= PARALLEL_SUBTREE_SIZE)
+        {
+            m_jobSystem->Run([this, _left, &counter] { Subdivide(_left, counter); }, &counter);
+        }
+        else
+        {
+            Subdivide(_left, counter);
+        }
+        Subdivide(_left + 1, counter);
+    }
+
+    void BoundingVolumeHierarchy::FillBins(const uint32_t begin, const uint32_t end, const Aabb& centroidBounds,
+                                           BinSet& bins) const
+    {
+        const glm::vec3 _extent = centroidBounds.Max - centroidBounds.Min;
+        glm::vec3 _scale(0.0f);
+        for (glm::length_t _axis = 0; _axis < 3; ++_axis)
+        {
+            if (_extent[_axis] > 0.0f)
+            {
+                _scale[_axis] = static_cast<float>(BIN_COUNT) / _extent[_axis];
+            }
+        }
+
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const uint32_t _object = m_objectIndices[i];
+            const glm::vec3& _centroid = m_centroids[_object];
+            for (glm::length_t _axis = 0; _axis < 3; ++_axis)
+            {
+                Bin& _bin = bins.Bins[_axis][GetBinIndex(_centroid[_axis], centroidBounds.Min[_axis], _scale[_axis])];
+                _bin.Bounds.Grow(m_objectBounds[_object]);
+                ++_bin.Count;
+            }
+        }
+    }
+
+    BoundingVolumeHierarchy::Split BoundingVolumeHierarchy::FindSplit(const uint32_t first, const uint32_t count,
+                                                                      const Aabb& centroidBounds)
+    {
+        BinSet _bins;
+        if (count >= PARALLEL_BINNING_SIZE)
+        {
+            _bins = m_jobSystem->ParallelReduce(
+                count, REDUCE_BATCH_SIZE, BinSet{},
+                [&](const uint32_t begin, const uint32_t end) {
+                    BinSet _partial;
+                    FillBins(first + begin, first + end, centroidBounds, _partial);
+                    return _partial;
+                },
+                [](BinSet a, const BinSet& b) {
+                    for (uint32_t _axis = 0; _axis < 3; ++_axis)
+                    {
+                        for (uint32_t _bin = 0; _bin < BIN_COUNT; ++_bin)
+                        {
+                            a.Bins[_axis][_bin].Bounds.Grow(b.Bins[_axis][_bin].Bounds);
+                            a.Bins[_axis][_bin].Count += b.Bins[_axis][_bin].Count;
+                        }
+                    }
+                    return a;
+                });
+        }
+        else
+        {
+            FillBins(first, first + count, centroidBounds, _bins);
+        }
+
+        Split _best;
+        const glm::vec3 _extent = centroidBounds.Max - centroidBounds.Min;
+        for (glm::length_t _axis = 0; _axis < 3; ++_axis)
+        {
+            if (_extent[_axis] <= 0.0f)
+            {
+                continue;
+            }
+
+            // Sweep from the left storing what every split leaves on that side, then from the right
+            const Bin* _axisBins = _bins.Bins[_axis];
+            Aabb _leftBounds[BIN_COUNT - 1];
+            uint32_t _leftCounts[BIN_COUNT - 1];
+            Aabb _left;
+            uint32_t _leftCount = 0;
+            for (uint32_t _bin = 0; _bin < BIN_COUNT - 1; ++_bin)
+            {
+                _left.Grow(_axisBins[_bin].Bounds);
+                _leftCount += _axisBins[_bin].Count;
+                _leftBounds[_bin] = _left;
+                _leftCounts[_bin] = _leftCount;
+            }
+
+            Aabb _right;
+            uint32_t _rightCount = 0;
+            for (uint32_t _bin = BIN_COUNT - 1; _bin > 0; --_bin)
+            {
+                _right.Grow(_axisBins[_bin].Bounds);
+                _rightCount += _axisBins[_bin].Count;
+                const uint32_t _splitBin = _bin - 1;
+                if (_leftCounts[_splitBin] == 0 || _rightCount == 0)
+                {
+                    continue;
+                }
+
+                const float _cost = static_cast<float>(_leftCounts[_splitBin]) * _leftBounds[_splitBin].GetHalfArea() +
+                                    static_cast<float>(_rightCount) * _right.GetHalfArea();
+                if (_cost < _best.Cost)
+                {
+                    _best = {static_cast<int>(_axis), _splitBin, _cost, _leftBounds[_splitBin], _right};
+                }
+            }
+        }
+        return _best;
+    }
+
+    Aabb BoundingVolumeHierarchy::ComputeBounds(const uint32_t first, const uint32_t count)
+    {
+        const auto _grow = [this](const uint32_t begin, const uint32_t end) {
+            Aabb _bounds;
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                _bounds.Grow(m_objectBounds[m_objectIndices[i]]);
+            }
+            return _bounds;
+        };
+
+        if (count < PARALLEL_BINNING_SIZE)
+        {
+            return _grow(first, first + count);
+        }
+        return m_jobSystem->ParallelReduce(
+            count, REDUCE_BATCH_SIZE, Aabb{},
+            [&](const uint32_t begin, const uint32_t end) { return _grow(first + begin, first + end); },
+            [](Aabb a, const Aabb& b) {
+                a.Grow(b);
+                return a;
+            });
+    }
+
+    void BoundingVolumeHierarchy::MakeLeaf(const uint32_t nodeIndex)
+    {
+        const BvhNode& _node = m_nodes[nodeIndex];
+        for (uint32_t i = _node.LeftFirst; i < _node.LeftFirst + _node.Count; ++i)
+        {
+            m_leafOfObject[m_objectIndices[i]] = nodeIndex;
+        }
+    }
+
+    bool BoundingVolumeHierarchy::RefitNode(const uint32_t nodeIndex)
+    {
+        BvhNode& _node = m_nodes[nodeIndex];
+        Aabb _bounds;
+        if (_node.IsLeaf())
+        {
+            for (uint32_t i = _node.LeftFirst; i < _node.LeftFirst + _node.Count; ++i)
+            {
+                _bounds.Grow(m_objectBounds[m_objectIndices[i]]);
+            }
+        }
+        else
+        {
+            const BvhNode& _left = m_nodes[_node.LeftFirst];
+            const BvhNode& _right = m_nodes[_node.LeftFirst + 1];
+            _bounds = {glm::min(_left.Min, _right.Min), glm::max(_left.Max, _right.Max)};
+        }
+
+        const bool _bChanged = _bounds.Min != _node.Min || _bounds.Max != _node.Max;
+        _node.Min = _bounds.Min;
+        _node.Max = _bounds.Max;
+        return _bChanged;
+    }
+
+    void BoundingVolumeHierarchy::Refit(const std::span<const Aabb> bounds)
+    {
+        PROFILE_FUNCTION()
+        if (bounds.size() != m_objectBounds.size())
+        {
+            throw std::invalid_argument("Refitting a bounding volume hierarchy with " + std::to_string(bounds.size()) +
+                                        " objects that was built with " + std::to_string(m_objectBounds.size()));
+        }
+
+        std::copy(bounds.begin(), bounds.end(), m_objectBounds.begin());
+        // Children come after their parents, so walking backwards visits them first
+        for (uint32_t _node = m_nodeCount; _node-- > 0;)
+        {
+            RefitNode(_node);
+        }
+    }
+
+    void BoundingVolumeHierarchy::UpdateObject(const uint32_t object, const Aabb& bounds)
+    {
+        m_objectBounds[object] = bounds;
+        uint32_t _node = m_leafOfObject[object];
+        while (_node != NO_PARENT && RefitNode(_node))
+        {
+            _node = m_parents[_node];
+        }
+    }
+
+    void BoundingVolumeHierarchy::AppendSubtree(const uint32_t nodeIndex, std::vector<uint32_t>& visible) const
+    {
+        // A subtree covers one contiguous range of the object list, from its leftmost to its rightmost leaf
+        uint32_t _leftmost = nodeIndex;
+        while (!m_nodes[_leftmost].IsLeaf())
+        {
+            _leftmost = m_nodes[_leftmost].LeftFirst;
+        }
+        uint32_t _rightmost = nodeIndex;
+        while (!m_nodes[_rightmost].IsLeaf())
+        {
+            _rightmost = m_nodes[_rightmost].LeftFirst + 1;
+        }
+
+        const auto _begin = m_objectIndices.begin() + m_nodes[_leftmost].LeftFirst;
+        const auto _end = m_objectIndices.begin() + m_nodes[_rightmost].LeftFirst + m_nodes[_rightmost].Count;
+        visible.insert(visible.end(), _begin, _end);
+    }
+
+    void BoundingVolumeHierarchy::Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const
+    {
+        PROFILE_FUNCTION()
+        visible.clear();
+        if (m_nodeCount == 0)
+        {
+            return;
+        }
+
+        struct StackEntry {
+            uint32_t Node;
+            // Planes the node is not entirely inside of yet, its children skip the others
+            uint32_t PlaneMask;
+        };
+        std::vector<StackEntry> _stack;
+        _stack.reserve(64);
+        _stack.push_back({0, (1u << Frustum::PlaneCount) - 1});
+
+        while (!_stack.empty())
+        {
+            auto [_nodeIndex, _planeMask] = _stack.back();
+            _stack.pop_back();
+            const BvhNode& _node = m_nodes[_nodeIndex];
+
+            const glm::vec3 _center = 0.5f * (_node.Min + _node.Max);
+            const glm::vec3 _extents = 0.5f * (_node.Max - _node.Min);
+            bool _bOutside = false;
+            for (uint32_t _plane = 0; _plane < Frustum::PlaneCount && !_bOutside; ++_plane)
+            {
+                if ((_planeMask & (1u << _plane)) == 0)
+                {
+                    continue;
+                }
+                const glm::vec3 _normal(frustum.Planes[_plane]);
+                const float _distance = glm::dot(_normal, _center) + frustum.Planes[_plane].w;
+                const float _radius = glm::dot(glm::abs(_normal), _extents);
+                _bOutside = _distance < -_radius;
+                if (_distance >= _radius)
+                {
+                    _planeMask &= ~(1u << _plane);
+                }
+            }
+
+            if (_bOutside)
+            {
+                continue;
+            }
+            if (_planeMask == 0)
+            {
+                AppendSubtree(_nodeIndex, visible);
+            }
+            else if (_node.IsLeaf())
+            {
+                for (uint32_t i = _node.LeftFirst; i < _node.LeftFirst + _node.Count; ++i)
+                {
+                    const Aabb& _bounds = m_objectBounds[m_objectIndices[i]];
+                    if (frustum.IntersectsBox(_bounds.GetCenter(), _bounds.GetExtents()))
+                    {
+                        visible.push_back(m_objectIndices[i]);
+                    }
+                }
+            }
+            else
+            {
+                _stack.push_back({_node.LeftFirst, _planeMask});
+                _stack.push_back({_node.LeftFirst + 1, _planeMask});
+            }
+        }
+    }
+
+    std::optional<BvhHit> BoundingVolumeHierarchy::Raycast(const Core::Ray& ray, const float maxDistance) const
+    {
+        if (m_nodeCount == 0)
+        {
+            return std::nullopt;
+        }
+
+        const glm::vec3 _inverseDirection = 1.0f / ray.Direction;
+        std::optional<BvhHit> _hit;
+        float _closest = maxDistance;
+
+        struct StackEntry {
+            uint32_t Node;
+            float Distance;
+        };
+        std::vector<StackEntry> _stack;
+        _stack.reserve(64);
+        _stack.push_back({0, IntersectRay(m_nodes[0].Min, m_nodes[0].Max, ray.Origin, _inverseDirection)});
+
+        while (!_stack.empty())
+        {
+            const StackEntry _entry = _stack.back();
+            _stack.pop_back();
+            // Something closer was hit since the node was pushed
+            if (_entry.Distance >= _closest)
+            {
+                continue;
+            }
+
+            const BvhNode& _node = m_nodes[_entry.Node];
+            if (_node.IsLeaf())
+            {
+                for (uint32_t i = _node.LeftFirst; i < _node.LeftFirst + _node.Count; ++i)
+                {
+                    const uint32_t _object = m_objectIndices[i];
+                    const float _distance = IntersectRay(m_objectBounds[_object].Min, m_objectBounds[_object].Max,
+                                                         ray.Origin, _inverseDirection);
+                    if (_distance < _closest)
+                    {
+                        _closest = _distance;
+                        _hit = BvhHit{_object, _distance};
+                    }
+                }
+                continue;
+            }
+
+            // Nearer child on top, so it is visited first and can prune the other one
+            StackEntry _left{_node.LeftFirst, IntersectRay(m_nodes[_node.LeftFirst].Min, m_nodes[_node.LeftFirst].Max,
+                                                           ray.Origin, _inverseDirection)};
+            StackEntry _right{_node.LeftFirst + 1,
+                              IntersectRay(m_nodes[_node.LeftFirst + 1].Min, m_nodes[_node.LeftFirst + 1].Max,
+                                           ray.Origin, _inverseDirection)};
+            if (_left.Distance > _right.Distance)
+            {
+                std::swap(_left, _right);
+            }
+            if (_right.Distance < _closest)
+            {
+                _stack.push_back(_right);
+            }
+            if (_left.Distance < _closest)
+            {
+                _stack.push_back(_left);
+            }
+        }
+        return _hit;
+    }
+
+    void BoundingVolumeHierarchy::RunBenchmark()
+    {
+        PROFILE_FUNCTION()
+        // Same scene as FrustumCuller::RunBenchmark, looking down -z from the middle of the objects
+        const glm::mat4 _projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+        const glm::mat4 _view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        const Frustum _frustum = Frustum::FromViewProjection(_projection * _view);
+
+        constexpr std::array<uint32_t, 3> OBJECT_COUNTS = {10'000, 100'000, 1'000'000};
+        constexpr uint32_t RAY_COUNT = 1000;
+        // Rays checked against testing every object, the rest is only timed
+        constexpr uint32_t CHECKED_RAY_COUNT = 32;
+        for (const uint32_t _objectCount : OBJECT_COUNTS)
+        {
+            std::mt19937 _random(_objectCount);
+            std::uniform_real_distribution<float> _position(-1000.0f, 1000.0f);
+            std::uniform_real_distribution<float> _size(0.5f, 8.0f);
+            std::uniform_real_distribution<float> _jitter(-1.0f, 1.0f);
+
+            std::vector<Aabb> _bounds(_objectCount);
+            for (Aabb& _box : _bounds)
+            {
+                const glm::vec3 _center(_position(_random), _position(_random), _position(_random));
+                const glm::vec3 _extents(_size(_random), _size(_random), _size(_random));
+                _box = {_center - _extents, _center + _extents};
+            }
+            // Every object drifts a little, as animated ones do between frames
+            std::vector<Aabb> _moved = _bounds;
+            for (Aabb& _box : _moved)
+            {
+                const glm::vec3 _offset(_jitter(_random), _jitter(_random), _jitter(_random));
+                _box = {_box.Min + _offset, _box.Max + _offset};
+            }
+
+            BoundingVolumeHierarchy _bvh;
+            const double _buildMilliseconds = TimeMilliseconds(4, [&] { _bvh.Build(_bounds); });
+            const double _refitMilliseconds = TimeMilliseconds(4, [&] { _bvh.Refit(_moved); });
+            // A hundredth of the objects moving on their own
+            const uint32_t _updateCount = std::max(1u, _objectCount / 100);
+            const double _updateMilliseconds = TimeMilliseconds(4, [&] {
+                for (uint32_t i = 0; i < _updateCount; ++i)
+                {
+                    const uint32_t _object = i * 100 % _objectCount;
+                    _bvh.UpdateObject(_object, _bounds[_object]);
+                }
+            });
+            _bvh.Refit(_moved);
+
+            std::vector<uint32_t> _visible;
+            const double _cullMilliseconds = TimeMilliseconds(16, [&] { _bvh.Cull(_frustum, _visible); });
+
+            BoxBoundsSoA _flatBounds;
+            _flatBounds.Reserve(_objectCount);
+            for (const Aabb& _box : _moved)
+            {
+                _flatBounds.Add(_box.Min, _box.Max);
+            }
+            FrustumCuller _flatCuller;
+            std::vector<uint32_t> _flatVisible;
+            _flatCuller.Cull(_frustum, _flatBounds, _flatVisible);
+            const double _flatMilliseconds =
+                TimeMilliseconds(16, [&] { _flatCuller.Cull(_frustum, _flatBounds, _flatVisible); });
+            std::sort(_visible.begin(), _visible.end());
+            if (_visible != _flatVisible)
+            {
+                throw std::runtime_error("Hierarchical culling of " + std::to_string(_objectCount) +
+                                         " objects disagrees with the FrustumCuller");
+            }
+
+            std::uniform_real_distribution<float> _direction(-1.0f, 1.0f);
+            std::vector<Core::Ray> _rays(RAY_COUNT);
+            for (Core::Ray& _ray : _rays)
+            {
+                _ray = {glm::vec3(0.0f), glm::normalize(glm::vec3(_direction(_random), _direction(_random),
+                                                                  _direction(_random)))};
+            }
+            uint32_t _hitCount = 0;
+            const double _pickMilliseconds = TimeMilliseconds(1, [&] {
+                for (const Core::Ray& _ray : _rays)
+                {
+                    _hitCount += _bvh.Raycast(_ray).has_value() ? 1 : 0;
+                }
+            });
+            for (uint32_t _rayIndex = 0; _rayIndex < CHECKED_RAY_COUNT; ++_rayIndex)
+            {
+                const Core::Ray& _ray = _rays[_rayIndex];
+                const glm::vec3 _inverseDirection = 1.0f / _ray.Direction;
+                float _closest = NO_HIT;
+                for (const Aabb& _box : _moved)
+                {
+                    _closest = std::min(_closest, IntersectRay(_box.Min, _box.Max, _ray.Origin, _inverseDirection));
+                }
+                const std::optional<BvhHit> _hit = _bvh.Raycast(_ray);
+                if (_hit.has_value() != (_closest != NO_HIT) || (_hit && _hit->Distance != _closest))
+                {
+                    throw std::runtime_error("Picking through the bounding volume hierarchy of " +
+                                             std::to_string(_objectCount) + " objects missed the nearest hit");
+                }
+            }
+
+            std::ostringstream _message;
+            _message << "BVH over " << _objectCount << " objects, " << _bvh.GetNodeCount() << " nodes: build "
+                     << _buildMilliseconds << " ms, refit " << _refitMilliseconds << " ms, update "
+                     << _updateCount << " objects " << _updateMilliseconds << " ms, cull " << _cullMilliseconds
+                     << " ms (flat " << FrustumCuller::GetPathName(_flatCuller.GetPath()) << " "
+                     << _flatMilliseconds << " ms, " << _visible.size() << " visible), pick "
+                     << _pickMilliseconds * 1000.0 / RAY_COUNT << " us per ray (" << _hitCount << " of "
+                     << RAY_COUNT << " hit)";
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(_message.str());
+        }
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,111 @@
+#include "Renderer/Frustum.h"
+
+#include <algorithm>
+
+namespace Thryve::Rendering {
+    BoundingSphere BoundingSphere::FromVertices(const std::span<const Vertex3D> vertices)
+    {
+        if (vertices.empty())
+        {
+            return {};
+        }
+
+        glm::vec3 _min = vertices.front().pos;
+        glm::vec3 _max = _min;
+        for (const Vertex3D& _vertex : vertices)
+        {
+            _min = glm::min(_min, _vertex.pos);
+            _max = glm::max(_max, _vertex.pos);
+        }
+
+        BoundingSphere _sphere;
+        _sphere.Center = 0.5f * (_min + _max);
+        _sphere.Radius = 0.5f * glm::length(_max - _min);
+        return _sphere;
+    }
+
+    BoundingSphere BoundingSphere::Transform(const glm::mat4& transform) const
+    {
+        const float _scale = std::max({glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])),
+                                       glm::length(glm::vec3(transform[2]))});
+
+        BoundingSphere _sphere;
+        _sphere.Center = glm::vec3(transform * glm::vec4(Center, 1.0f));
+        _sphere.Radius = Radius * _scale;
+        return _sphere;
+    }
+
+    Aabb Aabb::FromSphere(const BoundingSphere& sphere)
+    {
+        const glm::vec3 _radius(sphere.Radius);
+        return {sphere.Center - _radius, sphere.Center + _radius};
+    }
+
+    void Aabb::Grow(const glm::vec3& point)
+    {
+        Min = glm::min(Min, point);
+        Max = glm::max(Max, point);
+    }
+
+    void Aabb::Grow(const Aabb& box)
+    {
+        Min = glm::min(Min, box.Min);
+        Max = glm::max(Max, box.Max);
+    }
+
+    float Aabb::GetHalfArea() const
+    {
+        const glm::vec3 _size = Max - Min;
+        return _size.x * _size.y + _size.y * _size.z + _size.z * _size.x;
+    }
+
+    Frustum Frustum::FromViewProjection(const glm::mat4& viewProjection)
+    {
+        // Gribb-Hartmann, glm is column major so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+        const auto _row = [&viewProjection](const int row) {
+            return glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row],
+                             viewProjection[3][row]);
+        };
+
+        Frustum _frustum;
+        _frustum.Planes[Left] = _row(3) + _row(0);
+        _frustum.Planes[Right] = _row(3) - _row(0);
+        _frustum.Planes[Bottom] = _row(3) + _row(1);
+        _frustum.Planes[Top] = _row(3) - _row(1);
+        // Depth runs from 0 to w in Vulkan, not from -w
+        _frustum.Planes[Near] = _row(2);
+        _frustum.Planes[Far] = _row(3) - _row(2);
+
+        for (glm::vec4& _plane : _frustum.Planes)
+        {
+            _plane /= glm::length(glm::vec3(_plane));
+        }
+        return _frustum;
+    }
+
+    bool Frustum::IntersectsSphere(const glm::vec3& center, const float radius) const
+    {
+        for (const glm::vec4& _plane : Planes)
+        {
+            if (glm::dot(glm::vec3(_plane), center) + _plane.w < -radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Frustum::IntersectsBox(const glm::vec3& center, const glm::vec3& extents) const
+    {
+        for (const glm::vec4& _plane : Planes)
+        {
+            // Projected half size of the box onto the plane normal
+            const glm::vec3 _normal(_plane);
+            if (glm::dot(_normal, center) + _plane.w < -glm::dot(glm::abs(_normal), extents))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace Thryve::Rendering
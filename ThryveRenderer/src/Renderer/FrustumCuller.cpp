@@ -0,0 +1,516 @@
+#include "Renderer/FrustumCuller.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "Core/Log.h"
+#include "Core/Profiling.h"
+#include "Core/ServiceRegistry.h"
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define THRYVE_CULL_SIMD 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC compiles AVX intrinsics without /arch:AVX2, they are only called once the CPU is known to have them
+#define THRYVE_TARGET_AVX2
+#else
+#define THRYVE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define THRYVE_CULL_SIMD 0
+#endif
+
+namespace {
+    using namespace Thryve::Rendering;
+
+    // Every lane is written, only the visible ones advance the cursor, so there is no branch per object
+    inline uint32_t AppendVisible(uint32_t* visible, uint32_t count, const uint32_t first, const uint32_t mask,
+                                  const uint32_t lanes)
+    {
+        for (uint32_t _lane = 0; _lane < lanes; ++_lane)
+        {
+            visible[count] = first + _lane;
+            count += (mask >> _lane) & 1u;
+        }
+        return count;
+    }
+
+    uint32_t CullSpheresScalar(const Frustum& frustum, const SphereBoundsSoA& spheres, const uint32_t begin,
+                               const uint32_t end, uint32_t* visible, uint32_t count)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const glm::vec3 _center(spheres.CenterX[i], spheres.CenterY[i], spheres.CenterZ[i]);
+            visible[count] = i;
+            count += frustum.IntersectsSphere(_center, spheres.Radius[i]) ? 1 : 0;
+        }
+        return count;
+    }
+
+    uint32_t CullBoxesScalar(const Frustum& frustum, const BoxBoundsSoA& boxes, const uint32_t begin,
+                             const uint32_t end, uint32_t* visible, uint32_t count)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const glm::vec3 _center(boxes.CenterX[i], boxes.CenterY[i], boxes.CenterZ[i]);
+            const glm::vec3 _extents(boxes.ExtentX[i], boxes.ExtentY[i], boxes.ExtentZ[i]);
+            visible[count] = i;
+            count += frustum.IntersectsBox(_center, _extents) ? 1 : 0;
+        }
+        return count;
+    }
+
+    uint32_t CullSpheresChunkScalar(const Frustum& frustum, const void* bounds, const uint32_t begin,
+                                    const uint32_t end, uint32_t* visible)
+    {
+        return CullSpheresScalar(frustum, *static_cast<const SphereBoundsSoA*>(bounds), begin, end, visible, 0);
+    }
+
+    uint32_t CullBoxesChunkScalar(const Frustum& frustum, const void* bounds, const uint32_t begin,
+                                  const uint32_t end, uint32_t* visible)
+    {
+        return CullBoxesScalar(frustum, *static_cast<const BoxBoundsSoA*>(bounds), begin, end, visible, 0);
+    }
+
+#if THRYVE_CULL_SIMD
+    // The sums run in the same order as glm::dot in the scalar tests, so every path agrees bit for bit
+
+    uint32_t CullSpheresChunkSSE(const Frustum& frustum, const void* bounds, const uint32_t begin,
+                                 const uint32_t end, uint32_t* visible)
+    {
+        const auto& _spheres = *static_cast<const SphereBoundsSoA*>(bounds);
+        __m128 _planes[Frustum::PlaneCount][4];
+        for (uint32_t p = 0; p < Frustum::PlaneCount; ++p)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                _planes[p][c] = _mm_set1_ps(frustum.Planes[p][c]);
+            }
+        }
+        const __m128 _signMask = _mm_set1_ps(-0.0f);
+
+        uint32_t _count = 0;
+        uint32_t i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 _x = _mm_loadu_ps(_spheres.CenterX.data() + i);
+            const __m128 _y = _mm_loadu_ps(_spheres.CenterY.data() + i);
+            const __m128 _z = _mm_loadu_ps(_spheres.CenterZ.data() + i);
+            const __m128 _negativeRadius = _mm_xor_ps(_mm_loadu_ps(_spheres.Radius.data() + i), _signMask);
+
+            __m128 _inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const auto& _plane : _planes)
+            {
+                const __m128 _distance = _mm_add_ps(
+                    _mm_add_ps(_mm_add_ps(_mm_mul_ps(_plane[0], _x), _mm_mul_ps(_plane[1], _y)),
+                               _mm_mul_ps(_plane[2], _z)),
+                    _plane[3]);
+                _inside = _mm_and_ps(_inside, _mm_cmpge_ps(_distance, _negativeRadius));
+            }
+            _count = AppendVisible(visible, _count, i, static_cast<uint32_t>(_mm_movemask_ps(_inside)), 4);
+        }
+        return CullSpheresScalar(frustum, _spheres, i, end, visible, _count);
+    }
+
+    uint32_t CullBoxesChunkSSE(const Frustum& frustum, const void* bounds, const uint32_t begin, const uint32_t end,
+                               uint32_t* visible)
+    {
+        const auto& _boxes = *static_cast<const BoxBoundsSoA*>(bounds);
+        // Normal, its absolute value for the projected extent and the distance
+        __m128 _planes[Frustum::PlaneCount][7];
+        for (uint32_t p = 0; p < Frustum::PlaneCount; ++p)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                _planes[p][c] = _mm_set1_ps(frustum.Planes[p][c]);
+                _planes[p][c + 3] = _mm_set1_ps(std::abs(frustum.Planes[p][c]));
+            }
+            _planes[p][6] = _mm_set1_ps(frustum.Planes[p].w);
+        }
+        const __m128 _signMask = _mm_set1_ps(-0.0f);
+
+        uint32_t _count = 0;
+        uint32_t i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 _x = _mm_loadu_ps(_boxes.CenterX.data() + i);
+            const __m128 _y = _mm_loadu_ps(_boxes.CenterY.data() + i);
+            const __m128 _z = _mm_loadu_ps(_boxes.CenterZ.data() + i);
+            const __m128 _extentX = _mm_loadu_ps(_boxes.ExtentX.data() + i);
+            const __m128 _extentY = _mm_loadu_ps(_boxes.ExtentY.data() + i);
+            const __m128 _extentZ = _mm_loadu_ps(_boxes.ExtentZ.data() + i);
+
+            __m128 _inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const auto& _plane : _planes)
+            {
+                const __m128 _distance = _mm_add_ps(
+                    _mm_add_ps(_mm_add_ps(_mm_mul_ps(_plane[0], _x), _mm_mul_ps(_plane[1], _y)),
+                               _mm_mul_ps(_plane[2], _z)),
+                    _plane[6]);
+                const __m128 _projectedExtent = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_plane[3], _extentX), _mm_mul_ps(_plane[4], _extentY)),
+                    _mm_mul_ps(_plane[5], _extentZ));
+                _inside = _mm_and_ps(_inside, _mm_cmpge_ps(_distance, _mm_xor_ps(_projectedExtent, _signMask)));
+            }
+            _count = AppendVisible(visible, _count, i, static_cast<uint32_t>(_mm_movemask_ps(_inside)), 4);
+        }
+        return CullBoxesScalar(frustum, _boxes, i, end, visible, _count);
+    }
+
+    THRYVE_TARGET_AVX2 uint32_t CullSpheresChunkAVX2(const Frustum& frustum, const void* bounds,
+                                                     const uint32_t begin, const uint32_t end, uint32_t* visible)
+    {
+        const auto& _spheres = *static_cast<const SphereBoundsSoA*>(bounds);
+        __m256 _planes[Frustum::PlaneCount][4];
+        for (uint32_t p = 0; p < Frustum::PlaneCount; ++p)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                _planes[p][c] = _mm256_set1_ps(frustum.Planes[p][c]);
+            }
+        }
+        const __m256 _signMask = _mm256_set1_ps(-0.0f);
+
+        uint32_t _count = 0;
+        uint32_t i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            const __m256 _x = _mm256_loadu_ps(_spheres.CenterX.data() + i);
+            const __m256 _y = _mm256_loadu_ps(_spheres.CenterY.data() + i);
+            const __m256 _z = _mm256_loadu_ps(_spheres.CenterZ.data() + i);
+            const __m256 _negativeRadius = _mm256_xor_ps(_mm256_loadu_ps(_spheres.Radius.data() + i), _signMask);
+
+            __m256 _inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (const auto& _plane : _planes)
+            {
+                const __m256 _distance = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_plane[0], _x), _mm256_mul_ps(_plane[1], _y)),
+                                  _mm256_mul_ps(_plane[2], _z)),
+                    _plane[3]);
+                _inside = _mm256_and_ps(_inside, _mm256_cmp_ps(_distance, _negativeRadius, _CMP_GE_OQ));
+            }
+            _count = AppendVisible(visible, _count, i, static_cast<uint32_t>(_mm256_movemask_ps(_inside)), 8);
+        }
+        return CullSpheresScalar(frustum, _spheres, i, end, visible, _count);
+    }
+
+    THRYVE_TARGET_AVX2 uint32_t CullBoxesChunkAVX2(const Frustum& frustum, const void* bounds, const uint32_t begin,
+                                                   const uint32_t end, uint32_t* visible)
+    {
+        const auto& _boxes = *static_cast<const BoxBoundsSoA*>(bounds);
+        __m256 _planes[Frustum::PlaneCount][7];
+        for (uint32_t p = 0; p < Frustum::PlaneCount; ++p)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                _planes[p][c] = _mm256_set1_ps(frustum.Planes[p][c]);
+                _planes[p][c + 3] = _mm256_set1_ps(std::abs(frustum.Planes[p][c]));
+            }
+            _planes[p][6] = _mm256_set1_ps(frustum.Planes[p].w);
+        }
+        const __m256 _signMask = _mm256_set1_ps(-0.0f);
+
+        uint32_t _count = 0;
+        uint32_t i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            const __m256 _x = _mm256_loadu_ps(_boxes.CenterX.data() + i);
+            const __m256 _y = _mm256_loadu_ps(_boxes.CenterY.data() + i);
+            const __m256 _z = _mm256_loadu_ps(_boxes.CenterZ.data() + i);
+            const __m256 _extentX = _mm256_loadu_ps(_boxes.ExtentX.data() + i);
+            const __m256 _extentY = _mm256_loadu_ps(_boxes.ExtentY.data() + i);
+            const __m256 _extentZ = _mm256_loadu_ps(_boxes.ExtentZ.data() + i);
+
+            __m256 _inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (const auto& _plane : _planes)
+            {
+                const __m256 _distance = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_plane[0], _x), _mm256_mul_ps(_plane[1], _y)),
+                                  _mm256_mul_ps(_plane[2], _z)),
+                    _plane[6]);
+                const __m256 _projectedExtent = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(_plane[3], _extentX), _mm256_mul_ps(_plane[4], _extentY)),
+                    _mm256_mul_ps(_plane[5], _extentZ));
+                _inside = _mm256_and_ps(
+                    _inside, _mm256_cmp_ps(_distance, _mm256_xor_ps(_projectedExtent, _signMask), _CMP_GE_OQ));
+            }
+            _count = AppendVisible(visible, _count, i, static_cast<uint32_t>(_mm256_movemask_ps(_inside)), 8);
+        }
+        return CullBoxesScalar(frustum, _boxes, i, end, visible, _count);
+    }
+
+    bool SupportsAVX2()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int _info[4];
+        __cpuid(_info, 0);
+        if (_info[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(_info, 1);
+        // The OS has to save the YMM registers too
+        const bool _bOsSavesAvx = (_info[2] & (1 << 27)) && (_info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(_info, 7, 0);
+        return _bOsSavesAvx && (_info[1] & (1 << 5));
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    // Runs cull REPEATS times after a warm up run, which grows every list, and returns the average
+    template <typename Func>
+    double TimeMilliseconds(Func&& cull)
+    {
+        constexpr int REPEATS = 16;
+        cull();
+        const auto _start = std::chrono::steady_clock::now();
+        for (int i = 0; i < REPEATS; ++i)
+        {
+            cull();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count() / REPEATS;
+    }
+
+    template <typename Bounds, typename ReferenceFunc>
+    void BenchmarkBounds(const char* kind, const Frustum& frustum, const Bounds& bounds, ReferenceFunc&& reference)
+    {
+        std::vector<uint32_t> _reference;
+        const double _referenceMilliseconds = TimeMilliseconds([&] {
+            _reference.clear();
+            for (uint32_t i = 0; i < bounds.Size(); ++i)
+            {
+                if (reference(i))
+                {
+                    _reference.push_back(i);
+                }
+            }
+        });
+
+        std::ostringstream _message;
+        _message << "Frustum culling " << bounds.Size() << " " << kind << ", " << _reference.size()
+                 << " visible: scalar reference " << _referenceMilliseconds << " ms";
+        std::vector<uint32_t> _visible;
+        for (auto _path = static_cast<uint32_t>(CullingPath::Scalar);
+             _path <= static_cast<uint32_t>(FrustumCuller::GetBestPath()); ++_path)
+        {
+            FrustumCuller _culler(static_cast<CullingPath>(_path));
+            const double _milliseconds = TimeMilliseconds([&] { _culler.Cull(frustum, bounds, _visible); });
+            if (_visible != _reference)
+            {
+                throw std::runtime_error(std::string("Frustum culling of ") + kind + " on the " +
+                                         FrustumCuller::GetPathName(_culler.GetPath()) +
+                                         " path disagrees with the scalar reference");
+            }
+            _message << ", " << FrustumCuller::GetPathName(_culler.GetPath()) << " " << _milliseconds << " ms";
+        }
+        Thryve::Core::ServiceRegistry::GetService<Thryve::Core::DevelopmentLogger>()->LogInfo(_message.str());
+    }
+} // namespace
+
+namespace Thryve::Rendering {
+    void SphereBoundsSoA::Add(const BoundingSphere& sphere)
+    {
+        CenterX.push_back(sphere.Center.x);
+        CenterY.push_back(sphere.Center.y);
+        CenterZ.push_back(sphere.Center.z);
+        Radius.push_back(sphere.Radius);
+    }
+
+    void SphereBoundsSoA::Reserve(const uint32_t count)
+    {
+        CenterX.reserve(count);
+        CenterY.reserve(count);
+        CenterZ.reserve(count);
+        Radius.reserve(count);
+    }
+
+    void SphereBoundsSoA::Clear()
+    {
+        CenterX.clear();
+        CenterY.clear();
+        CenterZ.clear();
+        Radius.clear();
+    }
+
+    void BoxBoundsSoA::Add(const glm::vec3& min, const glm::vec3& max)
+    {
+        const glm::vec3 _center = 0.5f * (min + max);
+        const glm::vec3 _extents = 0.5f * (max - min);
+        CenterX.push_back(_center.x);
+        CenterY.push_back(_center.y);
+        CenterZ.push_back(_center.z);
+        ExtentX.push_back(_extents.x);
+        ExtentY.push_back(_extents.y);
+        ExtentZ.push_back(_extents.z);
+    }
+
+    void BoxBoundsSoA::Reserve(const uint32_t count)
+    {
+        CenterX.reserve(count);
+        CenterY.reserve(count);
+        CenterZ.reserve(count);
+        ExtentX.reserve(count);
+        ExtentY.reserve(count);
+        ExtentZ.reserve(count);
+    }
+
+    void BoxBoundsSoA::Clear()
+    {
+        CenterX.clear();
+        CenterY.clear();
+        CenterZ.clear();
+        ExtentX.clear();
+        ExtentY.clear();
+        ExtentZ.clear();
+    }
+
+    FrustumCuller::FrustumCuller(const CullingPath path) :
+        m_path(path), m_jobSystem(Core::ServiceRegistry::GetService<Core::JobSystem>())
+    {
+        if (static_cast<uint32_t>(path) > static_cast<uint32_t>(GetBestPath()))
+        {
+            throw std::invalid_argument(std::string("CPU does not support the ") + GetPathName(path) +
+                                        " culling path");
+        }
+    }
+
+    CullingPath FrustumCuller::GetBestPath()
+    {
+#if THRYVE_CULL_SIMD
+        static const CullingPath s_bestPath = SupportsAVX2() ? CullingPath::AVX2 : CullingPath::SSE;
+        return s_bestPath;
+#else
+        return CullingPath::Scalar;
+#endif
+    }
+
+    const char* FrustumCuller::GetPathName(const CullingPath path)
+    {
+        switch (path)
+        {
+        case CullingPath::Scalar:
+            return "Scalar";
+        case CullingPath::SSE:
+            return "SSE";
+        case CullingPath::AVX2:
+            return "AVX2";
+        }
+        return "Unknown";
+    }
+
+    void FrustumCuller::Cull(const Frustum& frustum, const SphereBoundsSoA& bounds, std::vector<uint32_t>& visible)
+    {
+        PROFILE_FUNCTION()
+        ChunkFunction _cullChunk = &CullSpheresChunkScalar;
+#if THRYVE_CULL_SIMD
+        if (m_path == CullingPath::SSE)
+        {
+            _cullChunk = &CullSpheresChunkSSE;
+        }
+        else if (m_path == CullingPath::AVX2)
+        {
+            _cullChunk = &CullSpheresChunkAVX2;
+        }
+#endif
+        CullChunks(frustum, &bounds, bounds.Size(), _cullChunk, visible);
+    }
+
+    void FrustumCuller::Cull(const Frustum& frustum, const BoxBoundsSoA& bounds, std::vector<uint32_t>& visible)
+    {
+        PROFILE_FUNCTION()
+        ChunkFunction _cullChunk = &CullBoxesChunkScalar;
+#if THRYVE_CULL_SIMD
+        if (m_path == CullingPath::SSE)
+        {
+            _cullChunk = &CullBoxesChunkSSE;
+        }
+        else if (m_path == CullingPath::AVX2)
+        {
+            _cullChunk = &CullBoxesChunkAVX2;
+        }
+#endif
+        CullChunks(frustum, &bounds, bounds.Size(), _cullChunk, visible);
+    }
+
+    void FrustumCuller::CullChunks(const Frustum& frustum, const void* bounds, const uint32_t count,
+                                   const ChunkFunction cullChunk, std::vector<uint32_t>& visible)
+    {
+        m_stats.TestedCount = count;
+        m_stats.ChunkCount = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        if (m_scratch.size() < count)
+        {
+            m_scratch.resize(count);
+        }
+        m_chunkVisibleCounts.resize(m_stats.ChunkCount);
+
+        uint32_t* _scratch = m_scratch.data();
+        uint32_t* _chunkVisibleCounts = m_chunkVisibleCounts.data();
+        m_jobSystem->ParallelFor(m_stats.ChunkCount, 1, [&](const uint32_t chunkBegin, const uint32_t chunkEnd) {
+            for (uint32_t _chunk = chunkBegin; _chunk < chunkEnd; ++_chunk)
+            {
+                const uint32_t _begin = _chunk * CHUNK_SIZE;
+                const uint32_t _end = std::min(count, _begin + CHUNK_SIZE);
+                _chunkVisibleCounts[_chunk] = cullChunk(frustum, bounds, _begin, _end, _scratch + _begin);
+            }
+        });
+
+        // Chunks are appended in order, so the list stays ascending
+        visible.clear();
+        for (uint32_t _chunk = 0; _chunk < m_stats.ChunkCount; ++_chunk)
+        {
+            const uint32_t* _chunkVisible = _scratch + _chunk * CHUNK_SIZE;
+            visible.insert(visible.end(), _chunkVisible, _chunkVisible + _chunkVisibleCounts[_chunk]);
+        }
+        m_stats.VisibleCount = static_cast<uint32_t>(visible.size());
+    }
+
+    void FrustumCuller::RunBenchmark()
+    {
+        PROFILE_FUNCTION()
+        // Looking down -z from the middle of the scattered objects, a small share of them ends up visible
+        const glm::mat4 _projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+        const glm::mat4 _view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        const Frustum _frustum = Frustum::FromViewProjection(_projection * _view);
+
+        constexpr std::array<uint32_t, 3> OBJECT_COUNTS = {10'000, 100'000, 1'000'000};
+        for (const uint32_t _objectCount : OBJECT_COUNTS)
+        {
+            // Same seed every run, so timings of different builds compare the same scene
+            std::mt19937 _random(_objectCount);
+            std::uniform_real_distribution<float> _position(-1000.0f, 1000.0f);
+            std::uniform_real_distribution<float> _size(0.5f, 8.0f);
+
+            SphereBoundsSoA _spheres;
+            BoxBoundsSoA _boxes;
+            _spheres.Reserve(_objectCount);
+            _boxes.Reserve(_objectCount);
+            for (uint32_t i = 0; i < _objectCount; ++i)
+            {
+                const glm::vec3 _center(_position(_random), _position(_random), _position(_random));
+                _spheres.Add({_center, _size(_random)});
+                const glm::vec3 _extents(_size(_random), _size(_random), _size(_random));
+                _boxes.Add(_center - _extents, _center + _extents);
+            }
+
+            BenchmarkBounds("spheres", _frustum, _spheres, [&](const uint32_t i) {
+                return _frustum.IntersectsSphere({_spheres.CenterX[i], _spheres.CenterY[i], _spheres.CenterZ[i]},
+                                                 _spheres.Radius[i]);
+            });
+            BenchmarkBounds("boxes", _frustum, _boxes, [&](const uint32_t i) {
+                return _frustum.IntersectsBox({_boxes.CenterX[i], _boxes.CenterY[i], _boxes.CenterZ[i]},
+                                              {_boxes.ExtentX[i], _boxes.ExtentY[i], _boxes.ExtentZ[i]});
+            });
+        }
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,247 @@
+#include "Renderer/Ktx2File.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include "Core/AtomicFile.h"
+#include "Core/Log.h"
+#include "Core/Profiling.h"
+#include "Core/ServiceRegistry.h"
+
+namespace {
+    constexpr uint64_t INDEX_OFFSET = sizeof(Thryve::Rendering::Ktx2File::IDENTIFIER) + sizeof(Thryve::Rendering::Ktx2Header);
+
+    // Khronos Data Format basic descriptor values, only the ones the BC formats need
+    constexpr uint32_t DF_VERSION = 2;
+    constexpr uint32_t DF_MODEL_BC4 = 131;
+    constexpr uint32_t DF_MODEL_BC5 = 132;
+    constexpr uint32_t DF_MODEL_BC7 = 134;
+    constexpr uint32_t DF_PRIMARIES_BT709 = 1;
+    constexpr uint32_t DF_TRANSFER_LINEAR = 1;
+    constexpr uint32_t DF_TRANSFER_SRGB = 2;
+    constexpr uint32_t DF_CHANNEL_RED = 0;
+    constexpr uint32_t DF_CHANNEL_GREEN = 1;
+
+    struct FormatDescription {
+        uint32_t ColorModel;
+        uint32_t BlockBytes;
+        bool bSrgb;
+    };
+
+    FormatDescription DescribeFormat(const VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            return {DF_MODEL_BC4, 8, false};
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            return {DF_MODEL_BC5, 16, false};
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            return {DF_MODEL_BC7, 16, false};
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return {DF_MODEL_BC7, 16, true};
+        default:
+            throw std::invalid_argument("KTX2 writer does not support VkFormat " + std::to_string(format));
+        }
+    }
+
+    std::vector<uint32_t> BuildDataFormatDescriptor(const FormatDescription& description)
+    {
+        // Sample: bit offset, bit length - 1 and channel, then position, lower and upper
+        std::vector<std::array<uint32_t, 4>> _samples;
+        const uint32_t _blockBits = description.BlockBytes * 8;
+        if (description.ColorModel == DF_MODEL_BC5)
+        {
+            _samples.push_back({0 | (63u << 16) | (DF_CHANNEL_RED << 24), 0, 0, UINT32_MAX});
+            _samples.push_back({64 | (63u << 16) | (DF_CHANNEL_GREEN << 24), 0, 0, UINT32_MAX});
+        }
+        else
+        {
+            _samples.push_back({0 | ((_blockBits - 1) << 16), 0, 0, UINT32_MAX});
+        }
+
+        const uint32_t _blockSize = 24 + 16 * static_cast<uint32_t>(_samples.size());
+        std::vector<uint32_t> _words = {
+            4 + _blockSize,
+            0, // vendor Khronos, basic descriptor type
+            DF_VERSION | (_blockSize << 16),
+            description.ColorModel | (DF_PRIMARIES_BT709 << 8) |
+                ((description.bSrgb ? DF_TRANSFER_SRGB : DF_TRANSFER_LINEAR) << 16),
+            3 | (3u << 8), // 4x4x1x1 texel block, stored minus one
+            description.BlockBytes,
+            0,
+        };
+        for (const auto& _sample : _samples)
+        {
+            _words.insert(_words.end(), _sample.begin(), _sample.end());
+        }
+        return _words;
+    }
+
+    uint64_t AlignUp(const uint64_t value, const uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+namespace Thryve::Rendering {
+    bool Ktx2File::Open(const std::string& path)
+    {
+        PROFILE_FUNCTION()
+        m_levels.clear();
+        m_keyValues.clear();
+        m_levelData = {};
+        if (!m_file.Open(path) || m_file.GetSize() < INDEX_OFFSET)
+        {
+            return false;
+        }
+
+        const std::byte* _data = m_file.GetData();
+        const size_t _size = m_file.GetSize();
+        std::memcpy(&m_header, _data + sizeof(IDENTIFIER), sizeof(m_header));
+        if (std::memcmp(_data, IDENTIFIER, sizeof(IDENTIFIER)) != 0 || m_header.TypeSize != 1 ||
+            m_header.PixelWidth == 0 || m_header.PixelHeight == 0 || m_header.PixelDepth != 0 ||
+            m_header.LayerCount > 1 || m_header.FaceCount != 1 || m_header.LevelCount == 0 ||
+            m_header.SupercompressionScheme != 0 ||
+            INDEX_OFFSET + uint64_t(m_header.LevelCount) * sizeof(Ktx2LevelIndex) > _size)
+        {
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogWarning(
+                path + " is not a KTX2 file the renderer can load");
+            m_file.Close();
+            return false;
+        }
+
+        uint64_t _dataBegin = UINT64_MAX;
+        uint64_t _dataEnd = 0;
+        std::vector<Ktx2LevelIndex> _index(m_header.LevelCount);
+        std::memcpy(_index.data(), _data + INDEX_OFFSET, _index.size() * sizeof(Ktx2LevelIndex));
+        for (const Ktx2LevelIndex& _level : _index)
+        {
+            if (_level.ByteLength == 0 || _level.ByteOffset + _level.ByteLength > _size)
+            {
+                Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogWarning(path + " is truncated");
+                m_file.Close();
+                return false;
+            }
+            _dataBegin = std::min(_dataBegin, _level.ByteOffset);
+            _dataEnd = std::max(_dataEnd, _level.ByteOffset + _level.ByteLength);
+        }
+
+        for (uint32_t _level = 0; _level < m_header.LevelCount; ++_level)
+        {
+            m_levels.push_back({std::max(1u, m_header.PixelWidth >> _level), std::max(1u, m_header.PixelHeight >> _level),
+                                _index[_level].ByteOffset - _dataBegin, _index[_level].ByteLength});
+        }
+        m_levelData = {_data + _dataBegin, _dataEnd - _dataBegin};
+
+        if (uint64_t(m_header.KvdByteOffset) + m_header.KvdByteLength <= _size)
+        {
+            uint64_t _position = m_header.KvdByteOffset;
+            const uint64_t _end = _position + m_header.KvdByteLength;
+            while (_position + sizeof(uint32_t) <= _end)
+            {
+                uint32_t _length;
+                std::memcpy(&_length, _data + _position, sizeof(_length));
+                _position += sizeof(_length);
+                if (_length == 0 || _position + _length > _end)
+                {
+                    break;
+                }
+
+                const char* _entry = reinterpret_cast<const char*>(_data + _position);
+                const size_t _keyLength = strnlen(_entry, _length);
+                if (_keyLength < _length)
+                {
+                    std::string _value(_entry + _keyLength + 1, _length - _keyLength - 1);
+                    if (!_value.empty() && _value.back() == '\0')
+                    {
+                        _value.pop_back();
+                    }
+                    m_keyValues.emplace_back(std::string(_entry, _keyLength), std::move(_value));
+                }
+                _position += AlignUp(_length, 4);
+            }
+        }
+        return true;
+    }
+
+    std::string Ktx2File::GetKeyValue(const std::string& key) const
+    {
+        for (const auto& [_key, _value] : m_keyValues)
+        {
+            if (_key == key)
+            {
+                return _value;
+            }
+        }
+        return {};
+    }
+
+    void Ktx2File::Write(const std::string& path, const VkFormat format, const std::span<const MipLevel> levels,
+                         const std::span<const std::byte> data,
+                         std::vector<std::pair<std::string, std::string>> keyValues)
+    {
+        PROFILE_FUNCTION()
+        if (levels.empty())
+        {
+            throw std::invalid_argument("KTX2 file " + path + " needs at least one level");
+        }
+
+        const FormatDescription _description = DescribeFormat(format);
+        const std::vector<uint32_t> _dfd = BuildDataFormatDescriptor(_description);
+
+        // The specification wants keys sorted by their bytes, values are written as NUL terminated strings
+        std::sort(keyValues.begin(), keyValues.end());
+        std::vector<std::byte> _kvd;
+        for (const auto& [_key, _value] : keyValues)
+        {
+            const uint32_t _length = static_cast<uint32_t>(_key.size() + 1 + _value.size() + 1);
+            const size_t _position = _kvd.size();
+            _kvd.resize(_position + sizeof(_length) + AlignUp(_length, 4));
+            std::memcpy(_kvd.data() + _position, &_length, sizeof(_length));
+            std::memcpy(_kvd.data() + _position + sizeof(_length), _key.c_str(), _key.size() + 1);
+            std::memcpy(_kvd.data() + _position + sizeof(_length) + _key.size() + 1, _value.c_str(), _value.size() + 1);
+        }
+
+        Ktx2Header _header{};
+        _header.Format = static_cast<uint32_t>(format);
+        _header.TypeSize = 1;
+        _header.PixelWidth = levels[0].Width;
+        _header.PixelHeight = levels[0].Height;
+        _header.FaceCount = 1;
+        _header.LevelCount = static_cast<uint32_t>(levels.size());
+        _header.DfdByteOffset = static_cast<uint32_t>(INDEX_OFFSET + levels.size() * sizeof(Ktx2LevelIndex));
+        _header.DfdByteLength = static_cast<uint32_t>(_dfd.size() * sizeof(uint32_t));
+        _header.KvdByteOffset = _kvd.empty() ? 0 : _header.DfdByteOffset + _header.DfdByteLength;
+        _header.KvdByteLength = static_cast<uint32_t>(_kvd.size());
+
+        // Smallest level first, so a streamer can show something before the whole file arrived
+        std::vector<Ktx2LevelIndex> _index(levels.size());
+        uint64_t _offset = uint64_t(_header.DfdByteOffset) + _header.DfdByteLength + _kvd.size();
+        for (size_t _level = levels.size(); _level-- > 0;)
+        {
+            _offset = AlignUp(_offset, _description.BlockBytes);
+            _index[_level] = {_offset, levels[_level].Size, levels[_level].Size};
+            _offset += levels[_level].Size;
+        }
+
+        Core::WriteFileAtomically(path, [&](std::ostream& file) {
+            static constexpr char ZEROES[16] = {};
+            file.write(reinterpret_cast<const char*>(IDENTIFIER), sizeof(IDENTIFIER));
+            file.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+            file.write(reinterpret_cast<const char*>(_index.data()),
+                       static_cast<std::streamsize>(_index.size() * sizeof(Ktx2LevelIndex)));
+            file.write(reinterpret_cast<const char*>(_dfd.data()), _header.DfdByteLength);
+            file.write(reinterpret_cast<const char*>(_kvd.data()), static_cast<std::streamsize>(_kvd.size()));
+            for (size_t _level = levels.size(); _level-- > 0;)
+            {
+                file.write(ZEROES, static_cast<std::streamsize>(_index[_level].ByteOffset -
+                                                                static_cast<uint64_t>(file.tellp())));
+                file.write(reinterpret_cast<const char*>(data.data() + levels[_level].Offset),
+                           static_cast<std::streamsize>(levels[_level].Size));
+            }
+        });
+    }
+} // namespace Thryve::Rendering
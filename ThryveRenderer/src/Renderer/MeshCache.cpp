@@ -0,0 +1,175 @@
+#include "Renderer/MeshCache.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+#include "Config.h"
+#include "Core/AtomicFile.h"
+#include "Core/Log.h"
+#include "Core/Profiling.h"
+#include "Core/ServiceRegistry.h"
+#include "Core/SourceSignature.h"
+
+namespace {
+    uint64_t AlignUp(const uint64_t value, const uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    void FillLayout(Thryve::Rendering::MeshCacheHeader& header)
+    {
+        const auto _attributes = Vertex3D::getAttributeDescriptions();
+        header.VertexStride = sizeof(Vertex3D);
+        header.AttributeCount = static_cast<uint32_t>(_attributes.size());
+        for (size_t _i = 0; _i < _attributes.size() && _i < Thryve::Rendering::MeshCacheHeader::MAX_ATTRIBUTES; ++_i)
+        {
+            header.Attributes[_i] = {_attributes[_i].location, static_cast<uint32_t>(_attributes[_i].format),
+                                     _attributes[_i].offset};
+        }
+    }
+
+    bool HasCurrentLayout(const Thryve::Rendering::MeshCacheHeader& header)
+    {
+        Thryve::Rendering::MeshCacheHeader _current{};
+        FillLayout(_current);
+        return header.VertexStride == _current.VertexStride && header.AttributeCount == _current.AttributeCount &&
+            header.IndexSize == sizeof(uint32_t) &&
+            std::memcmp(header.Attributes, _current.Attributes, sizeof(_current.Attributes)) == 0;
+    }
+}
+
+namespace Thryve::Rendering {
+    std::string MeshCache::GetCachePath(const std::string& sourcePath)
+    {
+        return std::string(CACHE_DIR) + "/meshes/" + std::filesystem::path(sourcePath).filename().string() + ".tmesh";
+    }
+
+    std::unique_ptr<CachedMesh> MeshCache::LoadOrImport(const std::string& sourcePath, MeshCacheStats* stats)
+    {
+        PROFILE_FUNCTION()
+        const auto _start = std::chrono::steady_clock::now();
+
+        MeshCacheStats _stats;
+        std::unique_ptr<CachedMesh> _mesh = Load(sourcePath);
+        _stats.bCacheHit = _mesh != nullptr;
+
+        if (!_mesh)
+        {
+            Write(sourcePath, MeshImporter::LoadObj(sourcePath, &_stats.ImportStats));
+            _mesh = Load(sourcePath);
+            if (!_mesh)
+            {
+                throw std::runtime_error("Failed to write mesh cache for " + sourcePath);
+            }
+        }
+
+        _stats.LoadMilliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+        if (stats)
+        {
+            *stats = _stats;
+        }
+        return _mesh;
+    }
+
+    std::unique_ptr<CachedMesh> MeshCache::Load(const std::string& sourcePath)
+    {
+        PROFILE_FUNCTION()
+        Core::SourceSignature _signature;
+        if (!Core::GetSourceSignature(sourcePath, _signature))
+        {
+            return nullptr;
+        }
+
+        const std::string _cachePath = GetCachePath(sourcePath);
+        auto _mesh = std::make_unique<CachedMesh>();
+        if (!_mesh->m_file.Open(_cachePath) || _mesh->m_file.GetSize() < sizeof(MeshCacheHeader))
+        {
+            return nullptr;
+        }
+
+        MeshCacheHeader _header;
+        std::memcpy(&_header, _mesh->m_file.GetData(), sizeof(_header));
+        if (_header.Magic != MeshCacheHeader::MAGIC || _header.Version != MeshCacheHeader::VERSION ||
+            !HasCurrentLayout(_header))
+        {
+            return nullptr;
+        }
+
+        if (_header.SourceSize != _signature.Size || _header.SourceWriteTime != _signature.WriteTime)
+        {
+            // Touched but possibly unchanged, e.g. after a checkout
+            if (_header.SourceSize != _signature.Size || _header.SourceHash != Core::HashSource(sourcePath))
+            {
+                return nullptr;
+            }
+
+            // Unchanged, so the next start matches on the signature again. Windows does not write mapped files
+            _mesh->m_file.Close();
+            Core::StoreSourceWriteTime(_cachePath, offsetof(MeshCacheHeader, SourceWriteTime), _signature.WriteTime);
+            if (!_mesh->m_file.Open(_cachePath))
+            {
+                return nullptr;
+            }
+        }
+
+        const uint64_t _fileSize = _mesh->m_file.GetSize();
+        const uint64_t _vertexBytes = _header.VertexCount * sizeof(Vertex3D);
+        const uint64_t _indexBytes = _header.IndexCount * sizeof(uint32_t);
+        if (_header.VertexOffset % MeshCacheHeader::BLOB_ALIGNMENT != 0 ||
+            _header.IndexOffset % MeshCacheHeader::BLOB_ALIGNMENT != 0 ||
+            _header.VertexOffset + _vertexBytes > _fileSize || _header.IndexOffset + _indexBytes > _fileSize)
+        {
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogWarning(
+                "Mesh cache " + _cachePath + " is truncated, rebuilding it");
+            return nullptr;
+        }
+
+        const std::byte* _data = _mesh->m_file.GetData();
+        _mesh->m_vertices = {reinterpret_cast<const Vertex3D*>(_data + _header.VertexOffset), _header.VertexCount};
+        _mesh->m_indices = {reinterpret_cast<const uint32_t*>(_data + _header.IndexOffset), _header.IndexCount};
+        return _mesh;
+    }
+
+    void MeshCache::Write(const std::string& sourcePath, const MeshData& mesh)
+    {
+        PROFILE_FUNCTION()
+        Core::SourceSignature _signature;
+        if (!Core::GetSourceSignature(sourcePath, _signature))
+        {
+            throw std::runtime_error("Mesh source " + sourcePath + " does not exist");
+        }
+
+        MeshCacheHeader _header{};
+        _header.Magic = MeshCacheHeader::MAGIC;
+        _header.Version = MeshCacheHeader::VERSION;
+        _header.SourceSize = _signature.Size;
+        _header.SourceWriteTime = _signature.WriteTime;
+        _header.SourceHash = Core::HashSource(sourcePath);
+        FillLayout(_header);
+        _header.IndexSize = sizeof(uint32_t);
+        _header.VertexCount = mesh.Vertices.size();
+        _header.VertexOffset = AlignUp(sizeof(MeshCacheHeader), MeshCacheHeader::BLOB_ALIGNMENT);
+        _header.IndexCount = mesh.Indices.size();
+        _header.IndexOffset = AlignUp(_header.VertexOffset + _header.VertexCount * sizeof(Vertex3D),
+                                      MeshCacheHeader::BLOB_ALIGNMENT);
+
+        Core::WriteFileAtomically(GetCachePath(sourcePath), [&](std::ostream& file) {
+            const auto WritePadding = [&file](const uint64_t target) {
+                static constexpr char ZEROES[MeshCacheHeader::BLOB_ALIGNMENT] = {};
+                const auto _position = static_cast<uint64_t>(file.tellp());
+                file.write(ZEROES, static_cast<std::streamsize>(target - _position));
+            };
+
+            file.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+            WritePadding(_header.VertexOffset);
+            file.write(reinterpret_cast<const char*>(mesh.Vertices.data()),
+                       static_cast<std::streamsize>(mesh.Vertices.size() * sizeof(Vertex3D)));
+            WritePadding(_header.IndexOffset);
+            file.write(reinterpret_cast<const char*>(mesh.Indices.data()),
+                       static_cast<std::streamsize>(mesh.Indices.size() * sizeof(uint32_t)));
+        });
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,316 @@
+#include "Renderer/MeshImporter.h"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <chrono>
+#include <stdexcept>
+#include "tiny_obj_loader.h"
+
+#include "Core/JobSystem.h"
+#include "Core/Profiling.h"
+#include "Core/ServiceRegistry.h"
+
+namespace {
+    struct VertexKey {
+        int Position;
+        int Normal;
+        int TexCoord;
+
+        bool operator==(const VertexKey& other) const
+        {
+            return Position == other.Position && Normal == other.Normal && TexCoord == other.TexCoord;
+        }
+    };
+
+    /**
+     * Open-addressing table from VertexKey to vertex index. Sized once up front and probed linearly,
+     * so lookups stay in a handful of cache lines and inserting never allocates.
+     */
+    class VertexKeyTable {
+    public:
+        explicit VertexKeyTable(const size_t expectedKeys)
+        {
+            size_t _capacity = 16;
+            while (_capacity < expectedKeys * 2)
+            {
+                _capacity <<= 1;
+            }
+            m_slots.resize(_capacity);
+            m_mask = _capacity - 1;
+        }
+
+        // Returns the index stored for key, inserting newIndex when the key is new
+        std::pair<uint32_t, bool> Insert(const VertexKey& key, const uint32_t newIndex)
+        {
+            for (size_t _slot = Hash(key) & m_mask;; _slot = (_slot + 1) & m_mask)
+            {
+                Slot& _entry = m_slots[_slot];
+                if (_entry.Index == EMPTY)
+                {
+                    _entry.Key = key;
+                    _entry.Index = newIndex;
+                    return {newIndex, true};
+                }
+                if (_entry.Key == key)
+                {
+                    return {_entry.Index, false};
+                }
+            }
+        }
+
+    private:
+        static constexpr uint32_t EMPTY = UINT32_MAX;
+
+        struct Slot {
+            VertexKey Key{};
+            uint32_t Index = EMPTY;
+        };
+
+        static size_t Hash(const VertexKey& key)
+        {
+            uint64_t _hash = static_cast<uint32_t>(key.Position) * 0x9E3779B97F4A7C15ull;
+            _hash ^= static_cast<uint32_t>(key.Normal) * 0xC2B2AE3D27D4EB4Full + (_hash << 6) + (_hash >> 2);
+            _hash ^= static_cast<uint32_t>(key.TexCoord) * 0x165667B19E3779F9ull + (_hash << 6) + (_hash >> 2);
+            return static_cast<size_t>(_hash ^ (_hash >> 29));
+        }
+
+        std::vector<Slot> m_slots;
+        size_t m_mask = 0;
+    };
+
+    // A triangle range of one shape, deduplicated on its own before the merge
+    struct MeshChunk {
+        const tinyobj::shape_t* Shape = nullptr;
+        size_t FirstIndex = 0;
+        size_t IndexCount = 0;
+        // Offset of this chunk's indices in the merged index buffer
+        size_t OutputOffset = 0;
+
+        std::vector<VertexKey> Keys;
+        std::vector<Vertex3D> Vertices;
+        std::vector<uint32_t> Indices;
+        std::vector<uint32_t> Remap;
+    };
+
+    Vertex3D MakeVertex(const tinyobj::attrib_t& attrib, const tinyobj::index_t& index)
+    {
+        Vertex3D _vertex{};
+        _vertex.pos = {
+            attrib.vertices[3 * index.vertex_index + 0],
+            attrib.vertices[3 * index.vertex_index + 1],
+            attrib.vertices[3 * index.vertex_index + 2]
+        };
+
+        if (index.texcoord_index >= 0)
+        {
+            _vertex.texCoord = {
+                attrib.texcoords[2 * index.texcoord_index + 0],
+                1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+            };
+        }
+
+        if (index.normal_index >= 0)
+        {
+            _vertex.normal = {
+                attrib.normals[3 * index.normal_index + 0],
+                attrib.normals[3 * index.normal_index + 1],
+                attrib.normals[3 * index.normal_index + 2]
+            };
+        }
+        return _vertex;
+    }
+
+    void ProcessChunk(const tinyobj::attrib_t& attrib, MeshChunk& chunk)
+    {
+        chunk.Indices.reserve(chunk.IndexCount);
+        // Closed meshes share a vertex between roughly six corners, half the corners is a generous guess
+        chunk.Keys.reserve(chunk.IndexCount / 2);
+        chunk.Vertices.reserve(chunk.IndexCount / 2);
+
+        VertexKeyTable _table(chunk.IndexCount);
+        for (size_t _i = 0; _i < chunk.IndexCount; ++_i)
+        {
+            const tinyobj::index_t& _index = chunk.Shape->mesh.indices[chunk.FirstIndex + _i];
+            const VertexKey _key{_index.vertex_index, _index.normal_index, _index.texcoord_index};
+
+            const auto [_vertexIndex, _bInserted] = _table.Insert(_key, static_cast<uint32_t>(chunk.Vertices.size()));
+            if (_bInserted)
+            {
+                chunk.Keys.push_back(_key);
+                chunk.Vertices.push_back(MakeVertex(attrib, _index));
+            }
+            chunk.Indices.push_back(_vertexIndex);
+        }
+
+        // Accumulate unnormalised face tangents, larger faces weigh more in the smoothed result
+        for (size_t _i = 0; _i + 2 < chunk.Indices.size(); _i += 3)
+        {
+            Vertex3D& _v0 = chunk.Vertices[chunk.Indices[_i + 0]];
+            Vertex3D& _v1 = chunk.Vertices[chunk.Indices[_i + 1]];
+            Vertex3D& _v2 = chunk.Vertices[chunk.Indices[_i + 2]];
+
+            const glm::vec3 _edge1 = _v1.pos - _v0.pos;
+            const glm::vec3 _edge2 = _v2.pos - _v0.pos;
+            const glm::vec2 _deltaUV1 = _v1.texCoord - _v0.texCoord;
+            const glm::vec2 _deltaUV2 = _v2.texCoord - _v0.texCoord;
+
+            const float _determinant = _deltaUV1.x * _deltaUV2.y - _deltaUV2.x * _deltaUV1.y;
+            if (std::abs(_determinant) < 1e-12f)
+            {
+                continue;
+            }
+
+            const float _f = 1.0f / _determinant;
+            const glm::vec3 _tangent = _f * (_deltaUV2.y * _edge1 - _deltaUV1.y * _edge2);
+            const glm::vec3 _bitangent = _f * (-_deltaUV2.x * _edge1 + _deltaUV1.x * _edge2);
+
+            for (Vertex3D* _vertex : {&_v0, &_v1, &_v2})
+            {
+                _vertex->tangent += _tangent;
+                _vertex->bitangent += _bitangent;
+            }
+        }
+    }
+
+    void OrthonormaliseTangentFrame(Vertex3D& vertex)
+    {
+        const glm::vec3 _normal = vertex.normal;
+        glm::vec3 _tangent = vertex.tangent - _normal * glm::dot(_normal, vertex.tangent);
+
+        if (glm::dot(_tangent, _tangent) < 1e-20f)
+        {
+            // No usable UV gradient, any direction perpendicular to the normal will do
+            const glm::vec3 _axis = std::abs(_normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+            _tangent = glm::cross(_normal, _axis);
+            if (glm::dot(_tangent, _tangent) < 1e-20f)
+            {
+                _tangent = _axis;
+            }
+        }
+        _tangent = glm::normalize(_tangent);
+
+        const float _handedness = glm::dot(glm::cross(_normal, _tangent), vertex.bitangent) < 0.0f ? -1.0f : 1.0f;
+        vertex.tangent = _tangent;
+        vertex.bitangent = glm::cross(_normal, _tangent) * _handedness;
+    }
+}
+
+namespace Thryve::Rendering {
+    MeshData MeshImporter::LoadObj(const std::string& path, MeshImportStats* stats)
+    {
+        PROFILE_FUNCTION()
+        const auto _parseStart = std::chrono::steady_clock::now();
+
+        tinyobj::attrib_t _attrib;
+        std::vector<tinyobj::shape_t> _shapes;
+        std::vector<tinyobj::material_t> _materials;
+        std::string _err, _warn;
+        {
+            PROFILE_SCOPE("Parse")
+            if (!tinyobj::LoadObj(&_attrib, &_shapes, &_materials, &_warn, &_err, path.c_str()))
+            {
+                throw std::runtime_error(_warn + _err);
+            }
+        }
+
+        const auto _processStart = std::chrono::steady_clock::now();
+
+        std::vector<MeshChunk> _chunks;
+        size_t _indexCount = 0;
+        for (const auto& _shape : _shapes)
+        {
+            constexpr size_t CHUNK_INDICES = TRIANGLES_PER_CHUNK * 3;
+            for (size_t _first = 0; _first < _shape.mesh.indices.size(); _first += CHUNK_INDICES)
+            {
+                MeshChunk& _chunk = _chunks.emplace_back();
+                _chunk.Shape = &_shape;
+                _chunk.FirstIndex = _first;
+                _chunk.IndexCount = std::min(CHUNK_INDICES, _shape.mesh.indices.size() - _first);
+                _chunk.OutputOffset = _indexCount;
+                _indexCount += _chunk.IndexCount;
+            }
+        }
+
+        auto _jobSystem = Core::ServiceRegistry::GetService<Core::JobSystem>();
+
+        {
+            PROFILE_SCOPE("Deduplicate Chunks")
+            _jobSystem->ParallelFor(static_cast<uint32_t>(_chunks.size()), 1, [&](const uint32_t begin, const uint32_t end) {
+                for (uint32_t _i = begin; _i < end; ++_i)
+                {
+                    ProcessChunk(_attrib, _chunks[_i]);
+                }
+            });
+        }
+
+        MeshData _mesh;
+        {
+            // Only chunk-unique vertices go through here, a small fraction of the corners
+            PROFILE_SCOPE("Merge Chunks")
+            size_t _chunkVertexCount = 0;
+            for (const auto& _chunk : _chunks)
+            {
+                _chunkVertexCount += _chunk.Vertices.size();
+            }
+
+            _mesh.Vertices.reserve(_chunkVertexCount);
+            VertexKeyTable _table(_chunkVertexCount);
+            for (auto& _chunk : _chunks)
+            {
+                _chunk.Remap.resize(_chunk.Vertices.size());
+                for (size_t _i = 0; _i < _chunk.Vertices.size(); ++_i)
+                {
+                    const auto [_vertexIndex, _bInserted] =
+                        _table.Insert(_chunk.Keys[_i], static_cast<uint32_t>(_mesh.Vertices.size()));
+                    if (_bInserted)
+                    {
+                        _mesh.Vertices.push_back(_chunk.Vertices[_i]);
+                    }
+                    else
+                    {
+                        _mesh.Vertices[_vertexIndex].tangent += _chunk.Vertices[_i].tangent;
+                        _mesh.Vertices[_vertexIndex].bitangent += _chunk.Vertices[_i].bitangent;
+                    }
+                    _chunk.Remap[_i] = _vertexIndex;
+                }
+            }
+        }
+
+        {
+            PROFILE_SCOPE("Remap Indices")
+            _mesh.Indices.resize(_indexCount);
+            _jobSystem->ParallelFor(static_cast<uint32_t>(_chunks.size()), 1, [&](const uint32_t begin, const uint32_t end) {
+                for (uint32_t _c = begin; _c < end; ++_c)
+                {
+                    MeshChunk& _chunk = _chunks[_c];
+                    for (size_t _i = 0; _i < _chunk.Indices.size(); ++_i)
+                    {
+                        _mesh.Indices[_chunk.OutputOffset + _i] = _chunk.Remap[_chunk.Indices[_i]];
+                    }
+                }
+            });
+        }
+
+        {
+            PROFILE_SCOPE("Tangent Frames")
+            _jobSystem->ParallelFor(static_cast<uint32_t>(_mesh.Vertices.size()), 4096, [&](const uint32_t begin, const uint32_t end) {
+                for (uint32_t _i = begin; _i < end; ++_i)
+                {
+                    OrthonormaliseTangentFrame(_mesh.Vertices[_i]);
+                }
+            });
+        }
+
+        if (stats)
+        {
+            const auto _end = std::chrono::steady_clock::now();
+            stats->SourceVertexCount = _indexCount;
+            stats->UniqueVertexCount = _mesh.Vertices.size();
+            stats->IndexCount = _mesh.Indices.size();
+            stats->ChunkCount = static_cast<uint32_t>(_chunks.size());
+            stats->ParseMilliseconds = std::chrono::duration<double, std::milli>(_processStart - _parseStart).count();
+            stats->ProcessMilliseconds = std::chrono::duration<double, std::milli>(_end - _processStart).count();
+        }
+
+        return _mesh;
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,160 @@
+#include "Renderer/MipCache.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include "Config.h"
+#include "Core/AtomicFile.h"
+#include "Core/Log.h"
+#include "Core/Profiling.h"
+#include "Core/ServiceRegistry.h"
+#include "Core/SourceSignature.h"
+#include "stb_image.h"
+
+namespace Thryve::Rendering {
+    std::string MipCache::GetCachePath(const std::string& sourcePath, const bool bSrgb, const MipFilter filter)
+    {
+        return std::string(CACHE_DIR) + "/textures/" + std::filesystem::path(sourcePath).filename().string() +
+            (bSrgb ? ".srgb" : ".linear") + (filter == MipFilter::Kaiser ? ".kaiser" : ".box") + ".tmip";
+    }
+
+    std::unique_ptr<CachedMipChain> MipCache::LoadOrBake(const std::string& sourcePath, const bool bSrgb,
+                                                         const MipFilter filter, MipCacheStats* stats)
+    {
+        PROFILE_FUNCTION()
+        const auto _start = std::chrono::steady_clock::now();
+
+        MipCacheStats _stats;
+        std::unique_ptr<CachedMipChain> _chain = Load(sourcePath, bSrgb, filter);
+        _stats.bCacheHit = _chain != nullptr;
+
+        if (!_chain)
+        {
+            int _width, _height, _channels;
+            stbi_uc* _pixels = stbi_load(sourcePath.c_str(), &_width, &_height, &_channels, STBI_rgb_alpha);
+            if (!_pixels)
+            {
+                throw std::runtime_error("failed to load texture image " + sourcePath);
+            }
+
+            const auto _bakeStart = std::chrono::steady_clock::now();
+            const MipChain _baked = MipGenerator::Generate(_pixels, static_cast<uint32_t>(_width),
+                                                           static_cast<uint32_t>(_height), bSrgb, filter);
+            _stats.BakeMilliseconds =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _bakeStart).count();
+            stbi_image_free(_pixels);
+
+            Write(sourcePath, bSrgb, filter, _baked);
+            _chain = Load(sourcePath, bSrgb, filter);
+            if (!_chain)
+            {
+                throw std::runtime_error("Failed to write mip cache for " + sourcePath);
+            }
+        }
+
+        _stats.LoadMilliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+        if (stats)
+        {
+            *stats = _stats;
+        }
+        return _chain;
+    }
+
+    std::unique_ptr<CachedMipChain> MipCache::Load(const std::string& sourcePath, const bool bSrgb,
+                                                   const MipFilter filter)
+    {
+        PROFILE_FUNCTION()
+        Core::SourceSignature _signature;
+        if (!Core::GetSourceSignature(sourcePath, _signature))
+        {
+            return nullptr;
+        }
+
+        const std::string _cachePath = GetCachePath(sourcePath, bSrgb, filter);
+        auto _chain = std::make_unique<CachedMipChain>();
+        if (!_chain->m_file.Open(_cachePath) || _chain->m_file.GetSize() < sizeof(MipCacheHeader))
+        {
+            return nullptr;
+        }
+
+        MipCacheHeader _header;
+        std::memcpy(&_header, _chain->m_file.GetData(), sizeof(_header));
+        if (_header.Magic != MipCacheHeader::MAGIC || _header.Version != MipCacheHeader::VERSION ||
+            _header.Filter != static_cast<uint32_t>(filter) || _header.bSrgb != static_cast<uint32_t>(bSrgb) ||
+            _header.LevelCount == 0 || _header.LevelCount > MipCacheHeader::MAX_LEVELS)
+        {
+            return nullptr;
+        }
+
+        if (_header.SourceSize != _signature.Size || _header.SourceWriteTime != _signature.WriteTime)
+        {
+            // Touched but possibly unchanged, e.g. after a checkout
+            if (_header.SourceSize != _signature.Size || _header.SourceHash != Core::HashSource(sourcePath))
+            {
+                return nullptr;
+            }
+
+            // Unchanged, so the next start matches on the signature again. Windows does not write mapped files
+            _chain->m_file.Close();
+            Core::StoreSourceWriteTime(_cachePath, offsetof(MipCacheHeader, SourceWriteTime), _signature.WriteTime);
+            if (!_chain->m_file.Open(_cachePath))
+            {
+                return nullptr;
+            }
+        }
+
+        const MipLevel& _lastLevel = _header.Levels[_header.LevelCount - 1];
+        if (_header.DataOffset % MipCacheHeader::DATA_ALIGNMENT != 0 ||
+            _lastLevel.Offset + _lastLevel.Size > _header.DataSize ||
+            _header.DataOffset + _header.DataSize > _chain->m_file.GetSize())
+        {
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogWarning(
+                "Mip cache " + _cachePath + " is truncated, rebuilding it");
+            return nullptr;
+        }
+
+        _chain->m_levels.assign(_header.Levels, _header.Levels + _header.LevelCount);
+        _chain->m_pixels = {_chain->m_file.GetData() + _header.DataOffset, _header.DataSize};
+        return _chain;
+    }
+
+    void MipCache::Write(const std::string& sourcePath, const bool bSrgb, const MipFilter filter, const MipChain& chain)
+    {
+        PROFILE_FUNCTION()
+        Core::SourceSignature _signature;
+        if (!Core::GetSourceSignature(sourcePath, _signature))
+        {
+            throw std::runtime_error("Texture source " + sourcePath + " does not exist");
+        }
+        if (chain.Levels.empty() || chain.Levels.size() > MipCacheHeader::MAX_LEVELS)
+        {
+            throw std::runtime_error("Mip chain of " + sourcePath + " has an unsupported level count");
+        }
+
+        MipCacheHeader _header{};
+        _header.Magic = MipCacheHeader::MAGIC;
+        _header.Version = MipCacheHeader::VERSION;
+        _header.SourceSize = _signature.Size;
+        _header.SourceWriteTime = _signature.WriteTime;
+        _header.SourceHash = Core::HashSource(sourcePath);
+        _header.Filter = static_cast<uint32_t>(filter);
+        _header.bSrgb = bSrgb ? 1 : 0;
+        _header.LevelCount = static_cast<uint32_t>(chain.Levels.size());
+        std::copy(chain.Levels.begin(), chain.Levels.end(), _header.Levels);
+        _header.DataOffset = (sizeof(MipCacheHeader) + MipCacheHeader::DATA_ALIGNMENT - 1) /
+            MipCacheHeader::DATA_ALIGNMENT * MipCacheHeader::DATA_ALIGNMENT;
+        _header.DataSize = chain.Pixels.size();
+
+        Core::WriteFileAtomically(GetCachePath(sourcePath, bSrgb, filter), [&](std::ostream& file) {
+            static constexpr char ZEROES[MipCacheHeader::DATA_ALIGNMENT] = {};
+            file.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+            file.write(ZEROES, static_cast<std::streamsize>(_header.DataOffset - sizeof(_header)));
+            file.write(reinterpret_cast<const char*>(chain.Pixels.data()),
+                       static_cast<std::streamsize>(chain.Pixels.size()));
+        });
+    }
+} // namespace Thryve::Rendering
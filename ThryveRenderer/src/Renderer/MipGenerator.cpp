@@ -0,0 +1,298 @@
+#include "Renderer/MipGenerator.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+#include "Core/JobSystem.h"
+#include "Core/Profiling.h"
+#include "Core/ServiceRegistry.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define THRYVE_MIP_SSE 1
+#else
+#define THRYVE_MIP_SSE 0
+#endif
+
+namespace {
+    // One linear RGBA texel, filtered as a whole in a single SSE register
+    struct alignas(16) Pixel {
+        float Channels[4];
+    };
+
+#if THRYVE_MIP_SSE
+    using Float4 = __m128;
+
+    inline Float4 Load(const Pixel& pixel) { return _mm_load_ps(pixel.Channels); }
+    inline void Store(Pixel& pixel, const Float4 value) { _mm_store_ps(pixel.Channels, value); }
+    inline Float4 Zero() { return _mm_setzero_ps(); }
+    inline Float4 Add(const Float4 a, const Float4 b) { return _mm_add_ps(a, b); }
+    inline Float4 MulAdd(const Float4 sum, const Float4 value, const float weight)
+    {
+        return _mm_add_ps(sum, _mm_mul_ps(value, _mm_set1_ps(weight)));
+    }
+    inline Float4 Scale(const Float4 value, const float factor) { return _mm_mul_ps(value, _mm_set1_ps(factor)); }
+    inline Float4 Saturate(const Float4 value)
+    {
+        return _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    }
+#else
+    struct Float4 {
+        float V[4];
+    };
+
+    inline Float4 Load(const Pixel& pixel) { return {pixel.Channels[0], pixel.Channels[1], pixel.Channels[2], pixel.Channels[3]}; }
+    inline void Store(Pixel& pixel, const Float4 value) { std::memcpy(pixel.Channels, value.V, sizeof(value.V)); }
+    inline Float4 Zero() { return {}; }
+    inline Float4 Add(const Float4 a, const Float4 b)
+    {
+        return {a.V[0] + b.V[0], a.V[1] + b.V[1], a.V[2] + b.V[2], a.V[3] + b.V[3]};
+    }
+    inline Float4 MulAdd(const Float4 sum, const Float4 value, const float weight)
+    {
+        return {sum.V[0] + value.V[0] * weight, sum.V[1] + value.V[1] * weight, sum.V[2] + value.V[2] * weight,
+                sum.V[3] + value.V[3] * weight};
+    }
+    inline Float4 Scale(const Float4 value, const float factor) { return MulAdd(Zero(), value, factor); }
+    inline Float4 Saturate(const Float4 value)
+    {
+        Float4 _result;
+        for (int _i = 0; _i < 4; ++_i)
+        {
+            _result.V[_i] = std::clamp(value.V[_i], 0.0f, 1.0f);
+        }
+        return _result;
+    }
+#endif
+
+    constexpr uint32_t ROWS_PER_JOB = 16;
+
+    // Taps at source texels 2x-2 .. 2x+3 around the output centre 2x+0.5
+    constexpr int KAISER_TAPS = 6;
+    constexpr int KAISER_FIRST_TAP = -2;
+
+    struct ColorTables {
+        std::array<float, 256> SrgbToLinear;
+        // Indexed by round(linear * (ENCODE_STEPS - 1)), fine enough that no 8-bit code is skipped
+        static constexpr uint32_t ENCODE_STEPS = 4096;
+        std::array<uint8_t, ENCODE_STEPS> LinearToSrgb;
+        std::array<float, KAISER_TAPS> KaiserWeights;
+    };
+
+    double BesselI0(const double x)
+    {
+        double _sum = 1.0;
+        double _term = 1.0;
+        for (int _k = 1; _k < 32; ++_k)
+        {
+            _term *= (x / (2.0 * _k)) * (x / (2.0 * _k));
+            _sum += _term;
+        }
+        return _sum;
+    }
+
+    ColorTables BuildTables()
+    {
+        ColorTables _tables{};
+        for (uint32_t _i = 0; _i < 256; ++_i)
+        {
+            const double _c = _i / 255.0;
+            _tables.SrgbToLinear[_i] =
+                static_cast<float>(_c <= 0.04045 ? _c / 12.92 : std::pow((_c + 0.055) / 1.055, 2.4));
+        }
+        for (uint32_t _i = 0; _i < ColorTables::ENCODE_STEPS; ++_i)
+        {
+            const double _l = _i / static_cast<double>(ColorTables::ENCODE_STEPS - 1);
+            const double _c = _l <= 0.0031308 ? _l * 12.92 : 1.055 * std::pow(_l, 1.0 / 2.4) - 0.055;
+            _tables.LinearToSrgb[_i] = static_cast<uint8_t>(std::lround(std::clamp(_c, 0.0, 1.0) * 255.0));
+        }
+
+        // Lanczos-like sinc for a 2x reduction, windowed by a Kaiser window with beta 4 over a radius of 3
+        constexpr double BETA = 4.0;
+        constexpr double RADIUS = 3.0;
+        double _total = 0.0;
+        std::array<double, KAISER_TAPS> _weights{};
+        for (int _tap = 0; _tap < KAISER_TAPS; ++_tap)
+        {
+            const double _distance = (KAISER_FIRST_TAP + _tap) - 0.5;
+            const double _t = _distance * 0.5;
+            const double _sinc = std::sin(std::numbers::pi * _t) / (std::numbers::pi * _t);
+            const double _ratio = _distance / RADIUS;
+            const double _window = BesselI0(BETA * std::sqrt(std::max(0.0, 1.0 - _ratio * _ratio))) / BesselI0(BETA);
+            _weights[_tap] = _sinc * _window;
+            _total += _weights[_tap];
+        }
+        for (int _tap = 0; _tap < KAISER_TAPS; ++_tap)
+        {
+            _tables.KaiserWeights[_tap] = static_cast<float>(_weights[_tap] / _total);
+        }
+        return _tables;
+    }
+
+    const ColorTables& GetTables()
+    {
+        static const ColorTables s_Tables = BuildTables();
+        return s_Tables;
+    }
+
+    struct Image {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        std::vector<Pixel> Pixels;
+
+        [[nodiscard]] const Pixel& At(const uint32_t x, const uint32_t y) const { return Pixels[size_t(y) * Width + x]; }
+    };
+
+    Image Decode(const uint8_t* rgba, const uint32_t width, const uint32_t height, const bool bSrgb)
+    {
+        const ColorTables& _tables = GetTables();
+        Image _image{width, height, std::vector<Pixel>(size_t(width) * height)};
+        for (size_t _i = 0; _i < _image.Pixels.size(); ++_i)
+        {
+            const uint8_t* _texel = rgba + _i * 4;
+            Pixel& _pixel = _image.Pixels[_i];
+            for (int _c = 0; _c < 3; ++_c)
+            {
+                _pixel.Channels[_c] = bSrgb ? _tables.SrgbToLinear[_texel[_c]] : _texel[_c] / 255.0f;
+            }
+            _pixel.Channels[3] = _texel[3] / 255.0f;
+        }
+        return _image;
+    }
+
+    void Encode(const Image& image, const bool bSrgb, std::byte* destination)
+    {
+        const ColorTables& _tables = GetTables();
+        auto* _out = reinterpret_cast<uint8_t*>(destination);
+        for (size_t _i = 0; _i < image.Pixels.size(); ++_i)
+        {
+            const Pixel& _pixel = image.Pixels[_i];
+            for (int _c = 0; _c < 3; ++_c)
+            {
+                const float _value = _pixel.Channels[_c];
+                _out[_i * 4 + _c] = bSrgb
+                    ? _tables.LinearToSrgb[static_cast<uint32_t>(_value * (ColorTables::ENCODE_STEPS - 1) + 0.5f)]
+                    : static_cast<uint8_t>(_value * 255.0f + 0.5f);
+            }
+            _out[_i * 4 + 3] = static_cast<uint8_t>(_pixel.Channels[3] * 255.0f + 0.5f);
+        }
+    }
+
+    Image DownsampleBox(const Image& source, Thryve::Core::JobSystem& jobSystem)
+    {
+        Image _result{std::max(1u, source.Width / 2), std::max(1u, source.Height / 2)};
+        _result.Pixels.resize(size_t(_result.Width) * _result.Height);
+
+        jobSystem.ParallelFor(_result.Height, ROWS_PER_JOB, [&](const uint32_t begin, const uint32_t end) {
+            for (uint32_t _y = begin; _y < end; ++_y)
+            {
+                const uint32_t _y0 = std::min(_y * 2, source.Height - 1);
+                const uint32_t _y1 = std::min(_y * 2 + 1, source.Height - 1);
+                for (uint32_t _x = 0; _x < _result.Width; ++_x)
+                {
+                    const uint32_t _x0 = std::min(_x * 2, source.Width - 1);
+                    const uint32_t _x1 = std::min(_x * 2 + 1, source.Width - 1);
+                    const Float4 _sum = Add(Add(Load(source.At(_x0, _y0)), Load(source.At(_x1, _y0))),
+                                            Add(Load(source.At(_x0, _y1)), Load(source.At(_x1, _y1))));
+                    Store(_result.Pixels[size_t(_y) * _result.Width + _x], Scale(_sum, 0.25f));
+                }
+            }
+        });
+        return _result;
+    }
+
+    Image DownsampleKaiser(const Image& source, Thryve::Core::JobSystem& jobSystem)
+    {
+        const auto& _weights = GetTables().KaiserWeights;
+        const uint32_t _width = std::max(1u, source.Width / 2);
+        const uint32_t _height = std::max(1u, source.Height / 2);
+
+        const auto Clamp = [](const int64_t value, const uint32_t size) {
+            return static_cast<uint32_t>(std::clamp<int64_t>(value, 0, int64_t(size) - 1));
+        };
+
+        // Horizontal pass at full source height
+        Image _rows{_width, source.Height, std::vector<Pixel>(size_t(_width) * source.Height)};
+        jobSystem.ParallelFor(source.Height, ROWS_PER_JOB, [&](const uint32_t begin, const uint32_t end) {
+            for (uint32_t _y = begin; _y < end; ++_y)
+            {
+                for (uint32_t _x = 0; _x < _width; ++_x)
+                {
+                    Float4 _sum = Zero();
+                    for (int _tap = 0; _tap < KAISER_TAPS; ++_tap)
+                    {
+                        const uint32_t _sx = Clamp(int64_t(_x) * 2 + KAISER_FIRST_TAP + _tap, source.Width);
+                        _sum = MulAdd(_sum, Load(source.At(_sx, _y)), _weights[_tap]);
+                    }
+                    Store(_rows.Pixels[size_t(_y) * _width + _x], _sum);
+                }
+            }
+        });
+
+        Image _result{_width, _height, std::vector<Pixel>(size_t(_width) * _height)};
+        jobSystem.ParallelFor(_height, ROWS_PER_JOB, [&](const uint32_t begin, const uint32_t end) {
+            for (uint32_t _y = begin; _y < end; ++_y)
+            {
+                for (uint32_t _x = 0; _x < _width; ++_x)
+                {
+                    Float4 _sum = Zero();
+                    for (int _tap = 0; _tap < KAISER_TAPS; ++_tap)
+                    {
+                        const uint32_t _sy = Clamp(int64_t(_y) * 2 + KAISER_FIRST_TAP + _tap, source.Height);
+                        _sum = MulAdd(_sum, Load(_rows.At(_x, _sy)), _weights[_tap]);
+                    }
+                    // The negative lobes overshoot at hard edges, clamp so it does not build up down the chain
+                    Store(_result.Pixels[size_t(_y) * _width + _x], Saturate(_sum));
+                }
+            }
+        });
+        return _result;
+    }
+}
+
+namespace Thryve::Rendering {
+    uint32_t MipGenerator::GetMipLevelCount(const uint32_t width, const uint32_t height)
+    {
+        uint32_t _levels = 1;
+        for (uint32_t _size = std::max(width, height); _size > 1; _size >>= 1)
+        {
+            ++_levels;
+        }
+        return _levels;
+    }
+
+    MipChain MipGenerator::Generate(const uint8_t* rgba, const uint32_t width, const uint32_t height, const bool bSrgb,
+                                    const MipFilter filter)
+    {
+        PROFILE_FUNCTION()
+        MipChain _chain;
+        const uint32_t _levelCount = GetMipLevelCount(width, height);
+
+        uint64_t _offset = 0;
+        for (uint32_t _level = 0; _level < _levelCount; ++_level)
+        {
+            const uint32_t _width = std::max(1u, width >> _level);
+            const uint32_t _height = std::max(1u, height >> _level);
+            const uint64_t _size = uint64_t(_width) * _height * 4;
+            _chain.Levels.push_back({_width, _height, _offset, _size});
+            _offset = (_offset + _size + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+        }
+        _chain.Pixels.resize(_offset);
+
+        // Level 0 is the source itself, no need to round-trip it through float
+        std::memcpy(_chain.Pixels.data(), rgba, _chain.Levels[0].Size);
+
+        auto _jobSystem = Core::ServiceRegistry::GetService<Core::JobSystem>();
+        Image _current = Decode(rgba, width, height, bSrgb);
+        for (uint32_t _level = 1; _level < _levelCount; ++_level)
+        {
+            _current = filter == MipFilter::Kaiser ? DownsampleKaiser(_current, *_jobSystem)
+                                                   : DownsampleBox(_current, *_jobSystem);
+            Encode(_current, bSrgb, _chain.Pixels.data() + _chain.Levels[_level].Offset);
+        }
+        return _chain;
+    }
+} // namespace Thryve::Rendering
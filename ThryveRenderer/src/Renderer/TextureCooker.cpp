@@ -0,0 +1,194 @@
+#include "Renderer/TextureCooker.h"
+
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+
+#include "Config.h"
+#include "Core/Profiling.h"
+#include "Core/SourceSignature.h"
+#include "Renderer/Ktx2File.h"
+#include "Renderer/MipGenerator.h"
+#include "stb_image.h"
+
+namespace {
+    // Custom key/value entries, KTX2 reserves only keys starting with "KTX" or "ktx"
+    constexpr const char* SOURCE_KEY = "ThryveSource";
+    constexpr const char* VERSION_KEY = "ThryveCooker";
+    constexpr const char* WRITER_KEY = "KTXwriter";
+
+    double MillisecondsSince(const std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+namespace Thryve::Rendering {
+    VkFormat TextureCooker::GetFormat(const TextureKind kind)
+    {
+        switch (kind)
+        {
+        case TextureKind::Color:
+            return VK_FORMAT_BC7_SRGB_BLOCK;
+        case TextureKind::Normal:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case TextureKind::Mask:
+            return VK_FORMAT_BC4_UNORM_BLOCK;
+        }
+        throw std::invalid_argument("Unknown texture kind");
+    }
+
+    BlockFormat TextureCooker::GetBlockFormat(const TextureKind kind)
+    {
+        switch (kind)
+        {
+        case TextureKind::Color:
+            return BlockFormat::BC7;
+        case TextureKind::Normal:
+            return BlockFormat::BC5;
+        case TextureKind::Mask:
+            return BlockFormat::BC4;
+        }
+        throw std::invalid_argument("Unknown texture kind");
+    }
+
+    std::string TextureCooker::GetCookedPath(const std::string& sourcePath, const TextureKind kind)
+    {
+        static constexpr const char* KIND_NAMES[] = {".color", ".normal", ".mask"};
+        return std::string(CACHE_DIR) + "/textures/" + std::filesystem::path(sourcePath).filename().string() +
+            KIND_NAMES[static_cast<uint32_t>(kind)] + ".ktx2";
+    }
+
+    bool TextureCooker::IsUpToDate(const std::string& sourcePath, const TextureKind kind)
+    {
+        PROFILE_FUNCTION()
+        Core::SourceSignature _signature;
+        Ktx2File _cooked;
+        if (!Core::GetSourceSignature(sourcePath, _signature) || !_cooked.Open(GetCookedPath(sourcePath, kind)) ||
+            _cooked.GetFormat() != GetFormat(kind) || _cooked.GetKeyValue(VERSION_KEY) != std::to_string(VERSION))
+        {
+            return false;
+        }
+
+        uint64_t _size = 0, _hash = 0;
+        int64_t _writeTime = 0;
+        std::istringstream _source(_cooked.GetKeyValue(SOURCE_KEY));
+        if (!(_source >> _size >> _writeTime >> _hash) || _size != _signature.Size)
+        {
+            return false;
+        }
+        if (_writeTime == _signature.WriteTime)
+        {
+            return true;
+        }
+        // Touched but possibly unchanged, e.g. after a checkout
+        if (_hash != Core::HashSource(sourcePath))
+        {
+            return false;
+        }
+
+        // Unchanged, so rewrite the cooked file with the new write time and the next start matches on the signature
+        // again. The value is text of varying length, the file cannot be patched in place. Windows does not replace
+        // mapped files, so the levels are copied out before the mapping goes
+        const std::vector<MipLevel> _levels(_cooked.GetLevels().begin(), _cooked.GetLevels().end());
+        const std::vector<std::byte> _blocks(_cooked.GetLevelData().begin(), _cooked.GetLevelData().end());
+        _cooked = {};
+        try
+        {
+            WriteCooked(sourcePath, kind, _levels, _blocks, _signature.Size, _signature.WriteTime, _hash);
+        }
+        catch (const std::runtime_error&)
+        {
+            // Only costs the next check another hash
+        }
+        return true;
+    }
+
+    std::string TextureCooker::CookIfStale(const std::string& sourcePath, const TextureKind kind,
+                                           TextureCookStats* stats)
+    {
+        if (!IsUpToDate(sourcePath, kind))
+        {
+            Cook(sourcePath, kind, stats);
+        }
+        else if (stats)
+        {
+            *stats = {};
+        }
+        return GetCookedPath(sourcePath, kind);
+    }
+
+    void TextureCooker::Cook(const std::string& sourcePath, const TextureKind kind, TextureCookStats* stats)
+    {
+        PROFILE_FUNCTION()
+        Core::SourceSignature _signature;
+        if (!Core::GetSourceSignature(sourcePath, _signature))
+        {
+            throw std::runtime_error("Texture source " + sourcePath + " does not exist");
+        }
+
+        TextureCookStats _stats;
+        _stats.bCooked = true;
+
+        auto _start = std::chrono::steady_clock::now();
+        int _width, _height, _channels;
+        stbi_uc* _pixels = stbi_load(sourcePath.c_str(), &_width, &_height, &_channels, STBI_rgb_alpha);
+        if (!_pixels)
+        {
+            throw std::runtime_error("failed to load texture image " + sourcePath);
+        }
+        _stats.DecodeMilliseconds = MillisecondsSince(_start);
+
+        // Colour is filtered in linear light, normals and masks are linear data already
+        _start = std::chrono::steady_clock::now();
+        const MipChain _chain = MipGenerator::Generate(_pixels, static_cast<uint32_t>(_width),
+                                                       static_cast<uint32_t>(_height), kind == TextureKind::Color,
+                                                       MipFilter::Kaiser);
+        stbi_image_free(_pixels);
+        _stats.MipMilliseconds = MillisecondsSince(_start);
+
+        _start = std::chrono::steady_clock::now();
+        const BlockFormat _format = GetBlockFormat(kind);
+        std::vector<MipLevel> _levels;
+        uint64_t _offset = 0;
+        for (const MipLevel& _level : _chain.Levels)
+        {
+            const uint64_t _size = BlockCompression::GetCompressedSize(_format, _level.Width, _level.Height);
+            _levels.push_back({_level.Width, _level.Height, _offset, _size});
+            _offset += _size;
+            _stats.UncompressedBytes += _level.Size;
+        }
+        std::vector<std::byte> _blocks(_offset);
+        for (size_t _level = 0; _level < _levels.size(); ++_level)
+        {
+            BlockCompression::Compress(_format, reinterpret_cast<const uint8_t*>(_chain.Pixels.data()) +
+                                           _chain.Levels[_level].Offset,
+                                       _levels[_level].Width, _levels[_level].Height,
+                                       _blocks.data() + _levels[_level].Offset);
+        }
+        _stats.CompressedBytes = _blocks.size();
+        _stats.EncodeMilliseconds = MillisecondsSince(_start);
+
+        WriteCooked(sourcePath, kind, _levels, _blocks, _signature.Size, _signature.WriteTime,
+                    Core::HashSource(sourcePath));
+
+        if (stats)
+        {
+            *stats = _stats;
+        }
+    }
+
+    void TextureCooker::WriteCooked(const std::string& sourcePath, const TextureKind kind,
+                                    const std::span<const MipLevel> levels, const std::span<const std::byte> data,
+                                    const uint64_t sourceSize, const int64_t sourceWriteTime,
+                                    const uint64_t sourceHash)
+    {
+        std::ostringstream _source;
+        _source << sourceSize << ' ' << sourceWriteTime << ' ' << sourceHash;
+        Ktx2File::Write(GetCookedPath(sourcePath, kind), GetFormat(kind), levels, data,
+                        {{WRITER_KEY, "ThryveRenderer TextureCooker"},
+                         {SOURCE_KEY, _source.str()},
+                         {VERSION_KEY, std::to_string(VERSION)}});
+    }
+} // namespace Thryve::Rendering
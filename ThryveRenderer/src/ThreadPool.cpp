@@ -1,6 +0,0 @@
-//
-// Created by kprie on 15.03.2024.
-//
-
-#include "ThreadPool.h"
-
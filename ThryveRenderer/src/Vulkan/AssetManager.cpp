@@ -0,0 +1,399 @@
+#include "Vulkan/AssetManager.h"
+
+#include <filesystem>
+#include <sstream>
+
+#include "Core/Log.h"
+#include "Core/Profiling.h"
+#include "Core/ServiceRegistry.h"
+#include "Vulkan/VulkanContext.h"
+#include "utils/ImageUtils.h"
+#include "utils/VkDebugUtils.h"
+
+namespace {
+    // Unorm so the flat normal decodes to exactly (0.5, 0.5, 1.0) in every channel the shaders read
+    constexpr VkFormat FALLBACK_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+    constexpr uint8_t FALLBACK_TEXELS[3][4] = {
+        {255, 255, 255, 255},
+        {0, 0, 0, 255},
+        {128, 128, 255, 255},
+    };
+
+    double MillisecondsSince(const std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::string GetFileName(const std::string& path)
+    {
+        return std::filesystem::path(path).filename().string();
+    }
+}
+
+namespace Thryve::Rendering {
+    AssetManager::AssetManager(UploadManager& uploadManager, const VkCommandPool commandPool) :
+        m_uploadManager(uploadManager), m_commandPool(commandPool)
+    {
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+        m_device = _deviceSelector->GetLogicalDevice();
+        m_physicalDevice = _deviceSelector->GetPhysicalDevice();
+        m_graphicsQueue = _deviceSelector->GetGraphicsQueue();
+        m_jobSystem = Core::ServiceRegistry::GetService<Core::JobSystem>();
+
+        CreateFallbacks();
+    }
+
+    AssetManager::~AssetManager()
+    {
+        // Decode jobs write into the assets, none may still be running when they go away
+        for (const auto& _texture : m_textures)
+        {
+            m_jobSystem->Wait(_texture->Counter);
+        }
+        for (const auto& _mesh : m_meshes)
+        {
+            m_jobSystem->Wait(_mesh->Counter);
+        }
+        m_textures.clear();
+        m_meshes.clear();
+
+        for (FallbackImage& _fallback : m_fallbacks)
+        {
+            vkDestroyImageView(m_device, _fallback.View, nullptr);
+            ImageUtils::DestroyImage(_fallback.Image, _fallback.Allocation);
+        }
+        vkDestroySampler(m_device, m_fallbackSampler, nullptr);
+    }
+
+    void AssetManager::CreateFallbacks()
+    {
+        PROFILE_FUNCTION()
+        for (size_t _index = 0; _index < m_fallbacks.size(); ++_index)
+        {
+            FallbackImage& _fallback = m_fallbacks[_index];
+            ImageUtils::CreateImage(1, 1, FALLBACK_FORMAT, VK_IMAGE_TILING_OPTIMAL,
+                                    VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _fallback.Image, _fallback.Allocation);
+            m_uploadManager.UploadImage(_fallback.Image, 1, 1, FALLBACK_TEXELS[_index], sizeof(FALLBACK_TEXELS[_index]));
+            _fallback.View = ImageUtils::CreateImageView(_fallback.Image, FALLBACK_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT);
+        }
+        // A handful of bytes, every frame can sample them from the first one on
+        m_uploadManager.Synchronize();
+
+        VkSamplerCreateInfo _samplerInfo{};
+        _samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        _samplerInfo.magFilter = VK_FILTER_NEAREST;
+        _samplerInfo.minFilter = VK_FILTER_NEAREST;
+        _samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        _samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        _samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        _samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        _samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        _samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+        VK_CALL(vkCreateSampler(m_device, &_samplerInfo, nullptr, &m_fallbackSampler));
+    }
+
+    void AssetManager::BeginRequest(const std::chrono::steady_clock::time_point requestTime)
+    {
+        if (m_pendingCount++ == 0)
+        {
+            m_streamStart = requestTime;
+            m_streamDecodeMilliseconds = 0.0;
+            m_streamAssetCount = 0;
+        }
+    }
+
+    TextureHandle AssetManager::LoadTexture(const std::string& path, const TextureKind kind,
+                                            const FallbackTexture fallback, const bool bCompressed,
+                                            const VulkanTextureImage::MipSource mipSource)
+    {
+        PROFILE_FUNCTION()
+        auto _asset = std::make_unique<TextureAsset>();
+        _asset->Path = path;
+        _asset->Kind = kind;
+        _asset->Fallback = fallback;
+        _asset->bCompressed = bCompressed;
+        _asset->MipSource = mipSource;
+        _asset->Texture = std::make_unique<VulkanTextureImage>(m_commandPool, VK_NULL_HANDLE);
+        _asset->RequestTime = std::chrono::steady_clock::now();
+        BeginRequest(_asset->RequestTime);
+
+        TextureAsset* _texture = _asset.get();
+        m_jobSystem->Run(
+            [_texture] {
+                PROFILE_SCOPE("Decode Texture")
+                try
+                {
+                    _texture->Texture->decodeTextureImage(_texture->Path, _texture->Kind, _texture->bCompressed,
+                                                          _texture->MipSource);
+                }
+                catch (...)
+                {
+                    _texture->Error = std::current_exception();
+                }
+            },
+            &_texture->Counter);
+
+        m_textures.push_back(std::move(_asset));
+        return {static_cast<uint32_t>(m_textures.size() - 1)};
+    }
+
+    MeshHandle AssetManager::LoadMesh(const std::string& path)
+    {
+        PROFILE_FUNCTION()
+        auto _asset = std::make_unique<MeshAsset>();
+        _asset->Path = path;
+        _asset->RequestTime = std::chrono::steady_clock::now();
+        BeginRequest(_asset->RequestTime);
+
+        MeshAsset* _mesh = _asset.get();
+        m_jobSystem->Run(
+            [_mesh] {
+                PROFILE_SCOPE("Decode Mesh")
+                try
+                {
+                    _mesh->Mesh = MeshCache::LoadOrImport(_mesh->Path, &_mesh->Stats);
+                    _mesh->Bounds = BoundingSphere::FromVertices(_mesh->Mesh->GetVertices());
+                }
+                catch (...)
+                {
+                    _mesh->Error = std::current_exception();
+                }
+            },
+            &_mesh->Counter);
+
+        m_meshes.push_back(std::move(_asset));
+        return {static_cast<uint32_t>(m_meshes.size() - 1)};
+    }
+
+    void AssetManager::HelpDecode()
+    {
+        if (m_jobSystem->GetWorkerCount() > 1)
+        {
+            return;
+        }
+        for (const auto& _texture : m_textures)
+        {
+            if (_texture->State == AssetState::Decoding && !_texture->Counter.IsDone())
+            {
+                m_jobSystem->Wait(_texture->Counter);
+                return;
+            }
+        }
+        for (const auto& _mesh : m_meshes)
+        {
+            if (_mesh->State == AssetState::Decoding && !_mesh->Counter.IsDone())
+            {
+                m_jobSystem->Wait(_mesh->Counter);
+                return;
+            }
+        }
+    }
+
+    void AssetManager::Update()
+    {
+        PROFILE_FUNCTION()
+        if (m_pendingCount == 0)
+        {
+            return;
+        }
+        HelpDecode();
+
+        bool _bRecorded = false;
+        for (const auto& _texture : m_textures)
+        {
+            if (_texture->State == AssetState::Uploading && m_uploadManager.IsReady(_texture->Ticket))
+            {
+                _texture->State = AssetState::Resident;
+                --m_pendingCount;
+
+                const VulkanTextureImage::LoadStats& _stats = _texture->Texture->GetLoadStats();
+                std::ostringstream _message;
+                _message << "Streamed " << GetFileName(_texture->Path) << " as "
+                         << (_stats.bCompressed ? "BCn" : "RGBA8") << ", " << _stats.DecodeMilliseconds
+                         << " ms decode, " << _stats.UploadMilliseconds << " ms upload, "
+                         << static_cast<double>(_stats.GpuBytes) / (1024.0 * 1024.0) << " MiB of VRAM, resident "
+                         << MillisecondsSince(_texture->RequestTime) << " ms after the request";
+                Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(_message.str());
+            }
+            else if (_texture->State == AssetState::Decoding && _texture->Counter.IsDone())
+            {
+                _bRecorded |= UploadTexture(*_texture);
+            }
+        }
+
+        for (const auto& _mesh : m_meshes)
+        {
+            if (_mesh->State == AssetState::Uploading && m_uploadManager.IsReady(_mesh->Ticket))
+            {
+                _mesh->State = AssetState::Resident;
+                --m_pendingCount;
+                std::ostringstream _message;
+                _message << "Streamed " << GetFileName(_mesh->Path) << ", "
+                         << _mesh->VertexBuffer->GetVertexCount() << " vertices and "
+                         << _mesh->IndexBuffer->GetIndexCount() << " indices, resident "
+                         << MillisecondsSince(_mesh->RequestTime) << " ms after the request";
+                Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(_message.str());
+            }
+            else if (_mesh->State == AssetState::Decoding && _mesh->Counter.IsDone())
+            {
+                _bRecorded |= UploadMesh(*_mesh);
+            }
+        }
+
+        // Everything decoded since the last frame goes out in one submit
+        if (_bRecorded)
+        {
+            const uint64_t _ticket = m_uploadManager.Flush();
+            for (const auto& _texture : m_textures)
+            {
+                if (_texture->State == AssetState::Uploading && _texture->Ticket == 0)
+                {
+                    _texture->Ticket = _ticket;
+                }
+            }
+            for (const auto& _mesh : m_meshes)
+            {
+                if (_mesh->State == AssetState::Uploading && _mesh->Ticket == 0)
+                {
+                    _mesh->Ticket = _ticket;
+                }
+            }
+        }
+
+        if (m_pendingCount == 0)
+        {
+            ReportStream();
+        }
+    }
+
+    bool AssetManager::UploadTexture(TextureAsset& asset)
+    {
+        PROFILE_FUNCTION()
+        if (asset.Error)
+        {
+            FinishAsset(asset.Path, asset.State, asset.Error);
+            return false;
+        }
+
+        asset.Texture->uploadTextureImage(m_uploadManager);
+        asset.Texture->createTextureImageView();
+        asset.Texture->createTextureSampler();
+        asset.State = AssetState::Uploading;
+
+        const VulkanTextureImage::LoadStats& _stats = asset.Texture->GetLoadStats();
+        m_streamDecodeMilliseconds += _stats.DecodeMilliseconds;
+        ++m_streamAssetCount;
+        return true;
+    }
+
+    bool AssetManager::UploadMesh(MeshAsset& asset)
+    {
+        PROFILE_FUNCTION()
+        if (asset.Error)
+        {
+            FinishAsset(asset.Path, asset.State, asset.Error);
+            return false;
+        }
+
+        asset.VertexBuffer = std::make_unique<VulkanVertexBuffer<Vertex3D>>(m_device, m_physicalDevice, m_commandPool,
+                                                                            m_graphicsQueue);
+        asset.VertexBuffer->Create(asset.Mesh->GetVertices(), m_uploadManager);
+        asset.IndexBuffer = std::make_unique<VulkanIndexBuffer>(m_commandPool);
+        asset.IndexBuffer->Create(asset.Mesh->GetIndices(), m_uploadManager);
+        // The ring holds its own copy now
+        asset.Mesh.reset();
+        asset.State = AssetState::Uploading;
+
+        m_streamDecodeMilliseconds += asset.Stats.LoadMilliseconds;
+        ++m_streamAssetCount;
+        if (!asset.Stats.bCacheHit)
+        {
+            const MeshImportStats& _import = asset.Stats.ImportStats;
+            std::ostringstream _message;
+            _message << "Imported " << asset.Path << ": " << _import.UniqueVertexCount << " unique vertices from "
+                     << _import.SourceVertexCount << " corners (" << _import.GetVertexReduction() * 100.0
+                     << "% fewer), parse " << _import.ParseMilliseconds << " ms, process "
+                     << _import.ProcessMilliseconds << " ms in " << _import.ChunkCount << " chunks, "
+                     << asset.Stats.LoadMilliseconds << " ms including the cache write";
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(_message.str());
+        }
+        return true;
+    }
+
+    void AssetManager::FinishAsset(const std::string& path, AssetState& state, const std::exception_ptr& error)
+    {
+        // A broken asset keeps its fallback, the rest of the scene still streams in
+        state = AssetState::Failed;
+        --m_pendingCount;
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch (const std::exception& _exception)
+        {
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogError(
+                "Failed to stream " + path + ": " + _exception.what());
+        }
+        catch (...)
+        {
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogError("Failed to stream " + path);
+        }
+    }
+
+    void AssetManager::ReportStream()
+    {
+        const double _streamMilliseconds = MillisecondsSince(m_streamStart);
+        const UploadStats& _uploadStats = m_uploadManager.GetStats();
+        std::ostringstream _message;
+        _message << "Streamed " << m_streamAssetCount << " assets in " << _streamMilliseconds << " ms, "
+                 << m_streamDecodeMilliseconds << " ms of decoding one after another, "
+                 << static_cast<double>(_uploadStats.BytesUploaded) / (1024.0 * 1024.0) << " MiB uploaded in "
+                 << _uploadStats.SubmitCount << " submits (" << _uploadStats.StallCount << " stalls) on the "
+                 << (m_uploadManager.UsesDedicatedTransferQueue() ? "dedicated transfer" : "graphics") << " queue";
+        Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(_message.str());
+        PROFILE_COUNTER("Asset Stream (us)", static_cast<int64_t>(_streamMilliseconds * 1000.0))
+        m_streamAssetCount = 0;
+    }
+
+    VkDescriptorImageInfo AssetManager::GetTextureDescriptor(const TextureHandle handle) const
+    {
+        VkDescriptorImageInfo _imageInfo{};
+        _imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        const TextureAsset& _texture = *m_textures.at(handle.Index);
+        if (_texture.State == AssetState::Resident)
+        {
+            _imageInfo.imageView = _texture.Texture->GetTextureImageView();
+            _imageInfo.sampler = _texture.Texture->GetTextureSampler();
+        }
+        else
+        {
+            _imageInfo.imageView = m_fallbacks[static_cast<uint32_t>(_texture.Fallback)].View;
+            _imageInfo.sampler = m_fallbackSampler;
+        }
+        return _imageInfo;
+    }
+
+    bool AssetManager::IsResident(const TextureHandle handle) const
+    {
+        return m_textures.at(handle.Index)->State == AssetState::Resident;
+    }
+
+    const VulkanVertexBuffer<Vertex3D>* AssetManager::GetVertexBuffer(const MeshHandle handle) const
+    {
+        const MeshAsset& _mesh = *m_meshes.at(handle.Index);
+        return _mesh.State == AssetState::Resident ? _mesh.VertexBuffer.get() : nullptr;
+    }
+
+    const VulkanIndexBuffer* AssetManager::GetIndexBuffer(const MeshHandle handle) const
+    {
+        const MeshAsset& _mesh = *m_meshes.at(handle.Index);
+        return _mesh.State == AssetState::Resident ? _mesh.IndexBuffer.get() : nullptr;
+    }
+
+    const BoundingSphere& AssetManager::GetMeshBounds(const MeshHandle handle) const
+    {
+        return m_meshes.at(handle.Index)->Bounds;
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,181 @@
+#include "Vulkan/BindlessTextureTable.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Core/Profiling.h"
+#include "Vulkan/VulkanContext.h"
+#include "utils/VkDebugUtils.h"
+
+namespace {
+    // Non-dispatchable handles are pointers on 64-bit platforms and uint64_t elsewhere
+    template <typename Handle>
+    uint64_t GetHandleValue(const Handle handle)
+    {
+        if constexpr (std::is_pointer_v<Handle>)
+        {
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+        }
+        else
+        {
+            return static_cast<uint64_t>(handle);
+        }
+    }
+
+    uint64_t HashImage(const VkDescriptorImageInfo& image)
+    {
+        uint64_t _hash = 0xCBF29CE484222325ull;
+        for (const uint64_t _value : {GetHandleValue(image.sampler), GetHandleValue(image.imageView),
+                                      uint64_t(image.imageLayout)})
+        {
+            _hash ^= _value;
+            _hash *= 0x100000001B3ull;
+        }
+        return _hash;
+    }
+
+    bool IsSameImage(const VkDescriptorImageInfo& lhs, const VkDescriptorImageInfo& rhs)
+    {
+        return lhs.sampler == rhs.sampler && lhs.imageView == rhs.imageView && lhs.imageLayout == rhs.imageLayout;
+    }
+}
+
+namespace Thryve::Rendering {
+    BindlessTextureTable::BindlessTextureTable(const uint32_t framesInFlight) : m_framesInFlight(framesInFlight)
+    {
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+        if (!_deviceSelector->SupportsDescriptorIndexing())
+        {
+            throw std::runtime_error("Bindless texture table needs VK_EXT_descriptor_indexing");
+        }
+        m_device = _deviceSelector->GetLogicalDevice();
+        m_capacity = std::min(MAX_TEXTURES, _deviceSelector->GetMaxBindlessTextures());
+
+        CreateLayout();
+        CreatePool();
+
+        VkDescriptorSetAllocateInfo _allocInfo{};
+        _allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        _allocInfo.descriptorPool = m_pool;
+        _allocInfo.descriptorSetCount = 1;
+        _allocInfo.pSetLayouts = &m_layout;
+        VK_CALL(vkAllocateDescriptorSets(m_device, &_allocInfo, &m_set));
+    }
+
+    BindlessTextureTable::~BindlessTextureTable()
+    {
+        // Frees m_set along with the pool
+        vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+        vkDestroyDescriptorSetLayout(m_device, m_layout, nullptr);
+    }
+
+    void BindlessTextureTable::CreateLayout()
+    {
+        VkDescriptorSetLayoutBinding _binding{};
+        _binding.binding = 0;
+        _binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        _binding.descriptorCount = m_capacity;
+        _binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        // Slots nobody wrote yet stay unbound, and free slots are written while other slots are read by the GPU
+        const VkDescriptorBindingFlagsEXT _bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT _bindingFlagsInfo{};
+        _bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+        _bindingFlagsInfo.bindingCount = 1;
+        _bindingFlagsInfo.pBindingFlags = &_bindingFlags;
+
+        // Binding flags are not part of the layout cache key, so the table creates and owns its layout
+        VkDescriptorSetLayoutCreateInfo _layoutInfo{};
+        _layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        _layoutInfo.pNext = &_bindingFlagsInfo;
+        _layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+        _layoutInfo.bindingCount = 1;
+        _layoutInfo.pBindings = &_binding;
+
+        VK_CALL(vkCreateDescriptorSetLayout(m_device, &_layoutInfo, nullptr, &m_layout));
+    }
+
+    void BindlessTextureTable::CreatePool()
+    {
+        VkDescriptorPoolSize _poolSize{};
+        _poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        _poolSize.descriptorCount = m_capacity;
+
+        VkDescriptorPoolCreateInfo _poolInfo{};
+        _poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        _poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+        _poolInfo.maxSets = 1;
+        _poolInfo.poolSizeCount = 1;
+        _poolInfo.pPoolSizes = &_poolSize;
+
+        VK_CALL(vkCreateDescriptorPool(m_device, &_poolInfo, nullptr, &m_pool));
+    }
+
+    void BindlessTextureTable::BeginFrame()
+    {
+        ++m_frame;
+
+        // The fence waited on before this frame retired every frame up to m_frame - m_framesInFlight
+        for (auto _it = m_slots.begin(); _it != m_slots.end();)
+        {
+            if (_it->second.LastUsedFrame + m_framesInFlight <= m_frame)
+            {
+                m_freeSlots.push_back(_it->second.Index);
+                _it = m_slots.erase(_it);
+                ++m_stats.RetireCount;
+            }
+            else
+            {
+                ++_it;
+            }
+        }
+        m_stats.SlotCount = static_cast<uint32_t>(m_slots.size());
+    }
+
+    uint32_t BindlessTextureTable::GetIndex(const VkDescriptorImageInfo& image)
+    {
+        const uint64_t _hash = HashImage(image);
+        const auto [_begin, _end] = m_slots.equal_range(_hash);
+        for (auto _it = _begin; _it != _end; ++_it)
+        {
+            if (IsSameImage(_it->second.Image, image))
+            {
+                _it->second.LastUsedFrame = m_frame;
+                return _it->second.Index;
+            }
+        }
+
+        PROFILE_FUNCTION()
+        uint32_t _index;
+        if (!m_freeSlots.empty())
+        {
+            _index = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else if (m_nextSlot < m_capacity)
+        {
+            _index = m_nextSlot++;
+        }
+        else
+        {
+            throw std::runtime_error("Bindless texture table is full");
+        }
+
+        VkWriteDescriptorSet _descriptorWrite{};
+        _descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        _descriptorWrite.dstSet = m_set;
+        _descriptorWrite.dstBinding = 0;
+        _descriptorWrite.dstArrayElement = _index;
+        _descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        _descriptorWrite.descriptorCount = 1;
+        _descriptorWrite.pImageInfo = &image;
+        vkUpdateDescriptorSets(m_device, 1, &_descriptorWrite, 0, nullptr);
+
+        m_slots.emplace(_hash, Slot{image, _index, m_frame});
+        m_stats.SlotCount = static_cast<uint32_t>(m_slots.size());
+        ++m_stats.WriteCount;
+        return _index;
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,117 @@
+#include "Vulkan/DescriptorAllocator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Core/Profiling.h"
+#include "Vulkan/VulkanContext.h"
+#include "utils/VkDebugUtils.h"
+
+namespace Thryve::Rendering {
+    DescriptorAllocator::DescriptorAllocator(const uint32_t initialSetsPerPool,
+                                             const std::initializer_list<DescriptorPoolSizeRatio> ratios) :
+        m_ratios(ratios), m_setsPerPool(std::clamp(initialSetsPerPool, 1u, MAX_SETS_PER_POOL))
+    {
+        m_device = VulkanContext::GetCurrentDevice()->GetLogicalDevice();
+    }
+
+    DescriptorAllocator::~DescriptorAllocator()
+    {
+        for (const VkDescriptorPool _pool : m_usedPools)
+        {
+            vkDestroyDescriptorPool(m_device, _pool, nullptr);
+        }
+        for (const VkDescriptorPool _pool : m_freePools)
+        {
+            vkDestroyDescriptorPool(m_device, _pool, nullptr);
+        }
+    }
+
+    VkDescriptorSet DescriptorAllocator::Allocate(const VkDescriptorSetLayout layout)
+    {
+        if (m_currentPool == VK_NULL_HANDLE)
+        {
+            m_currentPool = GrabPool();
+        }
+
+        VkDescriptorSetAllocateInfo _allocInfo{};
+        _allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        _allocInfo.descriptorPool = m_currentPool;
+        _allocInfo.descriptorSetCount = 1;
+        _allocInfo.pSetLayouts = &layout;
+
+        VkDescriptorSet _set;
+        const VkResult _result = vkAllocateDescriptorSets(m_device, &_allocInfo, &_set);
+        if (_result == VK_ERROR_OUT_OF_POOL_MEMORY || _result == VK_ERROR_FRAGMENTED_POOL)
+        {
+            // The current pool stays in m_usedPools until the next Reset
+            m_currentPool = GrabPool();
+            _allocInfo.descriptorPool = m_currentPool;
+            VK_CALL(vkAllocateDescriptorSets(m_device, &_allocInfo, &_set));
+        }
+        else
+        {
+            VK_CALL(_result);
+        }
+
+        ++m_stats.SetCount;
+        return _set;
+    }
+
+    void DescriptorAllocator::Reset()
+    {
+        for (const VkDescriptorPool _pool : m_usedPools)
+        {
+            VK_CALL(vkResetDescriptorPool(m_device, _pool, 0));
+            m_freePools.push_back(_pool);
+        }
+        m_usedPools.clear();
+        m_currentPool = VK_NULL_HANDLE;
+        m_stats.SetCount = 0;
+    }
+
+    VkDescriptorPool DescriptorAllocator::GrabPool()
+    {
+        VkDescriptorPool _pool;
+        if (!m_freePools.empty())
+        {
+            _pool = m_freePools.back();
+            m_freePools.pop_back();
+        }
+        else
+        {
+            _pool = CreatePool(m_setsPerPool);
+            m_setsPerPool = std::min(m_setsPerPool * 2, MAX_SETS_PER_POOL);
+            if (m_stats.PoolCount++ > 0)
+            {
+                ++m_stats.GrowCount;
+                PROFILE_COUNTER("Descriptor Pools", m_stats.PoolCount)
+            }
+        }
+        m_usedPools.push_back(_pool);
+        return _pool;
+    }
+
+    VkDescriptorPool DescriptorAllocator::CreatePool(const uint32_t setCount) const
+    {
+        std::vector<VkDescriptorPoolSize> _poolSizes;
+        _poolSizes.reserve(m_ratios.size());
+        for (const DescriptorPoolSizeRatio& _ratio : m_ratios)
+        {
+            _poolSizes.push_back(
+                {_ratio.Type, std::max(1u, static_cast<uint32_t>(std::ceil(_ratio.Ratio * static_cast<float>(setCount))))});
+        }
+
+        VkDescriptorPoolCreateInfo _poolInfo{};
+        _poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        // No FREE_DESCRIPTOR_SET_BIT, sets only ever go away with the whole pool
+        _poolInfo.flags = 0;
+        _poolInfo.maxSets = setCount;
+        _poolInfo.poolSizeCount = static_cast<uint32_t>(_poolSizes.size());
+        _poolInfo.pPoolSizes = _poolSizes.data();
+
+        VkDescriptorPool _pool;
+        VK_CALL(vkCreateDescriptorPool(m_device, &_poolInfo, nullptr, &_pool));
+        return _pool;
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,84 @@
+#include "Vulkan/DescriptorLayoutCache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Core/Profiling.h"
+#include "Vulkan/VulkanContext.h"
+#include "utils/VkDebugUtils.h"
+
+namespace {
+    uint64_t HashBinding(uint64_t hash, const VkDescriptorSetLayoutBinding& binding)
+    {
+        // FNV-1a over the fields, the struct has padding and a pointer that do not belong in the key
+        for (const uint64_t _value : {uint64_t(binding.binding), uint64_t(binding.descriptorType),
+                                      uint64_t(binding.descriptorCount), uint64_t(binding.stageFlags)})
+        {
+            hash ^= _value;
+            hash *= 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    bool IsSameBinding(const VkDescriptorSetLayoutBinding& lhs, const VkDescriptorSetLayoutBinding& rhs)
+    {
+        return lhs.binding == rhs.binding && lhs.descriptorType == rhs.descriptorType &&
+            lhs.descriptorCount == rhs.descriptorCount && lhs.stageFlags == rhs.stageFlags;
+    }
+}
+
+namespace Thryve::Rendering {
+    DescriptorLayoutCache::DescriptorLayoutCache()
+    {
+        m_device = VulkanContext::GetCurrentDevice()->GetLogicalDevice();
+    }
+
+    DescriptorLayoutCache::~DescriptorLayoutCache()
+    {
+        for (const auto& [_hash, _entry] : m_layouts)
+        {
+            vkDestroyDescriptorSetLayout(m_device, _entry.Layout, nullptr);
+        }
+    }
+
+    VkDescriptorSetLayout DescriptorLayoutCache::GetOrCreate(const std::span<const VkDescriptorSetLayoutBinding> bindings)
+    {
+        std::vector<VkDescriptorSetLayoutBinding> _bindings(bindings.begin(), bindings.end());
+        std::sort(_bindings.begin(), _bindings.end(),
+                  [](const VkDescriptorSetLayoutBinding& lhs, const VkDescriptorSetLayoutBinding& rhs) {
+                      return lhs.binding < rhs.binding;
+                  });
+
+        uint64_t _hash = 0xCBF29CE484222325ull;
+        for (const VkDescriptorSetLayoutBinding& _binding : _bindings)
+        {
+            if (_binding.pImmutableSamplers)
+            {
+                throw std::invalid_argument("Descriptor layout cache does not support immutable samplers");
+            }
+            _hash = HashBinding(_hash, _binding);
+        }
+
+        const auto [_begin, _end] = m_layouts.equal_range(_hash);
+        for (auto _it = _begin; _it != _end; ++_it)
+        {
+            if (std::equal(_bindings.begin(), _bindings.end(), _it->second.Bindings.begin(), _it->second.Bindings.end(),
+                           IsSameBinding))
+            {
+                ++m_hitCount;
+                return _it->second.Layout;
+            }
+        }
+
+        PROFILE_FUNCTION()
+        VkDescriptorSetLayoutCreateInfo _layoutInfo{};
+        _layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        _layoutInfo.bindingCount = static_cast<uint32_t>(_bindings.size());
+        _layoutInfo.pBindings = _bindings.data();
+
+        VkDescriptorSetLayout _layout;
+        VK_CALL(vkCreateDescriptorSetLayout(m_device, &_layoutInfo, nullptr, &_layout));
+        m_layouts.emplace(_hash, Entry{std::move(_bindings), _layout});
+        return _layout;
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,169 @@
+#include "Vulkan/DescriptorSetCache.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#include "Core/Profiling.h"
+#include "Vulkan/VulkanContext.h"
+
+namespace {
+    // Non-dispatchable handles are pointers on 64-bit platforms and uint64_t elsewhere
+    template <typename Handle>
+    uint64_t GetHandleValue(const Handle handle)
+    {
+        if constexpr (std::is_pointer_v<Handle>)
+        {
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+        }
+        else
+        {
+            return static_cast<uint64_t>(handle);
+        }
+    }
+
+    uint64_t HashValue(const uint64_t hash, const uint64_t value)
+    {
+        return (hash ^ value) * 0x100000001B3ull;
+    }
+
+    uint64_t HashWrites(const VkDescriptorSetLayout layout, const std::span<const Thryve::Rendering::DescriptorWrite> writes)
+    {
+        uint64_t _hash = HashValue(0xCBF29CE484222325ull, GetHandleValue(layout));
+        for (const Thryve::Rendering::DescriptorWrite& _write : writes)
+        {
+            _hash = HashValue(_hash, _write.Binding);
+            _hash = HashValue(_hash, _write.Type);
+            _hash = HashValue(_hash, GetHandleValue(_write.Buffer.buffer));
+            _hash = HashValue(_hash, _write.Buffer.offset);
+            _hash = HashValue(_hash, _write.Buffer.range);
+            _hash = HashValue(_hash, GetHandleValue(_write.Image.sampler));
+            _hash = HashValue(_hash, GetHandleValue(_write.Image.imageView));
+            _hash = HashValue(_hash, _write.Image.imageLayout);
+        }
+        return _hash;
+    }
+
+    bool IsSameWrite(const Thryve::Rendering::DescriptorWrite& lhs, const Thryve::Rendering::DescriptorWrite& rhs)
+    {
+        return lhs.Binding == rhs.Binding && lhs.Type == rhs.Type && lhs.Buffer.buffer == rhs.Buffer.buffer &&
+            lhs.Buffer.offset == rhs.Buffer.offset && lhs.Buffer.range == rhs.Buffer.range &&
+            lhs.Image.sampler == rhs.Image.sampler && lhs.Image.imageView == rhs.Image.imageView &&
+            lhs.Image.imageLayout == rhs.Image.imageLayout;
+    }
+
+    bool IsBufferType(const VkDescriptorType type)
+    {
+        return type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
+            type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    }
+}
+
+namespace Thryve::Rendering {
+    DescriptorWrite DescriptorWrite::UniformBuffer(const uint32_t binding, const VkBuffer buffer,
+                                                   const VkDeviceSize offset, const VkDeviceSize range)
+    {
+        DescriptorWrite _write;
+        _write.Binding = binding;
+        _write.Type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        _write.Buffer = {buffer, offset, range};
+        return _write;
+    }
+
+    DescriptorWrite DescriptorWrite::DynamicUniformBuffer(const uint32_t binding, const VkBuffer buffer,
+                                                          const VkDeviceSize offset, const VkDeviceSize range)
+    {
+        DescriptorWrite _write = UniformBuffer(binding, buffer, offset, range);
+        _write.Type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        return _write;
+    }
+
+    DescriptorWrite DescriptorWrite::CombinedImageSampler(const uint32_t binding, const VkDescriptorImageInfo& image)
+    {
+        DescriptorWrite _write;
+        _write.Binding = binding;
+        _write.Type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        _write.Image = image;
+        return _write;
+    }
+
+    DescriptorSetCache::DescriptorSetCache(DescriptorAllocator& allocator) : m_allocator(allocator)
+    {
+        m_device = VulkanContext::GetCurrentDevice()->GetLogicalDevice();
+    }
+
+    void DescriptorSetCache::BeginFrame()
+    {
+        const uint32_t _usedLastFrame = m_usedThisFrame;
+        m_usedThisFrame = 0;
+        ++m_frame;
+
+        // Stale sets pile up whenever a resource changes, e.g. a texture replacing its fallback
+        if (m_sets.size() > _usedLastFrame + MAX_UNUSED_SETS)
+        {
+            PROFILE_SCOPE("Flush Descriptor Set Cache")
+            m_sets.clear();
+            m_allocator.Reset();
+            ++m_stats.FlushCount;
+        }
+    }
+
+    bool DescriptorSetCache::Matches(const Entry& entry, const VkDescriptorSetLayout layout,
+                                     const std::span<const DescriptorWrite> writes) const
+    {
+        return entry.Layout == layout &&
+            std::equal(writes.begin(), writes.end(), entry.Writes.begin(), entry.Writes.end(), IsSameWrite);
+    }
+
+    VkDescriptorSet DescriptorSetCache::GetOrWrite(const VkDescriptorSetLayout layout,
+                                                   const std::span<const DescriptorWrite> writes)
+    {
+        const uint64_t _hash = HashWrites(layout, writes);
+        const auto [_begin, _end] = m_sets.equal_range(_hash);
+        for (auto _it = _begin; _it != _end; ++_it)
+        {
+            Entry& _entry = _it->second;
+            if (Matches(_entry, layout, writes))
+            {
+                if (_entry.LastUsedFrame != m_frame)
+                {
+                    _entry.LastUsedFrame = m_frame;
+                    ++m_usedThisFrame;
+                }
+                ++m_stats.HitCount;
+                return _entry.Set;
+            }
+        }
+
+        PROFILE_FUNCTION()
+        const VkDescriptorSet _set = m_allocator.Allocate(layout);
+
+        std::vector<VkWriteDescriptorSet> _descriptorWrites;
+        _descriptorWrites.reserve(writes.size());
+        for (const DescriptorWrite& _write : writes)
+        {
+            VkWriteDescriptorSet _descriptorWrite{};
+            _descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            _descriptorWrite.dstSet = _set;
+            _descriptorWrite.dstBinding = _write.Binding;
+            _descriptorWrite.dstArrayElement = 0;
+            _descriptorWrite.descriptorType = _write.Type;
+            _descriptorWrite.descriptorCount = 1;
+            if (IsBufferType(_write.Type))
+            {
+                _descriptorWrite.pBufferInfo = &_write.Buffer;
+            }
+            else
+            {
+                _descriptorWrite.pImageInfo = &_write.Image;
+            }
+            _descriptorWrites.push_back(_descriptorWrite);
+        }
+        vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(_descriptorWrites.size()), _descriptorWrites.data(), 0,
+                               nullptr);
+
+        m_sets.emplace(_hash, Entry{layout, {writes.begin(), writes.end()}, _set, m_frame});
+        ++m_usedThisFrame;
+        ++m_stats.WriteCount;
+        return _set;
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,386 @@
+#include "Vulkan/GpuDrivenScene.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "Config.h"
+#include "Core/Profiling.h"
+#include "Core/ServiceRegistry.h"
+#include "Vulkan/PipelineCacheService.h"
+#include "Vulkan/VulkanContext.h"
+#include "Vulkan/VulkanPipeline.h"
+#include "utils/VkDebugUtils.h"
+#include "utils/VulkanBufferUtils.h"
+
+namespace Thryve::Rendering {
+    GpuDrivenScene::GpuDrivenScene(DescriptorLayoutCache& layoutCache, const AssetManager& assetManager,
+                                   const uint32_t frameCount) :
+        m_assetManager(assetManager),
+        m_descriptorAllocator(frameCount, {{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4.0f}}), m_frames(frameCount)
+    {
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+        if (!_deviceSelector->SupportsIndirectDraws())
+        {
+            throw std::runtime_error("GPU-driven drawing needs multiDrawIndirect and drawIndirectFirstInstance");
+        }
+        m_device = _deviceSelector->GetLogicalDevice();
+
+        m_bCompact = _deviceSelector->SupportsDrawIndirectCount();
+        if (m_bCompact)
+        {
+            m_drawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                vkGetDeviceProcAddr(m_device, "vkCmdDrawIndexedIndirectCountKHR"));
+        }
+
+        std::array<VkDescriptorSetLayoutBinding, 4> _bindings{};
+        for (uint32_t i = 0; i < _bindings.size(); i++)
+        {
+            // Instances, objects, draw commands and draw counts
+            _bindings[i].binding = i;
+            _bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            _bindings[i].descriptorCount = 1;
+            _bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+        m_setLayout = layoutCache.GetOrCreate(_bindings);
+
+        CreatePipeline();
+    }
+
+    GpuDrivenScene::~GpuDrivenScene()
+    {
+        for (FrameResources& _frame : m_frames)
+        {
+            DestroyBuffers(_frame);
+        }
+        vkDestroyPipeline(m_device, m_pipeline, nullptr);
+        vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+    }
+
+    void GpuDrivenScene::CreatePipeline()
+    {
+        PROFILE_FUNCTION()
+        VkPushConstantRange _pushConstantRange{};
+        _pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        _pushConstantRange.offset = 0;
+        _pushConstantRange.size = sizeof(CullPushConstants);
+
+        VkPipelineLayoutCreateInfo _layoutInfo{};
+        _layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        _layoutInfo.setLayoutCount = 1;
+        _layoutInfo.pSetLayouts = &m_setLayout;
+        _layoutInfo.pushConstantRangeCount = 1;
+        _layoutInfo.pPushConstantRanges = &_pushConstantRange;
+        VK_CALL(vkCreatePipelineLayout(m_device, &_layoutInfo, nullptr, &m_pipelineLayout));
+
+        const std::vector<char> _code = VulkanPipeline::ReadShaderFile(std::string(SHADERS_DIR) + "/SPIRV/cull.comp.spv");
+        VkShaderModuleCreateInfo _moduleInfo{};
+        _moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        _moduleInfo.codeSize = _code.size();
+        _moduleInfo.pCode = reinterpret_cast<const uint32_t*>(_code.data());
+        VkShaderModule _module;
+        VK_CALL(vkCreateShaderModule(m_device, &_moduleInfo, nullptr, &_module));
+
+        // constant_id 0 of cull.comp, compacts survivors instead of writing every command in place
+        const VkBool32 _bCompact = m_bCompact ? VK_TRUE : VK_FALSE;
+        VkSpecializationMapEntry _mapEntry{0, 0, sizeof(VkBool32)};
+        VkSpecializationInfo _specialization{};
+        _specialization.mapEntryCount = 1;
+        _specialization.pMapEntries = &_mapEntry;
+        _specialization.dataSize = sizeof(VkBool32);
+        _specialization.pData = &_bCompact;
+
+        VkComputePipelineCreateInfo _pipelineInfo{};
+        _pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        _pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        _pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        _pipelineInfo.stage.module = _module;
+        _pipelineInfo.stage.pName = "main";
+        _pipelineInfo.stage.pSpecializationInfo = &_specialization;
+        _pipelineInfo.layout = m_pipelineLayout;
+
+        auto _pipelineCacheService = Core::ServiceRegistry::GetService<PipelineCacheService>();
+        const auto _creationStart = std::chrono::steady_clock::now();
+        VK_CALL(vkCreateComputePipelines(m_device, _pipelineCacheService->GetPipelineCache(), 1, &_pipelineInfo,
+                                         nullptr, &m_pipeline));
+        _pipelineCacheService->RecordPipelineCreation(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _creationStart).count());
+
+        vkDestroyShaderModule(m_device, _module, nullptr);
+    }
+
+    uint32_t GpuDrivenScene::AddObject(const MeshHandle mesh, const InstanceData& instance)
+    {
+        if (mesh.Index >= m_batchOfMesh.size())
+        {
+            m_batchOfMesh.resize(mesh.Index + 1, UINT32_MAX);
+        }
+        if (m_batchOfMesh[mesh.Index] == UINT32_MAX)
+        {
+            m_batchOfMesh[mesh.Index] = static_cast<uint32_t>(m_batches.size());
+            m_batches.push_back({mesh});
+        }
+        Batch& _batch = m_batches[m_batchOfMesh[mesh.Index]];
+        ++_batch.ObjectCount;
+
+        GpuObject _object{};
+        _object.Batch = m_batchOfMesh[mesh.Index];
+        if (_batch.bResident)
+        {
+            const BoundingSphere& _bounds = m_assetManager.GetMeshBounds(mesh);
+            _object.Sphere = glm::vec4(_bounds.Center, _bounds.Radius);
+            _object.IndexCount = m_assetManager.GetIndexBuffer(mesh)->GetIndexCount();
+        }
+
+        m_instances.push_back(instance);
+        m_objects.push_back(_object);
+        // Command ranges move, RefreshBatches uploads everything again
+        m_bLayoutDirty = true;
+
+        m_stats.ObjectCount = static_cast<uint32_t>(m_objects.size());
+        m_stats.BatchCount = static_cast<uint32_t>(m_batches.size());
+        return static_cast<uint32_t>(m_objects.size() - 1);
+    }
+
+    void GpuDrivenScene::UpdateObject(const uint32_t object, const InstanceData& instance)
+    {
+        m_instances[object] = instance;
+        MarkDirty(object, object + 1);
+    }
+
+    void GpuDrivenScene::MarkDirty(const uint32_t begin, const uint32_t end)
+    {
+        for (FrameResources& _frame : m_frames)
+        {
+            if (_frame.DirtyBegin == _frame.DirtyEnd)
+            {
+                _frame.DirtyBegin = begin;
+                _frame.DirtyEnd = end;
+            }
+            else
+            {
+                _frame.DirtyBegin = std::min(_frame.DirtyBegin, begin);
+                _frame.DirtyEnd = std::max(_frame.DirtyEnd, end);
+            }
+        }
+    }
+
+    void GpuDrivenScene::RefreshBatches()
+    {
+        for (uint32_t _batchIndex = 0; _batchIndex < m_batches.size(); ++_batchIndex)
+        {
+            Batch& _batch = m_batches[_batchIndex];
+            if (_batch.bResident || !m_assetManager.GetVertexBuffer(_batch.Mesh))
+            {
+                continue;
+            }
+
+            // Objects of a mesh that was still streaming were culled against an empty sphere and drew nothing
+            _batch.bResident = true;
+            const BoundingSphere& _bounds = m_assetManager.GetMeshBounds(_batch.Mesh);
+            const uint32_t _indexCount = m_assetManager.GetIndexBuffer(_batch.Mesh)->GetIndexCount();
+            for (GpuObject& _object : m_objects)
+            {
+                if (_object.Batch == _batchIndex)
+                {
+                    _object.Sphere = glm::vec4(_bounds.Center, _bounds.Radius);
+                    _object.IndexCount = _indexCount;
+                }
+            }
+            m_bLayoutDirty = true;
+        }
+
+        if (!m_bLayoutDirty)
+        {
+            return;
+        }
+
+        PROFILE_SCOPE("Layout GPU-Driven Batches")
+        uint32_t _firstCommand = 0;
+        for (Batch& _batch : m_batches)
+        {
+            _batch.FirstCommand = _firstCommand;
+            _firstCommand += _batch.ObjectCount;
+        }
+
+        std::vector<uint32_t> _nextSlot(m_batches.size());
+        for (GpuObject& _object : m_objects)
+        {
+            _object.FirstCommand = m_batches[_object.Batch].FirstCommand;
+            _object.Slot = _object.FirstCommand + _nextSlot[_object.Batch]++;
+        }
+
+        MarkDirty(0, static_cast<uint32_t>(m_objects.size()));
+        m_bLayoutDirty = false;
+    }
+
+    void GpuDrivenScene::DestroyBuffers(FrameResources& frame) const
+    {
+        VulkanBufferUtils::DestroyBuffer(frame.InstanceBuffer, frame.InstanceAllocation);
+        VulkanBufferUtils::DestroyBuffer(frame.ObjectBuffer, frame.ObjectAllocation);
+        VulkanBufferUtils::DestroyBuffer(frame.CommandBuffer, frame.CommandAllocation);
+        VulkanBufferUtils::DestroyBuffer(frame.CountBuffer, frame.CountAllocation);
+    }
+
+    void GpuDrivenScene::Reserve(FrameResources& frame)
+    {
+        const auto _objectCount = static_cast<uint32_t>(m_objects.size());
+        const auto _batchCount = static_cast<uint32_t>(m_batches.size());
+        if (_objectCount <= frame.ObjectCapacity && _batchCount <= frame.BatchCapacity)
+        {
+            return;
+        }
+
+        PROFILE_FUNCTION()
+        DestroyBuffers(frame);
+        frame.ObjectCapacity = std::max({_objectCount, frame.ObjectCapacity * 2, 64u});
+        frame.BatchCapacity = std::max({_batchCount, frame.BatchCapacity * 2, 8u});
+
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+        const VkPhysicalDevice _physicalDevice = _deviceSelector->GetPhysicalDevice();
+        constexpr VkMemoryPropertyFlags HOST_VISIBLE = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+        void* _mapped = nullptr;
+        VulkanBufferUtils::CreateBuffer({m_device, _physicalDevice, sizeof(InstanceData) * frame.ObjectCapacity,
+                                         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                         HOST_VISIBLE},
+                                        frame.InstanceBuffer, frame.InstanceAllocation, &_mapped);
+        frame.Instances = static_cast<InstanceData*>(_mapped);
+        VulkanBufferUtils::CreateBuffer({m_device, _physicalDevice, sizeof(GpuObject) * frame.ObjectCapacity,
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, HOST_VISIBLE},
+                                        frame.ObjectBuffer, frame.ObjectAllocation, &_mapped);
+        frame.Objects = static_cast<GpuObject*>(_mapped);
+        VulkanBufferUtils::CreateBuffer({m_device, _physicalDevice,
+                                         sizeof(VkDrawIndexedIndirectCommand) * frame.ObjectCapacity,
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT},
+                                        frame.CommandBuffer, frame.CommandAllocation);
+        VulkanBufferUtils::CreateBuffer({m_device, _physicalDevice, sizeof(uint32_t) * frame.BatchCapacity,
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                         VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT},
+                                        frame.CountBuffer, frame.CountAllocation);
+
+        if (frame.Set == VK_NULL_HANDLE)
+        {
+            frame.Set = m_descriptorAllocator.Allocate(m_setLayout);
+        }
+        // Nothing reads the set while its frame's buffers are replaced
+        const std::array<VkDescriptorBufferInfo, 4> _bufferInfos = {
+            VkDescriptorBufferInfo{frame.InstanceBuffer, 0, VK_WHOLE_SIZE},
+            VkDescriptorBufferInfo{frame.ObjectBuffer, 0, VK_WHOLE_SIZE},
+            VkDescriptorBufferInfo{frame.CommandBuffer, 0, VK_WHOLE_SIZE},
+            VkDescriptorBufferInfo{frame.CountBuffer, 0, VK_WHOLE_SIZE},
+        };
+        std::array<VkWriteDescriptorSet, 4> _writes{};
+        for (uint32_t i = 0; i < _writes.size(); i++)
+        {
+            _writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            _writes[i].dstSet = frame.Set;
+            _writes[i].dstBinding = i;
+            _writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            _writes[i].descriptorCount = 1;
+            _writes[i].pBufferInfo = &_bufferInfos[i];
+        }
+        vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(_writes.size()), _writes.data(), 0, nullptr);
+
+        // The new buffers hold nothing yet
+        frame.DirtyBegin = 0;
+        frame.DirtyEnd = _objectCount;
+    }
+
+    void GpuDrivenScene::BeginFrame(const uint32_t frameIndex)
+    {
+        PROFILE_FUNCTION()
+        m_frameIndex = frameIndex % static_cast<uint32_t>(m_frames.size());
+        RefreshBatches();
+
+        FrameResources& _frame = m_frames[m_frameIndex];
+        m_stats.UploadedObjectCount = 0;
+        if (m_objects.empty())
+        {
+            return;
+        }
+        Reserve(_frame);
+
+        if (_frame.DirtyBegin != _frame.DirtyEnd)
+        {
+            const uint32_t _count = _frame.DirtyEnd - _frame.DirtyBegin;
+            std::memcpy(_frame.Instances + _frame.DirtyBegin, m_instances.data() + _frame.DirtyBegin,
+                        sizeof(InstanceData) * _count);
+            std::memcpy(_frame.Objects + _frame.DirtyBegin, m_objects.data() + _frame.DirtyBegin,
+                        sizeof(GpuObject) * _count);
+            m_stats.UploadedObjectCount = _count;
+            _frame.DirtyBegin = _frame.DirtyEnd = 0;
+        }
+    }
+
+    void GpuDrivenScene::RecordCull(const VkCommandBuffer commandBuffer, const Frustum& frustum)
+    {
+        if (m_objects.empty())
+        {
+            return;
+        }
+        const FrameResources& _frame = m_frames[m_frameIndex];
+
+        if (m_bCompact)
+        {
+            vkCmdFillBuffer(commandBuffer, _frame.CountBuffer, 0, sizeof(uint32_t) * m_batches.size(), 0);
+
+            VkMemoryBarrier _clearBarrier{};
+            _clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            _clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            _clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                                 1, &_clearBarrier, 0, nullptr, 0, nullptr);
+        }
+
+        CullPushConstants _pushConstants{};
+        _pushConstants.Planes = frustum.Planes;
+        _pushConstants.ObjectCount = static_cast<uint32_t>(m_objects.size());
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &_frame.Set, 0,
+                                nullptr);
+        vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants),
+                           &_pushConstants);
+        vkCmdDispatch(commandBuffer, (_pushConstants.ObjectCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+    }
+
+    void GpuDrivenScene::RecordDraws(const VkCommandBuffer commandBuffer) const
+    {
+        if (m_objects.empty())
+        {
+            return;
+        }
+        const FrameResources& _frame = m_frames[m_frameIndex];
+
+        const VkDeviceSize _offset = 0;
+        vkCmdBindVertexBuffers(commandBuffer, 1, 1, &_frame.InstanceBuffer, &_offset);
+
+        constexpr uint32_t STRIDE = sizeof(VkDrawIndexedIndirectCommand);
+        for (uint32_t _batchIndex = 0; _batchIndex < m_batches.size(); ++_batchIndex)
+        {
+            const Batch& _batch = m_batches[_batchIndex];
+            if (!_batch.bResident)
+            {
+                continue;
+            }
+
+            m_assetManager.GetVertexBuffer(_batch.Mesh)->Bind(commandBuffer);
+            m_assetManager.GetIndexBuffer(_batch.Mesh)->Bind(commandBuffer);
+            const VkDeviceSize _commandOffset = static_cast<VkDeviceSize>(_batch.FirstCommand) * STRIDE;
+            if (m_bCompact)
+            {
+                m_drawIndexedIndirectCount(commandBuffer, _frame.CommandBuffer, _commandOffset, _frame.CountBuffer,
+                                           sizeof(uint32_t) * _batchIndex, _batch.ObjectCount, STRIDE);
+            }
+            else
+            {
+                vkCmdDrawIndexedIndirect(commandBuffer, _frame.CommandBuffer, _commandOffset, _batch.ObjectCount,
+                                         STRIDE);
+            }
+        }
+    }
+} // namespace Thryve::Rendering
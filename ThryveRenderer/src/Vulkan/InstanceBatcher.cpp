@@ -0,0 +1,116 @@
+#include "Vulkan/InstanceBatcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Core/Profiling.h"
+#include "Vulkan/VulkanContext.h"
+#include "utils/VulkanBufferUtils.h"
+
+namespace Thryve::Rendering {
+    InstanceBatcher::InstanceBatcher(const AssetManager& assetManager, const uint32_t frameCount) :
+        m_assetManager(assetManager), m_frameBuffers(frameCount)
+    {
+    }
+
+    InstanceBatcher::~InstanceBatcher()
+    {
+        for (InstanceBuffer& _buffer : m_frameBuffers)
+        {
+            if (_buffer.Buffer != VK_NULL_HANDLE)
+            {
+                VulkanBufferUtils::DestroyBuffer(_buffer.Buffer, _buffer.Allocation);
+            }
+        }
+    }
+
+    void InstanceBatcher::BeginFrame(const uint32_t frameIndex)
+    {
+        m_frameIndex = frameIndex % static_cast<uint32_t>(m_frameBuffers.size());
+        for (std::vector<InstanceData>& _batch : m_batches)
+        {
+            _batch.clear();
+        }
+        m_instanceCount = 0;
+    }
+
+    void InstanceBatcher::Submit(const MeshHandle mesh, const std::span<const InstanceData> instances)
+    {
+        if (!mesh.IsValid() || instances.empty())
+        {
+            return;
+        }
+        if (mesh.Index >= m_batches.size())
+        {
+            m_batches.resize(mesh.Index + 1);
+        }
+        std::vector<InstanceData>& _batch = m_batches[mesh.Index];
+        _batch.insert(_batch.end(), instances.begin(), instances.end());
+        m_instanceCount += static_cast<uint32_t>(instances.size());
+    }
+
+    void InstanceBatcher::Reserve(InstanceBuffer& buffer, const uint32_t instanceCount)
+    {
+        if (instanceCount <= buffer.Capacity)
+        {
+            return;
+        }
+
+        PROFILE_FUNCTION()
+        if (buffer.Buffer != VK_NULL_HANDLE)
+        {
+            VulkanBufferUtils::DestroyBuffer(buffer.Buffer, buffer.Allocation);
+            ++m_stats.GrowCount;
+        }
+
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+        buffer.Capacity = std::max({instanceCount, buffer.Capacity * 2, 64u});
+        void* _mapped = nullptr;
+        VulkanBufferUtils::CreateBuffer({_deviceSelector->GetLogicalDevice(), _deviceSelector->GetPhysicalDevice(),
+                                         sizeof(InstanceData) * buffer.Capacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT},
+                                        buffer.Buffer, buffer.Allocation, &_mapped);
+        buffer.Mapped = static_cast<InstanceData*>(_mapped);
+    }
+
+    void InstanceBatcher::Record(const VkCommandBuffer commandBuffer)
+    {
+        PROFILE_FUNCTION()
+        m_stats.DrawCount = 0;
+        m_stats.InstanceCount = 0;
+        if (m_instanceCount == 0)
+        {
+            return;
+        }
+
+        InstanceBuffer& _buffer = m_frameBuffers[m_frameIndex];
+        Reserve(_buffer, m_instanceCount);
+
+        const VkDeviceSize _offset = 0;
+        vkCmdBindVertexBuffers(commandBuffer, 1, 1, &_buffer.Buffer, &_offset);
+
+        uint32_t _firstInstance = 0;
+        for (uint32_t _meshIndex = 0; _meshIndex < m_batches.size(); ++_meshIndex)
+        {
+            const std::vector<InstanceData>& _batch = m_batches[_meshIndex];
+            const MeshHandle _mesh{_meshIndex};
+            const auto* _vertexBuffer = _batch.empty() ? nullptr : m_assetManager.GetVertexBuffer(_mesh);
+            if (!_vertexBuffer)
+            {
+                continue;
+            }
+
+            const auto _instanceCount = static_cast<uint32_t>(_batch.size());
+            std::memcpy(_buffer.Mapped + _firstInstance, _batch.data(), sizeof(InstanceData) * _instanceCount);
+
+            const auto* _indexBuffer = m_assetManager.GetIndexBuffer(_mesh);
+            _vertexBuffer->Bind(commandBuffer);
+            _indexBuffer->Bind(commandBuffer);
+            _indexBuffer->DrawInstanced(commandBuffer, _instanceCount, _firstInstance);
+
+            _firstInstance += _instanceCount;
+            ++m_stats.DrawCount;
+        }
+        m_stats.InstanceCount = _firstInstance;
+    }
+} // namespace Thryve::Rendering
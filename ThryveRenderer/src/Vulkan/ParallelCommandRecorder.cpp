@@ -0,0 +1,106 @@
+#include "Vulkan/ParallelCommandRecorder.h"
+
+#include "Core/Profiling.h"
+#include "Core/ServiceRegistry.h"
+#include "Vulkan/VulkanContext.h"
+#include "utils/VkDebugUtils.h"
+
+namespace Thryve::Rendering {
+    ParallelCommandRecorder::ParallelCommandRecorder(const uint32_t frameCount) :
+        m_jobSystem(Core::ServiceRegistry::GetService<Core::JobSystem>())
+    {
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+        m_device = _deviceSelector->GetLogicalDevice();
+
+        VkCommandPoolCreateInfo _poolInfo{};
+        _poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        // Buffers live for one frame and are only ever reset through their pool
+        _poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        _poolInfo.queueFamilyIndex = _deviceSelector->GetQueueFamilyIndices().GraphicsFamily.value();
+
+        m_pools = std::vector<ThreadPool>(static_cast<size_t>(frameCount) * GetSlotCount());
+        for (ThreadPool& _pool : m_pools)
+        {
+            VK_CALL(vkCreateCommandPool(m_device, &_poolInfo, nullptr, &_pool.Pool));
+        }
+    }
+
+    ParallelCommandRecorder::~ParallelCommandRecorder()
+    {
+        // Destroying a pool frees its buffers
+        for (const ThreadPool& _pool : m_pools)
+        {
+            vkDestroyCommandPool(m_device, _pool.Pool, nullptr);
+        }
+    }
+
+    void ParallelCommandRecorder::BeginFrame(const uint32_t frameIndex)
+    {
+        PROFILE_FUNCTION()
+        const uint32_t _slotCount = GetSlotCount();
+        m_frameIndex = frameIndex % static_cast<uint32_t>(m_pools.size() / _slotCount);
+        for (uint32_t _slot = 0; _slot < _slotCount; ++_slot)
+        {
+            ThreadPool& _pool = m_pools[m_frameIndex * _slotCount + _slot];
+            if (_pool.UsedCount > 0)
+            {
+                VK_CALL(vkResetCommandPool(m_device, _pool.Pool, 0));
+                _pool.UsedCount = 0;
+            }
+        }
+    }
+
+    ParallelCommandRecorder::ThreadPool& ParallelCommandRecorder::GetThreadPool()
+    {
+        const uint32_t _slotCount = GetSlotCount();
+        const uint32_t _workerIndex = Core::JobSystem::GetCurrentWorkerIndex();
+        const uint32_t _slot = _workerIndex == UINT32_MAX ? _slotCount - 1 : _workerIndex;
+        return m_pools[m_frameIndex * _slotCount + _slot];
+    }
+
+    VkCommandBuffer ParallelCommandRecorder::BeginSecondary(const VkCommandBufferInheritanceInfo& inheritance)
+    {
+        ThreadPool& _pool = GetThreadPool();
+        if (_pool.UsedCount == _pool.Buffers.size())
+        {
+            VkCommandBufferAllocateInfo _allocInfo{};
+            _allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            _allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            _allocInfo.commandPool = _pool.Pool;
+            _allocInfo.commandBufferCount = 1;
+
+            VkCommandBuffer _commandBuffer;
+            VK_CALL(vkAllocateCommandBuffers(m_device, &_allocInfo, &_commandBuffer));
+            _pool.Buffers.push_back(_commandBuffer);
+        }
+        const VkCommandBuffer _commandBuffer = _pool.Buffers[_pool.UsedCount++];
+
+        VkCommandBufferBeginInfo _beginInfo{};
+        _beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        _beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        _beginInfo.pInheritanceInfo = &inheritance;
+        VK_CALL(vkBeginCommandBuffer(_commandBuffer, &_beginInfo));
+        return _commandBuffer;
+    }
+
+    void ParallelCommandRecorder::EndSecondary(const VkCommandBuffer commandBuffer)
+    {
+        VK_CALL(vkEndCommandBuffer(commandBuffer));
+    }
+
+    void ParallelCommandRecorder::UpdateStats(const uint32_t itemCount)
+    {
+        m_stats.ItemCount = itemCount;
+        m_stats.SecondaryCount = static_cast<uint32_t>(m_recorded.size());
+        m_stats.ThreadCount = 0;
+        const uint32_t _slotCount = GetSlotCount();
+        for (uint32_t _slot = 0; _slot < _slotCount; ++_slot)
+        {
+            if (m_pools[m_frameIndex * _slotCount + _slot].UsedCount > 0)
+            {
+                ++m_stats.ThreadCount;
+            }
+        }
+        PROFILE_COUNTER("Secondary Command Buffers", static_cast<int64_t>(m_stats.SecondaryCount))
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,190 @@
+#include "Vulkan/PipelineCacheService.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "Config.h"
+#include "Core/AtomicFile.h"
+#include "Core/Log.h"
+#include "Core/Profiling.h"
+#include "Core/ServiceRegistry.h"
+#include "Vulkan/VulkanContext.h"
+#include "utils/VkDebugUtils.h"
+
+namespace {
+    // FNV-1a over the driver blob, catches truncated or corrupted files before the driver sees them
+    uint64_t HashCacheData(const char* data, const size_t size)
+    {
+        uint64_t _hash = 0xCBF29CE484222325ull;
+        for (size_t _i = 0; _i < size; ++_i)
+        {
+            _hash ^= static_cast<uint8_t>(data[_i]);
+            _hash *= 0x100000001B3ull;
+        }
+        return _hash;
+    }
+}
+
+namespace Thryve::Rendering {
+    void PipelineCacheService::Init(ServiceConfiguration* configuration)
+    {
+        if (const auto* _config = dynamic_cast<PipelineCacheServiceConfiguration*>(configuration))
+        {
+            m_config = *_config;
+        }
+
+        if (m_config.CachePath.empty())
+        {
+            m_config.CachePath = std::string(CACHE_DIR) + "/pipeline_cache.bin";
+        }
+    }
+
+    void PipelineCacheService::ShutDown()
+    {
+        if (m_pipelineCache != VK_NULL_HANDLE)
+        {
+            // The device may already be gone at this point, so the cache can neither be saved nor destroyed. The logger
+            // may be gone as well, so this goes straight to stderr
+            std::cerr << "PipelineCacheService shut down before Release, the pipeline cache was not saved" << std::endl;
+        }
+    }
+
+    VkPipelineCache PipelineCacheService::GetPipelineCache()
+    {
+        std::lock_guard _lock(m_mutex);
+        if (m_pipelineCache == VK_NULL_HANDLE && !m_bReleased)
+        {
+            CreateCache();
+        }
+        return m_pipelineCache;
+    }
+
+    void PipelineCacheService::RecordPipelineCreation(const double milliseconds)
+    {
+        std::lock_guard _lock(m_mutex);
+        ++m_stats.PipelineCount;
+        m_stats.PipelineCreationMilliseconds += milliseconds;
+    }
+
+    void PipelineCacheService::Release()
+    {
+        PROFILE_FUNCTION()
+        std::lock_guard _lock(m_mutex);
+        m_bReleased = true;
+        if (m_pipelineCache == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        SaveCacheData();
+        vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+        m_pipelineCache = VK_NULL_HANDLE;
+        m_device = VK_NULL_HANDLE;
+    }
+
+    PipelineCacheStats PipelineCacheService::GetStats()
+    {
+        std::lock_guard _lock(m_mutex);
+        return m_stats;
+    }
+
+    void PipelineCacheService::CreateCache()
+    {
+        PROFILE_FUNCTION()
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+        m_device = _deviceSelector->GetLogicalDevice();
+
+        VkPhysicalDeviceProperties _properties;
+        vkGetPhysicalDeviceProperties(_deviceSelector->GetPhysicalDevice(), &_properties);
+
+        const std::vector<char> _data = m_config.bLoadFromDisk ? LoadCacheData(_properties) : std::vector<char>{};
+
+        VkPipelineCacheCreateInfo _createInfo{};
+        _createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        _createInfo.initialDataSize = _data.size();
+        _createInfo.pInitialData = _data.empty() ? nullptr : _data.data();
+
+        if (vkCreatePipelineCache(m_device, &_createInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
+        {
+            // Drivers may still refuse a blob that passed the header check, fall back to an empty cache
+            _createInfo.initialDataSize = 0;
+            _createInfo.pInitialData = nullptr;
+            VK_CALL(vkCreatePipelineCache(m_device, &_createInfo, nullptr, &m_pipelineCache));
+        }
+
+        m_stats.bWarm = _createInfo.initialDataSize > 0;
+        m_stats.LoadedBytes = _createInfo.initialDataSize;
+    }
+
+    std::vector<char> PipelineCacheService::LoadCacheData(const VkPhysicalDeviceProperties& properties) const
+    {
+        std::ifstream _file(m_config.CachePath, std::ios::binary | std::ios::ate);
+        if (!_file.is_open())
+        {
+            return {};
+        }
+
+        const auto _fileSize = static_cast<size_t>(_file.tellg());
+        _file.seekg(0);
+
+        FileHeader _header{};
+        if (_fileSize < sizeof(FileHeader) || !_file.read(reinterpret_cast<char*>(&_header), sizeof(_header)) ||
+            _header.Magic != FileHeader::MAGIC || _header.Version != FileHeader::VERSION ||
+            _header.DataSize != _fileSize - sizeof(FileHeader) || _header.DataSize < sizeof(VkPipelineCacheHeaderVersionOne))
+        {
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogWarning(
+                "Ignoring malformed pipeline cache " + m_config.CachePath);
+            return {};
+        }
+
+        std::vector<char> _data(_header.DataSize);
+        if (!_file.read(_data.data(), static_cast<std::streamsize>(_data.size())) ||
+            HashCacheData(_data.data(), _data.size()) != _header.DataHash)
+        {
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogWarning(
+                "Ignoring corrupted pipeline cache " + m_config.CachePath);
+            return {};
+        }
+
+        VkPipelineCacheHeaderVersionOne _driverHeader;
+        std::memcpy(&_driverHeader, _data.data(), sizeof(_driverHeader));
+        if (_driverHeader.headerSize < sizeof(VkPipelineCacheHeaderVersionOne) ||
+            _driverHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+            _driverHeader.vendorID != properties.vendorID || _driverHeader.deviceID != properties.deviceID ||
+            std::memcmp(_driverHeader.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+        {
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(
+                "Pipeline cache was written by another device or driver, starting cold");
+            return {};
+        }
+
+        return _data;
+    }
+
+    void PipelineCacheService::SaveCacheData() const
+    {
+        size_t _size = 0;
+        VK_CALL(vkGetPipelineCacheData(m_device, m_pipelineCache, &_size, nullptr));
+        std::vector<char> _data(_size);
+        VK_CALL(vkGetPipelineCacheData(m_device, m_pipelineCache, &_size, _data.data()));
+        _data.resize(_size);
+
+        const FileHeader _header{FileHeader::MAGIC, FileHeader::VERSION, _data.size(),
+                                 HashCacheData(_data.data(), _data.size())};
+
+        // A failed save keeps the previous cache, the next run only starts colder
+        try
+        {
+            Core::WriteFileAtomically(m_config.CachePath, [&](std::ostream& file) {
+                file.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+                file.write(_data.data(), static_cast<std::streamsize>(_data.size()));
+            });
+        }
+        catch (const std::runtime_error& _exception)
+        {
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogError(
+                std::string("Failed to save pipeline cache: ") + _exception.what());
+        }
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,866 @@
+#include "Vulkan/RenderGraph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Vulkan/VulkanContext.h"
+#include "Vulkan/VulkanGpuProfiler.h"
+#include "utils/ImageUtils.h"
+#include "utils/VkDebugUtils.h"
+
+namespace {
+    using Thryve::Rendering::RenderGraphUsage;
+
+    struct UsageInfo {
+        VkPipelineStageFlags Stage;
+        VkAccessFlags ReadAccess;
+        // 0 when the usage cannot write
+        VkAccessFlags WriteAccess;
+        VkImageLayout ReadLayout;
+        VkImageLayout WriteLayout;
+        // What a transient image needs to be created with for it
+        VkImageUsageFlags ReadImageUsage;
+        VkImageUsageFlags WriteImageUsage;
+    };
+
+    // Indexed by RenderGraphUsage
+    constexpr UsageInfo USAGE_INFOS[] = {
+        // ColorAttachment, writes include the reads of loads and blending
+        {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT,
+         VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+         VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT},
+        // DepthAttachment
+        {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+         VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT},
+        // SampledFragment
+        {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_USAGE_SAMPLED_BIT, 0},
+        // SampledCompute
+        {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_USAGE_SAMPLED_BIT, 0},
+        // StorageCompute
+        {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+         VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+         VK_IMAGE_USAGE_STORAGE_BIT, VK_IMAGE_USAGE_STORAGE_BIT},
+        // IndirectCommand
+        {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED,
+         VK_IMAGE_LAYOUT_UNDEFINED, 0, 0},
+        // VertexInput
+        {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT, 0,
+         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED, 0, 0},
+        // Transfer
+        {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+         VK_IMAGE_USAGE_TRANSFER_DST_BIT},
+    };
+
+    constexpr VkAccessFlags WRITE_ACCESS_MASK = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                                VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT |
+                                                VK_ACCESS_MEMORY_WRITE_BIT;
+
+    const UsageInfo& GetUsageInfo(const RenderGraphUsage usage) { return USAGE_INFOS[static_cast<uint32_t>(usage)]; }
+
+    bool IsDepthFormat(const VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return true;
+        default:
+            return false;
+        }
+    }
+} // namespace
+
+namespace Thryve::Rendering {
+    RenderGraphPassBuilder& RenderGraphPassBuilder::Read(const RenderGraphResource resource,
+                                                         const RenderGraphUsage usage)
+    {
+        return Attach(resource, usage, false, std::nullopt);
+    }
+
+    RenderGraphPassBuilder& RenderGraphPassBuilder::Write(const RenderGraphResource resource,
+                                                          const RenderGraphUsage usage)
+    {
+        if (GetUsageInfo(usage).WriteAccess == 0)
+        {
+            throw std::invalid_argument("Render graph usage cannot write");
+        }
+        return Attach(resource, usage, true, std::nullopt);
+    }
+
+    RenderGraphPassBuilder& RenderGraphPassBuilder::ColorAttachment(const RenderGraphResource resource,
+                                                                    const std::optional<VkClearColorValue> clearValue)
+    {
+        std::optional<VkClearValue> _clearValue;
+        if (clearValue)
+        {
+            _clearValue = VkClearValue{};
+            _clearValue->color = *clearValue;
+        }
+        return Attach(resource, RenderGraphUsage::ColorAttachment, true, _clearValue);
+    }
+
+    RenderGraphPassBuilder& RenderGraphPassBuilder::DepthAttachment(
+        const RenderGraphResource resource, const std::optional<VkClearDepthStencilValue> clearValue,
+        const bool bReadOnly)
+    {
+        std::optional<VkClearValue> _clearValue;
+        if (clearValue)
+        {
+            _clearValue = VkClearValue{};
+            _clearValue->depthStencil = *clearValue;
+        }
+        return Attach(resource, RenderGraphUsage::DepthAttachment, !bReadOnly, _clearValue);
+    }
+
+    RenderGraphPassBuilder& RenderGraphPassBuilder::SideEffect()
+    {
+        m_graph.m_passes[m_passIndex].bSideEffect = true;
+        return *this;
+    }
+
+    RenderGraphPassBuilder& RenderGraphPassBuilder::SecondaryCommandBuffers(std::function<bool()> condition)
+    {
+        m_graph.m_passes[m_passIndex].bSecondaryCommandBuffers = true;
+        m_graph.m_passes[m_passIndex].SecondaryCondition = std::move(condition);
+        return *this;
+    }
+
+    RenderGraphPassBuilder& RenderGraphPassBuilder::Execute(RenderGraphExecuteFunction function)
+    {
+        m_graph.m_passes[m_passIndex].Function = std::move(function);
+        return *this;
+    }
+
+    RenderGraphPassBuilder& RenderGraphPassBuilder::Attach(const RenderGraphResource resource,
+                                                           const RenderGraphUsage usage, const bool bWrite,
+                                                           const std::optional<VkClearValue> clearValue)
+    {
+        if (!resource.IsValid() || resource.Index >= m_graph.m_resources.size())
+        {
+            throw std::invalid_argument("Unknown render graph resource");
+        }
+
+        RenderGraph::Pass& _pass = m_graph.m_passes[m_passIndex];
+        const RenderGraph::Resource& _resource = m_graph.m_resources[resource.Index];
+        const bool bAttachment = usage == RenderGraphUsage::ColorAttachment || usage == RenderGraphUsage::DepthAttachment;
+        if (bAttachment && !_resource.bImage)
+        {
+            throw std::invalid_argument("Render graph attachments have to be images");
+        }
+        if (bAttachment && _pass.Type != RenderGraphPassType::Graphics)
+        {
+            throw std::invalid_argument("Only graphics passes have attachments");
+        }
+        // All barriers of a pass go in front of it, so it cannot need two states of the same resource
+        for (const RenderGraph::ResourceUse& _use : _pass.Uses)
+        {
+            if (_use.Resource == resource.Index)
+            {
+                throw std::invalid_argument("Render graph pass uses " + _resource.Name + " twice");
+            }
+        }
+
+        _pass.Uses.push_back({resource.Index, usage, bWrite});
+        if (bAttachment)
+        {
+            _pass.Attachments.push_back({resource.Index, static_cast<uint32_t>(_pass.Uses.size() - 1), clearValue});
+        }
+        return *this;
+    }
+
+    RenderGraph::RenderGraph()
+    {
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+        m_device = _deviceSelector->GetLogicalDevice();
+        if (_deviceSelector->SupportsSynchronization2())
+        {
+            m_pipelineBarrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(
+                vkGetDeviceProcAddr(m_device, "vkCmdPipelineBarrier2KHR"));
+        }
+    }
+
+    RenderGraph::~RenderGraph() { ReleaseCompiled(); }
+
+    void RenderGraph::Reset()
+    {
+        ReleaseCompiled();
+        m_passes.clear();
+        m_resources.clear();
+    }
+
+    RenderGraphResource RenderGraph::CreateImage(std::string name, const RenderGraphImageDesc& desc)
+    {
+        Resource _resource;
+        _resource.Name = std::move(name);
+        _resource.bImage = true;
+        _resource.Desc = desc;
+        m_resources.push_back(std::move(_resource));
+        return {static_cast<uint32_t>(m_resources.size() - 1)};
+    }
+
+    RenderGraphResource RenderGraph::ImportImage(std::string name, const RenderGraphImageDesc& desc,
+                                                 const RenderGraphExternalState& initialState,
+                                                 const RenderGraphExternalState& finalState)
+    {
+        Resource _resource;
+        _resource.Name = std::move(name);
+        _resource.bImage = true;
+        _resource.bImported = true;
+        _resource.Desc = desc;
+        _resource.InitialState = initialState;
+        _resource.FinalState = finalState;
+        m_resources.push_back(std::move(_resource));
+        return {static_cast<uint32_t>(m_resources.size() - 1)};
+    }
+
+    RenderGraphResource RenderGraph::ImportBuffer(std::string name)
+    {
+        Resource _resource;
+        _resource.Name = std::move(name);
+        _resource.bImported = true;
+        m_resources.push_back(std::move(_resource));
+        return {static_cast<uint32_t>(m_resources.size() - 1)};
+    }
+
+    RenderGraphPassBuilder RenderGraph::AddPass(const char* name, const RenderGraphPassType type)
+    {
+        Pass _pass;
+        _pass.Name = name;
+        _pass.Type = type;
+        _pass.ScopeID = Core::ProfilingService::RegisterScope("RenderGraph", name);
+        m_passes.push_back(std::move(_pass));
+        return {*this, static_cast<uint32_t>(m_passes.size() - 1)};
+    }
+
+    void RenderGraph::Compile()
+    {
+        PROFILE_FUNCTION()
+        ReleaseCompiled();
+        m_stats = {};
+        m_stats.PassCount = static_cast<uint32_t>(m_passes.size());
+
+        CullPasses();
+        ComputeLifetimes();
+        AllocateTransientImages();
+        PlanBarriers();
+        for (Pass& _pass : m_passes)
+        {
+            if (!_pass.bCulled && _pass.Type == RenderGraphPassType::Graphics)
+            {
+                CreateRenderPass(_pass);
+            }
+        }
+    }
+
+    void RenderGraph::SetImportedImage(const RenderGraphResource resource, const VkImage image,
+                                       const VkImageView view)
+    {
+        Resource& _resource = m_resources[resource.Index];
+        if (!_resource.bImported || !_resource.bImage)
+        {
+            throw std::invalid_argument("Only imported images are set from outside the render graph");
+        }
+        _resource.Image = image;
+        _resource.View = view;
+    }
+
+    void RenderGraph::ReleaseCompiled()
+    {
+        for (Pass& _pass : m_passes)
+        {
+            for (const auto& [_views, _framebuffer] : _pass.Framebuffers)
+            {
+                vkDestroyFramebuffer(m_device, _framebuffer, nullptr);
+            }
+            _pass.Framebuffers.clear();
+            if (_pass.RenderPass != VK_NULL_HANDLE)
+            {
+                vkDestroyRenderPass(m_device, _pass.RenderPass, nullptr);
+                _pass.RenderPass = VK_NULL_HANDLE;
+            }
+            _pass.bCulled = false;
+        }
+
+        // The images themselves go with the next Allocate or the graph, their memory stays for reuse
+        for (Resource& _resource : m_resources)
+        {
+            if (!_resource.bImported)
+            {
+                _resource.View = VK_NULL_HANDLE;
+                _resource.Image = VK_NULL_HANDLE;
+                _resource.TransientImage = UINT32_MAX;
+            }
+        }
+        m_barriers.clear();
+    }
+
+    void RenderGraph::CullPasses()
+    {
+        // Walks back from the passes the outside world sees, a pass stays when a later one still needs something
+        // it writes. A write that is not also a read ends the need, whatever came before it is overwritten
+        std::vector<bool> _needed(m_resources.size(), false);
+        for (auto _pass = m_passes.rbegin(); _pass != m_passes.rend(); ++_pass)
+        {
+            bool bLive = _pass->bSideEffect;
+            for (const ResourceUse& _use : _pass->Uses)
+            {
+                if (_use.bWrite && (_needed[_use.Resource] || m_resources[_use.Resource].bImported))
+                {
+                    bLive = true;
+                }
+            }
+
+            _pass->bCulled = !bLive;
+            if (!bLive)
+            {
+                ++m_stats.CulledPassCount;
+                continue;
+            }
+
+            for (const ResourceUse& _use : _pass->Uses)
+            {
+                if (_use.bWrite)
+                {
+                    _needed[_use.Resource] = false;
+                }
+            }
+            for (const ResourceUse& _use : _pass->Uses)
+            {
+                if (!_use.bWrite)
+                {
+                    _needed[_use.Resource] = true;
+                }
+            }
+            // Attachments that are loaded read what was there before
+            for (const Attachment& _attachment : _pass->Attachments)
+            {
+                if (!_attachment.ClearValue)
+                {
+                    _needed[_attachment.Resource] = true;
+                }
+            }
+        }
+    }
+
+    void RenderGraph::ComputeLifetimes()
+    {
+        for (Resource& _resource : m_resources)
+        {
+            _resource.FirstPass = UINT32_MAX;
+            _resource.LastPass = 0;
+            _resource.ImageUsage = 0;
+        }
+
+        for (uint32_t _passIndex = 0; _passIndex < m_passes.size(); ++_passIndex)
+        {
+            const Pass& _pass = m_passes[_passIndex];
+            if (_pass.bCulled)
+            {
+                continue;
+            }
+            for (const ResourceUse& _use : _pass.Uses)
+            {
+                Resource& _resource = m_resources[_use.Resource];
+                _resource.FirstPass = std::min(_resource.FirstPass, _passIndex);
+                _resource.LastPass = std::max(_resource.LastPass, _passIndex);
+                const UsageInfo& _info = GetUsageInfo(_use.Usage);
+                _resource.ImageUsage |= _use.bWrite ? _info.WriteImageUsage : _info.ReadImageUsage;
+            }
+        }
+    }
+
+    void RenderGraph::AllocateTransientImages()
+    {
+        PROFILE_FUNCTION()
+        std::vector<TransientAttachmentDesc> _descs;
+        for (Resource& _resource : m_resources)
+        {
+            if (_resource.bImported || !_resource.bImage || _resource.FirstPass == UINT32_MAX)
+            {
+                continue;
+            }
+
+            TransientAttachmentDesc _desc;
+            _desc.Format = _resource.Desc.Format;
+            _desc.Extent = _resource.Desc.Extent;
+            _desc.Samples = _resource.Desc.Samples;
+            _desc.Usage = _resource.ImageUsage;
+            _desc.Aspect = GetSubresourceRange(_resource).aspectMask;
+            _desc.FirstUse = _resource.FirstPass;
+            _desc.LastUse = _resource.LastPass;
+            // Used by a single render pass, which neither loads nor stores it, so it never has to leave the tile
+            _desc.bLazy = _resource.FirstPass == _resource.LastPass;
+            _resource.TransientImage = static_cast<uint32_t>(_descs.size());
+            _descs.push_back(_desc);
+        }
+
+        m_transientAllocator.Allocate(_descs);
+        for (Resource& _resource : m_resources)
+        {
+            if (_resource.TransientImage != UINT32_MAX)
+            {
+                _resource.Image = m_transientAllocator.GetImage(_resource.TransientImage);
+                _resource.View = m_transientAllocator.GetImageView(_resource.TransientImage);
+            }
+        }
+        m_stats.TransientImages = m_transientAllocator.GetStats();
+    }
+
+    void RenderGraph::PlanBarriers()
+    {
+        PROFILE_FUNCTION()
+        // Every stage and write of a resource over the whole frame
+        std::vector<VkPipelineStageFlags> _frameStages(m_resources.size(), 0);
+        std::vector<VkAccessFlags> _frameWriteAccess(m_resources.size(), 0);
+        for (const Pass& _pass : m_passes)
+        {
+            if (_pass.bCulled)
+            {
+                continue;
+            }
+            for (const ResourceUse& _use : _pass.Uses)
+            {
+                const UsageInfo& _info = GetUsageInfo(_use.Usage);
+                _frameStages[_use.Resource] |= _info.Stage;
+                if (_use.bWrite)
+                {
+                    _frameWriteAccess[_use.Resource] |= _info.WriteAccess & WRITE_ACCESS_MASK;
+                }
+            }
+        }
+
+        std::vector<ResourceState> _states(m_resources.size());
+        for (uint32_t _index = 0; _index < m_resources.size(); ++_index)
+        {
+            const Resource& _resource = m_resources[_index];
+            if (_resource.bImported && _resource.bImage)
+            {
+                // Whatever signalled the image, e.g. the acquire semaphore's wait stage, counts as its last write
+                _states[_index].Layout = _resource.InitialState.Layout;
+                _states[_index].WriteStages = _resource.InitialState.Stage;
+                _states[_index].WriteAccess = _resource.InitialState.Access;
+            }
+        }
+
+        for (uint32_t _passIndex = 0; _passIndex < m_passes.size(); ++_passIndex)
+        {
+            Pass& _pass = m_passes[_passIndex];
+            if (_pass.bCulled)
+            {
+                continue;
+            }
+
+            _pass.FirstBarrier = static_cast<uint32_t>(m_barriers.size());
+            PlannedBarrier _memoryBarrier{UINT32_MAX, 0, 0, 0, 0, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED};
+            for (const ResourceUse& _use : _pass.Uses)
+            {
+                const Resource& _resource = m_resources[_use.Resource];
+                ResourceState& _state = _states[_use.Resource];
+                const UsageInfo& _info = GetUsageInfo(_use.Usage);
+                const VkAccessFlags _dstAccess = _use.bWrite ? _info.WriteAccess : _info.ReadAccess;
+                const VkImageLayout _layout = !_resource.bImage ? VK_IMAGE_LAYOUT_UNDEFINED
+                                              : _use.bWrite     ? _info.WriteLayout
+                                                                : _info.ReadLayout;
+
+                VkPipelineStageFlags _srcStages = _state.WriteStages | _state.ReadStages;
+                VkAccessFlags _srcAccess = _state.WriteAccess;
+                if (_passIndex == _resource.FirstPass && !_resource.bImported)
+                {
+                    // The memory is shared with the last frame, which may still be in flight, and with the images
+                    // aliased into it, so the first use waits for every use of all of them
+                    for (uint32_t _other = 0; _other < m_resources.size(); ++_other)
+                    {
+                        const Resource& _otherResource = m_resources[_other];
+                        if (_otherResource.TransientImage != UINT32_MAX &&
+                            m_transientAllocator.SharesMemory(_otherResource.TransientImage, _resource.TransientImage))
+                        {
+                            _srcStages |= _frameStages[_other];
+                            _srcAccess |= _frameWriteAccess[_other];
+                        }
+                    }
+                }
+
+                const bool bLayoutChange = _resource.bImage && _state.Layout != _layout;
+                bool bBarrier;
+                if (_use.bWrite)
+                {
+                    // Write after write or after read
+                    bBarrier = bLayoutChange || _srcStages != 0;
+                }
+                else
+                {
+                    // Read after write the write has not been made visible to yet
+                    bBarrier = bLayoutChange || (_state.WriteStages != 0 &&
+                                                 ((_info.Stage & ~_state.VisibleStages) != 0 ||
+                                                  (_dstAccess & ~_state.VisibleAccess) != 0));
+                }
+
+                if (bBarrier)
+                {
+                    const VkPipelineStageFlags _srcStage =
+                        _srcStages != 0 ? _srcStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+                    if (_resource.bImage)
+                    {
+                        // Nothing before the first use of a transient image is worth keeping
+                        const VkImageLayout _oldLayout = _passIndex == _resource.FirstPass && !_resource.bImported
+                                                             ? VK_IMAGE_LAYOUT_UNDEFINED
+                                                             : _state.Layout;
+                        m_barriers.push_back({_use.Resource, _srcStage, _srcAccess, _info.Stage, _dstAccess, _oldLayout,
+                                              _layout});
+                        ++m_stats.ImageBarrierCount;
+                    }
+                    else
+                    {
+                        _memoryBarrier.SrcStage |= _srcStage;
+                        _memoryBarrier.SrcAccess |= _srcAccess;
+                        _memoryBarrier.DstStage |= _info.Stage;
+                        _memoryBarrier.DstAccess |= _dstAccess;
+                    }
+                }
+
+                if (_use.bWrite)
+                {
+                    _state.WriteStages = _info.Stage;
+                    _state.WriteAccess = _dstAccess & WRITE_ACCESS_MASK;
+                    _state.ReadStages = 0;
+                    _state.VisibleStages = 0;
+                    _state.VisibleAccess = 0;
+                }
+                else if (bBarrier)
+                {
+                    // Later readers in other stages chain onto this barrier, also for the layout it moved to
+                    _state.ReadStages |= _info.Stage;
+                    _state.VisibleStages = (bLayoutChange ? 0 : _state.VisibleStages) | _info.Stage;
+                    _state.VisibleAccess = (bLayoutChange ? 0 : _state.VisibleAccess) | _dstAccess;
+                }
+                else
+                {
+                    _state.ReadStages |= _info.Stage;
+                }
+                _state.Layout = _layout;
+            }
+
+            if (_memoryBarrier.DstStage != 0)
+            {
+                m_barriers.push_back(_memoryBarrier);
+                ++m_stats.MemoryBarrierCount;
+            }
+            _pass.BarrierCount = static_cast<uint32_t>(m_barriers.size()) - _pass.FirstBarrier;
+            if (_pass.BarrierCount > 0)
+            {
+                ++m_stats.BarrierBatchCount;
+            }
+        }
+
+        // Hands imported images back in the state their owner expects
+        m_finalBarrier = static_cast<uint32_t>(m_barriers.size());
+        for (uint32_t _index = 0; _index < m_resources.size(); ++_index)
+        {
+            const Resource& _resource = m_resources[_index];
+            const ResourceState& _state = _states[_index];
+            if (!_resource.bImported || !_resource.bImage || _resource.FirstPass == UINT32_MAX)
+            {
+                continue;
+            }
+            if (_state.Layout == _resource.FinalState.Layout && _resource.FinalState.Access == 0)
+            {
+                continue;
+            }
+            const VkPipelineStageFlags _srcStages = _state.WriteStages | _state.ReadStages;
+            m_barriers.push_back({_index,
+                                  _srcStages != 0 ? _srcStages
+                                                  : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+                                  _state.WriteAccess, _resource.FinalState.Stage, _resource.FinalState.Access,
+                                  _state.Layout, _resource.FinalState.Layout});
+            ++m_stats.ImageBarrierCount;
+        }
+        m_finalBarrierCount = static_cast<uint32_t>(m_barriers.size()) - m_finalBarrier;
+        if (m_finalBarrierCount > 0)
+        {
+            ++m_stats.BarrierBatchCount;
+        }
+    }
+
+    void RenderGraph::CreateRenderPass(Pass& pass)
+    {
+        std::vector<VkAttachmentDescription> _attachments;
+        std::vector<VkAttachmentReference> _colorReferences;
+        std::optional<VkAttachmentReference> _depthReference;
+        pass.ClearValues.clear();
+
+        const uint32_t _passIndex = static_cast<uint32_t>(&pass - m_passes.data());
+        for (const Attachment& _attachment : pass.Attachments)
+        {
+            const Resource& _resource = m_resources[_attachment.Resource];
+            const ResourceUse& _use = pass.Uses[_attachment.Use];
+            const UsageInfo& _info = GetUsageInfo(_use.Usage);
+            const VkImageLayout _layout = _use.bWrite ? _info.WriteLayout : _info.ReadLayout;
+
+            // Contents only survive into passes that come later, or out of the graph
+            const bool bStore = _use.bWrite && (_resource.bImported || _resource.LastPass > _passIndex);
+            const bool bHasContents = _resource.bImported ? _resource.InitialState.Layout != VK_IMAGE_LAYOUT_UNDEFINED ||
+                                                                _resource.FirstPass < _passIndex
+                                                          : _resource.FirstPass < _passIndex;
+            VkAttachmentLoadOp _loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            if (_attachment.ClearValue)
+            {
+                _loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+            }
+            else if (bHasContents)
+            {
+                _loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+            }
+            const VkAttachmentStoreOp _storeOp = bStore ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            const bool bStencil = ImageUtils::HasStencilComponent(_resource.Desc.Format);
+
+            VkAttachmentDescription _description{};
+            _description.format = _resource.Desc.Format;
+            _description.samples = _resource.Desc.Samples;
+            _description.loadOp = _loadOp;
+            _description.storeOp = _storeOp;
+            _description.stencilLoadOp = bStencil ? _loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            _description.stencilStoreOp = bStencil ? _storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            // The graph's barriers move the image in and out of the attachment layout
+            _description.initialLayout = _layout;
+            _description.finalLayout = _layout;
+
+            const VkAttachmentReference _reference{static_cast<uint32_t>(_attachments.size()), _layout};
+            if (_use.Usage == RenderGraphUsage::DepthAttachment)
+            {
+                _depthReference = _reference;
+            }
+            else
+            {
+                _colorReferences.push_back(_reference);
+            }
+            _attachments.push_back(_description);
+            pass.ClearValues.push_back(_attachment.ClearValue.value_or(VkClearValue{}));
+        }
+
+        VkSubpassDescription _subpass{};
+        _subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        _subpass.colorAttachmentCount = static_cast<uint32_t>(_colorReferences.size());
+        _subpass.pColorAttachments = _colorReferences.data();
+        _subpass.pDepthStencilAttachment = _depthReference ? &*_depthReference : nullptr;
+
+        VkRenderPassCreateInfo _renderPassInfo{};
+        _renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        _renderPassInfo.attachmentCount = static_cast<uint32_t>(_attachments.size());
+        _renderPassInfo.pAttachments = _attachments.data();
+        _renderPassInfo.subpassCount = 1;
+        _renderPassInfo.pSubpasses = &_subpass;
+        VK_CALL(vkCreateRenderPass(m_device, &_renderPassInfo, nullptr, &pass.RenderPass));
+    }
+
+    VkFramebuffer RenderGraph::GetFramebuffer(Pass& pass)
+    {
+        m_attachmentViews.clear();
+        for (const Attachment& _attachment : pass.Attachments)
+        {
+            const VkImageView _view = m_resources[_attachment.Resource].View;
+            if (_view == VK_NULL_HANDLE)
+            {
+                throw std::runtime_error("Render graph image " + m_resources[_attachment.Resource].Name +
+                                         " was never set");
+            }
+            m_attachmentViews.push_back(_view);
+        }
+
+        for (const auto& [_views, _framebuffer] : pass.Framebuffers)
+        {
+            if (_views == m_attachmentViews)
+            {
+                return _framebuffer;
+            }
+        }
+
+        const VkExtent2D _extent = m_resources[pass.Attachments.front().Resource].Desc.Extent;
+        VkFramebufferCreateInfo _framebufferInfo{};
+        _framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        _framebufferInfo.renderPass = pass.RenderPass;
+        _framebufferInfo.attachmentCount = static_cast<uint32_t>(m_attachmentViews.size());
+        _framebufferInfo.pAttachments = m_attachmentViews.data();
+        _framebufferInfo.width = _extent.width;
+        _framebufferInfo.height = _extent.height;
+        _framebufferInfo.layers = 1;
+
+        VkFramebuffer _framebuffer;
+        VK_CALL(vkCreateFramebuffer(m_device, &_framebufferInfo, nullptr, &_framebuffer));
+        pass.Framebuffers.emplace_back(m_attachmentViews, _framebuffer);
+        return _framebuffer;
+    }
+
+    void RenderGraph::Execute(const VkCommandBuffer commandBuffer)
+    {
+        PROFILE_FUNCTION()
+        for (Pass& _pass : m_passes)
+        {
+            if (_pass.bCulled)
+            {
+                continue;
+            }
+
+#ifdef ENABLE_PROFILING
+            GpuScopeProfiler _gpuScope{commandBuffer, _pass.ScopeID};
+#endif
+            RecordBarriers(commandBuffer, _pass.FirstBarrier, _pass.BarrierCount);
+
+            if (_pass.Type != RenderGraphPassType::Graphics)
+            {
+                if (_pass.Function)
+                {
+                    _pass.Function(commandBuffer, RenderGraphPassContext{*this});
+                }
+                continue;
+            }
+
+            const bool _bSecondaries =
+                _pass.bSecondaryCommandBuffers && (!_pass.SecondaryCondition || _pass.SecondaryCondition());
+            const RenderGraphPassContext _context{*this, _pass.RenderPass, GetFramebuffer(_pass),
+                                                  m_resources[_pass.Attachments.front().Resource].Desc.Extent,
+                                                  _bSecondaries};
+            VkRenderPassBeginInfo _renderPassInfo{};
+            _renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            _renderPassInfo.renderPass = _context.RenderPass;
+            _renderPassInfo.framebuffer = _context.Framebuffer;
+            _renderPassInfo.renderArea.offset = {0, 0};
+            _renderPassInfo.renderArea.extent = _context.Extent;
+            _renderPassInfo.clearValueCount = static_cast<uint32_t>(_pass.ClearValues.size());
+            _renderPassInfo.pClearValues = _pass.ClearValues.data();
+
+            vkCmdBeginRenderPass(commandBuffer, &_renderPassInfo,
+                                 _bSecondaries ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                                               : VK_SUBPASS_CONTENTS_INLINE);
+            if (_pass.Function)
+            {
+                _pass.Function(commandBuffer, _context);
+            }
+            vkCmdEndRenderPass(commandBuffer);
+        }
+
+        RecordBarriers(commandBuffer, m_finalBarrier, m_finalBarrierCount);
+    }
+
+    void RenderGraph::RecordBarriers(const VkCommandBuffer commandBuffer, const uint32_t firstBarrier,
+                                     const uint32_t barrierCount)
+    {
+        if (barrierCount == 0)
+        {
+            return;
+        }
+
+        if (m_pipelineBarrier2)
+        {
+            // Every barrier keeps its own stages
+            m_imageBarriers2.clear();
+            VkMemoryBarrier2KHR _memoryBarrier{};
+            _memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2_KHR;
+            bool bMemoryBarrier = false;
+            for (uint32_t _index = firstBarrier; _index < firstBarrier + barrierCount; ++_index)
+            {
+                const PlannedBarrier& _planned = m_barriers[_index];
+                if (_planned.Resource == UINT32_MAX)
+                {
+                    _memoryBarrier.srcStageMask = _planned.SrcStage;
+                    _memoryBarrier.srcAccessMask = _planned.SrcAccess;
+                    _memoryBarrier.dstStageMask = _planned.DstStage;
+                    _memoryBarrier.dstAccessMask = _planned.DstAccess;
+                    bMemoryBarrier = true;
+                    continue;
+                }
+
+                const Resource& _resource = m_resources[_planned.Resource];
+                VkImageMemoryBarrier2KHR _barrier{};
+                _barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+                _barrier.srcStageMask = _planned.SrcStage;
+                _barrier.srcAccessMask = _planned.SrcAccess;
+                _barrier.dstStageMask = _planned.DstStage;
+                _barrier.dstAccessMask = _planned.DstAccess;
+                _barrier.oldLayout = _planned.OldLayout;
+                _barrier.newLayout = _planned.NewLayout;
+                _barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                _barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                _barrier.image = _resource.Image;
+                _barrier.subresourceRange = GetSubresourceRange(_resource);
+                m_imageBarriers2.push_back(_barrier);
+            }
+
+            VkDependencyInfoKHR _dependencyInfo{};
+            _dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+            _dependencyInfo.memoryBarrierCount = bMemoryBarrier ? 1 : 0;
+            _dependencyInfo.pMemoryBarriers = &_memoryBarrier;
+            _dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(m_imageBarriers2.size());
+            _dependencyInfo.pImageMemoryBarriers = m_imageBarriers2.data();
+            m_pipelineBarrier2(commandBuffer, &_dependencyInfo);
+            return;
+        }
+
+        // Without synchronization2 one call shares its stage masks between all of its barriers
+        m_imageBarriers.clear();
+        VkPipelineStageFlags _srcStages = 0;
+        VkPipelineStageFlags _dstStages = 0;
+        VkMemoryBarrier _memoryBarrier{};
+        _memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        bool bMemoryBarrier = false;
+        for (uint32_t _index = firstBarrier; _index < firstBarrier + barrierCount; ++_index)
+        {
+            const PlannedBarrier& _planned = m_barriers[_index];
+            _srcStages |= _planned.SrcStage;
+            _dstStages |= _planned.DstStage;
+            if (_planned.Resource == UINT32_MAX)
+            {
+                _memoryBarrier.srcAccessMask = _planned.SrcAccess;
+                _memoryBarrier.dstAccessMask = _planned.DstAccess;
+                bMemoryBarrier = true;
+                continue;
+            }
+
+            const Resource& _resource = m_resources[_planned.Resource];
+            VkImageMemoryBarrier _barrier{};
+            _barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            _barrier.srcAccessMask = _planned.SrcAccess;
+            _barrier.dstAccessMask = _planned.DstAccess;
+            _barrier.oldLayout = _planned.OldLayout;
+            _barrier.newLayout = _planned.NewLayout;
+            _barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            _barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            _barrier.image = _resource.Image;
+            _barrier.subresourceRange = GetSubresourceRange(_resource);
+            m_imageBarriers.push_back(_barrier);
+        }
+
+        vkCmdPipelineBarrier(commandBuffer, _srcStages, _dstStages, 0, bMemoryBarrier ? 1 : 0, &_memoryBarrier, 0,
+                             nullptr, static_cast<uint32_t>(m_imageBarriers.size()), m_imageBarriers.data());
+    }
+
+    VkImageSubresourceRange RenderGraph::GetSubresourceRange(const Resource& resource) const
+    {
+        VkImageSubresourceRange _range{};
+        _range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        if (IsDepthFormat(resource.Desc.Format))
+        {
+            _range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+            if (ImageUtils::HasStencilComponent(resource.Desc.Format))
+            {
+                _range.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+            }
+        }
+        _range.baseMipLevel = 0;
+        _range.levelCount = 1;
+        _range.baseArrayLayer = 0;
+        _range.layerCount = 1;
+        return _range;
+    }
+} // namespace Thryve::Rendering
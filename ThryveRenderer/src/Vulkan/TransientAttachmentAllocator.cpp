@@ -0,0 +1,265 @@
+#include "Vulkan/TransientAttachmentAllocator.h"
+
+#include <algorithm>
+
+#include "Core/Profiling.h"
+#include "Vulkan/VulkanContext.h"
+#include "utils/ImageUtils.h"
+#include "utils/VkDebugUtils.h"
+
+namespace {
+    // The only usage VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT may be combined with
+    constexpr VkImageUsageFlags ATTACHMENT_USAGE_MASK = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                                                        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                                                        VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+    VkDeviceSize AlignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+} // namespace
+
+namespace Thryve::Rendering {
+    TransientAttachmentAllocator::TransientAttachmentAllocator()
+    {
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+        m_device = _deviceSelector->GetLogicalDevice();
+        m_allocator = _deviceSelector->GetAllocator();
+
+        const VkPhysicalDeviceMemoryProperties* _memoryProperties;
+        vmaGetMemoryProperties(m_allocator, &_memoryProperties);
+        for (uint32_t _type = 0; _type < _memoryProperties->memoryTypeCount; ++_type)
+        {
+            if (_memoryProperties->memoryTypes[_type].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
+            {
+                m_lazyMemoryTypeBits |= 1u << _type;
+            }
+        }
+    }
+
+    TransientAttachmentAllocator::~TransientAttachmentAllocator()
+    {
+        ReleaseImages();
+        FreeBlocks(m_blocks);
+    }
+
+    void TransientAttachmentAllocator::Allocate(const std::span<const TransientAttachmentDesc> descs)
+    {
+        PROFILE_FUNCTION()
+        ReleaseImages();
+        m_stats = {};
+
+        for (const TransientAttachmentDesc& _desc : descs)
+        {
+            Image _image;
+            _image.FirstUse = _desc.FirstUse;
+            _image.LastUse = _desc.LastUse;
+            _image.bLazy = _desc.bLazy && SupportsLazyAllocation() && (_desc.Usage & ~ATTACHMENT_USAGE_MASK) == 0;
+
+            VkImageCreateInfo _imageInfo{};
+            _imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            _imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            _imageInfo.format = _desc.Format;
+            _imageInfo.extent = {_desc.Extent.width, _desc.Extent.height, 1};
+            _imageInfo.mipLevels = 1;
+            _imageInfo.arrayLayers = 1;
+            _imageInfo.samples = _desc.Samples;
+            _imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            _imageInfo.usage = _desc.Usage | (_image.bLazy ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : 0);
+            _imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            _imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VK_CALL(vkCreateImage(m_device, &_imageInfo, nullptr, &_image.Image));
+            vkGetImageMemoryRequirements(m_device, _image.Image, &_image.Requirements);
+
+            // The transient usage stays a hint for the driver when the format cannot live in lazy memory
+            if (_image.bLazy && (_image.Requirements.memoryTypeBits & m_lazyMemoryTypeBits) != 0)
+            {
+                _image.Requirements.memoryTypeBits &= m_lazyMemoryTypeBits;
+            }
+            else
+            {
+                _image.bLazy = false;
+            }
+
+            ++m_stats.ImageCount;
+            m_stats.ImageBytes += _image.Requirements.size;
+            m_images.push_back(_image);
+        }
+
+        std::vector<Block> _retained = std::move(m_blocks);
+        m_blocks.clear();
+        PlaceImages();
+
+        for (Block& _block : m_blocks)
+        {
+            if (TakeRetainedBlock(_retained, _block))
+            {
+                ++m_stats.ReusedBlockCount;
+            }
+            else
+            {
+                VmaAllocationCreateInfo _allocInfo{};
+                _allocInfo.requiredFlags = _block.bLazy ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT
+                                                        : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+                _allocInfo.memoryTypeBits = _block.Requirements.memoryTypeBits;
+                if (_block.bLazy)
+                {
+                    // Lazy memory is committed per VkDeviceMemory, sharing one with other allocations would
+                    // commit them along
+                    _allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+                }
+                VK_CALL(vmaAllocateMemory(m_allocator, &_block.Requirements, &_allocInfo, &_block.Allocation, nullptr));
+            }
+
+            ++m_stats.BlockCount;
+            m_stats.AllocatedBytes += _block.Requirements.size;
+            if (_block.bLazy)
+            {
+                m_stats.LazyBytes += _block.Requirements.size;
+            }
+        }
+        // Whatever did not fit the new layout goes back to the driver
+        FreeBlocks(_retained);
+
+        for (uint32_t _index = 0; _index < m_images.size(); ++_index)
+        {
+            Image& _image = m_images[_index];
+            VK_CALL(vmaBindImageMemory2(m_allocator, m_blocks[_image.Block].Allocation, _image.Offset, _image.Image,
+                                        nullptr));
+            _image.View = ImageUtils::CreateImageView(_image.Image, descs[_index].Format, descs[_index].Aspect);
+            if (_image.bLazy)
+            {
+                ++m_stats.LazyImageCount;
+            }
+        }
+
+        const VkDeviceSize _backedBytes = m_stats.AllocatedBytes - m_stats.LazyBytes;
+        m_stats.SavedBytes = m_stats.ImageBytes > _backedBytes ? m_stats.ImageBytes - _backedBytes : 0;
+        PROFILE_COUNTER("Transient Attachment Bytes", static_cast<int64_t>(_backedBytes))
+    }
+
+    void TransientAttachmentAllocator::ReleaseImages()
+    {
+        for (const Image& _image : m_images)
+        {
+            if (_image.View != VK_NULL_HANDLE)
+            {
+                vkDestroyImageView(m_device, _image.View, nullptr);
+            }
+            vkDestroyImage(m_device, _image.Image, nullptr);
+        }
+        m_images.clear();
+    }
+
+    bool TransientAttachmentAllocator::SharesMemory(const uint32_t first, const uint32_t second) const
+    {
+        const Image& _first = m_images[first];
+        const Image& _second = m_images[second];
+        return _first.Block == _second.Block && _first.Offset < _second.Offset + _second.Requirements.size &&
+               _second.Offset < _first.Offset + _first.Requirements.size;
+    }
+
+    void TransientAttachmentAllocator::PlaceImages()
+    {
+        std::vector<uint32_t> _order(m_images.size());
+        for (uint32_t _index = 0; _index < _order.size(); ++_index)
+        {
+            _order[_index] = _index;
+        }
+        std::sort(_order.begin(), _order.end(), [this](const uint32_t a, const uint32_t b) {
+            return m_images[a].Requirements.size > m_images[b].Requirements.size;
+        });
+
+        // Images only share a block with images that can live in the same memory type
+        std::vector<std::vector<uint32_t>> _blockImages;
+        for (const uint32_t _index : _order)
+        {
+            Image& _image = m_images[_index];
+            const VkMemoryRequirements& _requirements = _image.Requirements;
+            uint32_t _blockIndex = 0;
+            while (_blockIndex < m_blocks.size() &&
+                   (m_blocks[_blockIndex].bLazy != _image.bLazy ||
+                    (m_blocks[_blockIndex].Requirements.memoryTypeBits & _requirements.memoryTypeBits) == 0))
+            {
+                ++_blockIndex;
+            }
+            if (_blockIndex == m_blocks.size())
+            {
+                Block _block;
+                _block.Requirements = {0, 1, _requirements.memoryTypeBits};
+                _block.bLazy = _image.bLazy;
+                m_blocks.push_back(_block);
+                _blockImages.emplace_back();
+            }
+            Block& _block = m_blocks[_blockIndex];
+
+            VkDeviceSize _offset = 0;
+            for (bool bMoved = true; bMoved;)
+            {
+                bMoved = false;
+                for (const uint32_t _other : _blockImages[_blockIndex])
+                {
+                    const Image& _placed = m_images[_other];
+                    const bool bAliveTogether = _placed.FirstUse <= _image.LastUse && _image.FirstUse <= _placed.LastUse;
+                    const VkDeviceSize _placedEnd = _placed.Offset + _placed.Requirements.size;
+                    if (bAliveTogether && _offset < _placedEnd && _placed.Offset < _offset + _requirements.size)
+                    {
+                        _offset = AlignUp(_placedEnd, _requirements.alignment);
+                        bMoved = true;
+                    }
+                }
+            }
+
+            _image.Block = _blockIndex;
+            _image.Offset = _offset;
+            _blockImages[_blockIndex].push_back(_index);
+            _block.Requirements.size = std::max(_block.Requirements.size, _offset + _requirements.size);
+            _block.Requirements.alignment = std::max(_block.Requirements.alignment, _requirements.alignment);
+            _block.Requirements.memoryTypeBits &= _requirements.memoryTypeBits;
+        }
+    }
+
+    bool TransientAttachmentAllocator::TakeRetainedBlock(std::vector<Block>& retained, Block& block) const
+    {
+        for (Block& _retained : retained)
+        {
+            if (_retained.Allocation == VK_NULL_HANDLE || _retained.bLazy != block.bLazy)
+            {
+                continue;
+            }
+            const bool bFits = _retained.Requirements.size >= block.Requirements.size &&
+                               _retained.Requirements.size <= block.Requirements.size * MAX_REUSE_FACTOR &&
+                               _retained.Requirements.alignment % block.Requirements.alignment == 0;
+            if (!bFits)
+            {
+                continue;
+            }
+            VmaAllocationInfo _allocationInfo;
+            vmaGetAllocationInfo(m_allocator, _retained.Allocation, &_allocationInfo);
+            if ((block.Requirements.memoryTypeBits & (1u << _allocationInfo.memoryType)) == 0)
+            {
+                continue;
+            }
+
+            block.Allocation = _retained.Allocation;
+            block.Requirements.size = _retained.Requirements.size;
+            block.Requirements.alignment = _retained.Requirements.alignment;
+            _retained.Allocation = VK_NULL_HANDLE;
+            return true;
+        }
+        return false;
+    }
+
+    void TransientAttachmentAllocator::FreeBlocks(std::vector<Block>& blocks) const
+    {
+        for (Block& _block : blocks)
+        {
+            if (_block.Allocation != VK_NULL_HANDLE)
+            {
+                vmaFreeMemory(m_allocator, _block.Allocation);
+                _block.Allocation = VK_NULL_HANDLE;
+            }
+        }
+        blocks.clear();
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,62 @@
+#include "Vulkan/UniformBufferRing.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "Vulkan/VulkanContext.h"
+#include "utils/VulkanBufferUtils.h"
+
+namespace Thryve::Rendering {
+    UniformBufferRing::UniformBufferRing(const uint32_t frameCount, const VkDeviceSize bytesPerFrame) :
+        m_frameCount(frameCount)
+    {
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+        const VkPhysicalDevice _physicalDevice = _deviceSelector->GetPhysicalDevice();
+
+        VkPhysicalDeviceProperties _properties;
+        vkGetPhysicalDeviceProperties(_physicalDevice, &_properties);
+        // Always a power of two
+        m_alignment = _properties.limits.minUniformBufferOffsetAlignment;
+
+        // Every region starts aligned, so offsets stay aligned across frames
+        m_bytesPerFrame = (bytesPerFrame + m_alignment - 1) & ~(m_alignment - 1);
+        if (m_bytesPerFrame * m_frameCount > UINT32_MAX)
+        {
+            throw std::invalid_argument("Uniform buffer ring does not fit 32-bit dynamic offsets");
+        }
+
+        void* _mapped = nullptr;
+        VulkanBufferUtils::CreateBuffer({_deviceSelector->GetLogicalDevice(), _physicalDevice,
+                                         m_bytesPerFrame * m_frameCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT},
+                                        m_buffer, m_allocation, &_mapped);
+        m_mapped = static_cast<uint8_t*>(_mapped);
+    }
+
+    UniformBufferRing::~UniformBufferRing()
+    {
+        VulkanBufferUtils::DestroyBuffer(m_buffer, m_allocation);
+    }
+
+    void UniformBufferRing::BeginFrame(const uint32_t frameIndex)
+    {
+        m_frameBegin = m_bytesPerFrame * (frameIndex % m_frameCount);
+        m_cursor = m_frameBegin;
+    }
+
+    UniformAllocation UniformBufferRing::Allocate(const VkDeviceSize size)
+    {
+        const VkDeviceSize _alignedSize = (size + m_alignment - 1) & ~(m_alignment - 1);
+        if (m_cursor + _alignedSize > m_frameBegin + m_bytesPerFrame)
+        {
+            throw std::runtime_error("Uniform buffer ring is out of space, " + std::to_string(m_bytesPerFrame) +
+                                     " bytes per frame");
+        }
+
+        UniformAllocation _allocation;
+        _allocation.Data = m_mapped + m_cursor;
+        _allocation.Offset = static_cast<uint32_t>(m_cursor);
+        m_cursor += _alignedSize;
+        return _allocation;
+    }
+} // namespace Thryve::Rendering
@@ -0,0 +1,605 @@
+#include "Vulkan/UploadManager.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Core/Profiling.h"
+#include "Vulkan/VulkanContext.h"
+#include "utils/VkDebugUtils.h"
+#include "utils/VulkanBufferUtils.h"
+
+namespace {
+    VkCommandPool CreateCommandPool(const VkDevice device, const uint32_t queueFamily)
+    {
+        VkCommandPoolCreateInfo _poolInfo{};
+        _poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        _poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        _poolInfo.queueFamilyIndex = queueFamily;
+
+        VkCommandPool _commandPool;
+        VK_CALL(vkCreateCommandPool(device, &_poolInfo, nullptr, &_commandPool));
+        return _commandPool;
+    }
+
+    VkCommandBuffer AllocateCommandBuffer(const VkDevice device, const VkCommandPool commandPool)
+    {
+        VkCommandBufferAllocateInfo _allocInfo{};
+        _allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        _allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        _allocInfo.commandPool = commandPool;
+        _allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer _commandBuffer;
+        VK_CALL(vkAllocateCommandBuffers(device, &_allocInfo, &_commandBuffer));
+        return _commandBuffer;
+    }
+
+    VkFence CreateFence(const VkDevice device)
+    {
+        VkFenceCreateInfo _fenceInfo{};
+        _fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        VkFence _fence;
+        VK_CALL(vkCreateFence(device, &_fenceInfo, nullptr, &_fence));
+        return _fence;
+    }
+
+    VkAccessFlags ReadAccessForLayout(const VkImageLayout layout)
+    {
+        switch (layout)
+        {
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+            return VK_ACCESS_TRANSFER_READ_BIT;
+        case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+            return VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        default:
+            return VK_ACCESS_SHADER_READ_BIT;
+        }
+    }
+
+    // Everything a vertex, index, uniform or storage buffer can be read by
+    constexpr VkPipelineStageFlags BUFFER_READ_STAGES = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    constexpr VkAccessFlags BUFFER_READ_ACCESS = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+        VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+}
+
+namespace Thryve::Rendering {
+    UploadManager::UploadManager(const VkDeviceSize ringSize) : m_ringSize{ringSize}
+    {
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+        m_device = _deviceSelector->GetLogicalDevice();
+        m_transferQueue = _deviceSelector->GetTransferQueue();
+        m_graphicsQueue = _deviceSelector->GetGraphicsQueue();
+        m_transferFamily = _deviceSelector->GetTransferFamily();
+        m_graphicsFamily = _deviceSelector->GetQueueFamilyIndices().GraphicsFamily.value();
+        m_bOwnershipTransfer = m_transferFamily != m_graphicsFamily;
+
+        m_commandPool = CreateCommandPool(m_device, m_transferFamily);
+        if (m_bOwnershipTransfer)
+        {
+            m_acquireCommandPool = CreateCommandPool(m_device, m_graphicsFamily);
+        }
+
+        void* _mappedData = nullptr;
+        VulkanBufferUtils::CreateBuffer({m_device, _deviceSelector->GetPhysicalDevice(), m_ringSize,
+                                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT},
+                                        m_ringBuffer, m_ringAllocation, &_mappedData);
+        m_ringData = static_cast<std::byte*>(_mappedData);
+    }
+
+    UploadManager::~UploadManager()
+    {
+        WaitIdle();
+
+        for (const Batch& _batch : m_freeBatches)
+        {
+            vkDestroyFence(m_device, _batch.Fence, nullptr);
+            vkDestroyFence(m_device, _batch.AcquireFence, nullptr);
+            vkDestroySemaphore(m_device, _batch.TransferSemaphore, nullptr);
+        }
+        // Frees every command buffer allocated from them
+        vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+        vkDestroyCommandPool(m_device, m_acquireCommandPool, nullptr);
+        VulkanBufferUtils::DestroyBuffer(m_ringBuffer, m_ringAllocation);
+    }
+
+    StagingAllocation UploadManager::Allocate(const VkDeviceSize size, const VkDeviceSize alignment)
+    {
+        if (size > m_ringSize)
+        {
+            return AllocateDedicated(size);
+        }
+
+        bool _bStalled = false;
+        while (true)
+        {
+            if (m_head == m_tail && m_inFlightBatches.empty())
+            {
+                // Nothing in flight, start over at the front so the whole ring is one free range
+                m_head = m_tail = 0;
+            }
+
+            uint64_t _position = (m_head + alignment - 1) / alignment * alignment;
+            uint64_t _offset = _position % m_ringSize;
+            if (_offset + size > m_ringSize)
+            {
+                // Copies cannot wrap, skip the rest of the ring
+                _position += m_ringSize - _offset;
+                _offset = 0;
+            }
+
+            if (_position + size - m_tail <= m_ringSize)
+            {
+                GetCurrentBatch();
+                m_head = _position + size;
+                return {m_ringData + _offset, m_ringBuffer, _offset};
+            }
+
+            // Out of space. Reclaim what the GPU is done with first, submit and wait only when that is not enough.
+            if (RetireBatches(false))
+            {
+                continue;
+            }
+            if (!_bStalled)
+            {
+                _bStalled = true;
+                ++m_stats.StallCount;
+            }
+            Flush();
+            RetireBatches(true);
+        }
+    }
+
+    StagingAllocation UploadManager::AllocateDedicated(const VkDeviceSize size)
+    {
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+
+        std::pair<VkBuffer, VmaAllocation> _buffer{VK_NULL_HANDLE, VK_NULL_HANDLE};
+        void* _mappedData = nullptr;
+        VulkanBufferUtils::CreateBuffer({m_device, _deviceSelector->GetPhysicalDevice(), size,
+                                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT},
+                                        _buffer.first, _buffer.second, &_mappedData);
+
+        // Released together with the batch that reads from it
+        GetCurrentBatch().DedicatedBuffers.push_back(_buffer);
+        ++m_stats.DedicatedCount;
+        return {_mappedData, _buffer.first, 0};
+    }
+
+    VkCommandBuffer UploadManager::GetCommandBuffer() { return GetCurrentBatch().CommandBuffer; }
+
+    UploadManager::Batch& UploadManager::GetCurrentBatch()
+    {
+        if (m_currentBatch)
+        {
+            return *m_currentBatch;
+        }
+
+        if (!m_freeBatches.empty())
+        {
+            m_currentBatch = std::move(m_freeBatches.back());
+            m_freeBatches.pop_back();
+        }
+        else
+        {
+            m_currentBatch.emplace();
+            m_currentBatch->CommandBuffer = AllocateCommandBuffer(m_device, m_commandPool);
+            m_currentBatch->Fence = CreateFence(m_device);
+
+            if (m_bOwnershipTransfer)
+            {
+                m_currentBatch->AcquireCommandBuffer = AllocateCommandBuffer(m_device, m_acquireCommandPool);
+                m_currentBatch->AcquireFence = CreateFence(m_device);
+
+                VkSemaphoreCreateInfo _semaphoreInfo{};
+                _semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+                VK_CALL(vkCreateSemaphore(m_device, &_semaphoreInfo, nullptr, &m_currentBatch->TransferSemaphore));
+            }
+        }
+
+        VkCommandBufferBeginInfo _beginInfo{};
+        _beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        _beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_CALL(vkBeginCommandBuffer(m_currentBatch->CommandBuffer, &_beginInfo));
+
+        return *m_currentBatch;
+    }
+
+    void UploadManager::UploadBuffer(const VkBuffer dstBuffer, const VkDeviceSize dstOffset, const void* data,
+                                     const VkDeviceSize size)
+    {
+        const StagingAllocation _staging = Allocate(size);
+        std::memcpy(_staging.Data, data, size);
+
+        VkBufferCopy _region{};
+        _region.srcOffset = _staging.Offset;
+        _region.dstOffset = dstOffset;
+        _region.size = size;
+        vkCmdCopyBuffer(GetCommandBuffer(), _staging.Buffer, dstBuffer, 1, &_region);
+        ReleaseBuffer(dstBuffer, dstOffset, size);
+
+        m_stats.BytesUploaded += size;
+        ++m_stats.CopyCount;
+    }
+
+    void UploadManager::UploadImage(const VkImage image, const uint32_t width, const uint32_t height,
+                                    const void* data, const VkDeviceSize size, const uint32_t mipLevels)
+    {
+        const StagingAllocation _staging = Allocate(size);
+        std::memcpy(_staging.Data, data, size);
+
+        const VkCommandBuffer _commandBuffer = GetCommandBuffer();
+        BeginImageUpload(_commandBuffer, image);
+
+        VkBufferImageCopy _region{};
+        _region.bufferOffset = _staging.Offset;
+        _region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        _region.imageExtent = {width, height, 1};
+        vkCmdCopyBufferToImage(_commandBuffer, _staging.Buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+                               &_region);
+
+        const VkImageSubresourceRange _range{VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0,
+                                             VK_REMAINING_ARRAY_LAYERS};
+        if (mipLevels <= 1)
+        {
+            ReleaseImage(image, _range, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        }
+        else if (!m_bOwnershipTransfer)
+        {
+            RecordMipGeneration(_commandBuffer, {image, width, height, mipLevels});
+        }
+        else
+        {
+            // Hand the image over as it is, the chain is blitted once the graphics queue owns it
+            ReleaseImage(image, _range, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT);
+            GetCurrentBatch().MipGenerations.push_back({image, width, height, mipLevels});
+        }
+
+        m_stats.BytesUploaded += size;
+        ++m_stats.CopyCount;
+    }
+
+    void UploadManager::UploadImageLevels(const VkImage image, const std::span<const MipLevel> levels,
+                                          const void* data, const VkDeviceSize size)
+    {
+        const StagingAllocation _staging = Allocate(size);
+        std::memcpy(_staging.Data, data, size);
+
+        const VkCommandBuffer _commandBuffer = GetCommandBuffer();
+        BeginImageUpload(_commandBuffer, image);
+
+        std::vector<VkBufferImageCopy> _regions(levels.size());
+        for (uint32_t _level = 0; _level < levels.size(); ++_level)
+        {
+            _regions[_level].bufferOffset = _staging.Offset + levels[_level].Offset;
+            _regions[_level].imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, _level, 0, 1};
+            _regions[_level].imageExtent = {levels[_level].Width, levels[_level].Height, 1};
+        }
+        vkCmdCopyBufferToImage(_commandBuffer, _staging.Buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(_regions.size()), _regions.data());
+
+        ReleaseImage(image, {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS},
+                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        m_stats.BytesUploaded += size;
+        ++m_stats.CopyCount;
+    }
+
+    void UploadManager::BeginImageUpload(const VkCommandBuffer commandBuffer, const VkImage image) const
+    {
+        VkImageMemoryBarrier _barrier{};
+        _barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        _barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        _barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        _barrier.image = image;
+        _barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+        _barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        _barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        _barrier.srcAccessMask = 0;
+        _barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                             nullptr, 0, nullptr, 1, &_barrier);
+    }
+
+    void UploadManager::RecordMipGeneration(const VkCommandBuffer commandBuffer, const MipGeneration& generation)
+    {
+        VkImageMemoryBarrier _barrier{};
+        _barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        _barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        _barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        _barrier.image = generation.Image;
+        _barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+        int32_t _width = static_cast<int32_t>(generation.Width);
+        int32_t _height = static_cast<int32_t>(generation.Height);
+        for (uint32_t _level = 1; _level < generation.MipLevels; ++_level)
+        {
+            // The previous level becomes the blit source once its copy or blit has landed
+            _barrier.subresourceRange.baseMipLevel = _level - 1;
+            _barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            _barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            _barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            _barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                                 nullptr, 0, nullptr, 1, &_barrier);
+
+            const int32_t _nextWidth = std::max(1, _width / 2);
+            const int32_t _nextHeight = std::max(1, _height / 2);
+
+            VkImageBlit _blit{};
+            _blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, _level - 1, 0, 1};
+            _blit.srcOffsets[1] = {_width, _height, 1};
+            _blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, _level, 0, 1};
+            _blit.dstOffsets[1] = {_nextWidth, _nextHeight, 1};
+            vkCmdBlitImage(commandBuffer, generation.Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, generation.Image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &_blit, VK_FILTER_LINEAR);
+
+            _barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            _barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            _barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            _barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &_barrier);
+
+            _width = _nextWidth;
+            _height = _nextHeight;
+        }
+
+        // The last level was only ever written
+        _barrier.subresourceRange.baseMipLevel = generation.MipLevels - 1;
+        _barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        _barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        _barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        _barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0,
+                             nullptr, 0, nullptr, 1, &_barrier);
+    }
+
+    void UploadManager::ReleaseBuffer(const VkBuffer buffer, const VkDeviceSize offset, const VkDeviceSize size)
+    {
+        if (!m_bOwnershipTransfer)
+        {
+            // Covered by the memory barrier at the end of the batch
+            return;
+        }
+
+        VkBufferMemoryBarrier _barrier{};
+        _barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        _barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        _barrier.srcQueueFamilyIndex = m_transferFamily;
+        _barrier.dstQueueFamilyIndex = m_graphicsFamily;
+        _barrier.buffer = buffer;
+        _barrier.offset = offset;
+        _barrier.size = size;
+        vkCmdPipelineBarrier(GetCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 1, &_barrier, 0, nullptr);
+
+        // The acquire has to repeat the release exactly, apart from its own access mask
+        Batch& _batch = GetCurrentBatch();
+        _barrier.srcAccessMask = 0;
+        _barrier.dstAccessMask = BUFFER_READ_ACCESS;
+        _batch.BufferAcquires.push_back(_barrier);
+        _batch.AcquireStageMask |= BUFFER_READ_STAGES;
+    }
+
+    void UploadManager::ReleaseImage(const VkImage image, const VkImageSubresourceRange& range,
+                                     const VkImageLayout oldLayout, const VkImageLayout newLayout,
+                                     const VkPipelineStageFlags dstStageMask)
+    {
+        VkImageMemoryBarrier _barrier{};
+        _barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        _barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        _barrier.oldLayout = oldLayout;
+        _barrier.newLayout = newLayout;
+        _barrier.image = image;
+        _barrier.subresourceRange = range;
+
+        if (!m_bOwnershipTransfer)
+        {
+            _barrier.dstAccessMask = ReadAccessForLayout(newLayout);
+            _barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            _barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            vkCmdPipelineBarrier(GetCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask, 0, 0, nullptr, 0,
+                                 nullptr, 1, &_barrier);
+            return;
+        }
+
+        // The layout transition happens once, between the release on the transfer queue and the acquire
+        _barrier.srcQueueFamilyIndex = m_transferFamily;
+        _barrier.dstQueueFamilyIndex = m_graphicsFamily;
+        vkCmdPipelineBarrier(GetCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &_barrier);
+
+        Batch& _batch = GetCurrentBatch();
+        _barrier.srcAccessMask = 0;
+        _barrier.dstAccessMask = ReadAccessForLayout(newLayout);
+        _batch.ImageAcquires.push_back(_barrier);
+        _batch.AcquireStageMask |= dstStageMask;
+    }
+
+    uint64_t UploadManager::Flush()
+    {
+        if (!m_currentBatch)
+        {
+            return m_nextTicket - 1;
+        }
+
+        PROFILE_FUNCTION()
+        Batch _batch = std::move(*m_currentBatch);
+        m_currentBatch.reset();
+        _batch.Ticket = m_nextTicket++;
+
+        if (!m_bOwnershipTransfer)
+        {
+            // Later submits on this queue may read anything written here, vertex and index fetch included
+            VkMemoryBarrier _barrier{};
+            _barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            _barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            _barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+            vkCmdPipelineBarrier(_batch.CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &_barrier, 0, nullptr, 0, nullptr);
+        }
+        VK_CALL(vkEndCommandBuffer(_batch.CommandBuffer));
+
+        VkSubmitInfo _submitInfo{};
+        _submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        _submitInfo.commandBufferCount = 1;
+        _submitInfo.pCommandBuffers = &_batch.CommandBuffer;
+        // A binary semaphore may only be signalled again after it was waited on, so only signal it for an acquire
+        if (_batch.NeedsAcquire())
+        {
+            _submitInfo.signalSemaphoreCount = 1;
+            _submitInfo.pSignalSemaphores = &_batch.TransferSemaphore;
+        }
+        VK_CALL(vkQueueSubmit(m_transferQueue, 1, &_submitInfo, _batch.Fence));
+
+        if (!m_bOwnershipTransfer)
+        {
+            // Same queue, submission order is enough
+            m_readyTicket = _batch.Ticket;
+        }
+
+        _batch.RingEnd = m_head;
+        const uint64_t _ticket = _batch.Ticket;
+        m_inFlightBatches.push_back(std::move(_batch));
+        ++m_stats.SubmitCount;
+        return _ticket;
+    }
+
+    void UploadManager::Synchronize()
+    {
+        Flush();
+        for (Batch& _batch : m_inFlightBatches)
+        {
+            if (_batch.NeedsAcquire() && !_batch.bAcquireSubmitted)
+            {
+                SubmitAcquire(_batch);
+            }
+        }
+    }
+
+    void UploadManager::Update()
+    {
+        PROFILE_FUNCTION()
+        RetireBatches(false);
+    }
+
+    void UploadManager::SubmitAcquire(Batch& batch)
+    {
+        VkCommandBufferBeginInfo _beginInfo{};
+        _beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        _beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_CALL(vkBeginCommandBuffer(batch.AcquireCommandBuffer, &_beginInfo));
+        vkCmdPipelineBarrier(batch.AcquireCommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, batch.AcquireStageMask, 0,
+                             0, nullptr, static_cast<uint32_t>(batch.BufferAcquires.size()),
+                             batch.BufferAcquires.data(), static_cast<uint32_t>(batch.ImageAcquires.size()),
+                             batch.ImageAcquires.data());
+        for (const MipGeneration& _generation : batch.MipGenerations)
+        {
+            RecordMipGeneration(batch.AcquireCommandBuffer, _generation);
+        }
+        VK_CALL(vkEndCommandBuffer(batch.AcquireCommandBuffer));
+
+        // Graphics submits after this one are ordered behind the acquire barrier, so they see the uploads
+        // Waiting at ALL_COMMANDS chains the semaphore into the barrier's first scope
+        constexpr VkPipelineStageFlags _waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        VkSubmitInfo _submitInfo{};
+        _submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        _submitInfo.waitSemaphoreCount = 1;
+        _submitInfo.pWaitSemaphores = &batch.TransferSemaphore;
+        _submitInfo.pWaitDstStageMask = &_waitStage;
+        _submitInfo.commandBufferCount = 1;
+        _submitInfo.pCommandBuffers = &batch.AcquireCommandBuffer;
+        VK_CALL(vkQueueSubmit(m_graphicsQueue, 1, &_submitInfo, batch.AcquireFence));
+
+        batch.bAcquireSubmitted = true;
+        m_readyTicket = std::max(m_readyTicket, batch.Ticket);
+        ++m_stats.OwnershipTransferCount;
+    }
+
+    void UploadManager::WaitIdle()
+    {
+        Flush();
+        while (!m_inFlightBatches.empty() || !m_acquiringBatches.empty())
+        {
+            RetireBatches(true);
+        }
+    }
+
+    bool UploadManager::RetireBatches(const bool bWaitForOldest)
+    {
+        if (bWaitForOldest && !m_inFlightBatches.empty())
+        {
+            VK_CALL(vkWaitForFences(m_device, 1, &m_inFlightBatches.front().Fence, VK_TRUE, UINT64_MAX));
+        }
+        else if (bWaitForOldest && !m_acquiringBatches.empty())
+        {
+            VK_CALL(vkWaitForFences(m_device, 1, &m_acquiringBatches.front().AcquireFence, VK_TRUE, UINT64_MAX));
+        }
+
+        // Batches complete in submission order, so stop at the first one still running
+        bool _bRetired = false;
+        while (!m_inFlightBatches.empty() && vkGetFenceStatus(m_device, m_inFlightBatches.front().Fence) == VK_SUCCESS)
+        {
+            Batch _batch = std::move(m_inFlightBatches.front());
+            m_inFlightBatches.pop_front();
+            _bRetired = true;
+
+            // The transfer is done with the staging memory, even if the acquire has not run yet
+            m_tail = _batch.RingEnd;
+            for (auto& [_buffer, _allocation] : _batch.DedicatedBuffers)
+            {
+                VulkanBufferUtils::DestroyBuffer(_buffer, _allocation);
+            }
+            _batch.DedicatedBuffers.clear();
+
+            if (!_batch.NeedsAcquire())
+            {
+                m_readyTicket = std::max(m_readyTicket, _batch.Ticket);
+                RecycleBatch(_batch);
+                continue;
+            }
+
+            if (!_batch.bAcquireSubmitted)
+            {
+                // Already signalled, the graphics queue will not wait on it
+                SubmitAcquire(_batch);
+            }
+            m_acquiringBatches.push_back(std::move(_batch));
+        }
+
+        while (!m_acquiringBatches.empty() &&
+               vkGetFenceStatus(m_device, m_acquiringBatches.front().AcquireFence) == VK_SUCCESS)
+        {
+            RecycleBatch(m_acquiringBatches.front());
+            m_acquiringBatches.pop_front();
+        }
+        return _bRetired;
+    }
+
+    void UploadManager::RecycleBatch(Batch& batch)
+    {
+        VK_CALL(vkResetFences(m_device, 1, &batch.Fence));
+        VK_CALL(vkResetCommandBuffer(batch.CommandBuffer, 0));
+
+        if (batch.bAcquireSubmitted)
+        {
+            VK_CALL(vkResetFences(m_device, 1, &batch.AcquireFence));
+            VK_CALL(vkResetCommandBuffer(batch.AcquireCommandBuffer, 0));
+        }
+        batch.BufferAcquires.clear();
+        batch.ImageAcquires.clear();
+        batch.AcquireStageMask = 0;
+        batch.MipGenerations.clear();
+        batch.bAcquireSubmitted = false;
+
+        m_freeBatches.push_back(std::move(batch));
+    }
+} // namespace Thryve::Rendering
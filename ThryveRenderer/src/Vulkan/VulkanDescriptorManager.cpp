@@ -9,28 +9,23 @@
 #include "utils/VkDebugUtils.h"
 
 namespace Thryve::Rendering {
-    VulkanDescriptorManager::VulkanDescriptorManager(VkDescriptorPool descriptorPool): m_descriptorPool(descriptorPool), m_descriptorSetLayout(nullptr) {
+    VulkanDescriptorManager::VulkanDescriptorManager(DescriptorLayoutCache &layoutCache): m_layoutCache(&layoutCache), m_descriptorSetLayout(nullptr) {
         m_device = Thryve::Rendering::VulkanContext::GetCurrentDevice()->GetLogicalDevice();
     }
 
     void VulkanDescriptorManager::CreateDescriptorSetLayout(const std::vector<VulkanDescriptor> &descriptors) {
-        VulkanDescriptorSetBuilder builder(m_device);
+        VulkanDescriptorSetBuilder builder(*m_layoutCache);
         for (const auto &descriptor: descriptors) {
             builder.AddDescriptor(descriptor);
         }
         m_descriptorSetLayout = builder.BuildLayout();
     }
 
-    void VulkanDescriptorManager::AllocateDescriptorSets(uint32_t setCount) {
-        const std::vector layouts(setCount, m_descriptorSetLayout);
-        VkDescriptorSetAllocateInfo allocInfo = {};
-        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocInfo.descriptorPool = m_descriptorPool;
-        allocInfo.descriptorSetCount = setCount;
-        allocInfo.pSetLayouts = layouts.data();
-
+    void VulkanDescriptorManager::AllocateDescriptorSets(DescriptorAllocator &allocator, uint32_t setCount) {
         m_descriptorSets.resize(setCount);
-        VK_CALL(vkAllocateDescriptorSets(m_device, &allocInfo, m_descriptorSets.data()));
+        for (VkDescriptorSet &descriptorSet : m_descriptorSets) {
+            descriptorSet = allocator.Allocate(m_descriptorSetLayout);
+        }
     }
 
     // In VulkanDescriptorManager class, add these helper methods:
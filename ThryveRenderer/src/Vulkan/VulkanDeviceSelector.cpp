@@ -4,6 +4,10 @@
 
 #include "Vulkan/VulkanDeviceSelector.h"
 
+#define VMA_IMPLEMENTATION
+#include "vk_mem_alloc.h"
+
+#include <algorithm>
 #include <set>
 #include <stdexcept>
 
@@ -17,6 +21,10 @@ VulkanDeviceSelector::VulkanDeviceSelector(const VkInstance instance
 }
 
 VulkanDeviceSelector::~VulkanDeviceSelector() {
+    if (m_allocator != VK_NULL_HANDLE) {
+        vmaDestroyAllocator(m_allocator); // Every buffer and image has to be gone by now
+        m_allocator = VK_NULL_HANDLE;
+    }
     if (m_logicalDevice != VK_NULL_HANDLE) {
         vkDestroyDevice(m_logicalDevice, nullptr); // Destroy the logical device
         m_logicalDevice = VK_NULL_HANDLE;
@@ -28,21 +36,36 @@ VulkanDeviceSelector::VulkanDeviceSelector(VulkanDeviceSelector && other) noexce
   m_surface(other.m_surface),
   m_physicalDevice(other.m_physicalDevice),
   m_logicalDevice(other.m_logicalDevice),
+  m_allocator(other.m_allocator),
   m_graphicsQueue(other.m_graphicsQueue),
-  m_presentQueue(other.m_presentQueue) {
+  m_presentQueue(other.m_presentQueue),
+  m_transferQueue(other.m_transferQueue),
+  m_bTextureCompressionBC(other.m_bTextureCompressionBC),
+  m_bDescriptorIndexing(other.m_bDescriptorIndexing),
+  m_maxBindlessTextures(other.m_maxBindlessTextures),
+  m_bIndirectDraws(other.m_bIndirectDraws),
+  m_bDrawIndirectCount(other.m_bDrawIndirectCount),
+  m_bSynchronization2(other.m_bSynchronization2),
+  m_queueFamiliyIndices(other.m_queueFamiliyIndices) {
 
         // Invalidate the moved-from object's Vulkan handles to ensure it doesn't destroy them.
         other.m_instance = VK_NULL_HANDLE;
         other.m_surface = VK_NULL_HANDLE;
         other.m_physicalDevice = VK_NULL_HANDLE;
         other.m_logicalDevice = VK_NULL_HANDLE;
+        other.m_allocator = VK_NULL_HANDLE;
         other.m_graphicsQueue = VK_NULL_HANDLE;
         other.m_presentQueue = VK_NULL_HANDLE;
+        other.m_transferQueue = VK_NULL_HANDLE;
 }
 
 VulkanDeviceSelector & VulkanDeviceSelector::operator=(VulkanDeviceSelector && other) noexcept {
     if (this != &other) { // Prevent self-assignment
         // Clean up the current resources
+        if (m_allocator != VK_NULL_HANDLE) {
+            vmaDestroyAllocator(m_allocator);
+            m_allocator = VK_NULL_HANDLE;
+        }
         if (m_logicalDevice != VK_NULL_HANDLE) {
             vkDestroyDevice(m_logicalDevice, nullptr); // Only destroy the logical device; Vulkan cleans up the physical device
             m_logicalDevice = VK_NULL_HANDLE; // Ensure we mark it as no longer valid
@@ -54,16 +77,27 @@ VulkanDeviceSelector & VulkanDeviceSelector::operator=(VulkanDeviceSelector && o
         m_surface = other.m_surface;
         m_physicalDevice = other.m_physicalDevice;
         m_logicalDevice = other.m_logicalDevice;
+        m_allocator = other.m_allocator;
         m_graphicsQueue = other.m_graphicsQueue;
         m_presentQueue = other.m_presentQueue;
+        m_transferQueue = other.m_transferQueue;
+        m_bTextureCompressionBC = other.m_bTextureCompressionBC;
+        m_bDescriptorIndexing = other.m_bDescriptorIndexing;
+        m_maxBindlessTextures = other.m_maxBindlessTextures;
+        m_bIndirectDraws = other.m_bIndirectDraws;
+        m_bDrawIndirectCount = other.m_bDrawIndirectCount;
+        m_bSynchronization2 = other.m_bSynchronization2;
+        m_queueFamiliyIndices = other.m_queueFamiliyIndices;
 
         // Invalidate the moved-from object to prevent it from freeing resources that are now owned by this
         other.m_instance = VK_NULL_HANDLE;
         other.m_surface = VK_NULL_HANDLE;
         other.m_physicalDevice = VK_NULL_HANDLE;
         other.m_logicalDevice = VK_NULL_HANDLE;
+        other.m_allocator = VK_NULL_HANDLE;
         other.m_graphicsQueue = VK_NULL_HANDLE;
         other.m_presentQueue = VK_NULL_HANDLE;
+        other.m_transferQueue = VK_NULL_HANDLE;
     }
     return *this;
 }
@@ -87,6 +121,15 @@ VkQueue VulkanDeviceSelector::GetGraphicsQueue() const {
 
 VkQueue VulkanDeviceSelector::GetPresentQueue() const { return m_presentQueue; }
 
+VkQueue VulkanDeviceSelector::GetTransferQueue() const {
+    return m_transferQueue != VK_NULL_HANDLE ? m_transferQueue : m_graphicsQueue;
+}
+
+uint32_t VulkanDeviceSelector::GetTransferFamily() const {
+    return m_transferQueue != VK_NULL_HANDLE ? m_queueFamiliyIndices.TransferFamily.value()
+                                             : m_queueFamiliyIndices.GraphicsFamily.value();
+}
+
 std::string VulkanDeviceSelector::GetGraphicsCardType(VkPhysicalDeviceProperties props)
 {
     switch (props.deviceType)
@@ -195,6 +238,32 @@ bool VulkanDeviceSelector::CheckDeviceExtensionSupport(VkPhysicalDevice device
         return requiredExtensions.empty();
 }
 
+bool VulkanDeviceSelector::QueryDescriptorIndexing(VkPhysicalDevice device
+    , VkPhysicalDeviceDescriptorIndexingFeaturesEXT &features) {
+        features = {};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+        // maintenance3 is required by descriptor indexing
+        const std::vector<const char *> _extensions = {VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
+                                                       VK_KHR_MAINTENANCE3_EXTENSION_NAME};
+        // Only resolves when the instance enabled VK_KHR_get_physical_device_properties2
+        const auto _getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+            vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceFeatures2KHR"));
+        if (!_getFeatures2 || !CheckDeviceExtensionSupport(device, _extensions)) {
+            return false;
+        }
+
+        VkPhysicalDeviceFeatures2KHR _features2{};
+        _features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+        _features2.pNext = &features;
+        _getFeatures2(device, &_features2);
+        _features2.pNext = nullptr;
+
+        return features.shaderSampledImageArrayNonUniformIndexing && features.runtimeDescriptorArray &&
+               features.descriptorBindingPartiallyBound && features.descriptorBindingSampledImageUpdateAfterBind &&
+               features.descriptorBindingUpdateUnusedWhilePending;
+}
+
 QueueFamilyIndices VulkanDeviceSelector::FindQueueFamilies(VkPhysicalDevice device) const {
         QueueFamilyIndices indices;
 
@@ -204,29 +273,55 @@ QueueFamilyIndices VulkanDeviceSelector::FindQueueFamilies(VkPhysicalDevice devi
         std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
         vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
-        int i = 0;
-        for (const auto& queueFamily : queueFamilies) {
-            if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+        for (uint32_t i = 0; i < queueFamilyCount; i++) {
+            const VkQueueFlags flags = queueFamilies[i].queueFlags;
+            if ((flags & VK_QUEUE_GRAPHICS_BIT) && !indices.GraphicsFamily.has_value()) {
                 indices.GraphicsFamily = i;
             }
 
             VkBool32 presentSupport = false;
             VK_CALL(vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_surface, &presentSupport));
 
-            if (presentSupport) {
+            if (presentSupport && !indices.PresentFamily.has_value()) {
                 indices.PresentFamily = i;
             }
 
-            if (indices.IsComplete()) {
-                break;
+            // One family doing both keeps the swap chain images exclusive
+            if ((flags & VK_QUEUE_GRAPHICS_BIT) && presentSupport && indices.GraphicsFamily != indices.PresentFamily) {
+                indices.GraphicsFamily = i;
+                indices.PresentFamily = i;
             }
 
-            i++;
+            // Prefer a pure copy engine over an async compute family that also does transfers
+            if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT)) {
+                const bool bCopyOnly = !(flags & VK_QUEUE_COMPUTE_BIT);
+                if (!indices.TransferFamily.has_value() ||
+                    (bCopyOnly && (queueFamilies[indices.TransferFamily.value()].queueFlags & VK_QUEUE_COMPUTE_BIT))) {
+                    indices.TransferFamily = i;
+                }
+            }
         }
 
         return indices;
 }
 
+bool VulkanDeviceSelector::QuerySynchronization2(VkPhysicalDevice device) {
+        const auto _getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+            vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceFeatures2KHR"));
+        if (!_getFeatures2 || !CheckDeviceExtensionSupport(device, {VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME})) {
+            return false;
+        }
+
+        VkPhysicalDeviceSynchronization2FeaturesKHR _synchronization2{};
+        _synchronization2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+        VkPhysicalDeviceFeatures2KHR _features2{};
+        _features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+        _features2.pNext = &_synchronization2;
+        _getFeatures2(device, &_features2);
+
+        return _synchronization2.synchronization2 == VK_TRUE;
+}
+
 void VulkanDeviceSelector::CreateLogicalDevice(VkPhysicalDevice physicalDevice
     , const std::vector<const char *> &deviceExtensions, bool enableValidationLayers) {
 
@@ -234,6 +329,9 @@ void VulkanDeviceSelector::CreateLogicalDevice(VkPhysicalDevice physicalDevice
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
         std::set<uint32_t> uniqueQueueFamilies = {indices.GraphicsFamily.value(), indices.PresentFamily.value()};
+        if (indices.TransferFamily.has_value()) {
+            uniqueQueueFamilies.insert(indices.TransferFamily.value());
+        }
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -245,19 +343,68 @@ void VulkanDeviceSelector::CreateLogicalDevice(VkPhysicalDevice physicalDevice
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
         VkPhysicalDeviceFeatures deviceFeatures{};
         deviceFeatures.samplerAnisotropy = VK_TRUE;
+        // Optional, textures fall back to uncompressed RGBA8 without it
+        deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+        // Optional, the GPU-driven path needs both, see SupportsIndirectDraws
+        deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+        deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+
+        // Optional as well, only the features the bindless texture table relies on are switched on
+        std::vector<const char *> enabledExtensions = deviceExtensions;
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT supportedIndexing;
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+        indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        const bool bDescriptorIndexing = QueryDescriptorIndexing(physicalDevice, supportedIndexing);
+        if (bDescriptorIndexing) {
+            enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+            enabledExtensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+            indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+            indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+            indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+            indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        }
+
+        const bool bDrawIndirectCount = CheckDeviceExtensionSupport(physicalDevice, {VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME});
+        if (bDrawIndirectCount) {
+            enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        }
+
+        // Optional, the render graph falls back to vkCmdPipelineBarrier without it
+        VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{};
+        synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+        const bool bSynchronization2 = QuerySynchronization2(physicalDevice);
+        if (bSynchronization2) {
+            enabledExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+            synchronization2Features.synchronization2 = VK_TRUE;
+        }
+
+        void* featureChain = nullptr;
+        if (bSynchronization2) {
+            synchronization2Features.pNext = featureChain;
+            featureChain = &synchronization2Features;
+        }
+        if (bDescriptorIndexing) {
+            indexingFeatures.pNext = featureChain;
+            featureChain = &indexingFeatures;
+        }
 
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext = featureChain;
 
         createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
         createInfo.pEnabledFeatures = &deviceFeatures;
 
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+        createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
         if (enableValidationLayers) {
             createInfo.enabledLayerCount = static_cast<uint32_t>(VALIDATION_LAYERS.size());
@@ -268,7 +415,44 @@ void VulkanDeviceSelector::CreateLogicalDevice(VkPhysicalDevice physicalDevice
 
 
         VK_CALL(vkCreateDevice(physicalDevice, &createInfo, nullptr, &m_logicalDevice));
+        m_bTextureCompressionBC = deviceFeatures.textureCompressionBC == VK_TRUE;
+        m_bDescriptorIndexing = bDescriptorIndexing;
+        m_bIndirectDraws = deviceFeatures.multiDrawIndirect == VK_TRUE && deviceFeatures.drawIndirectFirstInstance == VK_TRUE;
+        m_bDrawIndirectCount = bDrawIndirectCount;
+        m_bSynchronization2 = bSynchronization2;
+        if (bDescriptorIndexing) {
+            const auto getProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(
+                vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceProperties2KHR"));
+            VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties{};
+            indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+            VkPhysicalDeviceProperties2KHR properties2{};
+            properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+            properties2.pNext = &indexingProperties;
+            getProperties2(physicalDevice, &properties2);
+            m_maxBindlessTextures = std::min(indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                                             indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+            m_maxBindlessTextures = std::min(m_maxBindlessTextures,
+                                             std::min(indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                                                      indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers));
+        }
 
         vkGetDeviceQueue(m_logicalDevice, indices.GraphicsFamily.value(), 0, &m_graphicsQueue);
         vkGetDeviceQueue(m_logicalDevice, indices.PresentFamily.value(), 0, &m_presentQueue);
+        if (indices.TransferFamily.has_value()) {
+            vkGetDeviceQueue(m_logicalDevice, indices.TransferFamily.value(), 0, &m_transferQueue);
+        }
+        m_queueFamiliyIndices = indices;
+
+        CreateAllocator();
+}
+
+void VulkanDeviceSelector::CreateAllocator() {
+        VmaAllocatorCreateInfo allocatorInfo{};
+        // Has to match the apiVersion the instance was created with
+        allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_0;
+        allocatorInfo.instance = m_instance;
+        allocatorInfo.physicalDevice = m_physicalDevice;
+        allocatorInfo.device = m_logicalDevice;
+
+        VK_CALL(vmaCreateAllocator(&allocatorInfo, &m_allocator));
 }
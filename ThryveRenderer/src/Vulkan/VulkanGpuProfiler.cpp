@@ -0,0 +1,183 @@
+#include "Vulkan/VulkanGpuProfiler.h"
+
+#include "Core/Log.h"
+#include "Core/ServiceRegistry.h"
+#include "Vulkan/VulkanContext.h"
+#include "utils/SingleTimeCommandUtil.h"
+#include "utils/VkDebugUtils.h"
+
+namespace Thryve::Rendering {
+    VulkanGpuProfiler::VulkanGpuProfiler(const VkCommandPool commandPool, const uint32_t maxFramesInFlight)
+    {
+        const auto _deviceSelector = VulkanContext::GetCurrentDevice();
+        m_device = _deviceSelector->GetLogicalDevice();
+
+        VkPhysicalDeviceProperties _properties;
+        vkGetPhysicalDeviceProperties(_deviceSelector->GetPhysicalDevice(), &_properties);
+
+        uint32_t _familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(_deviceSelector->GetPhysicalDevice(), &_familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> _families(_familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(_deviceSelector->GetPhysicalDevice(), &_familyCount, _families.data());
+
+        const uint32_t _validBits = _families[_deviceSelector->GetQueueFamilyIndices().GraphicsFamily.value()].timestampValidBits;
+        if (_validBits == 0 || _properties.limits.timestampPeriod <= 0.0f)
+        {
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogWarning(
+                "Graphics queue does not support timestamps, GPU scopes are disabled");
+            return;
+        }
+
+        m_timestampPeriod = _properties.limits.timestampPeriod;
+        m_timestampMask = _validBits >= 64 ? UINT64_MAX : (uint64_t{1} << _validBits) - 1;
+
+        VkQueryPoolCreateInfo _poolInfo{};
+        _poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        _poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        _poolInfo.queryCount = MAX_SCOPES_PER_FRAME * 2;
+
+        m_frames.resize(maxFramesInFlight);
+        for (auto& _frame : m_frames)
+        {
+            VK_CALL(vkCreateQueryPool(m_device, &_poolInfo, nullptr, &_frame.QueryPool));
+            _frame.Scopes.reserve(MAX_SCOPES_PER_FRAME);
+        }
+        m_results.resize(MAX_SCOPES_PER_FRAME * 2 * 2);
+
+        Calibrate(commandPool);
+
+        m_bSupported = true;
+        s_Current = this;
+    }
+
+    VulkanGpuProfiler::~VulkanGpuProfiler()
+    {
+        if (s_Current == this)
+        {
+            s_Current = nullptr;
+        }
+
+        for (const auto& _frame : m_frames)
+        {
+            vkDestroyQueryPool(m_device, _frame.QueryPool, nullptr);
+        }
+    }
+
+    void VulkanGpuProfiler::Calibrate(const VkCommandPool commandPool)
+    {
+        // Places one GPU tick count against the CPU profiler clock. The submit is bracketed by two CPU
+        // samples and the midpoint is taken, which is accurate to a fraction of one submit round trip.
+        const VkQueue _queue = VulkanContext::GetCurrentDevice()->GetGraphicsQueue();
+        const VkQueryPool _pool = m_frames.front().QueryPool;
+
+        VkCommandBuffer _commandBuffer = SingleTimeCommandUtil::BeginSingleTimeCommands(m_device, commandPool);
+        vkCmdResetQueryPool(_commandBuffer, _pool, 0, 1);
+        vkCmdWriteTimestamp(_commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _pool, 0);
+
+        const int64_t _before = Core::ProfilingService::Now();
+        SingleTimeCommandUtil::EndSingleTimeCommands(m_device, commandPool, _queue, _commandBuffer);
+        const int64_t _after = Core::ProfilingService::Now();
+
+        VK_CALL(vkGetQueryPoolResults(m_device, _pool, 0, 1, sizeof(uint64_t), &m_calibrationTicks, sizeof(uint64_t),
+                                      VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+        m_calibrationTicks &= m_timestampMask;
+        m_calibrationTime = _before + (_after - _before) / 2;
+    }
+
+    void VulkanGpuProfiler::BeginFrame(const VkCommandBuffer commandBuffer, const uint32_t frameIndex)
+    {
+        if (!m_bSupported)
+        {
+            return;
+        }
+
+        m_currentFrame = frameIndex % static_cast<uint32_t>(m_frames.size());
+        m_depth = 0;
+
+        FrameQueries& _frame = m_frames[m_currentFrame];
+        CollectResults(_frame);
+
+        vkCmdResetQueryPool(commandBuffer, _frame.QueryPool, 0, MAX_SCOPES_PER_FRAME * 2);
+    }
+
+    uint32_t VulkanGpuProfiler::BeginScope(const VkCommandBuffer commandBuffer, const Core::ProfileScopeID scopeID)
+    {
+        if (!m_bSupported)
+        {
+            return INVALID_SCOPE;
+        }
+
+        FrameQueries& _frame = m_frames[m_currentFrame];
+        if (_frame.Scopes.size() >= MAX_SCOPES_PER_FRAME)
+        {
+            return INVALID_SCOPE;
+        }
+
+        const auto _scopeIndex = static_cast<uint32_t>(_frame.Scopes.size());
+        _frame.Scopes.push_back({scopeID, m_depth++});
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _frame.QueryPool, _scopeIndex * 2);
+        return _scopeIndex;
+    }
+
+    void VulkanGpuProfiler::EndScope(const VkCommandBuffer commandBuffer, const uint32_t scopeIndex)
+    {
+        if (scopeIndex == INVALID_SCOPE)
+        {
+            return;
+        }
+
+        --m_depth;
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_frames[m_currentFrame].QueryPool,
+                            scopeIndex * 2 + 1);
+    }
+
+    void VulkanGpuProfiler::CollectResults(FrameQueries& frame)
+    {
+        if (frame.Scopes.empty())
+        {
+            return;
+        }
+
+        // No WAIT_BIT, the frame fence has already signalled. Availability still guards against
+        // a recording that was never submitted, e.g. after a failed image acquire.
+        const auto _queryCount = static_cast<uint32_t>(frame.Scopes.size() * 2);
+        constexpr VkDeviceSize STRIDE = sizeof(uint64_t) * 2;
+        const VkResult _result = vkGetQueryPoolResults(m_device, frame.QueryPool, 0, _queryCount,
+                                                       _queryCount * STRIDE, m_results.data(), STRIDE,
+                                                       VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+        if (_result == VK_SUCCESS || _result == VK_NOT_READY)
+        {
+            for (size_t _i = 0; _i < frame.Scopes.size(); ++_i)
+            {
+                const uint64_t* _begin = &m_results[_i * 4];
+                const uint64_t* _end = &m_results[_i * 4 + 2];
+                if (_begin[1] == 0 || _end[1] == 0)
+                {
+                    continue;
+                }
+
+                const uint64_t _beginTicks = _begin[0] & m_timestampMask;
+                const uint64_t _elapsedTicks = (_end[0] - _beginTicks) & m_timestampMask;
+                const auto _duration = static_cast<int64_t>(static_cast<double>(_elapsedTicks) * m_timestampPeriod);
+
+                Core::ProfilingService::RecordGpuScope(frame.Scopes[_i].ScopeID, ToProfilerTime(_beginTicks),
+                                                       _duration, frame.Scopes[_i].Depth);
+            }
+        }
+
+        frame.Scopes.clear();
+    }
+
+    int64_t VulkanGpuProfiler::ToProfilerTime(const uint64_t ticks) const
+    {
+        // Signed distance on the masked counter, so timestamps on either side of the calibration point work
+        const uint64_t _delta = (ticks - m_calibrationTicks) & m_timestampMask;
+        auto _signedDelta = static_cast<int64_t>(_delta);
+        if (m_timestampMask != UINT64_MAX && _delta > (m_timestampMask >> 1))
+        {
+            _signedDelta -= static_cast<int64_t>(m_timestampMask) + 1;
+        }
+        return m_calibrationTime + static_cast<int64_t>(static_cast<double>(_signedDelta) * m_timestampPeriod);
+    }
+} // namespace Thryve::Rendering
@@ -4,19 +4,20 @@
 
 #include "Vulkan/VulkanImGuiLayer.h"
 
+#include <cstdio>
 #include <external/imgui/backends/imgui_impl_glfw.h>
 #include <external/imgui/backends/imgui_impl_vulkan.h>
 #include <external/imgui/imgui.h>
 
 #include "Core/App.h"
+#include "Core/ServiceRegistry.h"
+#include "Vulkan/PipelineCacheService.h"
 #include "Vulkan/VulkanContext.h"
 #include "Vulkan/VulkanSwapChain.h"
 #include "Vulkan/VulkanWindow.h"
 #include "utils/VkDebugUtils.h"
 
 namespace Thryve::UI {
-    static std::vector<VkCommandBuffer> s_ImGuiCommandBuffers;
-
     VulkanImGuiLayer::~VulkanImGuiLayer() {}
 
     void VulkanImGuiLayer::OnAttach()
@@ -77,10 +78,12 @@ namespace Thryve::UI {
         init_info.QueueFamily = _deviceSelector->GetQueueFamilyIndices().GraphicsFamily.value();
         init_info.Queue = _deviceSelector->GetGraphicsQueue();
         init_info.DescriptorPool = m_imguiPool->Get();
-        init_info.RenderPass = _swapChain->GetRenderPass();
+        // Drawn by the frame graph's UI pass on top of the main pass, which has no depth
+        init_info.RenderPass = _swapChain->GetOverlayRenderPass();
         init_info.MinImageCount = 2;
         init_info.ImageCount = _swapChain->GetImageCount();
         init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
+        init_info.PipelineCache = Core::ServiceRegistry::GetService<Rendering::PipelineCacheService>()->GetPipelineCache();
 
         if (!ImGui_ImplVulkan_Init(&init_info))
         {
@@ -101,6 +104,53 @@ namespace Thryve::UI {
     {
         bool _pOpen = true;
         ImGui::ShowDemoWindow(&_pOpen);
+        DrawGpuMemoryPanel();
+    }
+
+    void VulkanImGuiLayer::DrawGpuMemoryPanel()
+    {
+        constexpr float MIB = 1024.0f * 1024.0f;
+        const VmaAllocator _allocator = Rendering::VulkanContext::GetCurrentDevice()->GetAllocator();
+
+        const VkPhysicalDeviceProperties* _deviceProperties;
+        const VkPhysicalDeviceMemoryProperties* _memoryProperties;
+        vmaGetPhysicalDeviceProperties(_allocator, &_deviceProperties);
+        vmaGetMemoryProperties(_allocator, &_memoryProperties);
+
+        // Budgets carry per-heap block and allocation statistics, so this stays cheap enough to run every frame
+        VmaBudget _budgets[VK_MAX_MEMORY_HEAPS];
+        vmaGetHeapBudgets(_allocator, _budgets);
+
+        ImGui::Begin("GPU Memory");
+
+        uint32_t _blockCount = 0;
+        uint32_t _allocationCount = 0;
+        for (uint32_t _heap = 0; _heap < _memoryProperties->memoryHeapCount; ++_heap)
+        {
+            const VmaBudget& _budget = _budgets[_heap];
+            _blockCount += _budget.statistics.blockCount;
+            _allocationCount += _budget.statistics.allocationCount;
+
+            const bool _bDeviceLocal = _memoryProperties->memoryHeaps[_heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+            ImGui::Text("Heap %u (%s)", _heap, _bDeviceLocal ? "device local" : "host");
+
+            char _overlay[64];
+            snprintf(_overlay, sizeof(_overlay), "%.1f / %.1f MiB", static_cast<float>(_budget.usage) / MIB,
+                     static_cast<float>(_budget.budget) / MIB);
+            const float _fraction = _budget.budget > 0 ? static_cast<float>(_budget.usage) / static_cast<float>(_budget.budget) : 0.0f;
+            ImGui::ProgressBar(_fraction, ImVec2(-1.0f, 0.0f), _overlay);
+
+            ImGui::Text("%u allocations, %.1f MiB in %u blocks of %.1f MiB", _budget.statistics.allocationCount,
+                        static_cast<float>(_budget.statistics.allocationBytes) / MIB, _budget.statistics.blockCount,
+                        static_cast<float>(_budget.statistics.blockBytes) / MIB);
+        }
+
+        ImGui::Separator();
+        // Blocks are what counts against maxMemoryAllocationCount, allocations are suballocated from them
+        ImGui::Text("%u allocations in %u device memory blocks (limit %u)", _allocationCount, _blockCount,
+                    _deviceProperties->limits.maxMemoryAllocationCount);
+
+        ImGui::End();
     }
     void VulkanImGuiLayer::Begin()
     {
@@ -113,62 +163,6 @@ namespace Thryve::UI {
         ImGui::EndFrame();
         ImGui::Render();
 
-        auto swapChain = &Core::App::Get().GetWindow().As<Rendering::VulkanWindow>()->GetSwapChain();
-        auto _deviceSelector = Rendering::VulkanContext::GetCurrentDevice();
-        VulkanCommandBuffer commandBuffer(_deviceSelector->GetLogicalDevice(), swapChain->GetCommandPool());
-
-        VkClearValue clearValues[2];
-        clearValues[0].color = {{0.1f, 0.1f, 0.1f, 1.0f}};
-        clearValues[1].depthStencil = {1.0f, 0};
-
-        uint32_t width = swapChain->GetSwapchainExtent().width;
-        uint32_t height = swapChain->GetSwapchainExtent().height;
-
-        VkCommandBuffer drawCommandBuffer = commandBuffer.Get();
-        VkCommandBufferBeginInfo drawCmdBufInfo = {};
-        drawCmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        drawCmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-        if (VK_CALL(vkBeginCommandBuffer(drawCommandBuffer, &drawCmdBufInfo)) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Failed to begin recording command buffer!");
-        }
-
-        VkRenderPassBeginInfo renderPassBeginInfo = {};
-        renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassBeginInfo.renderPass = swapChain->GetRenderPass();
-        renderPassBeginInfo.framebuffer = swapChain->GetCurrentFramebuffer();
-        renderPassBeginInfo.renderArea = {{0, 0}, {width, height}};
-        renderPassBeginInfo.clearValueCount = 2;
-        renderPassBeginInfo.pClearValues = clearValues;
-
-        vkCmdBeginRenderPass(drawCommandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-        VkViewport viewport = {};
-        viewport.x = 0.0f;
-        viewport.y = static_cast<float>(height);
-        viewport.height = -static_cast<float>(height);
-        viewport.width = static_cast<float>(width);
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-        vkCmdSetViewport(drawCommandBuffer, 0, 1, &viewport);
-
-        VkRect2D scissor = {};
-        scissor.extent.width = width;
-        scissor.extent.height = height;
-        scissor.offset = {0, 0};
-        vkCmdSetScissor(drawCommandBuffer, 0, 1, &scissor);
-
-        ImDrawData* drawData = ImGui::GetDrawData();
-        ImGui_ImplVulkan_RenderDrawData(drawData, drawCommandBuffer);
-
-        vkCmdEndRenderPass(drawCommandBuffer);
-
-        if (VK_CALL(vkEndCommandBuffer(drawCommandBuffer)) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Failed to record command buffer!");
-        }
-
         ImGuiIO& io = ImGui::GetIO();
         (void)io;
         if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
@@ -177,4 +171,10 @@ namespace Thryve::UI {
             ImGui::RenderPlatformWindowsDefault();
         }
     }
+
+    void VulkanImGuiLayer::RecordDrawData(const VkCommandBuffer commandBuffer) const
+    {
+        // Sets its own viewport and scissor
+        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+    }
 } // namespace Thryve::UI
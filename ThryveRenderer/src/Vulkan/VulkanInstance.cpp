@@ -163,6 +163,20 @@ namespace Thryve::Rendering {
 
         std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
 
+        // Optional, the device selector queries descriptor indexing support through vkGetPhysicalDeviceFeatures2KHR
+        uint32_t availableCount = 0;
+        VK_CALL(vkEnumerateInstanceExtensionProperties(nullptr, &availableCount, nullptr));
+        std::vector<VkExtensionProperties> availableExtensions(availableCount);
+        VK_CALL(vkEnumerateInstanceExtensionProperties(nullptr, &availableCount, availableExtensions.data()));
+        for (const auto &extension : availableExtensions)
+        {
+            if (strcmp(extension.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0)
+            {
+                extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+                break;
+            }
+        }
+
         if (m_enableValidationLayers)
         {
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
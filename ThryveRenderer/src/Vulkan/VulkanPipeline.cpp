@@ -4,8 +4,11 @@
 
 #include "Vulkan/VulkanPipeline.h"
 
+#include <chrono>
 #include <fstream>
 
+#include "Core/ServiceRegistry.h"
+#include "Vulkan/PipelineCacheService.h"
 #include "Vulkan/VulkanContext.h"
 
 VulkanPipeline::VulkanPipeline(const VkRenderPass renderPass) :
@@ -69,9 +72,10 @@ void VulkanPipeline::CreatePipeline(const std::string &vertexShaderPath, const s
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &configInfo.descriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(configInfo.descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = configInfo.descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(configInfo.pushConstantRanges.size());
+    pipelineLayoutInfo.pPushConstantRanges = configInfo.pushConstantRanges.data();
 
     if (vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
@@ -102,10 +106,16 @@ void VulkanPipeline::CreatePipeline(const std::string &vertexShaderPath, const s
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) !=
+    auto _pipelineCacheService = Thryve::Core::ServiceRegistry::GetService<Thryve::Rendering::PipelineCacheService>();
+    const VkPipelineCache _pipelineCache = _pipelineCacheService->GetPipelineCache();
+
+    const auto _creationStart = std::chrono::steady_clock::now();
+    if (vkCreateGraphicsPipelines(m_device, _pipelineCache, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) !=
         VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
+    _pipelineCacheService->RecordPipelineCreation(
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _creationStart).count());
 
     vkDestroyShaderModule(m_device, fragShaderModule, nullptr);
     vkDestroyShaderModule(m_device, vertShaderModule, nullptr);
@@ -118,7 +128,7 @@ std::vector<char> VulkanPipeline::ReadShaderFile(const std::string &filename) {
     std::ifstream file(filename, std::ios::ate | std::ios::binary);
 
     if (!file.is_open()) {
-        throw std::runtime_error("failed to open file!");
+        throw std::runtime_error("failed to open shader " + filename + ", build the ThryveShaders target");
     }
 
     const auto fileSize = static_cast<size_t>(file.tellg());
@@ -6,19 +6,23 @@
 
 
 #define STB_IMAGE_IMPLEMENTATION
-#define TINYOBJLOADER_IMPLEMENTATION
 #include <external/imgui/backends/imgui_impl_vulkan.h>
+#include <chrono>
+#include <cmath>
 #include <iostream>
-#include "tiny_obj_loader.h"
+#include <sstream>
 
 #include "Config.h"
 #include "Core/Camera.h"
+#include "Core/Log.h"
 #include "Core/Profiling.h"
 #include "Core/ServiceRegistry.h"
+#include "Vulkan/PipelineCacheService.h"
 #include "Vulkan/VulkanContext.h"
 #include "Vulkan/VulkanDescriptorManager.h"
 #include "Vulkan/VulkanDescriptorSetBuilder.h"
 #include "Vulkan/VulkanDeviceSelector.h"
+#include "Vulkan/VulkanImGuiLayer.h"
 #include "Vulkan/VulkanUniformBuffer.h"
 #include "glm/ext/matrix_clip_space.hpp"
 #include "stb_image.h"
@@ -36,171 +40,347 @@ namespace Thryve::Rendering {
     VulkanRenderContext::~VulkanRenderContext() {
     }
 
-    void VulkanRenderContext::CreateFramebuffers() {
-        m_swapChain->CreateFramebuffers(m_device);
-    }
-
     void VulkanRenderContext::AssignCommandPool() {
         m_commandPool = m_swapChain->GetCommandPool();
     }
 
-    VkDescriptorPool VulkanRenderContext::CreateDescriptorPool() const {
-
-        std::array<VkDescriptorPoolSize, 2> poolSizes{};
-        // Uniform buffers
-        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-        // Image samplers
-        poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT * 4);
+    void VulkanRenderContext::CreateDescriptorAllocators() {
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            // One uniform buffer and four textures per draw, the pools grow once a frame needs more
+            m_frameDescriptorAllocators[i] = std::make_unique<DescriptorAllocator>(16, std::initializer_list<DescriptorPoolSizeRatio>{
+                {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+                {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+            });
+            m_frameDescriptorSetCaches[i] = std::make_unique<DescriptorSetCache>(*m_frameDescriptorAllocators[i]);
+        }
+    }
 
-        VkDescriptorPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-        poolInfo.pPoolSizes = poolSizes.data();
-        // The maximum number of descriptor sets that can be allocated from the pool
-        poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT * 2); // Assuming one set for UB and one for samplers per frame
+    VkDescriptorSet VulkanRenderContext::GetDrawDescriptorSet(const uint32_t frameIndex) {
+        if (m_bBindless) {
+            // Textures come from the table, the set never changes
+            const std::array<DescriptorWrite, 1> _writes = {
+                DescriptorWrite::DynamicUniformBuffer(0, m_uniformRing->GetBuffer(), 0, sizeof(UniformBufferObject)),
+            };
+            return m_frameDescriptorSetCaches[frameIndex]->GetOrWrite(m_descriptorSetLayout, _writes);
+        }
 
-        VkDescriptorPool descriptorPool;
-        VK_CALL(vkCreateDescriptorPool(VulkanContext::GetCurrentDevice()->GetLogicalDevice(), &poolInfo, nullptr, &descriptorPool));
+        // Fallbacks until a texture is resident, a texture that arrives mid-frame shows up in the next set.
+        // Bindings as declared in triangle.frag, the normal map comes before the metallic map.
+        const std::array<DescriptorWrite, 5> _writes = {
+            DescriptorWrite::DynamicUniformBuffer(0, m_uniformRing->GetBuffer(), 0, sizeof(UniformBufferObject)),
+            DescriptorWrite::CombinedImageSampler(1, m_assetManager->GetTextureDescriptor(m_AlbedoTexture)),
+            DescriptorWrite::CombinedImageSampler(2, m_assetManager->GetTextureDescriptor(m_NormalTexture)),
+            DescriptorWrite::CombinedImageSampler(3, m_assetManager->GetTextureDescriptor(m_MetallicTexture)),
+            DescriptorWrite::CombinedImageSampler(4, m_assetManager->GetTextureDescriptor(m_EmmissionTexture)),
+        };
+        return m_frameDescriptorSetCaches[frameIndex]->GetOrWrite(m_descriptorSetLayout, _writes);
+    }
 
-        return descriptorPool;
+    MaterialPushConstants VulkanRenderContext::GetBindlessMaterial() {
+        MaterialPushConstants _material{};
+        _material.Albedo = m_bindlessTable->GetIndex(m_assetManager->GetTextureDescriptor(m_AlbedoTexture));
+        _material.Normal = m_bindlessTable->GetIndex(m_assetManager->GetTextureDescriptor(m_NormalTexture));
+        _material.Metallic = m_bindlessTable->GetIndex(m_assetManager->GetTextureDescriptor(m_MetallicTexture));
+        _material.Emission = m_bindlessTable->GetIndex(m_assetManager->GetTextureDescriptor(m_EmmissionTexture));
+        return _material;
     }
 
-    void VulkanRenderContext::CreateDescriptorSets() {
+    void VulkanRenderContext::CreateDescriptorSetLayout() {
+        // Dynamic, every object binds the same set at its own offset into the uniform ring
+        VulkanDescriptor _uboDescriptor(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0, VK_SHADER_STAGE_VERTEX_BIT);
+        if (m_bBindless) {
+            // Set 1 is the bindless table, it brings its own layout
+            m_descriptorSetLayout = VulkanDescriptorSetBuilder(*m_descriptorLayoutCache)
+                                        .AddDescriptor(_uboDescriptor)
+                                        .BuildLayout();
+            return;
+        }
 
-        m_descriptorManager->AllocateDescriptorSets(MAX_FRAMES_IN_FLIGHT);
-        m_descriptorSets = m_descriptorManager->GetDescriptorSets();
+        VulkanDescriptor _albedoDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,1, VK_SHADER_STAGE_FRAGMENT_BIT);
+        VulkanDescriptor _metallicDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,3, VK_SHADER_STAGE_FRAGMENT_BIT);
+        VulkanDescriptor _normalDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,2, VK_SHADER_STAGE_FRAGMENT_BIT);
+        VulkanDescriptor _emmissionDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,4, VK_SHADER_STAGE_FRAGMENT_BIT);
 
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            VkDescriptorBufferInfo bufferInfo{};
-            bufferInfo.buffer = m_uniformBuffers[i];
-            bufferInfo.offset = 0;
-            bufferInfo.range = sizeof(UniformBufferObject);
+        // The layout cache owns the layout, so building it does not need the descriptor manager
+        m_descriptorSetLayout = VulkanDescriptorSetBuilder(*m_descriptorLayoutCache)
+                                    .AddDescriptor(_uboDescriptor)
+                                    .AddDescriptor(_albedoDescriptor)
+                                    .AddDescriptor(_metallicDescriptor)
+                                    .AddDescriptor(_normalDescriptor)
+                                    .AddDescriptor(_emmissionDescriptor)
+                                    .BuildLayout();
+    }
 
-            VkDescriptorImageInfo albedoImageInfo{};
-            albedoImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            albedoImageInfo.imageView = m_AlbedoImageView;
-            albedoImageInfo.sampler = m_AlbedoSampler;
+    void VulkanRenderContext::CreateStressInstances() {
+        if constexpr (STRESS_INSTANCE_COUNT == 0) {
+            return;
+        }
 
-            VkDescriptorImageInfo metallicImageInfo{};
-            metallicImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            metallicImageInfo.imageView = m_MetallicImageView;
-            metallicImageInfo.sampler = m_MetallicSampler;
+        // A square grid on the ground, stretching away from the camera behind the scene's robot
+        constexpr float SPACING = 4.0f;
+        const auto _side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(STRESS_INSTANCE_COUNT))));
+        m_stressInstances.resize(STRESS_INSTANCE_COUNT);
+        for (uint32_t i = 0; i < STRESS_INSTANCE_COUNT; i++) {
+            const float _x = (static_cast<float>(i % _side) - 0.5f * static_cast<float>(_side)) * SPACING;
+            const float _z = -static_cast<float>(i / _side + 1) * SPACING;
+            const glm::mat4 _translation = glm::translate(glm::mat4(1.0f), glm::vec3(_x, 0.0f, _z));
+            m_stressInstances[i].Model = glm::rotate(_translation, static_cast<float>(i) * 0.37f, glm::vec3(0.0f, 1.0f, 0.0f));
+            m_stressInstances[i].Textures = glm::uvec4(0);
+        }
+        Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(
+            "Stress benchmark with " + std::to_string(STRESS_INSTANCE_COUNT) + " extra robots");
+    }
 
-            VkDescriptorImageInfo normalImageInfo{};
-            normalImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            normalImageInfo.imageView = m_NormalImageView;
-            normalImageInfo.sampler = m_NormalSampler;
+    void VulkanRenderContext::UpdateSceneBvh() {
+        PROFILE_FUNCTION()
+        // Nothing is drawn before the model is resident, its bounds are only known from then on
+        if (!m_assetManager->GetVertexBuffer(m_modelMesh)) {
+            return;
+        }
 
-            VkDescriptorImageInfo emmissionImageInfo{};
-            emmissionImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            emmissionImageInfo.imageView = m_EmmissionImageView;
-            emmissionImageInfo.sampler = m_EmmissionSampler;
+        const BoundingSphere& _meshBounds = m_assetManager->GetMeshBounds(m_modelMesh);
+        // m_modelMatrix is last frame's, UpdateUniformBuffer turns the robot after culling
+        const Aabb _modelBounds = Aabb::FromSphere(_meshBounds.Transform(m_modelMatrix));
+        if (m_sceneBvh->GetObjectCount() > 0) {
+            m_sceneBvh->UpdateObject(0, _modelBounds);
+            return;
+        }
 
-            VkWriteDescriptorSet _bufferWrite = m_descriptorManager->createBufferDescriptorWrite(m_descriptorSets[i], 0, &bufferInfo);
-            VkWriteDescriptorSet _albedoImageWrite = m_descriptorManager->createImageDescriptorWrite(m_descriptorSets[i], 1, &albedoImageInfo);
-            VkWriteDescriptorSet _metallicImageWrite = m_descriptorManager->createImageDescriptorWrite(m_descriptorSets[i], 2, &metallicImageInfo);
-            VkWriteDescriptorSet _normalImageWrite = m_descriptorManager->createImageDescriptorWrite(m_descriptorSets[i], 3, &normalImageInfo);
-            VkWriteDescriptorSet _emmissionImageWrite = m_descriptorManager->createImageDescriptorWrite(m_descriptorSets[i], 4, &emmissionImageInfo);
+        std::vector<Aabb> _bounds;
+        _bounds.reserve(m_stressInstances.size() + 1);
+        _bounds.push_back(_modelBounds);
+        for (const InstanceData& _instance : m_stressInstances) {
+            _bounds.push_back(Aabb::FromSphere(_meshBounds.Transform(_instance.Model)));
+        }
+        m_sceneBvh->Build(_bounds);
+        Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(
+            "Scene BVH over " + std::to_string(m_sceneBvh->GetObjectCount()) + " objects with " +
+            std::to_string(m_sceneBvh->GetNodeCount()) + " nodes");
+    }
 
-            std::array<VkWriteDescriptorSet, 5> _descriptorWrites = {_bufferWrite, _albedoImageWrite, _metallicImageWrite, _normalImageWrite, _emmissionImageWrite};
+    void VulkanRenderContext::CullStressInstances() {
+        PROFILE_FUNCTION()
+        m_visibleStressInstances.clear();
+        if (m_stressInstances.empty() || !m_assetManager->GetVertexBuffer(m_modelMesh)) {
+            return;
+        }
 
-            vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(_descriptorWrites.size()), _descriptorWrites.data(), 0, nullptr);
+        if constexpr (HIERARCHICAL_CULLING) {
+            m_sceneBvh->Cull(Frustum{g_Camera.CalculateFrustrumPlanes()}, m_visibleSceneObjects);
+            for (const uint32_t _object : m_visibleSceneObjects) {
+                // The scene's robot is drawn regardless
+                if (_object > 0) {
+                    m_visibleStressInstances.push_back(_object - 1);
+                }
+            }
+            PROFILE_COUNTER("Visible Stress Instances", static_cast<int64_t>(m_visibleStressInstances.size()))
+            return;
         }
-    }
 
-    void VulkanRenderContext::CreateDescriptorSetLayout() {
-        //TODO Either Refactor From DescriptorSetManager or make static, needs the Manager instantiated too early at the moment
-        VulkanDescriptor _uboDescriptor(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, VK_SHADER_STAGE_VERTEX_BIT);
-        VulkanDescriptor _albedoDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,1, VK_SHADER_STAGE_FRAGMENT_BIT);
-        VulkanDescriptor _metallicDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,2, VK_SHADER_STAGE_FRAGMENT_BIT);
-        VulkanDescriptor _normalDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,3, VK_SHADER_STAGE_FRAGMENT_BIT);
-        VulkanDescriptor _emmissionDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,4, VK_SHADER_STAGE_FRAGMENT_BIT);
+        if (m_stressBounds.Size() == 0) {
+            const BoundingSphere& _meshBounds = m_assetManager->GetMeshBounds(m_modelMesh);
+            m_stressBounds.Reserve(static_cast<uint32_t>(m_stressInstances.size()));
+            for (const InstanceData& _instance : m_stressInstances) {
+                m_stressBounds.Add(_meshBounds.Transform(_instance.Model));
+            }
+        }
 
-        m_descriptorManager->CreateDescriptorSetLayout({_uboDescriptor, _albedoDescriptor, _metallicDescriptor, _normalDescriptor, _emmissionDescriptor});
-        m_descriptorSetLayout = m_descriptorManager->GetDescriptorSetLayout();
+        m_frustumCuller->Cull(Frustum{g_Camera.CalculateFrustrumPlanes()}, m_stressBounds, m_visibleStressInstances);
+        PROFILE_COUNTER("Visible Stress Instances", static_cast<int64_t>(m_visibleStressInstances.size()))
     }
 
-    void VulkanRenderContext::CreateTextureImage(const std::string& albedoPath, const std::string& metallicPath,
-                                                 const std::string& normalPath, const std::string& emmissionPath) {
-        m_AlbedoTextureImage =
-            std::make_unique<VulkanTextureImage>(m_swapChain->GetCommandPool(), m_commandBuffer);
-        m_AlbedoTextureImage->createTextureImage(albedoPath);
-        m_albedoImage = m_AlbedoTextureImage->GetTextureImage();
-
-        m_MetallicTextureImage = std::make_unique<VulkanTextureImage>(m_swapChain->GetCommandPool(), m_commandBuffer);
-        m_MetallicTextureImage->createTextureImage(metallicPath);
-        m_metallicImage = m_MetallicTextureImage->GetTextureImage();
+    void VulkanRenderContext::PickObject() {
+        GLFWwindow* _window = VulkanContext::GetWindowStatic();
+        const bool _bDown = glfwGetMouseButton(_window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+        const bool _bClicked = _bDown && !m_bPickButtonDown;
+        m_bPickButtonDown = _bDown;
+        if (!_bClicked) {
+            return;
+        }
+        m_pickedObject.reset();
+        if (m_sceneBvh->GetObjectCount() == 0) {
+            return;
+        }
 
-        m_NormalTextureImage = std::make_unique<VulkanTextureImage>(m_swapChain->GetCommandPool(), m_commandBuffer);
-        m_NormalTextureImage->createTextureImage(normalPath);
-        m_normalImage = m_NormalTextureImage->GetTextureImage();
+        PROFILE_FUNCTION()
+        double _cursorX = 0.0;
+        double _cursorY = 0.0;
+        int _width = 0;
+        int _height = 0;
+        glfwGetCursorPos(_window, &_cursorX, &_cursorY);
+        glfwGetWindowSize(_window, &_width, &_height);
+        if (_width == 0 || _height == 0) {
+            return;
+        }
 
-        m_EmmissionTextureImage = std::make_unique<VulkanTextureImage>(m_swapChain->GetCommandPool(), m_commandBuffer);
-        m_EmmissionTextureImage->createTextureImage(emmissionPath);
-        m_EmmissionImage = m_EmmissionTextureImage->GetTextureImage();
+        // The camera's projection has Y up, the cursor's goes down
+        const glm::vec2 _ndc(2.0f * static_cast<float>(_cursorX) / static_cast<float>(_width) - 1.0f,
+                             1.0f - 2.0f * static_cast<float>(_cursorY) / static_cast<float>(_height));
+        m_pickedObject = m_sceneBvh->Raycast(g_Camera.ScreenPointToRay(_ndc));
     }
 
-    void VulkanRenderContext::CreateTextureImageView() {
-        m_AlbedoTextureImage->createTextureImageView();
-        m_AlbedoImageView = m_AlbedoTextureImage->GetTextureImageView();
-
-        m_MetallicTextureImage->createTextureImageView();
-        m_MetallicImageView = m_MetallicTextureImage->GetTextureImageView();
+    void VulkanRenderContext::SubmitInstances() {
+        PROFILE_FUNCTION()
+        const glm::uvec4 _textures(m_material.Albedo, m_material.Normal, m_material.Metallic, m_material.Emission);
+        // Slots only move when a texture replaces its fallback, the transforms never change
+        const bool _bTexturesChanged = !m_stressInstances.empty() && m_stressInstances.front().Textures != _textures;
+        if (_bTexturesChanged) {
+            for (InstanceData& _instance : m_stressInstances) {
+                _instance.Textures = _textures;
+            }
+        }
 
-        m_NormalTextureImage->createTextureImageView();
-        m_NormalImageView = m_NormalTextureImage->GetTextureImageView();
+        if (m_bGpuDriven) {
+            // Object 0 is the scene's robot, the stress instances follow it. Only what changed is uploaded
+            m_gpuScene->UpdateObject(0, InstanceData{m_modelMatrix, _textures});
+            if (_bTexturesChanged) {
+                for (uint32_t i = 0; i < m_stressInstances.size(); i++) {
+                    m_gpuScene->UpdateObject(i + 1, m_stressInstances[i]);
+                }
+            }
+            m_gpuScene->BeginFrame(currentFrame);
+            return;
+        }
 
-        m_EmmissionTextureImage->createTextureImageView();
-        m_EmmissionImageView = m_EmmissionTextureImage->GetTextureImageView();
+        m_instanceBatcher->BeginFrame(currentFrame);
+        m_instanceBatcher->Submit(m_modelMesh, InstanceData{m_modelMatrix, _textures});
+        if (!m_visibleStressInstances.empty()) {
+            m_visibleInstanceData.clear();
+            for (const uint32_t _index : m_visibleStressInstances) {
+                m_visibleInstanceData.push_back(m_stressInstances[_index]);
+            }
+            // Same mesh as the scene's robot, merged into its draw
+            m_instanceBatcher->Submit(m_modelMesh, m_visibleInstanceData);
+        }
     }
 
-    void VulkanRenderContext::CreateTextureSampler() {
-        m_AlbedoTextureImage->createTextureSampler();
-        m_AlbedoSampler = m_AlbedoTextureImage->GetTextureSampler();
+    void VulkanRenderContext::ReportBenchmark(const double recordMilliseconds) {
+        const auto _now = std::chrono::steady_clock::now();
+        if (m_benchmarkFrameCount > 0 || m_lastFrameStart != std::chrono::steady_clock::time_point{}) {
+            m_benchmarkFrameMilliseconds += std::chrono::duration<double, std::milli>(_now - m_lastFrameStart).count();
+            m_benchmarkRecordMilliseconds += recordMilliseconds;
+            ++m_benchmarkFrameCount;
+        }
+        m_lastFrameStart = _now;
 
-        m_MetallicTextureImage->createTextureSampler();
-        m_MetallicSampler = m_MetallicTextureImage->GetTextureSampler();
+        if (m_benchmarkFrameCount < BENCHMARK_FRAMES) {
+            return;
+        }
 
-        m_NormalTextureImage->createTextureSampler();
-        m_NormalSampler = m_NormalTextureImage->GetTextureSampler();
+        const double _recordMilliseconds = m_benchmarkRecordMilliseconds / m_benchmarkFrameCount;
+        const double _frameMilliseconds = m_benchmarkFrameMilliseconds / m_benchmarkFrameCount;
+        uint32_t _drawCount = static_cast<uint32_t>(m_stressUniformOffsets.size()) + 1;
+        if (m_bGpuDriven) {
+            _drawCount = m_gpuScene->GetStats().BatchCount;
+        } else if (m_bInstanced) {
+            _drawCount = m_instanceBatcher->GetStats().DrawCount;
+        }
+        std::ostringstream _message;
+        _message << "Stress benchmark: " << STRESS_INSTANCE_COUNT + 1 << " robots in " << _drawCount << " draws, record "
+                 << _recordMilliseconds << " ms";
+        if (RecordsMainPassInParallel()) {
+            const ParallelCommandRecorderStats& _recorderStats = m_commandRecorder->GetStats();
+            _message << " into " << _recorderStats.SecondaryCount << " secondaries on " << _recorderStats.ThreadCount
+                     << " threads";
+        }
+        _message << ", frame " << _frameMilliseconds << " ms (" << BENCHMARK_FRAMES << " frame average)";
+        Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(_message.str());
+        PROFILE_COUNTER("Stress Record (us)", static_cast<int64_t>(_recordMilliseconds * 1000.0))
+        PROFILE_COUNTER("Stress Frame (us)", static_cast<int64_t>(_frameMilliseconds * 1000.0))
+
+        m_benchmarkRecordMilliseconds = 0.0;
+        m_benchmarkFrameMilliseconds = 0.0;
+        m_benchmarkFrameCount = 0;
+    }
 
-        m_EmmissionTextureImage->createTextureSampler();
-        m_EmmissionSampler = m_EmmissionTextureImage->GetTextureSampler();
+    void VulkanRenderContext::RequestAssets() {
+        PROFILE_FUNCTION()
+        m_AlbedoTexture = m_assetManager->LoadTexture(std::string(RESOURCE_DIR) + "/Robot_Albedo_Map_1K.jpg", TextureKind::Color,
+                                                      FallbackTexture::White, TEXTURE_COMPRESSION, TEXTURE_MIP_SOURCE);
+        m_MetallicTexture = m_assetManager->LoadTexture(std::string(RESOURCE_DIR) + "/Robot_Metallic_Map.jpeg", TextureKind::Mask,
+                                                        FallbackTexture::Black, TEXTURE_COMPRESSION, TEXTURE_MIP_SOURCE);
+        m_NormalTexture = m_assetManager->LoadTexture(std::string(RESOURCE_DIR) + "/Robot_Normal_Map_1K.jpg", TextureKind::Normal,
+                                                      FallbackTexture::FlatNormal, TEXTURE_COMPRESSION, TEXTURE_MIP_SOURCE);
+        m_EmmissionTexture = m_assetManager->LoadTexture(std::string(RESOURCE_DIR) + "/Robot_Emmission_Map.jpeg", TextureKind::Color,
+                                                         FallbackTexture::Black, TEXTURE_COMPRESSION, TEXTURE_MIP_SOURCE);
+        m_modelMesh = m_assetManager->LoadMesh(std::string(RESOURCE_DIR) + "/Robot_Model.obj");
     }
 
     void VulkanRenderContext::InitVulkan()
     {
         PROFILE_FUNCTION();
+        m_initStart = std::chrono::steady_clock::now();
         PickSuitableDevices();
 
         m_swapChain = &Core::App::Get().GetWindow().As<VulkanWindow>()->GetSwapChain();
         m_renderPass = m_swapChain->GetRenderPass();
 
-        m_descriptorPool = CreateDescriptorPool();
-        m_descriptorManager = Core::UniqueRef<VulkanDescriptorManager>::Create(m_descriptorPool);
+        // Every mode's shaders are compiled with the build, a missing one throws when its pipeline is created
+        m_bBindless = BINDLESS_TEXTURES && VulkanContext::GetCurrentDevice()->SupportsDescriptorIndexing();
+        Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(
+            m_bBindless ? "Sampling textures from a bindless table" : "Sampling textures from per-material descriptor sets");
+        if (m_bBindless) {
+            m_bindlessTable = std::make_unique<BindlessTextureTable>(MAX_FRAMES_IN_FLIGHT);
+        }
+
+        Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(
+            m_bInstanced ? "Drawing meshes instanced" : "Drawing one object per draw call");
+
+        m_bGpuDriven = GPU_DRIVEN_DRAWS && m_bInstanced && VulkanContext::GetCurrentDevice()->SupportsIndirectDraws();
+        if (m_bGpuDriven) {
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(
+                VulkanContext::GetCurrentDevice()->SupportsDrawIndirectCount()
+                    ? "Culling on the GPU, compacted draws with vkCmdDrawIndexedIndirectCount"
+                    : "Culling on the GPU, in place draws with vkCmdDrawIndexedIndirect");
+        }
+
+        m_descriptorLayoutCache = std::make_unique<DescriptorLayoutCache>();
+        m_descriptorManager = Core::UniqueRef<VulkanDescriptorManager>::Create(*m_descriptorLayoutCache);
+        CreateDescriptorAllocators();
         CreateDescriptorSetLayout();
         CreateGraphicsPipeline();
+        {
+            const PipelineCacheStats _cacheStats = Core::ServiceRegistry::GetService<PipelineCacheService>()->GetStats();
+            std::ostringstream _message;
+            _message << "Created " << _cacheStats.PipelineCount << " pipelines in "
+                     << _cacheStats.PipelineCreationMilliseconds << " ms with a "
+                     << (_cacheStats.bWarm ? "warm" : "cold") << " pipeline cache (" << _cacheStats.LoadedBytes
+                     << " bytes loaded)";
+            Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(_message.str());
+        }
         AssignCommandPool();
         AssignCommandBuffer();
         // Stop Refactor
 
-        auto _albedoPath = std::string(RESOURCE_DIR) + "/Robot_Albedo_Map_1K.jpg";
-        auto _metallicPath = std::string(RESOURCE_DIR) + "/Robot_Metallic_Map.jpeg";
-        auto _normalPath = std::string(RESOURCE_DIR) + "/Robot_Normal_Map_1K.jpg";
-        auto _emmissionPath = std::string(RESOURCE_DIR) + "/Robot_Emmission_Map.jpeg";
-
-        CreateTextureImage(_albedoPath, _metallicPath, _normalPath, _emmissionPath);
-        CreateTextureImageView();
-        CreateTextureSampler();
-        auto _modelPath = std::string(RESOURCE_DIR)+"/Robot_Model.obj";
-        LoadModel(_modelPath);
-        CreateVertexBuffer();
-        CreateIndexBuffer();
+        m_uploadManager = std::make_unique<UploadManager>();
+        m_assetManager = std::make_unique<AssetManager>(*m_uploadManager, m_commandPool);
+        // Decoded and uploaded while the first frames already render with fallbacks
+        RequestAssets();
+        CreateStressInstances();
+        if (m_bGpuDriven) {
+            m_gpuScene = std::make_unique<GpuDrivenScene>(*m_descriptorLayoutCache, *m_assetManager, MAX_FRAMES_IN_FLIGHT);
+            m_gpuScene->AddObject(m_modelMesh, InstanceData{m_modelMatrix, glm::uvec4(0)});
+            for (const InstanceData& _instance : m_stressInstances) {
+                m_gpuScene->AddObject(m_modelMesh, _instance);
+            }
+        } else if (m_bInstanced) {
+            m_instanceBatcher = std::make_unique<InstanceBatcher>(*m_assetManager, MAX_FRAMES_IN_FLIGHT);
+        }
+        m_frustumCuller = std::make_unique<FrustumCuller>();
+        Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(
+            std::string("Culling on the CPU with ") + FrustumCuller::GetPathName(m_frustumCuller->GetPath()));
+        if (m_bParallelRecording) {
+            m_commandRecorder = std::make_unique<ParallelCommandRecorder>(MAX_FRAMES_IN_FLIGHT);
+        }
+        m_sceneBvh = std::make_unique<BoundingVolumeHierarchy>();
+        m_frameGraph = std::make_unique<RenderGraph>();
+        if constexpr (CULLING_BENCHMARK) {
+            FrustumCuller::RunBenchmark();
+            BoundingVolumeHierarchy::RunBenchmark();
+        }
         CreateUniformBuffer();
-        CreateDescriptorSets();
         CreateSyncObjects();
+        m_gpuProfiler = std::make_unique<VulkanGpuProfiler>(m_commandPool, MAX_FRAMES_IN_FLIGHT);
     }
     void VulkanRenderContext::PickSuitableDevices()
     {
@@ -215,7 +395,9 @@ namespace Thryve::Rendering {
         while (!glfwWindowShouldClose(VulkanContext::GetWindowStatic()))
         {
             glfwPollEvents();
+            PickObject();
             DrawFrame();
+            PROFILE_FRAME_MARK()
         }
 
         VK_CALL(vkDeviceWaitIdle(m_device));
@@ -223,24 +405,30 @@ namespace Thryve::Rendering {
 
     void VulkanRenderContext::Cleanup() {
         PROFILE_FUNCTION();
+        // Waits for any upload still in flight before the resources it writes go away
+        m_uploadManager->WaitIdle();
+        m_instanceBatcher.reset();
+        m_gpuScene.reset();
+        m_commandRecorder.reset();
+        m_frameGraph.reset();
+        m_frustumCuller.reset();
+        m_sceneBvh.reset();
+        m_assetManager.reset();
+        m_uploadManager.reset();
+        m_gpuProfiler.reset();
         m_FrameSynchronizer.reset();
-        m_indexBuffer.reset();
-        m_vulkanVertexBuffer.reset();
         m_pipeline.reset();
+        Core::ServiceRegistry::GetService<PipelineCacheService>()->Release();
+
+        m_uniformRing.reset();
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-             vkDestroyBuffer(m_device, m_uniformBuffers[i], nullptr);
-             vkFreeMemory(m_device, m_uniformBuffersMemory[i], nullptr);
+            m_frameDescriptorSetCaches[i].reset();
+            m_frameDescriptorAllocators[i].reset();
         }
 
-        vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
-
-        m_AlbedoTextureImage.reset();
-        m_MetallicTextureImage.reset();
-        m_NormalTextureImage.reset();
-        m_EmmissionTextureImage.reset();
-
-        vkDestroyDescriptorSetLayout(m_device, m_descriptorSetLayout, nullptr);
+        m_bindlessTable.reset();
+        m_descriptorLayoutCache.reset();
     }
 
     void VulkanRenderContext::CreateGraphicsPipeline() {
@@ -248,119 +436,221 @@ namespace Thryve::Rendering {
         PipelineConfigInfo configInfo;
         configInfo.vertexInput.bindings = {Vertex3D::getBindingDescription()};
         configInfo.vertexInput.attributes = Vertex3D::getAttributeDescriptions();
+        if (m_bInstanced) {
+            configInfo.vertexInput.bindings.push_back(InstanceData::getBindingDescription());
+            const auto _instanceAttributes = InstanceData::getAttributeDescriptions();
+            configInfo.vertexInput.attributes.insert(configInfo.vertexInput.attributes.end(), _instanceAttributes.begin(), _instanceAttributes.end());
+        }
         configInfo.SetViewportAndScissor(WIDTH, HEIGHT);
         configInfo.EnableDynamicViewportAndLineWidth();
-        configInfo.descriptorSetLayout = m_descriptorSetLayout;
+        configInfo.descriptorSetLayouts = {m_descriptorSetLayout};
+        if (m_bBindless) {
+            configInfo.descriptorSetLayouts.push_back(m_bindlessTable->GetLayout());
+            configInfo.pushConstantRanges = {{VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(MaterialPushConstants)}};
+        }
         configInfo.cullMode = VK_CULL_MODE_BACK_BIT;
         configInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
 
         m_pipeline = std::make_unique<VulkanPipeline>(m_renderPass);
 
-        const auto vertexShaderPath = std::string(SHADERS_DIR)+"/SPIRV/triangle.vert.spv";
-        const auto fragmentShaderPath = std::string(SHADERS_DIR)+"/SPIRV/triangle.frag.spv";
+        const auto vertexShaderPath = std::string(SHADERS_DIR) + (m_bInstanced ? "/SPIRV/triangle_instanced.vert.spv" : "/SPIRV/triangle.vert.spv");
+        // Instanced draws read their texture slots from the instance instead of push constants
+        const char* _fragmentShader = m_bBindless ? (m_bInstanced ? "/SPIRV/triangle_instanced.frag.spv" : "/SPIRV/triangle_bindless.frag.spv")
+                                                  : "/SPIRV/triangle.frag.spv";
+        const auto fragmentShaderPath = std::string(SHADERS_DIR) + _fragmentShader;
 
         m_pipeline->CreatePipeline(vertexShaderPath, fragmentShaderPath, configInfo);
     }
 
-    void VulkanRenderContext::CreateVertexBuffer() {
+    void VulkanRenderContext::CreateUniformBuffer() {
         PROFILE_FUNCTION();
-        auto _deviceSelector = VulkanContext::GetCurrentDevice();
-        m_vulkanVertexBuffer = std::make_unique<VulkanVertexBuffer<Vertex3D>>(m_device, m_physicalDevice, m_commandPool, _deviceSelector->GetGraphicsQueue());
-        std::cout << "Model Vertex Count: " << ModelVertices.size() << "\n";
-        m_vulkanVertexBuffer->Create(ModelVertices);
+        // Drawn one by one, every stress instance needs a block of its own. 256 is the largest alignment a device may ask for
+        const uint32_t _blocksPerFrame = 1 + (m_bInstanced ? 0 : STRESS_INSTANCE_COUNT);
+        const VkDeviceSize _bytesPerFrame = std::max(UniformBufferRing::DEFAULT_BYTES_PER_FRAME,
+                                                     _blocksPerFrame * std::max<VkDeviceSize>(sizeof(UniformBufferObject), 256));
+        m_uniformRing = std::make_unique<UniformBufferRing>(MAX_FRAMES_IN_FLIGHT, _bytesPerFrame);
     }
 
-    void VulkanRenderContext::CreateIndexBuffer() {
-        PROFILE_FUNCTION();
-        m_indexBuffer = std::make_unique<VulkanIndexBuffer>(m_commandPool);
-        std::cout << "Model Index Count: " << ModelIndices.size() << "\n";
-        m_indexBuffer->Create(ModelIndices);
+    void VulkanRenderContext::AssignCommandBuffer() {
+        m_commandBuffer = m_swapChain->GetCommandBuffer();
     }
 
-    void VulkanRenderContext::CreateUniformBuffer() {
-        PROFILE_FUNCTION();
-        m_uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-        m_uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-        m_uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
-
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            constexpr VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-            VulkanBufferUtils::CreateBuffer({ m_device, m_physicalDevice, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT}, m_uniformBuffers[i], m_uniformBuffersMemory[i]);
+    void VulkanRenderContext::BuildFrameGraph() {
+        PROFILE_FUNCTION()
+        m_frameGraph->Reset();
+        const VkExtent2D _extent = m_swapChain->GetSwapchainExtent();
+
+        // The acquire semaphore is waited on at the color output stage, the image arrives there
+        m_backbuffer = m_frameGraph->ImportImage(
+            "Backbuffer", {m_swapChain->GetSwapchainImageFormat(), _extent},
+            {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0},
+            {VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0});
+        const RenderGraphResource _depth =
+            m_frameGraph->CreateImage("Depth", {ImageUtils::FindDepthFormat(m_physicalDevice), _extent});
+
+        RenderGraphResource _drawCommands;
+        if (m_bGpuDriven) {
+            // Only ordered through memory barriers, the buffer of the frame is picked inside the scene
+            _drawCommands = m_frameGraph->ImportBuffer("Draw Commands");
+            m_frameGraph->AddPass("Cull Pass", RenderGraphPassType::Compute)
+                .Write(_drawCommands, RenderGraphUsage::StorageCompute)
+                .Execute([this](const VkCommandBuffer commandBuffer, const RenderGraphPassContext&) {
+                    m_gpuScene->RecordCull(commandBuffer, Frustum::FromViewProjection(m_viewProjection));
+                });
+        }
 
-            VK_CALL(vkMapMemory(m_device, m_uniformBuffersMemory[i], 0, bufferSize, 0, &m_uniformBuffersMapped[i]));
+        RenderGraphPassBuilder _mainPass = m_frameGraph->AddPass("Main Pass", RenderGraphPassType::Graphics);
+        _mainPass.ColorAttachment(m_backbuffer, VkClearColorValue{{0.02f, 0.02f, 0.02f, 1.0f}})
+            .DepthAttachment(_depth, VkClearDepthStencilValue{1.0f, 0})
+            .Execute([this](const VkCommandBuffer commandBuffer, const RenderGraphPassContext& context) {
+                RecordMainPass(commandBuffer, context);
+            });
+        if (m_bGpuDriven) {
+            _mainPass.Read(_drawCommands, RenderGraphUsage::IndirectCommand);
+        }
+        if (m_bParallelRecording) {
+            // The item count changes with residency and culling, so the choice is made again every frame
+            _mainPass.SecondaryCommandBuffers([this] { return RecordsMainPassInParallel(); });
         }
-    }
 
-    void VulkanRenderContext::AssignCommandBuffer() {
-        m_commandBuffer = m_swapChain->GetCommandBuffer();
+        // Over the finished scene, with the draw data App::Run built this frame
+        m_frameGraph->AddPass("UI Pass", RenderGraphPassType::Graphics)
+            .ColorAttachment(m_backbuffer)
+            .Execute([](const VkCommandBuffer commandBuffer, const RenderGraphPassContext&) {
+                static_cast<UI::VulkanImGuiLayer*>(Core::App::Get().GetImGuiLayer())->RecordDrawData(commandBuffer);
+            });
+
+        m_frameGraph->Compile();
+        m_frameGraphGeneration = m_swapChain->GetGeneration();
+
+        const RenderGraphStats& _stats = m_frameGraph->GetStats();
+        const TransientAttachmentStats& _transients = _stats.TransientImages;
+        std::ostringstream _message;
+        _message << "Compiled the frame graph at " << _extent.width << "x" << _extent.height << ": "
+                 << _stats.PassCount - _stats.CulledPassCount << " of " << _stats.PassCount << " passes, "
+                 << _stats.BarrierBatchCount << " barrier batches with " << _stats.ImageBarrierCount
+                 << " image and " << _stats.MemoryBarrierCount << " memory barriers";
+        Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(_message.str());
+        // Per resolution, what aliasing and lazy allocation leave of the transient images' memory
+        _message.str({});
+        _message << "Transient images at " << _extent.width << "x" << _extent.height << ": " << _transients.ImageCount
+                 << " images of " << _transients.ImageBytes << " bytes in " << _transients.BlockCount << " blocks of "
+                 << _transients.AllocatedBytes << " bytes (" << _transients.LazyImageCount << " lazily allocated in "
+                 << _transients.LazyBytes << " bytes, " << _transients.ReusedBlockCount << " blocks reused), "
+                 << _transients.SavedBytes << " bytes saved";
+        Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(_message.str());
+        PROFILE_COUNTER("Transient Bytes Saved", static_cast<int64_t>(_transients.SavedBytes))
     }
 
     void VulkanRenderContext::RecordCommandBufferSegment(VkCommandBuffer commandBuffer, const uint32_t imageIndex) {
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    VK_CALL(vkBeginCommandBuffer(commandBuffer, &beginInfo));
-
-    Core::App::Get().SetCurrentImageIndex(imageIndex);
-    const auto framebuffers = m_swapChain->GetFrameBuffers();
-    m_renderPass = m_swapChain->GetRenderPass();
-
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = m_renderPass;
-    renderPassInfo.framebuffer = framebuffers[imageIndex];
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = m_swapChain->GetSwapchainExtent();
-
-    std::array<VkClearValue, 2> clearValues{};
-    clearValues[0].color = {{0.02f, 0.02f, 0.02f, 1.0f}};
-    clearValues[1].depthStencil = {1.f, 0};
-
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
-
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->GetPipeline());
-
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(m_swapChain->GetSwapchainExtent().width);
-    viewport.height = static_cast<float>(m_swapChain->GetSwapchainExtent().height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = m_swapChain->GetSwapchainExtent();
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
-    if (m_vulkanVertexBuffer) {
-        m_vulkanVertexBuffer->Bind(commandBuffer);
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VK_CALL(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+        // The fence of currentFrame was waited on in DrawFrame, so its previous timestamps are ready
+        m_gpuProfiler->BeginFrame(commandBuffer, currentFrame);
+
+        Core::App::Get().SetCurrentImageIndex(imageIndex);
+        m_frameGraph->SetImportedImage(m_backbuffer, m_swapChain->GetSwapchainImages()[imageIndex],
+                                       m_swapChain->GetSwapchainImageViews()[imageIndex]);
+        // Every pass with the barriers in front of it, the backbuffer ends up ready to present
+        m_frameGraph->Execute(commandBuffer);
+
+        VK_CALL(vkEndCommandBuffer(commandBuffer));
+    }
+
+    void VulkanRenderContext::RecordMainPass(const VkCommandBuffer commandBuffer, const RenderGraphPassContext& context) {
+        const uint32_t _itemCount = GetMainPassItemCount();
+        if (context.bSecondaryCommandBuffers) {
+            const std::span<const VkCommandBuffer> _secondaries = m_commandRecorder->Record(
+                context.RenderPass, 0, context.Framebuffer, _itemCount,
+                [this](const VkCommandBuffer secondary, const uint32_t begin, const uint32_t end) {
+                    RecordMainPassItems(secondary, begin, end);
+                });
+            if (!_secondaries.empty()) {
+                vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(_secondaries.size()), _secondaries.data());
+            }
+        } else {
+            RecordMainPassItems(commandBuffer, 0, _itemCount);
+        }
+    }
+
+    bool VulkanRenderContext::RecordsMainPassInParallel() const {
+        // With fewer items the recorder makes a single secondary, which only adds the cost of executing it
+        return m_bParallelRecording && GetMainPassItemCount() >= 2 * ParallelCommandRecorder::MIN_ITEMS_PER_BUFFER;
     }
 
-    if (m_indexBuffer) {
-        m_indexBuffer->Bind(commandBuffer);
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->GetPipelineLayout(), 0, 1, &m_descriptorSets[currentFrame], 0, nullptr);
-        m_indexBuffer->Draw(commandBuffer);
-    } else {
-        m_vulkanVertexBuffer->Draw(commandBuffer);
+    uint32_t VulkanRenderContext::GetMainPassItemCount() const {
+        if (m_bGpuDriven || m_bInstanced) {
+            // A handful of draws, split any further and the secondaries cost more than they save
+            return 1;
+        }
+        // An empty mesh until the model is resident, the frame only clears
+        if (!m_assetManager->GetVertexBuffer(m_modelMesh)) {
+            return 0;
+        }
+        // The scene's robot, then one draw per visible stress instance
+        return static_cast<uint32_t>(m_stressUniformOffsets.size()) + 1;
     }
 
-    vkCmdEndRenderPass(commandBuffer);
+    void VulkanRenderContext::RecordMainPassItems(const VkCommandBuffer commandBuffer, const uint32_t begin,
+                                                  const uint32_t end) const {
+        // Secondaries inherit no state, every one of them sets up the whole pass
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->GetPipeline());
+
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = static_cast<float>(m_swapChain->GetSwapchainExtent().width);
+        viewport.height = static_cast<float>(m_swapChain->GetSwapchainExtent().height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+        VkRect2D scissor{};
+        scissor.offset = {0, 0};
+        scissor.extent = m_swapChain->GetSwapchainExtent();
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->GetPipelineLayout(), 0, 1, &m_drawDescriptorSet, 1, &m_modelUniformOffset);
+        if (m_bBindless) {
+            // Bound once for every material, a draw only pushes its texture indices
+            const VkDescriptorSet _tableSet = m_bindlessTable->GetSet();
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->GetPipelineLayout(), 1, 1, &_tableSet, 0, nullptr);
+            if (!m_bInstanced) {
+                vkCmdPushConstants(commandBuffer, m_pipeline->GetPipelineLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(MaterialPushConstants), &m_material);
+            }
+        }
 
-    VK_CALL(vkEndCommandBuffer(commandBuffer));
-}
+        if (m_bGpuDriven) {
+            m_gpuScene->RecordDraws(commandBuffer);
+        } else if (m_bInstanced) {
+            // Instances carry their transform and texture slots, the set only provides view and projection
+            m_instanceBatcher->Record(commandBuffer);
+        } else if (begin < end) {
+            const auto* _vertexBuffer = m_assetManager->GetVertexBuffer(m_modelMesh);
+            const auto* _indexBuffer = m_assetManager->GetIndexBuffer(m_modelMesh);
+            _vertexBuffer->Bind(commandBuffer);
+            _indexBuffer->Bind(commandBuffer);
+
+            for (uint32_t i = begin; i < end; i++) {
+                if (i > 0) {
+                    // Same set, only the dynamic offset moves to the instance's uniform block
+                    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->GetPipelineLayout(), 0, 1, &m_drawDescriptorSet, 1, &m_stressUniformOffsets[i - 1]);
+                }
+                _indexBuffer->Draw(commandBuffer);
+            }
+        }
+    }
 
     void VulkanRenderContext::CreateSyncObjects() {
         PROFILE_FUNCTION();
         m_FrameSynchronizer = std::make_unique<VulkanFrameSynchronizer>(MAX_FRAMES_IN_FLIGHT);
     }
 
-    void VulkanRenderContext::UpdateUniformBuffer(const uint32_t currentImage) const {
+    void VulkanRenderContext::UpdateUniformBuffer() {
         static auto startTime = std::chrono::high_resolution_clock::now();
 
         const auto currentTime = std::chrono::high_resolution_clock::now();
@@ -371,7 +661,8 @@ namespace Thryve::Rendering {
 
         // Uncomment to add constant Rotation
         float rotationAngle = deltaTime * glm::radians(45.0f); // Rotate at 45 degrees per second
-        ubo.model = glm::rotate(glm::mat4(1.0f), rotationAngle, glm::vec3(0.0f, 1.0f, 0.0f));
+        m_modelMatrix = glm::rotate(glm::mat4(1.0f), rotationAngle, glm::vec3(0.0f, 1.0f, 0.0f));
+        ubo.model = m_modelMatrix;
 
         // Comment out if you want to add rotation
         // Set the model matrix (if you want to rotate the model over time)
@@ -385,8 +676,18 @@ namespace Thryve::Rendering {
 
         // Vulkan clip space has inverted Y and half Z
         ubo.projection[1][1] *= -1;
+        m_viewProjection = ubo.projection * ubo.view;
 
-        memcpy(m_uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+        m_modelUniformOffset = m_uniformRing->Push(ubo);
+
+        if (!m_bInstanced) {
+            m_stressUniformOffsets.clear();
+            for (const uint32_t _index : m_visibleStressInstances) {
+                ubo.model = m_stressInstances[_index].Model;
+                m_stressUniformOffsets.push_back(m_uniformRing->Push(ubo));
+            }
+        }
+        PROFILE_COUNTER("Uniform Ring (bytes)", static_cast<int64_t>(m_uniformRing->GetUsedBytes()))
     }
 
     /*void VulkanRenderContext::UpdateUniformBuffer(const uint32_t currentImage) const {
@@ -423,21 +724,63 @@ namespace Thryve::Rendering {
                     m_swapChain->RecreateSwapChain();
                 }
 
-                UpdateUniformBuffer(currentFrame);
+                // The fence above retired the last frame that wrote this region of the ring
+                m_uniformRing->BeginFrame(currentFrame);
+                UpdateSceneBvh();
+                if (!m_bGpuDriven) {
+                    // The GPU-driven scene culls in its own compute pass
+                    CullStressInstances();
+                }
+                UpdateUniformBuffer();
+                // Hands finished transfers to the graphics queue ahead of this frame's submit
+                m_uploadManager->Update();
+                m_assetManager->Update();
+                // The fence above retired the last frame that used these sets, textures swap in at this boundary
+                m_frameDescriptorSetCaches[currentFrame]->BeginFrame();
+                m_drawDescriptorSet = GetDrawDescriptorSet(currentFrame);
+                if (m_bBindless) {
+                    m_bindlessTable->BeginFrame();
+                    m_material = GetBindlessMaterial();
+                }
+                if (m_bInstanced) {
+                    SubmitInstances();
+                }
+
+                // Every layer's UI for this frame, recorded by the graph's UI pass
+                Core::App::Get().Run();
 
+                if (m_frameGraphGeneration != m_swapChain->GetGeneration()) {
+                    // Transient images and framebuffers of the old extent may still be in use by the other frame
+                    VK_CALL(vkDeviceWaitIdle(m_device));
+                    BuildFrameGraph();
+                }
+                if (m_bParallelRecording) {
+                    // The fence above retired the last frame that executed these pools' secondaries
+                    m_commandRecorder->BeginFrame(currentFrame);
+                }
                 VK_CALL(vkResetFences(m_device, 1, &_syncObjects.in_flight_fence));
                 m_commandBuffer = m_swapChain->GetCommandBuffer();
                 // CommandBuffer goes out od scope somewhere I think
                 VK_CALL(vkResetCommandBuffer(m_commandBuffer, /*VkCommandBufferResetFlagBits*/ 0));
+                const auto _recordStart = std::chrono::steady_clock::now();
                 RecordCommandBufferSegment(m_commandBuffer, _imageIndex);
-
-                // Core::App::Get().Run();
+                if constexpr (STRESS_INSTANCE_COUNT > 0) {
+                    ReportBenchmark(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _recordStart).count());
+                }
 
                 if (!m_FrameSynchronizer->SubmitCommandBuffers(&m_commandBuffer, currentFrame, _imageIndex)) {
                     throw std::runtime_error("Failed to submit draw command buffer!");
                 }
 
-                //TODO Hack to get the UI drawn
+                if (!m_bFirstFrameSubmitted) {
+                    m_bFirstFrameSubmitted = true;
+                    const double _firstFrameMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_initStart).count();
+                    std::ostringstream _message;
+                    _message << "First frame submitted " << _firstFrameMilliseconds << " ms after init, "
+                             << m_assetManager->GetPendingCount() << " assets still streaming";
+                    Core::ServiceRegistry::GetService<Core::DevelopmentLogger>()->LogInfo(_message.str());
+                    PROFILE_COUNTER("Time To First Frame (us)", static_cast<int64_t>(_firstFrameMilliseconds * 1000.0))
+                }
 
                 result = m_swapChain->PresentImage(_imageIndex, _syncObjects.render_finished_semaphore);
                 if (m_swapChain->HandlePresentResult(result)) {
@@ -455,71 +798,4 @@ namespace Thryve::Rendering {
         MainLoop();
         Cleanup();
     }
-
-  void VulkanRenderContext::LoadModel(const std::string& path)
-{
-    PROFILE_FUNCTION()
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string err, warn;
-
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str())) {
-        throw std::runtime_error(warn + err);
-    }
-
-    for (const auto& shape : shapes) {
-        for (size_t i = 0; i < shape.mesh.indices.size(); i += 3) {
-            std::array<Vertex3D, 3> vertices;
-            for (size_t j = 0; j < 3; j++) {
-                tinyobj::index_t idx = shape.mesh.indices[i + j];
-
-                vertices[j].pos = {
-                    attrib.vertices[3 * idx.vertex_index + 0],
-                    attrib.vertices[3 * idx.vertex_index + 1],
-                    attrib.vertices[3 * idx.vertex_index + 2]
-                };
-
-                vertices[j].texCoord = {
-                    attrib.texcoords[2 * idx.texcoord_index + 0],
-                    1.0f - attrib.texcoords[2 * idx.texcoord_index + 1]
-                };
-
-                vertices[j].normal = {
-                    attrib.normals[3 * idx.normal_index + 0],
-                    attrib.normals[3 * idx.normal_index + 1],
-                    attrib.normals[3 * idx.normal_index + 2]
-                };
-            }
-
-            // Calculate tangents and bitangents
-            glm::vec3 edge1 = vertices[1].pos - vertices[0].pos;
-            glm::vec3 edge2 = vertices[2].pos - vertices[0].pos;
-            glm::vec2 deltaUV1 = vertices[1].texCoord - vertices[0].texCoord;
-            glm::vec2 deltaUV2 = vertices[2].texCoord - vertices[0].texCoord;
-
-            float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
-
-            glm::vec3 tangent;
-            tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
-            tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
-            tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
-
-            glm::vec3 bitangent;
-            bitangent.x = f * (-deltaUV2.x * edge1.x + deltaUV1.x * edge2.x);
-            bitangent.y = f * (-deltaUV2.x * edge1.y + deltaUV1.x * edge2.y);
-            bitangent.z = f * (-deltaUV2.x * edge1.z + deltaUV1.x * edge2.z);
-
-            for (size_t j = 0; j < 3; j++) {
-                vertices[j].tangent = tangent;
-                vertices[j].bitangent = bitangent;
-
-                ModelVertices.push_back(vertices[j]);
-                ModelIndices.push_back(static_cast<uint32_t>(ModelVertices.size() - 1));
-            }
-        }
-    }
-}
-
-
 } // namespace Thryve::Rendering
@@ -44,7 +44,8 @@ void VulkanRenderPassBuilder::CreateStandardRenderPasses(const VkFormat swapChai
     depthAttachment.format = ImageUtils::FindDepthFormat(m_deviceSelector->GetPhysicalDevice()); // Ensure this format matches the pipeline
     depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
     depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE; // Changed to STORE
+    // Nothing reads depth after the pass, not storing it lets it stay in tile memory and be lazily allocated
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -69,6 +70,20 @@ void VulkanRenderPassBuilder::CreateStandardRenderPasses(const VkFormat swapChai
     dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
     CreateCustomRenderPass({colorAttachment, depthAttachment}, {subpass}, {dependency}, "default");
+
+    // Draws over what the passes before it left in the color attachment, without depth. Only the attachment
+    // formats matter for pipelines built against it, the frame graph begins its own compatible render pass
+    VkAttachmentDescription overlayAttachment = colorAttachment;
+    overlayAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    overlayAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    overlayAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription overlaySubpass{};
+    overlaySubpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    overlaySubpass.colorAttachmentCount = 1;
+    overlaySubpass.pColorAttachments = &colorAttachmentRef;
+
+    CreateCustomRenderPass({overlayAttachment}, {overlaySubpass}, {}, "overlay");
 }
 
 std::shared_ptr<VulkanRenderPass> VulkanRenderPassBuilder::CreateCustomRenderPass(const std::vector<VkAttachmentDescription> &attachments
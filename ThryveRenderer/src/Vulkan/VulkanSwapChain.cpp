@@ -9,7 +9,6 @@
 #include "GLFW/glfw3.h"
 #include "Vulkan/VulkanContext.h"
 #include "Vulkan/VulkanDeviceSelector.h"
-#include "utils/ImageUtils.h"
 
 VulkanSwapChain::VulkanSwapChain(Thryve::Core::SharedRef<Thryve::Rendering::VulkanContext> context) :
     m_renderPass(nullptr), m_swapChain(nullptr), m_swapChainImageFormat(), m_swapChainExtent()
@@ -88,14 +87,6 @@ void VulkanSwapChain::CleanupSwapChain()
     m_renderPassBuilder.reset();
     m_vulkanCommandBuffer.reset();
     m_commandPoolManager.reset();
-    vkDestroyImageView(_device, m_DepthImageView, nullptr);
-    vkDestroyImage(_device, m_DepthImage, nullptr);
-    vkFreeMemory(_device, m_DepthImageMemory, nullptr);
-
-    for (auto framebuffer : m_Framebuffers)
-    {
-        vkDestroyFramebuffer(_device, framebuffer, nullptr);
-    }
 
     for (auto imageView : m_swapChainImageViews)
     {
@@ -105,31 +96,6 @@ void VulkanSwapChain::CleanupSwapChain()
     vkDestroySwapchainKHR(_device, m_swapChain, nullptr);
 }
 
-void VulkanSwapChain::CreateFramebuffers(VkDevice device)
-{
-    m_Framebuffers.resize(m_swapChainImageViews.size());
-
-    for (size_t i = 0; i < m_swapChainImageViews.size(); i++)
-    {
-        std::array<VkImageView, 2> _attachments = {m_swapChainImageViews[i], m_DepthImageView};
-
-        VkFramebufferCreateInfo framebufferInfo{};
-        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = m_renderPass; /* The render pass that your framebuffers will be used with */
-        ;
-        framebufferInfo.attachmentCount = static_cast<uint32_t>(_attachments.size());
-        framebufferInfo.pAttachments = _attachments.data();
-        framebufferInfo.width = m_swapChainExtent.width;
-        framebufferInfo.height = m_swapChainExtent.height;
-        framebufferInfo.layers = 1;
-
-        if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &m_Framebuffers[i]) != VK_SUCCESS)
-        {
-            throw std::runtime_error("failed to create framebuffer!");
-        }
-    }
-}
-
 void VulkanSwapChain::RecreateSwapChain()
 {
 
@@ -229,9 +195,9 @@ void VulkanSwapChain::CreateSwapChain()
     m_renderPassBuilder = std::make_unique<VulkanRenderPassBuilder>();
     m_renderPassBuilder->CreateStandardRenderPasses(m_swapChainImageFormat);
     m_renderPass = m_renderPassBuilder->GetRenderPass("default")->GetRenderPass();
-    // Framebuffer for (every) Swapchain Image
-    CreateDepthResources();
-    CreateFramebuffers(_device);
+    m_overlayRenderPass = m_renderPassBuilder->GetRenderPass("overlay")->GetRenderPass();
+    // The frame graph owns the depth target and the framebuffers, the render passes are only for compatibility
+    ++m_generation;
 }
 
 void VulkanSwapChain::CreateImageViews()
@@ -367,19 +333,3 @@ VkResult VulkanSwapChain::PresentImage(uint32_t imageIndex, VkSemaphore renderFi
 
     return vkQueuePresentKHR(m_deviceSelector->GetPresentQueue(), &presentInfo);
 }
-
-void VulkanSwapChain::CreateDepthResources()
-{
-    PROFILE_FUNCTION()
-    VkDevice _device = m_deviceSelector->GetLogicalDevice();
-
-    VkFormat _depthFormat = ImageUtils::FindDepthFormat(m_deviceSelector->GetPhysicalDevice());
-
-    ImageUtils::CreateImage(GetSwapchainExtent().width, GetSwapchainExtent().height, _depthFormat,
-                            VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_DepthImage, m_DepthImageMemory);
-    m_DepthImageView = ImageUtils::CreateImageView(m_DepthImage, _depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
-    //    ImageUtils::transitionImageLayout(
-    //        _device, m_commandPool, m_deviceSelector->GetGraphicsQueue(), m_DepthImage, _depthFormat,
-    //        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
-}
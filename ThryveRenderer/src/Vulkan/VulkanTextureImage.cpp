@@ -4,7 +4,14 @@
 
 #include "Vulkan/VulkanTextureImage.h"
 
+#include <chrono>
 #include <complex>
+#include <iostream>
+#include <sstream>
+#include "Core/Log.h"
+#include "Core/ServiceRegistry.h"
+#include "Renderer/Ktx2File.h"
+#include "Renderer/MipCache.h"
 #include "Vulkan/VulkanContext.h"
 #include "stb_image.h"
 
@@ -12,6 +19,37 @@
 #include "utils/VkDebugUtils.h"
 #include "utils/VulkanBufferUtils.h"
 
+namespace {
+    // RGBA8 counterpart of TextureCooker::GetFormat, only colour is stored in sRGB
+    VkFormat GetUncompressedFormat(const Thryve::Rendering::TextureKind kind)
+    {
+        return kind == Thryve::Rendering::TextureKind::Color ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+struct VulkanTextureImage::DecodedTexture {
+    Thryve::Rendering::TextureKind Kind = Thryve::Rendering::TextureKind::Color;
+    MipSource Source = MipSource::None;
+
+    // Exactly one of these holds the texels
+    std::unique_ptr<Thryve::Rendering::Ktx2File> CompressedFile;
+    std::unique_ptr<Thryve::Rendering::CachedMipChain> BakedChain;
+    stbi_uc *Pixels = nullptr;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+
+    DecodedTexture() = default;
+    DecodedTexture(const DecodedTexture &) = delete;
+    DecodedTexture &operator=(const DecodedTexture &) = delete;
+
+    ~DecodedTexture()
+    {
+        if (Pixels)
+        {
+            stbi_image_free(Pixels);
+        }
+    }
+};
 
 VulkanTextureImage::VulkanTextureImage(VkCommandPool commandPool, VkCommandBuffer commandBuffer) :
     m_commandPool(commandPool), m_commandBuffer(commandBuffer)
@@ -30,58 +68,181 @@ VulkanTextureImage::~VulkanTextureImage() {
 void VulkanTextureImage::cleanup() {
     vkDestroySampler(m_device, m_TextureSampler, nullptr);
     vkDestroyImageView(m_device, m_textureImageView, nullptr);
-    vkDestroyImage(m_device, m_textureImage, nullptr);
-    vkFreeMemory(m_device, m_textureImageMemory, nullptr);
+    ImageUtils::DestroyImage(m_textureImage, m_textureImageAllocation);
 }
 
-void VulkanTextureImage::createTextureImage(const std::string &fileName)
+void VulkanTextureImage::createTextureImage(const std::string &fileName, Thryve::Rendering::UploadManager &uploadManager,
+                                            const MipSource mipSource)
 {
-    int texWidth, texHeight, texChannels;
-    const stbi_uc *pixels = stbi_load(fileName.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    const VkDeviceSize imageSize = texWidth * texHeight * 4;
+    decodeTextureImage(fileName, Thryve::Rendering::TextureKind::Color, false, mipSource);
+    uploadTextureImage(uploadManager);
+}
 
-    if (!pixels)
+bool VulkanTextureImage::createCompressedTextureImage(const std::string &fileName,
+                                                      const Thryve::Rendering::TextureKind kind,
+                                                      Thryve::Rendering::UploadManager &uploadManager)
+{
+    if (!Thryve::Rendering::VulkanContext::Get()->GetDevice()->SupportsTextureCompressionBC())
     {
-        throw std::runtime_error("failed to load texture image!");
+        return false;
     }
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
+    decodeTextureImage(fileName, kind, true);
+    uploadTextureImage(uploadManager);
+    return true;
+}
 
-    BufferCreationInfo _stagingBufferCreateInfo{};
-    _stagingBufferCreateInfo.Device = m_device;
-    _stagingBufferCreateInfo.PhysicalDevice = m_PhysicalDevice;
-    _stagingBufferCreateInfo.Size = imageSize;
-    _stagingBufferCreateInfo.Usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    _stagingBufferCreateInfo.Properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+void VulkanTextureImage::decodeTextureImage(const std::string &fileName, const Thryve::Rendering::TextureKind kind,
+                                            const bool bCompressed, MipSource mipSource)
+{
+    PROFILE_FUNCTION()
+    const auto _start = std::chrono::steady_clock::now();
+    auto _decoded = std::make_unique<DecodedTexture>();
+    _decoded->Kind = kind;
 
-    VulkanBufferUtils::CreateBuffer(_stagingBufferCreateInfo, stagingBuffer, stagingBufferMemory);
+    if (bCompressed && Thryve::Rendering::VulkanContext::Get()->GetDevice()->SupportsTextureCompressionBC())
+    {
+        Thryve::Rendering::TextureCookStats _cookStats;
+        const std::string _cookedPath = Thryve::Rendering::TextureCooker::CookIfStale(fileName, kind, &_cookStats);
+        if (_cookStats.bCooked)
+        {
+            std::ostringstream _message;
+            _message << "Cooked " << fileName << " in " << _cookStats.DecodeMilliseconds << " ms decode, "
+                     << _cookStats.MipMilliseconds << " ms mips, " << _cookStats.EncodeMilliseconds << " ms encode, "
+                     << _cookStats.UncompressedBytes << " -> " << _cookStats.CompressedBytes << " bytes";
+            Thryve::Core::ServiceRegistry::GetService<Thryve::Core::DevelopmentLogger>()->LogInfo(_message.str());
+        }
 
-    void *data;
-    vkMapMemory(m_device, stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    vkUnmapMemory(m_device, stagingBufferMemory);
+        // Mapped until the blocks are copied into the upload ring
+        _decoded->CompressedFile = std::make_unique<Thryve::Rendering::Ktx2File>();
+        if (!_decoded->CompressedFile->Open(_cookedPath) ||
+            _decoded->CompressedFile->GetFormat() != Thryve::Rendering::TextureCooker::GetFormat(kind))
+        {
+            throw std::runtime_error("failed to load cooked texture " + _cookedPath);
+        }
+    }
+    else
+    {
+        if (mipSource == MipSource::GpuBlit && !SupportsLinearBlit(GetUncompressedFormat(kind)))
+        {
+            Thryve::Core::ServiceRegistry::GetService<Thryve::Core::DevelopmentLogger>()->LogInfo(
+                "Linear blits of the texture format are not supported, baking the mips of " + fileName + " on the CPU");
+            mipSource = MipSource::Baked;
+        }
+        _decoded->Source = mipSource;
 
-    stbi_image_free((void *)(pixels));
+        if (mipSource == MipSource::Baked)
+        {
+            // Colour is filtered in linear light, normals and masks are linear data already
+            _decoded->BakedChain = Thryve::Rendering::MipCache::LoadOrBake(
+                fileName, kind == Thryve::Rendering::TextureKind::Color, Thryve::Rendering::MipFilter::Kaiser);
+        }
+        else
+        {
+            int texWidth, texHeight, texChannels;
+            _decoded->Pixels = stbi_load(fileName.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+            if (!_decoded->Pixels)
+            {
+                throw std::runtime_error("failed to load texture image " + fileName);
+            }
+            _decoded->Width = static_cast<uint32_t>(texWidth);
+            _decoded->Height = static_cast<uint32_t>(texHeight);
+        }
+    }
 
-    ImageUtils::CreateImage(static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), VK_FORMAT_R8G8B8A8_SRGB,
-                            VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_textureImage, m_textureImageMemory);
+    m_loadStats = {};
+    m_loadStats.DecodeMilliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+    m_loadStats.bCompressed = _decoded->CompressedFile != nullptr;
+    m_decoded = std::move(_decoded);
+}
 
-    ImageUtils::transitionImageLayout(m_device, m_commandPool, m_transferQueue, m_textureImage, VK_FORMAT_B8G8R8A8_SRGB,
-                                      VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    ImageUtils::copyBufferToImage(m_device, m_commandPool, m_transferQueue, stagingBuffer, m_textureImage, texWidth,
-                                  texHeight);
-    ImageUtils::transitionImageLayout(m_device, m_commandPool, m_transferQueue, m_textureImage, VK_FORMAT_B8G8R8A8_SRGB,
-                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+void VulkanTextureImage::uploadTextureImage(Thryve::Rendering::UploadManager &uploadManager)
+{
+    PROFILE_FUNCTION()
+    if (!m_decoded)
+    {
+        throw std::logic_error("decodeTextureImage has to run before uploadTextureImage");
+    }
+    const auto _start = std::chrono::steady_clock::now();
+
+    if (const auto& _file = m_decoded->CompressedFile)
+    {
+        const auto _levels = _file->GetLevels();
+        m_format = _file->GetFormat();
+        m_mipLevels = static_cast<uint32_t>(_levels.size());
+        ImageUtils::CreateImage(_file->GetWidth(), _file->GetHeight(), m_format, VK_IMAGE_TILING_OPTIMAL,
+                                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_textureImage, m_textureImageAllocation,
+                                m_mipLevels);
+        uploadManager.UploadImageLevels(m_textureImage, _levels, _file->GetLevelData().data(),
+                                        _file->GetLevelData().size());
+
+        if (m_decoded->Kind == Thryve::Rendering::TextureKind::Normal)
+        {
+            // BC5 has no blue channel. Reading it as one keeps shaders that still use .rgb roughly right for
+            // mostly flat normals, the fragment shader rebuilds z from x and y.
+            m_components.b = VK_COMPONENT_SWIZZLE_ONE;
+        }
+    }
+    else if (const auto& _chain = m_decoded->BakedChain)
+    {
+        const auto _levels = _chain->GetLevels();
+        m_format = GetUncompressedFormat(m_decoded->Kind);
+        m_mipLevels = static_cast<uint32_t>(_levels.size());
+
+        ImageUtils::CreateImage(_levels[0].Width, _levels[0].Height, m_format, VK_IMAGE_TILING_OPTIMAL,
+                                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_textureImage, m_textureImageAllocation,
+                                m_mipLevels);
+        uploadManager.UploadImageLevels(m_textureImage, _levels, _chain->GetPixels().data(), _chain->GetPixels().size());
+    }
+    else
+    {
+        const uint32_t _width = m_decoded->Width;
+        const uint32_t _height = m_decoded->Height;
+        m_format = GetUncompressedFormat(m_decoded->Kind);
+        m_mipLevels = m_decoded->Source == MipSource::GpuBlit
+            ? Thryve::Rendering::MipGenerator::GetMipLevelCount(_width, _height)
+            : 1;
+
+        // Every level but the last is read back as a blit source
+        const VkImageUsageFlags _usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+            (m_mipLevels > 1 ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0);
+        ImageUtils::CreateImage(_width, _height, m_format, VK_IMAGE_TILING_OPTIMAL, _usage,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_textureImage, m_textureImageAllocation,
+                                m_mipLevels);
+
+        // Copies the pixels into the upload ring, so they can be freed right away
+        uploadManager.UploadImage(m_textureImage, _width, _height, m_decoded->Pixels,
+                                  VkDeviceSize(_width) * _height * 4, m_mipLevels);
+    }
+
+    // Frees the pixels or unmaps the cache file
+    m_decoded.reset();
+
+    VmaAllocationInfo _allocationInfo;
+    vmaGetAllocationInfo(Thryve::Rendering::VulkanContext::Get()->GetDevice()->GetAllocator(),
+                         m_textureImageAllocation, &_allocationInfo);
+    m_loadStats.UploadMilliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+    m_loadStats.GpuBytes = _allocationInfo.size;
+}
+
+bool VulkanTextureImage::SupportsLinearBlit(const VkFormat format) const
+{
+    VkFormatProperties _properties;
+    vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, format, &_properties);
 
-    vkDestroyBuffer(m_device, stagingBuffer, nullptr);
-    vkFreeMemory(m_device, stagingBufferMemory, nullptr);
+    constexpr VkFormatFeatureFlags _required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (_properties.optimalTilingFeatures & _required) == _required;
 }
 
 void VulkanTextureImage::createTextureImageView()
 {
-    m_textureImageView = ImageUtils::CreateImageView(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_textureImageView = ImageUtils::CreateImageView(m_textureImage, m_format, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels,
+                                                     m_components);
 }
 
 void VulkanTextureImage::createTextureSampler() {
@@ -109,7 +270,8 @@ void VulkanTextureImage::createTextureSampler() {
     samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    // Let the hardware pick any level the image has, maxLod used to pin every texture to mip 0
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 
     VK_CALL(vkCreateSampler(m_device, &samplerInfo, nullptr, &m_TextureSampler));
 }
@@ -12,12 +12,9 @@ VulkanUniformBuffer::VulkanUniformBuffer(VkDevice device, VkPhysicalDevice physi
 }
 
 VulkanUniformBuffer::~VulkanUniformBuffer() {
+    // Persistently mapped allocations are unmapped by VMA when they are destroyed
     for (size_t i = 0; i < m_BufferCount; i++) {
-        if (m_UniformBuffersMemory[i] != VK_NULL_HANDLE) {
-            vkUnmapMemory(m_Device, m_UniformBuffersMemory[i]);
-        }
-        vkDestroyBuffer(m_Device, m_UniformBuffers[i], nullptr);
-        vkFreeMemory(m_Device, m_UniformBuffersMemory[i], nullptr);
+        VulkanBufferUtils::DestroyBuffer(m_UniformBuffers[i], m_UniformBufferAllocations[i]);
     }
 }
 
@@ -26,46 +23,12 @@ void VulkanUniformBuffer::UpdateUniformBuffer(uint32_t currentImage, const Unifo
 
 void VulkanUniformBuffer::CreateUniformBuffers() {
     m_UniformBuffers.resize(m_BufferCount);
-    m_UniformBuffersMemory.resize(m_BufferCount);
-
-    for (size_t i = 0; i < m_BufferCount; i++) {
-        CreateBuffer(m_BufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_UniformBuffers[i], m_UniformBuffersMemory[i]);
-    }
-}
-
-void VulkanUniformBuffer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties
-    , VkBuffer&buffer, VkDeviceMemory&bufferMemory) {
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = size;
-    bufferInfo.usage = usage;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    if (vkCreateBuffer(m_Device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create buffer!");
-    }
-
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(m_Device, buffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = VulkanBufferUtils::FindMemoryType(m_PhysicalDevice, memRequirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate buffer memory!");
-    }
-
-    vkBindBufferMemory(m_Device, buffer, bufferMemory, 0);
-    MapMemory();
-}
-
-void VulkanUniformBuffer::MapMemory() {
+    m_UniformBufferAllocations.resize(m_BufferCount);
     m_MappedMemory.resize(m_BufferCount);
 
-    for (size_t i = 0; i < m_BufferCount; ++i) {
-        vkMapMemory(m_Device, m_UniformBuffersMemory[i], 0, m_BufferSize, 0, &m_MappedMemory[i]);
+    for (size_t i = 0; i < m_BufferCount; i++) {
+        const BufferCreationInfo creationInfo{m_Device, m_PhysicalDevice, m_BufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+        VulkanBufferUtils::CreateBuffer(creationInfo, m_UniformBuffers[i], m_UniformBufferAllocations[i], &m_MappedMemory[i]);
     }
 }
-
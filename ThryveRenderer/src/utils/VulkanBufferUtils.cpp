@@ -4,3 +4,42 @@
 
 #include "utils/VulkanBufferUtils.h"
 
+#include "Vulkan/VulkanContext.h"
+
+void VulkanBufferUtils::CreateBuffer(const BufferCreationInfo& creationInfo, VkBuffer& buffer,
+                                     VmaAllocation& allocation, void** mappedData)
+{
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = creationInfo.Size;
+    bufferInfo.usage = creationInfo.Usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    // Required flags keep the memory type choice of the old FindMemoryType path
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_UNKNOWN;
+    allocInfo.requiredFlags = creationInfo.Properties;
+    if (mappedData)
+    {
+        allocInfo.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    }
+
+    VmaAllocationInfo allocationInfo{};
+    VK_CALL(vmaCreateBuffer(Thryve::Rendering::VulkanContext::GetCurrentDevice()->GetAllocator(), &bufferInfo,
+                            &allocInfo, &buffer, &allocation, &allocationInfo));
+
+    if (mappedData)
+    {
+        *mappedData = allocationInfo.pMappedData;
+    }
+}
+
+void VulkanBufferUtils::DestroyBuffer(VkBuffer& buffer, VmaAllocation& allocation)
+{
+    if (buffer != VK_NULL_HANDLE || allocation != VK_NULL_HANDLE)
+    {
+        vmaDestroyBuffer(Thryve::Rendering::VulkanContext::GetCurrentDevice()->GetAllocator(), buffer, allocation);
+    }
+    buffer = VK_NULL_HANDLE;
+    allocation = VK_NULL_HANDLE;
+}
@@ -1,9 +1,11 @@
 #include <iostream>
 
 #include "Core/App.h"
+#include "Core/JobSystem.h"
 #include "Core/Log.h"
 #include "Core/ServiceRegistry.h"
 #include "ThryveApplication.h"
+#include "Vulkan/PipelineCacheService.h"
 
 int main() {
 
@@ -19,8 +21,23 @@ int main() {
     auto _validationLoggerService = Thryve::Core::ServiceRegistry::RegisterService<Thryve::Core::ValidationLayerLogger>("Validation");
     _validationLoggerService->Init(&_valLogConfig);
 
+    Thryve::Core::ProfilingServiceConfiguration _profilingConfig = {};
+    _profilingConfig.StreamTraceEvents = true;
+    _profilingConfig.KeepInvocationHistory = true;
+
     auto _profilingService = Thryve::Core::ServiceRegistry::RegisterService<Thryve::Core::ProfilingService>();
-    _profilingService->Init(nullptr);
+    _profilingService->Init(&_profilingConfig);
+    PROFILE_THREAD_NAME("Main")
+
+    // Registers the main thread as worker 0, so it has to run on the thread that renders
+    Thryve::Core::JobSystemConfiguration _jobSystemConfig = {};
+    auto _jobSystem = Thryve::Core::ServiceRegistry::RegisterService<Thryve::Core::JobSystem>();
+    _jobSystem->Init(&_jobSystemConfig);
+
+    // The cache itself is created lazily once a device exists and saved by the render context on cleanup
+    Thryve::Rendering::PipelineCacheServiceConfiguration _pipelineCacheConfig = {};
+    auto _pipelineCacheService = Thryve::Core::ServiceRegistry::RegisterService<Thryve::Rendering::PipelineCacheService>();
+    _pipelineCacheService->Init(&_pipelineCacheConfig);
 
     auto* _coreApp = new Thryve::Core::App();
 